@@ -0,0 +1,77 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "WinDualSenseReplay.h"
+#include "WinDualSenseBank.h"
+#include "WinDualSenseCalibration.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseBankDecodeTest, "Plugins.WinDualSense.Bank.Decode", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//The vector kernel matches the lane by lane one, and both match the per controller decode the bank replaced, on full and partial lane groups
+bool FDualSenseBankDecodeTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 MaxControllers = FDualSenseControllerBank::MaxControllers;
+	constexpr int32 InputFrames = 64;
+
+	TArray<FDualSenseBankInput> Inputs;
+	FDualSenseCalibration Calibrations[MaxControllers];
+	FVector GyroBiases[MaxControllers];
+	DualSenseReplay::MakeBankInputs(InputFrames, Inputs, Calibrations, GyroBiases);
+
+	const int32 LaneCounts[] = { 1, 4, 5, 16 };
+	for (int32 LaneCount : LaneCounts)
+	{
+		TUniquePtr<FDualSenseControllerBank> Bank = MakeUnique<FDualSenseControllerBank>();
+		int32 KernelMismatches = 0;
+		int32 DecodeMismatches = 0;
+
+		for (int32 Frame = 0; Frame < InputFrames; ++Frame)
+		{
+			const FDualSenseBankInput* FrameInputs = &Inputs[Frame * MaxControllers];
+			for (int32 Controller = 0; Controller < LaneCount; ++Controller)
+			{
+				Bank->SetInput(Controller, FrameInputs[Controller].Buttons, FrameInputs[Controller].State, Calibrations[Controller], false);
+				Bank->SetMotion(Controller, FrameInputs[Controller].Report, GyroBiases[Controller]);
+			}
+
+			TUniquePtr<FDualSenseControllerBank> Reference = MakeUnique<FDualSenseControllerBank>(*Bank);
+			Reference->UpdateScalar(LaneCount);
+			Bank->Update(LaneCount);
+
+			for (int32 Controller = 0; Controller < LaneCount; ++Controller)
+			{
+				//Vector kernel against the lane by lane reference
+				bool bKernelMatches = Reference->PressedButtons[Controller] == Bank->PressedButtons[Controller] && Reference->ReleasedButtons[Controller] == Bank->ReleasedButtons[Controller];
+				for (int32 Row = 0; Row < FDualSenseControllerBank::AnalogCount; ++Row)
+				{
+					bKernelMatches &= FMath::IsNearlyEqual(Reference->AnalogValues[Row][Controller], Bank->AnalogValues[Row][Controller], 1e-5f);
+				}
+				for (int32 Row = 0; Row < FDualSenseControllerBank::MotionCount; ++Row)
+				{
+					bKernelMatches &= FMath::IsNearlyEqual(Reference->MotionValues[Row][Controller], Bank->MotionValues[Row][Controller], 1e-3f);
+				}
+				KernelMismatches += bKernelMatches ? 0 : 1;
+
+				//Bank against the per controller decode it replaced
+				const FDualSenseBankInput& Input = FrameInputs[Controller];
+				bool bDecodeMatches = Bank->Buttons[Controller] == Input.Buttons;
+				for (int32 Type = 0; Type <= (int32)EDualSenseAnalogType::RIGHT_TRIGGER; ++Type)
+				{
+					const float Expected = DualSenseReplay::DecodeAnalog((EDualSenseAnalogType)Type, Input.State, Calibrations[Controller]);
+					bDecodeMatches &= FMath::IsNearlyEqual(Bank->GetAnalog((EDualSenseAnalogType)Type, Controller), Expected, 1e-4f);
+				}
+				bDecodeMatches &= Bank->GetAngularVelocity(Controller).Equals(DualSenseReplay::DecodeVector(EDualSenseVectorType::GYROSCOPE, Input.Report, GyroBiases[Controller]), 1e-3f);
+				bDecodeMatches &= Bank->GetAcceleration(Controller).Equals(DualSenseReplay::DecodeVector(EDualSenseVectorType::ACCELERATION, Input.Report, GyroBiases[Controller]), 1e-3f);
+				DecodeMismatches += bDecodeMatches ? 0 : 1;
+			}
+		}
+
+		TestEqual(FString::Printf(TEXT("%d lanes, Update and UpdateScalar disagree"), LaneCount), KernelMismatches, 0);
+		TestEqual(FString::Printf(TEXT("%d lanes, bank and per controller decode disagree"), LaneCount), DecodeMismatches, 0);
+	}
+	return true;
+}
+
+#endif
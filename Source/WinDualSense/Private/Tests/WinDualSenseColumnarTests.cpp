@@ -0,0 +1,57 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "WinDualSenseReplay.h"
+#include "WinDualSenseSession.h"
+#include "WinDualSenseColumnar.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseColumnarKernelTest, "Plugins.WinDualSense.Columnar.Kernels", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//The scalar and vectorized table builds agree column by column, and the table writes
+bool FDualSenseColumnarKernelTest::RunTest(const FString& Parameters)
+{
+	FDualSenseSession Session;
+	DualSenseReplay::MakeSessionRecording(60.f, 250, Session.Reports);
+	Session.Calibration.LeftStickCenter = FVector2D(1.5f, -0.5f);
+	Session.Calibration.TriggerRest = FVector2D(2.f, 3.f);
+	Session.Calibration.GyroBias = FVector(5.f, -3.f, 2.f);
+
+	FDualSenseColumnarTable Tables[2];
+	DualSenseColumnar::BuildTable(Session, false, Tables[0]);
+	DualSenseColumnar::BuildTable(Session, true, Tables[1]);
+
+	if (!TestEqual(TEXT("Column count"), Tables[1].Columns.Num(), Tables[0].Columns.Num()) || !TestEqual(TEXT("Row count"), Tables[1].RowCount, Tables[0].RowCount))
+		return false;
+
+	//Same conversion, different instructions, a fused multiply add may round the last bit differently
+	for (int32 Column = 0; Column < Tables[0].Columns.Num(); ++Column)
+	{
+		FDualSenseColumn& Scalar = Tables[0].Columns[Column];
+		FDualSenseColumn& Vectorized = Tables[1].Columns[Column];
+		if (Scalar.Type != EDualSenseColumnType::Float32)
+		{
+			TestTrue(FString::Printf(TEXT("Column %d identical"), Column), Scalar.Data == Vectorized.Data);
+			continue;
+		}
+
+		float MaxDifference = 0.f;
+		const float* ScalarValues = Scalar.GetValues<float>();
+		const float* VectorizedValues = Vectorized.GetValues<float>();
+		for (int64 Row = 0; Row < Tables[0].RowCount; ++Row)
+		{
+			MaxDifference = FMath::Max(MaxDifference, FMath::Abs(ScalarValues[Row] - VectorizedValues[Row]) / FMath::Max(1.f, FMath::Abs(ScalarValues[Row])));
+		}
+		TestTrue(FString::Printf(TEXT("Column %d relative difference %g within 1e-6"), Column, MaxDifference), MaxDifference <= 1e-6f);
+	}
+
+	const FString File = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("DualSense"), TEXT("Sessions"), TEXT("ColumnarTest.dscol"));
+	TestTrue(TEXT("Table written"), DualSenseColumnar::WriteFile(Tables[1], File));
+	IFileManager::Get().Delete(*File);
+	return true;
+}
+
+#endif
@@ -0,0 +1,332 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "WinDualSenseReplay.h"
+#include "WinDualSenseDevice.h"
+#include "GenericPlatform/GenericApplicationMessageHandler.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/RunnableThread.h"
+#include "Algo/Count.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#pragma region Dual Sense [Device Tests]
+namespace
+{
+	//Forwards to the real allocator and counts what the added threads allocate while counting is on
+	class FCountingMalloc : public FMalloc
+	{
+	public:
+		FCountingMalloc(FMalloc* InInner) : Inner(InInner)
+		{
+		}
+
+		static constexpr int32 MaxCountedThreads = 4;
+
+		//Before counting starts
+		void AddCountedThread(uint32 ThreadId)
+		{
+			for (std::atomic<uint32>& CountedThreadId : CountedThreadIds)
+			{
+				uint32 Expected = 0;
+				if (CountedThreadId.compare_exchange_strong(Expected, ThreadId))
+				{
+					return;
+				}
+			}
+			check(false);
+		}
+
+		void BeginCounting()
+		{
+			bCounting.store(true, std::memory_order_release);
+		}
+
+		void EndCounting()
+		{
+			bCounting.store(false, std::memory_order_release);
+			for (std::atomic<uint32>& CountedThreadId : CountedThreadIds)
+			{
+				CountedThreadId.store(0, std::memory_order_relaxed);
+			}
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			AddAllocation(Count);
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			AddAllocation(Count);
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			AddAllocation(Count);
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			AddAllocation(Count);
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override
+		{
+			Inner->Free(Original);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			return Inner->QuantizeSize(Count, Alignment);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return Inner->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual void Trim(bool bTrimThreadCaches) override
+		{
+			Inner->Trim(bTrimThreadCaches);
+		}
+
+		virtual void SetupTLSCachesOnCurrentThread() override
+		{
+			Inner->SetupTLSCachesOnCurrentThread();
+		}
+
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+		{
+			Inner->ClearAndDisableTLSCachesOnCurrentThread();
+		}
+
+		virtual bool IsInternallyThreadSafe() const override
+		{
+			return Inner->IsInternallyThreadSafe();
+		}
+
+		virtual const TCHAR* GetDescriptiveName() override
+		{
+			return TEXT("DualSenseCountingMalloc");
+		}
+
+		FMalloc* Inner;
+		std::atomic<uint64> Allocations{ 0 };
+		std::atomic<uint64> AllocatedBytes{ 0 };
+
+	private:
+		FORCEINLINE void AddAllocation(SIZE_T Size)
+		{
+			if (!bCounting.load(std::memory_order_acquire))
+			{
+				return;
+			}
+
+			const uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
+			for (const std::atomic<uint32>& CountedThreadId : CountedThreadIds)
+			{
+				if (CountedThreadId.load(std::memory_order_relaxed) == ThreadId)
+				{
+					Allocations.fetch_add(1, std::memory_order_relaxed);
+					AllocatedBytes.fetch_add(Size, std::memory_order_relaxed);
+					return;
+				}
+			}
+		}
+
+		std::atomic<bool> bCounting{ false };
+		std::atomic<uint32> CountedThreadIds[MaxCountedThreads] = {};
+	};
+
+	//Stands in for the IO thread : injects the reports of each frame the game thread asks for, in lock step with it
+	class FSyntheticReportThread : public FRunnable
+	{
+	public:
+		FSyntheticReportThread(FDualSenseSyntheticFrameProducer& InProducer) : Producer(InProducer)
+		{
+			Thread = FRunnableThread::Create(this, TEXT("DualSenseSyntheticIO"), 0, TPri_AboveNormal);
+		}
+
+		~FSyntheticReportThread()
+		{
+			bStopping.store(true, std::memory_order_release);
+			if (Thread)
+			{
+				Thread->WaitForCompletion();
+				delete Thread;
+			}
+		}
+
+		uint32 GetThreadId() const
+		{
+			return Thread ? Thread->GetThreadID() : 0;
+		}
+
+		//Game thread, returns once the frame's reports are queued
+		void InjectReports(int32 Frame)
+		{
+			RequestedFrame.store(Frame, std::memory_order_release);
+			while (InjectedFrame.load(std::memory_order_acquire) != Frame)
+			{
+				FPlatformProcess::Yield();
+			}
+		}
+
+		virtual uint32 Run() override
+		{
+			while (!bStopping.load(std::memory_order_acquire))
+			{
+				const int32 Frame = RequestedFrame.load(std::memory_order_acquire);
+				if (Frame == InjectedFrame.load(std::memory_order_relaxed))
+				{
+					FPlatformProcess::Yield();
+					continue;
+				}
+
+				Producer.InjectReports(Frame);
+				InjectedFrame.store(Frame, std::memory_order_release);
+			}
+			return 0;
+		}
+
+	private:
+		FDualSenseSyntheticFrameProducer& Producer;
+		FRunnableThread* Thread = nullptr;
+		std::atomic<int32> RequestedFrame{ -1 };
+		std::atomic<int32> InjectedFrame{ -1 };
+		std::atomic<bool> bStopping{ false };
+	};
+
+	//Every first press and release of the face buttons, in dispatch order
+	class FEdgeMessageHandler : public FGenericApplicationMessageHandler
+	{
+	public:
+		virtual bool OnControllerButtonPressed(FGamepadKeyNames::Type KeyName, int32 ControllerId, bool IsRepeat) override
+		{
+			AddEvent(KeyName, true, IsRepeat);
+			return true;
+		}
+
+		virtual bool OnControllerButtonReleased(FGamepadKeyNames::Type KeyName, int32 ControllerId, bool IsRepeat) override
+		{
+			AddEvent(KeyName, false, IsRepeat);
+			return true;
+		}
+
+		int32 GetPressCount() const
+		{
+			return Algo::CountIf(Events, [](const TPair<FName, bool>& Event) { return Event.Value; });
+		}
+
+		TArray<TPair<FName, bool>> Events;
+
+	private:
+		void AddEvent(FGamepadKeyNames::Type KeyName, bool bPressed, bool bIsRepeat)
+		{
+			if (!bIsRepeat && (KeyName == FGamepadKeyNames::FaceButtonBottom || KeyName == FGamepadKeyNames::FaceButtonRight))
+			{
+				Events.Emplace(KeyName, bPressed);
+			}
+		}
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseFrameAllocationTest, "Plugins.WinDualSense.Device.FrameAllocations", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseSubFrameEdgeTest, "Plugins.WinDualSense.Device.SubFrameEdges", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//The whole frame of 16 controllers, on the game and the IO thread, must not allocate once warmed up
+bool FDualSenseFrameAllocationTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 ControllerCount = 16;
+	constexpr int32 Frames = 1000;
+
+	TUniquePtr<FDualSenseIOThread> IOThread = MakeUnique<FDualSenseIOThread>(false);
+	FDualSenseIOThread* Injector = IOThread.Get();
+	for (int32 Controller = 0; Controller < ControllerCount; ++Controller)
+	{
+		Injector->OpenInjectedStream(Controller);
+	}
+
+	FWinDualSenseDevice Device(MakeShared<FGenericApplicationMessageHandler>(), MoveTemp(IOThread));
+	FDualSenseSyntheticFrameProducer Producer(Device, Injector, ControllerCount);
+	FSyntheticReportThread ReportThread(Producer);
+
+	//Warm up, controllers connect and bind
+	for (int32 Frame = 0; Frame < 60; ++Frame)
+	{
+		ReportThread.InjectReports(Frame);
+		Producer.SendOutputs(Frame);
+		Device.SendControllerEvents();
+	}
+
+	//Never freed, another thread may still be inside it after GMalloc is restored
+	static FCountingMalloc* CountingMalloc = new FCountingMalloc(GMalloc);
+	CountingMalloc->Inner = GMalloc;
+	CountingMalloc->Allocations.store(0);
+	CountingMalloc->AllocatedBytes.store(0);
+	CountingMalloc->AddCountedThread(FPlatformTLS::GetCurrentThreadId());
+	CountingMalloc->AddCountedThread(ReportThread.GetThreadId());
+	GMalloc = CountingMalloc;
+
+	//Reports through every IO thread stage, force feedback and output commands from gameplay, then the drain, the output encode and the dispatch
+	CountingMalloc->BeginCounting();
+	for (int32 Frame = 60; Frame < 60 + Frames; ++Frame)
+	{
+		ReportThread.InjectReports(Frame);
+		Producer.SendOutputs(Frame);
+		Device.SendControllerEvents();
+	}
+	CountingMalloc->EndCounting();
+
+	GMalloc = CountingMalloc->Inner;
+
+	TestEqual(FString::Printf(TEXT("Frame allocations (%llu bytes)"), CountingMalloc->AllocatedBytes.load()), CountingMalloc->Allocations.load(), (uint64)0);
+	return true;
+}
+
+//Taps shorter than a frame reach the game as a press and a release, in the same order at any frame rate
+bool FDualSenseSubFrameEdgeTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 ReportRate = 1000;
+
+	TArray<FDualSenseInputReport> Recording;
+	DualSenseReplay::MakeTapRecording(10.f, ReportRate, Recording);
+
+	const uint32 FaceButtons = DualSenseReport::GetButtonMask(EDualSenseButtonType::CROSS) | DualSenseReport::GetButtonMask(EDualSenseButtonType::CIRCLE);
+	const int32 ExpectedPresses = DualSenseReplay::CountPresses(Recording, FaceButtons, ReportRate, 0);
+	const int32 FrameRates[] = { 20, 144 };
+
+	TArray<TPair<FName, bool>> FirstEvents;
+	for (int32 FrameRate : FrameRates)
+	{
+		TUniquePtr<FDualSenseIOThread> IOThread = MakeUnique<FDualSenseIOThread>(false);
+		FDualSenseIOThread* Injector = IOThread.Get();
+		Injector->OpenInjectedStream(0);
+
+		TSharedRef<FEdgeMessageHandler> MessageHandler = MakeShared<FEdgeMessageHandler>();
+		FWinDualSenseDevice Device(MessageHandler, MoveTemp(IOThread));
+		//Simulated frames, nothing arrives while waiting
+		Device.LatchSettings.bEnabled = false;
+		Device.SendControllerEvents();
+
+		const int32 DroppedReports = DualSenseReplay::ReplayFrames(Device, *Injector, Recording, FrameRate);
+
+		TestEqual(FString::Printf(TEXT("%d fps dropped reports"), FrameRate), DroppedReports, 0);
+		TestEqual(FString::Printf(TEXT("%d fps dispatched presses"), FrameRate), MessageHandler->GetPressCount(), ExpectedPresses);
+
+		if (FirstEvents.Num() == 0)
+		{
+			FirstEvents = MessageHandler->Events;
+		}
+		TestTrue(FString::Printf(TEXT("%d fps presses and releases in the same order"), FrameRate), FirstEvents == MessageHandler->Events);
+	}
+	return true;
+}
+#pragma endregion
+
+#endif
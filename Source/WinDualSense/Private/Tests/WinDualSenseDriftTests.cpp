@@ -0,0 +1,84 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "WinDualSenseReplay.h"
+#include "WinDualSenseDrift.h"
+#include "WinDualSense_Struct.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseDriftProfileTest, "Plugins.WinDualSense.Drift.Profiles", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseDriftReacquireTest, "Plugins.WinDualSense.Drift.Reacquire", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//Healthy, worn and drifting sticks : the adaptive deadzone keeps rest reports out and loses no more small input than the fixed one
+bool FDualSenseDriftProfileTest::RunTest(const FString& Parameters)
+{
+	constexpr float Seconds = 120.f;
+	constexpr int32 ReportRate = 250;
+
+	const FDualSenseStickProfile Profiles[] =
+	{
+		{ TEXT("Healthy"), FVector2D(0.4f, -0.6f), FVector2D(0.4f, -0.6f), 0.5f, 0.5f },
+		{ TEXT("Worn"), FVector2D(7.f, -5.f), FVector2D(7.f, -5.f), 1.5f, 3.f },
+		{ TEXT("Drifting"), FVector2D::ZeroVector, FVector2D(36.f, -12.f), 1.f, 1.5f }
+	};
+
+	//The default FDualSenseAnalogData deadzone, no recentering
+	const float FixedDeadZoneRatio = FDualSenseAnalogData().DeadZoneRatio;
+	//Time to learn before anything is scored
+	const int32 WarmUpSamples = FMath::Min(10 * ReportRate, FMath::CeilToInt(Seconds * ReportRate) / 2);
+
+	for (const FDualSenseStickProfile& Profile : Profiles)
+	{
+		TArray<FDualSenseStickSample> Samples;
+		DualSenseReplay::MakeStickSamples(Profile, Seconds, ReportRate, Samples);
+
+		const FDualSenseDriftScore Score = DualSenseReplay::ScoreDrift(Samples, WarmUpSamples, FixedDeadZoneRatio);
+		TestTrue(FString::Printf(TEXT("%s estimate is valid"), Profile.Name), Score.Drift.bIsValid);
+		TestTrue(FString::Printf(TEXT("%s rest leaks %.2f%% within 1%%"), Profile.Name, Score.GetLeakPercent(true)), Score.GetLeakPercent(true) <= 1.0);
+		TestTrue(FString::Printf(TEXT("%s small input lost %lld, fixed deadzone %lld"), Profile.Name, Score.AdaptiveLost, Score.FixedLost), Score.AdaptiveLost <= Score.FixedLost);
+	}
+	return true;
+}
+
+//A stick knocked to a new rest position is learned again there instead of gating every rest out as a held thumb
+bool FDualSenseDriftReacquireTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 ReportRate = 250;
+	constexpr float Seconds = 90.f;
+	constexpr float KnockTime = 30.f;
+	const FVector2D KnockedCenter(20.f, 0.f);
+
+	FRandomStream Random(0x5717C);
+	FDualSenseDriftEstimator Estimator;
+	FDualSenseStickDrift Drift;
+
+	//2 s at rest, 1 s of sweeps, no holds so every rejected window is the new rest
+	const int32 SampleCount = FMath::CeilToInt(Seconds * ReportRate);
+	for (int32 Index = 0; Index < SampleCount; ++Index)
+	{
+		const float Time = (float)Index / ReportRate;
+		FVector2D Position;
+		if (FMath::Fmod(Time, 3.f) < 2.f)
+		{
+			Position = (Time < KnockTime ? FVector2D::ZeroVector : KnockedCenter) + FVector2D(Random.FRandRange(-1.f, 1.f), Random.FRandRange(-1.f, 1.f));
+		}
+		else
+		{
+			Position = FVector2D(110.f * FMath::Sin(2.f * PI * 1.3f * Time), 110.f * FMath::Cos(2.f * PI * 0.9f * Time));
+		}
+
+		const int8 X = (int8)FMath::Clamp(FMath::RoundToInt(Position.X), -128, 127);
+		const int8 Y = (int8)FMath::Clamp(FMath::RoundToInt(Position.Y), -128, 127);
+		if (Estimator.AddSample(X, Y))
+		{
+			Drift = Estimator.GetDrift();
+		}
+	}
+
+	TestTrue(TEXT("Estimate is valid"), Drift.bIsValid);
+	TestTrue(FString::Printf(TEXT("Center %s follows the knocked rest %s"), *Drift.Center.ToString(), *KnockedCenter.ToString()), (Drift.Center - KnockedCenter).Size() <= 2.f);
+	return true;
+}
+
+#endif
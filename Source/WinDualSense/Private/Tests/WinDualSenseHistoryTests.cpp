@@ -0,0 +1,103 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "WinDualSenseReplay.h"
+#include "WinDualSenseHistory.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#pragma region Dual Sense [History Tests]
+namespace
+{
+	FORCEINLINE FDualSenseInputSnapshot MakeSnapshot(const FDualSenseDispatchedInput& Input)
+	{
+		return FDualSenseInputSnapshot::Make(Input.Buttons, Input.LeftStick, Input.RightStick, Input.Triggers[0], Input.Triggers[1]);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseHistoryRollbackTest, "Plugins.WinDualSense.History.Rollback", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseHistoryLookupTest, "Plugins.WinDualSense.History.Lookup", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//A remote peer predicts the last Window frames as the input it had before them, the history must report the first frame that really differs
+bool FDualSenseHistoryRollbackTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Frames = 3600;
+	constexpr int32 Window = 8;
+
+	TArray<FDualSenseDispatchedInput> Inputs;
+	DualSenseReplay::MakeDispatchedInputs(Frames, Inputs);
+
+	FDualSenseInputHistory History;
+	TArray<FDualSenseInputSnapshot> Predicted;
+	Predicted.SetNumUninitialized(Window);
+
+	int64 Rollbacks = 0;
+	int64 WrongRollbacks = 0;
+	for (int32 Frame = 0; Frame < Frames; ++Frame)
+	{
+		History.Capture(Frame, MakeSnapshot(Inputs[Frame]));
+		if (Frame < Window)
+			continue;
+
+		const uint64 FirstFrame = Frame - Window + 1;
+		const FDualSenseInputSnapshot LastKnown = *History.Find(FirstFrame - 1);
+		for (FDualSenseInputSnapshot& Snapshot : Predicted)
+		{
+			Snapshot = LastKnown;
+		}
+		const int64 Mismatch = History.FindFirstDifference(FirstFrame, Predicted.GetData(), Window);
+
+		//Reference : first frame of the window whose quantized input is not the last known one
+		int64 Expected = INDEX_NONE;
+		for (int32 Check = Frame - Window + 1; Check <= Frame && Expected == INDEX_NONE; ++Check)
+		{
+			Expected = MakeSnapshot(Inputs[Check]) != LastKnown ? Check : INDEX_NONE;
+		}
+
+		Rollbacks += Mismatch != INDEX_NONE ? 1 : 0;
+		WrongRollbacks += Mismatch != Expected ? 1 : 0;
+	}
+
+	TestTrue(TEXT("The inputs cause rollbacks"), Rollbacks > 0);
+	TestEqual(TEXT("Wrong rollback frames"), WrongRollbacks, (int64)0);
+	return true;
+}
+
+//Every frame still in the ring decodes to its input within half a step, older ones are gone
+bool FDualSenseHistoryLookupTest::RunTest(const FString& Parameters)
+{
+	const int32 Frames = FDualSenseInputHistory::Capacity * 3;
+
+	TArray<FDualSenseDispatchedInput> Inputs;
+	DualSenseReplay::MakeDispatchedInputs(Frames, Inputs);
+
+	FDualSenseInputHistory History;
+	for (int32 Frame = 0; Frame < Frames; ++Frame)
+	{
+		History.Capture(Frame, MakeSnapshot(Inputs[Frame]));
+	}
+
+	float MaxError = 0.f;
+	int32 LookupErrors = 0;
+	for (int32 Frame = Frames - FDualSenseInputHistory::Capacity; Frame < Frames; ++Frame)
+	{
+		const FDualSenseInputSnapshot* Snapshot = History.Find(Frame);
+		if (!Snapshot || Snapshot->GetButtons() != Inputs[Frame].Buttons)
+		{
+			++LookupErrors;
+			continue;
+		}
+
+		MaxError = FMath::Max(MaxError, FMath::Abs(Snapshot->GetLeftStick().X - Inputs[Frame].LeftStick.X));
+		MaxError = FMath::Max(MaxError, FMath::Abs(Snapshot->GetRightStick().Y - Inputs[Frame].RightStick.Y));
+		MaxError = FMath::Max(MaxError, FMath::Abs(Snapshot->GetTrigger(true) - Inputs[Frame].Triggers[1]));
+	}
+
+	TestEqual(TEXT("Frames in the ring missing or with the wrong buttons"), LookupErrors, 0);
+	TestTrue(FString::Printf(TEXT("Quantization error %.4f within half a step"), MaxError), MaxError <= 0.5f / 63.f + KINDA_SMALL_NUMBER);
+	TestNull(TEXT("Frame evicted from the ring"), History.Find(Frames - FDualSenseInputHistory::Capacity - 1));
+	return true;
+}
+#pragma endregion
+
+#endif
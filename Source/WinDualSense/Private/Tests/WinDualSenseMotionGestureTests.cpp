@@ -0,0 +1,93 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "WinDualSenseReplay.h"
+#include "WinDualSenseMotionGesture.h"
+#include "WinDualSenseDevice.h"
+#include "GenericPlatform/GenericApplicationMessageHandler.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#pragma region Dual Sense [Motion Gesture Tests]
+namespace
+{
+	//Motion gesture buttons, in dispatch order
+	class FMotionGestureMessageHandler : public FGenericApplicationMessageHandler
+	{
+	public:
+		virtual bool OnControllerButtonPressed(FGamepadKeyNames::Type KeyName, int32 ControllerId, bool IsRepeat) override
+		{
+			for (int32 Gesture = 0; Gesture < (int32)EDualSenseMotionGesture::MAX_COUNT; ++Gesture)
+			{
+				if (KeyName == DualSenseMotionGesture::GetKey((EDualSenseMotionGesture)Gesture))
+				{
+					Gestures.Add((EDualSenseMotionGesture)Gesture);
+				}
+			}
+			return true;
+		}
+
+		TArray<EDualSenseMotionGesture> Gestures;
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseMotionGestureScriptTest, "Plugins.WinDualSense.MotionGesture.Script", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//The detector finds every scripted gesture and nothing else at 250 and 1000 Hz, and the device dispatches the same sequence at 60 fps
+bool FDualSenseMotionGestureScriptTest::RunTest(const FString& Parameters)
+{
+	FDualSenseMotionGestureSettings Settings;
+	Settings.bEnabled = true;
+
+	const int32 ReportRates[] = { 250, 1000 };
+	for (int32 ReportRate : ReportRates)
+	{
+		TArray<FDualSenseInputReport> Recording;
+		TArray<FDualSenseScriptedMotionGesture> Script;
+		DualSenseReplay::MakeMotionRecording(ReportRate, Recording, Script);
+
+		//Detector alone, on sensor seconds
+		TArray<TPair<EDualSenseMotionGesture, double>> Detected;
+		{
+			FDualSenseMotionGestureDetector Detector;
+			for (const FDualSenseInputReport& Report : Recording)
+			{
+				Detector.Update(Settings, Report, [&Detected, &Report](EDualSenseMotionGesture Gesture)
+				{
+					Detected.Emplace(Gesture, (double)Report.SensorTimestamp / DualSenseReport::SensorTicksPerSecond);
+				});
+			}
+		}
+
+		int32 Unexpected = 0;
+		const int32 Matched = DualSenseReplay::MatchMotionGestures(Script, Detected, Unexpected);
+		TestEqual(FString::Printf(TEXT("%d Hz scripted gestures detected"), ReportRate), Matched, Script.Num());
+		TestEqual(FString::Printf(TEXT("%d Hz unexpected gestures"), ReportRate), Unexpected, 0);
+
+		//Through the IO thread and the device at 60 fps, dispatched as controller buttons
+		TUniquePtr<FDualSenseIOThread> IOThread = MakeUnique<FDualSenseIOThread>(false);
+		FDualSenseIOThread* Injector = IOThread.Get();
+		Injector->OpenInjectedStream(0);
+
+		TSharedRef<FMotionGestureMessageHandler> MessageHandler = MakeShared<FMotionGestureMessageHandler>();
+		FWinDualSenseDevice Device(MessageHandler, MoveTemp(IOThread));
+		Device.LatchSettings.bEnabled = false;
+		Device.SetMotionGestureSettings(Settings);
+		Device.SendControllerEvents();
+
+		const int32 DroppedReports = DualSenseReplay::ReplayFrames(Device, *Injector, Recording, 60);
+		TestEqual(FString::Printf(TEXT("%d Hz dropped reports"), ReportRate), DroppedReports, 0);
+
+		const TArray<EDualSenseMotionGesture>& Dispatched = MessageHandler->Gestures;
+		bool bSameDispatch = Dispatched.Num() == Detected.Num();
+		for (int32 Index = 0; bSameDispatch && Index < Dispatched.Num(); ++Index)
+		{
+			bSameDispatch = Dispatched[Index] == Detected[Index].Key;
+		}
+		TestTrue(FString::Printf(TEXT("%d Hz dispatched gestures match the detector"), ReportRate), bSameDispatch);
+	}
+	return true;
+}
+#pragma endregion
+
+#endif
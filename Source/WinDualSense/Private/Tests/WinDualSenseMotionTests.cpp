@@ -0,0 +1,64 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "WinDualSenseReplay.h"
+#include "WinDualSenseMotion.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseGyroAimFrameRateTest, "Plugins.WinDualSense.Motion.GyroAimFrameRates", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//One gyro recording through gyro aim at 30 / 60 / 144 fps, the accumulated aim must match the per report reference at every frame
+bool FDualSenseGyroAimFrameRateTest::RunTest(const FString& Parameters)
+{
+	TArray<FDualSenseInputReport> Recording;
+	DualSenseReplay::MakeGyroRecording(10.f, 250, Recording);
+
+	FDualSenseGyroAimSettings Settings;
+	Settings.bEnabled = true;
+	Settings.RatchetButton = EDualSenseButtonType::CROSS;
+
+	//Reference : output consumed after every report
+	TArray<FIntPoint> ReferenceTotals;
+	ReferenceTotals.SetNum(Recording.Num());
+	{
+		FDualSenseMotion Motion;
+		Motion.AimSettings = Settings;
+
+		FIntPoint Total = FIntPoint::ZeroValue;
+		for (int32 Index = 0; Index < Recording.Num(); ++Index)
+		{
+			Motion.AddSample(Recording[Index]);
+			Total += Motion.ConsumeAimDelta();
+			ReferenceTotals[Index] = Total;
+		}
+	}
+	TestTrue(TEXT("The recording turns the aim"), ReferenceTotals.Last() != FIntPoint::ZeroValue);
+
+	//Frames consume whatever reports arrived before them, compared to the reference after the same report
+	const int32 FrameRates[] = { 30, 60, 144 };
+	for (int32 FrameRate : FrameRates)
+	{
+		FDualSenseMotion Motion;
+		Motion.AimSettings = Settings;
+
+		FIntPoint Total = FIntPoint::ZeroValue;
+		int32 MaxDeviation = 0;
+		DualSenseReplay::ReplayFrames(Recording, FrameRate, 0.f,
+			[&Motion](const FDualSenseInputReport& Report)
+			{
+				Motion.AddSample(Report);
+			},
+			[&](int32 LastIndex)
+			{
+				Total += Motion.ConsumeAimDelta();
+				const FIntPoint Deviation = Total - ReferenceTotals[LastIndex];
+				MaxDeviation = FMath::Max(MaxDeviation, FMath::Max(FMath::Abs(Deviation.X), FMath::Abs(Deviation.Y)));
+			});
+
+		TestTrue(FString::Printf(TEXT("%d fps stays within a count of the reference (max %d)"), FrameRate, MaxDeviation), MaxDeviation <= 1);
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,61 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "WinDualSenseReplay.h"
+#include "WinDualSenseOutput.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseOutputQueueTest, "Plugins.WinDualSense.Output.ConcurrentProducers", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//Producer threads flood the output command queue while one consumer drains it : nothing lost, per producer order kept, the last command folded
+bool FDualSenseOutputQueueTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 ProducerCount = 8;
+	constexpr int32 CommandsPerProducer = 20000;
+
+	FDualSenseOutputQueue Queue;
+	std::atomic<bool> bStart{ false };
+
+	TArray<TUniquePtr<FDualSenseOutputCommandProducer>> Producers;
+	for (int32 Producer = 0; Producer < ProducerCount; ++Producer)
+	{
+		Producers.Add(MakeUnique<FDualSenseOutputCommandProducer>(Queue, Producer, CommandsPerProducer, bStart));
+	}
+
+	DS5W::DS5OutputState States[ProducerCount];
+	FMemory::Memzero(States);
+	int32 NextSequences[ProducerCount] = {};
+	int64 OutOfOrder = 0;
+	int64 Received = 0;
+
+	const int64 Expected = (int64)ProducerCount * CommandsPerProducer;
+	const double TimeoutTime = FPlatformTime::Seconds() + 60.0;
+	bStart.store(true, std::memory_order_release);
+
+	while (Received < Expected && FPlatformTime::Seconds() < TimeoutTime)
+	{
+		Received += Queue.Drain([&](const FDualSenseOutputCommand& Command)
+		{
+			const int32 Sequence = FDualSenseOutputCommandProducer::GetSequence(Command.LightBar);
+			OutOfOrder += Sequence != NextSequences[Command.ControllerId] ? 1 : 0;
+			NextSequences[Command.ControllerId] = Sequence + 1;
+			Command.Apply(States[Command.ControllerId]);
+		});
+	}
+
+	for (TUniquePtr<FDualSenseOutputCommandProducer>& Producer : Producers)
+	{
+		Producer->Join();
+	}
+
+	TestEqual(TEXT("Commands received"), Received, Expected);
+	TestEqual(TEXT("Commands out of producer order"), OutOfOrder, (int64)0);
+	for (int32 Producer = 0; Producer < ProducerCount; ++Producer)
+	{
+		TestEqual(FString::Printf(TEXT("Producer %d folded state is its last command"), Producer), FDualSenseOutputCommandProducer::GetSequence(States[Producer].lightbar), CommandsPerProducer - 1);
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,89 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "WinDualSenseReplay.h"
+#include "WinDualSensePointer.h"
+#include "Algo/Count.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSensePointerFrameRateTest, "Plugins.WinDualSense.Pointer.FrameRates", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//The touchpad pointer gives the same pixels (within one) and the same clicks whether it is consumed after every report or once per jittering frame
+bool FDualSensePointerFrameRateTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Seconds = 10;
+
+	TArray<FDualSenseInputReport> Recording;
+	DualSenseReplay::MakePointerRecording(Seconds, 250, Recording);
+
+	FDualSenseTouchPointerSettings Settings;
+	Settings.bEnabled = true;
+
+	//Reference : pixels and clicks consumed after every report
+	TArray<FIntPoint> ReferenceTotals;
+	ReferenceTotals.SetNum(Recording.Num());
+	TArray<EDualSensePointerClick> ReferenceClicks;
+	{
+		FDualSenseTouchPointer Pointer;
+		Pointer.Settings = Settings;
+
+		FIntPoint Total = FIntPoint::ZeroValue;
+		EDualSensePointerClick Clicks[FDualSenseTouchPointer::MaxPendingClicks];
+		for (int32 Index = 0; Index < Recording.Num(); ++Index)
+		{
+			Pointer.AddSample(Recording[Index]);
+			Total += Pointer.ConsumeDelta();
+			ReferenceTotals[Index] = Total;
+			ReferenceClicks.Append(Clicks, Pointer.ConsumeClicks(Clicks));
+		}
+	}
+
+	//Every second : one tap (left) and one touchpad press (right on odd seconds)
+	int32 ExpectedClicks[4] = {};
+	for (int32 Cycle = 0; Cycle < Seconds; ++Cycle)
+	{
+		ExpectedClicks[(int32)EDualSensePointerClick::LeftDown] += Cycle % 2 == 1 ? 1 : 2;
+		ExpectedClicks[(int32)EDualSensePointerClick::RightDown] += Cycle % 2 == 1 ? 1 : 0;
+	}
+	ExpectedClicks[(int32)EDualSensePointerClick::LeftUp] = ExpectedClicks[(int32)EDualSensePointerClick::LeftDown];
+	ExpectedClicks[(int32)EDualSensePointerClick::RightUp] = ExpectedClicks[(int32)EDualSensePointerClick::RightDown];
+
+	for (int32 Click = 0; Click < 4; ++Click)
+	{
+		TestEqual(FString::Printf(TEXT("Reference clicks of type %d"), Click), (int32)Algo::Count(ReferenceClicks, (EDualSensePointerClick)Click), ExpectedClicks[Click]);
+	}
+
+	//Frames consume whatever reports arrived before them, compared to the reference after the same report
+	const int32 FrameRates[] = { 20, 60, 144 };
+	for (int32 FrameRate : FrameRates)
+	{
+		FDualSenseTouchPointer Pointer;
+		Pointer.Settings = Settings;
+
+		FIntPoint Total = FIntPoint::ZeroValue;
+		TArray<EDualSensePointerClick> FrameClicks;
+		EDualSensePointerClick Clicks[FDualSenseTouchPointer::MaxPendingClicks];
+		int32 MaxDeviation = 0;
+
+		DualSenseReplay::ReplayFrames(Recording, FrameRate, 0.5f,
+			[&Pointer](const FDualSenseInputReport& Report)
+			{
+				Pointer.AddSample(Report);
+			},
+			[&](int32 LastIndex)
+			{
+				Total += Pointer.ConsumeDelta();
+				FrameClicks.Append(Clicks, Pointer.ConsumeClicks(Clicks));
+
+				const FIntPoint Deviation = Total - ReferenceTotals[LastIndex];
+				MaxDeviation = FMath::Max(MaxDeviation, FMath::Max(FMath::Abs(Deviation.X), FMath::Abs(Deviation.Y)));
+			});
+
+		TestTrue(FString::Printf(TEXT("%d fps stays within a pixel of the reference (max %d)"), FrameRate, MaxDeviation), MaxDeviation <= 1);
+		TestTrue(FString::Printf(TEXT("%d fps clicks identical to the reference"), FrameRate), FrameClicks == ReferenceClicks);
+	}
+	return true;
+}
+
+#endif
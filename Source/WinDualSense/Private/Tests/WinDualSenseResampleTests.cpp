@@ -0,0 +1,129 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "WinDualSenseReplay.h"
+#include "WinDualSenseResample.h"
+#include "WinDualSenseCalibration.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#pragma region Dual Sense [Resample Tests]
+namespace
+{
+	bool IsSameStep(const FDualSenseResampledStep& A, const FDualSenseResampledStep& B)
+	{
+		return A.Index == B.Index && A.Time == B.Time && A.LeftStick == B.LeftStick && A.RightStick == B.RightStick
+			&& A.LeftTrigger == B.LeftTrigger && A.RightTrigger == B.RightTrigger
+			&& A.Rotation == B.Rotation && A.AngularVelocity == B.AngularVelocity && A.Acceleration == B.Acceleration;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseResampleFrameRateTest, "Plugins.WinDualSense.Resample.FrameRateIndependent", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//The same recording read by games at different, jittering frame rates must give bit identical fixed steps, none skipped
+bool FDualSenseResampleFrameRateTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 StepRate = 120;
+
+	TArray<FDualSenseInputReport> Recording;
+	DualSenseReplay::MakeSessionRecording(30.f, 250, Recording);
+
+	const int32 FrameRates[] = { 20, 60, 144 };
+	const FDualSenseCalibration Calibration;
+	TArray<FDualSenseResampledStep> FirstSteps;
+
+	for (int32 FrameRate : FrameRates)
+	{
+		FDualSenseResampler Resampler;
+		FDualSenseResampleCursor Cursor(1.0 / StepRate);
+		TArray<FDualSenseResampledStep> Steps;
+
+		DualSenseReplay::ReplayFrames(Recording, FrameRate, 0.5f,
+			[&Resampler, &Calibration](const FDualSenseInputReport& Report)
+			{
+				Resampler.AddSample(Report.SensorTimestamp, FDualSenseResampleSample::Make(Report, Calibration, FVector::ZeroVector));
+			},
+			[&Resampler, &Cursor, &Steps](int32 LastIndex)
+			{
+				FDualSenseResampledStep Step;
+				while (Resampler.ConsumeStep(Cursor, Step))
+				{
+					Steps.Add(Step);
+				}
+			});
+
+		TestEqual(FString::Printf(TEXT("%d fps skipped steps"), FrameRate), Cursor.SkippedSteps, (int64)0);
+		if (FirstSteps.Num() == 0)
+		{
+			FirstSteps = Steps;
+			TestTrue(FString::Printf(TEXT("%d fps produced steps"), FrameRate), Steps.Num() > 0);
+			continue;
+		}
+
+		bool bSame = FirstSteps.Num() == Steps.Num();
+		for (int32 Index = 0; bSame && Index < Steps.Num(); ++Index)
+		{
+			bSame = IsSameStep(FirstSteps[Index], Steps[Index]);
+		}
+		TestTrue(FString::Printf(TEXT("%d fps steps identical to %d fps"), FrameRate, FrameRates[0]), bSame);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseResampleLateCursorTest, "Plugins.WinDualSense.Resample.LateCursor", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//A cursor first used long after the oldest kept report must land on the grid of a cursor used from the first report,
+//and a cursor given the first report's timestamp as its origin on that same grid
+bool FDualSenseResampleLateCursorTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 StepRate = 120;
+
+	TArray<FDualSenseInputReport> Recording;
+	DualSenseReplay::MakeSessionRecording(4.f, 250, Recording);
+	const FDualSenseCalibration Calibration;
+
+	FDualSenseResampler Resampler;
+	FDualSenseResampleCursor EarlyCursor(1.0 / StepRate);
+	FDualSenseResampleCursor GivenCursor(1.0 / StepRate, Recording[0].SensorTimestamp);
+	FDualSenseResampleCursor LateCursor(1.0 / StepRate);
+	TMap<int64, FDualSenseResampledStep> EarlySteps;
+
+	int32 GivenMismatches = 0;
+	int32 LateMismatches = 0;
+	int32 LateSteps = 0;
+	for (int32 Index = 0; Index < Recording.Num(); ++Index)
+	{
+		Resampler.AddSample(Recording[Index].SensorTimestamp, FDualSenseResampleSample::Make(Recording[Index], Calibration, FVector::ZeroVector));
+
+		FDualSenseResampledStep Step;
+		while (Resampler.ConsumeStep(EarlyCursor, Step))
+		{
+			EarlySteps.Add(Step.Index, Step);
+		}
+		while (Resampler.ConsumeStep(GivenCursor, Step))
+		{
+			const FDualSenseResampledStep* EarlyStep = EarlySteps.Find(Step.Index);
+			GivenMismatches += EarlyStep && IsSameStep(*EarlyStep, Step) ? 0 : 1;
+		}
+
+		//Starts once the first reports are no longer kept
+		if (Index < Recording.Num() / 2)
+			continue;
+
+		while (Resampler.ConsumeStep(LateCursor, Step))
+		{
+			const FDualSenseResampledStep* EarlyStep = EarlySteps.Find(Step.Index);
+			LateMismatches += EarlyStep && IsSameStep(*EarlyStep, Step) ? 0 : 1;
+			++LateSteps;
+		}
+	}
+
+	TestTrue(TEXT("Late cursor produced steps"), LateSteps > 0);
+	TestEqual(TEXT("Late cursor steps off the first report's grid"), LateMismatches, 0);
+	TestEqual(TEXT("Late cursor skipped steps"), LateCursor.SkippedSteps, (int64)0);
+	TestEqual(TEXT("Given origin steps off the first report's grid"), GivenMismatches, 0);
+	return true;
+}
+#pragma endregion
+
+#endif
@@ -0,0 +1,51 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "WinDualSenseReplay.h"
+#include "WinDualSenseScope.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseScopeClosedTest, "Plugins.WinDualSense.Scope.ClosedWritesNothing", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseScopeReaderTest, "Plugins.WinDualSense.Scope.LappedReader", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//Nobody reading, the producer leaves the ring alone
+bool FDualSenseScopeClosedTest::RunTest(const FString& Parameters)
+{
+	TUniquePtr<FDualSenseScopeBuffer> Buffer = MakeUnique<FDualSenseScopeBuffer>();
+	for (uint64 Index = 0; Index < 10000; ++Index)
+	{
+		Buffer->AddReport(DualSenseReplay::MakeIndexedReport(Index));
+	}
+
+	TestEqual(TEXT("Samples written with the scope closed"), Buffer->GetWrittenCount(), (uint64)0);
+	return true;
+}
+
+//Producer flat out against a display rate reader : the ring is lapped between reads, torn or reordered samples must never come out
+bool FDualSenseScopeReaderTest::RunTest(const FString& Parameters)
+{
+	TUniquePtr<FDualSenseScopeBuffer> Buffer = MakeUnique<FDualSenseScopeBuffer>();
+	Buffer->AddReader();
+
+	FDualSenseScopeReaderThread Reader(*Buffer, 144);
+	uint64 NextIndex = 0;
+	const double EndTime = FPlatformTime::Seconds() + 0.5;
+	while (FPlatformTime::Seconds() < EndTime)
+	{
+		for (int32 Index = 0; Index < 1000; ++Index)
+		{
+			Buffer->AddReport(DualSenseReplay::MakeIndexedReport(NextIndex++));
+		}
+	}
+	Reader.Finish();
+	Buffer->RemoveReader();
+
+	TestTrue(TEXT("Reader read the ring"), Reader.Reads > 0);
+	TestTrue(TEXT("Reader saw samples"), Reader.SeenSamples > 0);
+	TestEqual(TEXT("Corrupt samples"), Reader.CorruptSamples, (uint64)0);
+	TestEqual(TEXT("Out of order samples"), Reader.OutOfOrderSamples, (uint64)0);
+	return true;
+}
+
+#endif
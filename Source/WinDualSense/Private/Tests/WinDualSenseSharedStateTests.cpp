@@ -0,0 +1,63 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "WinDualSenseReplay.h"
+#include "WinDualSenseSharedState.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseSharedStateTest, "Plugins.WinDualSense.SharedState.ConcurrentReaders", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//Readers polling every controller through their own mapping while the writer publishes at 1000 Hz must never see a torn record
+bool FDualSenseSharedStateTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 ReportRate = 1000;
+	constexpr int32 ReaderCount = 2;
+
+	const FString Name = FString::Printf(TEXT("Local\\DualSenseStateTest_%u"), FPlatformProcess::GetCurrentProcessId());
+	FDualSenseSharedStateWriter Writer;
+	if (!TestTrue(FString::Printf(TEXT("Shared state %s opened"), *Name), Writer.Open(Name)))
+		return false;
+
+	TArray<TUniquePtr<FDualSenseSharedStateReaderThread>> Readers;
+	for (int32 Reader = 0; Reader < ReaderCount; ++Reader)
+	{
+		Readers.Add(MakeUnique<FDualSenseSharedStateReaderThread>(Name, Reader));
+	}
+
+	//Every controller gets every index, so it matches the WriteCount the region stamps into the record
+	uint64 NextIndex = 0;
+	const double Interval = 1.0 / ReportRate;
+	const double EndTime = FPlatformTime::Seconds() + 1.0;
+	double NextReportTime = FPlatformTime::Seconds();
+	while (FPlatformTime::Seconds() < EndTime)
+	{
+		const FDualSenseInputReport Report = DualSenseReplay::MakeIndexedReport(NextIndex++);
+		for (int32 Controller = 0; Controller < (int32)DualSenseShared::MaxControllers; ++Controller)
+		{
+			Writer.Publish(Controller, Report);
+		}
+		Writer.Heartbeat();
+
+		NextReportTime += Interval;
+		const double WaitTime = NextReportTime - FPlatformTime::Seconds();
+		if (WaitTime > 0.0)
+		{
+			FPlatformProcess::SleepNoStats((float)WaitTime);
+		}
+	}
+
+	for (int32 Reader = 0; Reader < ReaderCount; ++Reader)
+	{
+		FDualSenseSharedStateReaderThread& Thread = *Readers[Reader];
+		Thread.Finish();
+		TestFalse(FString::Printf(TEXT("Reader %d failed to open"), Reader), Thread.bOpenFailed);
+		TestTrue(FString::Printf(TEXT("Reader %d read records"), Reader), Thread.ReadRecords > 0);
+		TestEqual(FString::Printf(TEXT("Reader %d corrupt records"), Reader), Thread.CorruptRecords, (uint64)0);
+	}
+
+	Writer.Close();
+	return true;
+}
+
+#endif
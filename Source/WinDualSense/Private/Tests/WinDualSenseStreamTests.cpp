@@ -0,0 +1,160 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "WinDualSenseReplay.h"
+#include "WinDualSenseStream.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseStreamRoundTripTest, "Plugins.WinDualSense.Stream.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//A session recording streamed over localhost, paced like the controller sends it, must come out of the host unchanged.
+//Without loss every report arrives, with loss whatever arrives or is recovered from redundancy must still match
+bool FDualSenseStreamRoundTripTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 ReportRate = 250;
+	const int32 Port = DualSenseStream::DefaultPort + 2;
+
+	TArray<FDualSenseInputReport> Reports;
+	DualSenseReplay::MakeSessionRecording(2.f, ReportRate, Reports);
+
+	TMap<uint32, int32> ReportIndices;
+	ReportIndices.Reserve(Reports.Num());
+	for (int32 Index = 0; Index < Reports.Num(); ++Index)
+	{
+		ReportIndices.Add(Reports[Index].SensorTimestamp, Index);
+	}
+
+	struct FStreamCase
+	{
+		int32 Redundancy;
+		float Loss;
+	};
+	const FStreamCase Cases[] = { { 0, 0.f }, { 2, 0.1f } };
+
+	for (const FStreamCase& Case : Cases)
+	{
+		FDualSenseIOThread IOThread(false);
+		FDualSenseStreamHost Host(IOThread, 0);
+		if (!TestTrue(FString::Printf(TEXT("Stream host started on port %d"), Port), Host.Start(Port)))
+			return false;
+
+		FDualSenseStreamClient Client;
+		if (!TestTrue(FString::Printf(TEXT("Stream client connected to port %d"), Port), Client.Connect(TEXT("127.0.0.1"), Port)))
+			return false;
+		Client.Encoder.Redundancy = Case.Redundancy;
+		Client.DropRate = Case.Loss;
+
+		int32 Received = 0;
+		int32 Mismatches = 0;
+		auto DrainHost = [&]()
+		{
+			FDualSenseInputReport Decoded;
+			while (IOThread.DequeueReport(0, Decoded))
+			{
+				const int32* Index = ReportIndices.Find(Decoded.SensorTimestamp);
+				if (!Index)
+				{
+					++Mismatches;
+					continue;
+				}
+
+				++Received;
+				Mismatches += FDualSenseStreamState::FromReport(Decoded) == FDualSenseStreamState::FromReport(Reports[*Index]) ? 0 : 1;
+			}
+		};
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < Reports.Num(); ++Index)
+		{
+			const double SendTime = StartTime + (double)Index / ReportRate;
+			while (FPlatformTime::Seconds() < SendTime)
+			{
+				DrainHost();
+				FPlatformProcess::SleepNoStats(0.0005f);
+			}
+			Client.Send(Reports[Index]);
+		}
+
+		const double DrainEndTime = FPlatformTime::Seconds() + 0.5;
+		while (FPlatformTime::Seconds() < DrainEndTime)
+		{
+			DrainHost();
+			FPlatformProcess::SleepNoStats(0.001f);
+		}
+
+		const FString Description = FString::Printf(TEXT("Redundancy %d, loss %.0f%%"), Case.Redundancy, Case.Loss * 100.f);
+		TestEqual(Description + TEXT(" mismatched reports"), Mismatches, 0);
+		if (Case.Loss > 0.f)
+		{
+			TestTrue(Description + TEXT(" received reports"), Received > 0);
+		}
+		else
+		{
+			TestEqual(Description + TEXT(" received reports"), Received, Reports.Num());
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseStreamKeyFrameTest, "Plugins.WinDualSense.Stream.KeyFrameRecovery", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//A restarted host lost every baseline the client deltas against. It asks for a key frame and decodes again from the next packet.
+//A host that stops acking makes the client fall back to key frames after AckTimeout packets on its own
+bool FDualSenseStreamKeyFrameTest::RunTest(const FString& Parameters)
+{
+	TArray<FDualSenseInputReport> Reports;
+	DualSenseReplay::MakeSessionRecording(1.f, 250, Reports);
+
+	FDualSenseStreamEncoder Encoder;
+	FDualSenseStreamDecoder Decoder;
+	uint8 Datagram[DualSenseStream::MaxDatagramSize];
+	int32 NextReport = 0;
+
+	//Sends the next report, acks or asks for a key frame like the host thread. Returns whether it came out unchanged
+	auto SendNext = [&]()
+	{
+		const FDualSenseInputReport& Report = Reports[NextReport++];
+		bool bMatches = false;
+		const bool bHasNewPacket = Decoder.Decode(Datagram, Encoder.Encode(Report, Datagram), [&](const FDualSenseInputReport& Decoded)
+		{
+			bMatches = FDualSenseStreamState::FromReport(Decoded) == FDualSenseStreamState::FromReport(Report);
+		});
+
+		if (bHasNewPacket)
+		{
+			Encoder.Acknowledge(Decoder.GetNewestSequence());
+		}
+		else if (Decoder.NeedsKeyFrame())
+		{
+			Encoder.RequestKeyFrame(Decoder.GetUndecodableSequence());
+		}
+		return bMatches;
+	};
+
+	for (int32 Index = 0; Index < 20; ++Index)
+	{
+		SendNext();
+	}
+	TestEqual(TEXT("Key frames before the restart"), Encoder.KeyFrames.load(), (uint64)1);
+
+	Decoder.Reset();
+	TestFalse(TEXT("Delta decoded by the restarted host"), SendNext());
+	TestTrue(TEXT("Restarted host asks for a key frame"), Decoder.NeedsKeyFrame());
+	TestTrue(TEXT("Key frame after the request decoded"), SendNext());
+	TestEqual(TEXT("Key frames after the restart"), Encoder.KeyFrames.load(), (uint64)2);
+	TestTrue(TEXT("Deltas decoded after the key frame"), SendNext() && SendNext());
+
+	//No more acks
+	for (int32 Index = 0; Index < DualSenseStream::AckTimeout; ++Index)
+	{
+		Encoder.Encode(Reports[NextReport++], Datagram);
+	}
+	TestEqual(TEXT("Key frames inside the ack timeout"), Encoder.KeyFrames.load(), (uint64)2);
+	Encoder.Encode(Reports[NextReport++], Datagram);
+	TestEqual(TEXT("Ack timeouts"), Encoder.AckTimeouts.load(), (uint64)1);
+	TestEqual(TEXT("Key frames after the ack timeout"), Encoder.KeyFrames.load(), (uint64)3);
+	return true;
+}
+
+#endif
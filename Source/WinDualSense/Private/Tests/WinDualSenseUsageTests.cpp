@@ -0,0 +1,71 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "WinDualSenseReplay.h"
+#include "WinDualSenseUsage.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDualSenseUsageCountTest, "Plugins.WinDualSense.Usage.Counts", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//Every report, press and release of a session is counted once, and lands in exactly one cell / bucket of each map
+bool FDualSenseUsageCountTest::RunTest(const FString& Parameters)
+{
+	TArray<FDualSenseInputReport> Recording;
+	DualSenseReplay::MakeTapSessionRecording(60.f, 250, Recording);
+
+	FDualSenseUsageTracker Tracker;
+	for (const FDualSenseInputReport& Report : Recording)
+	{
+		Tracker.AddReport(Report);
+	}
+
+	//Presses and releases straight from the recording
+	uint64 ExpectedPresses[FDualSenseUsageSnapshot::ButtonCount] = {};
+	uint64 ExpectedReleases = 0;
+	uint32 LastButtons = 0;
+	for (const FDualSenseInputReport& Report : Recording)
+	{
+		const uint32 ChangedButtons = Report.Buttons ^ LastButtons;
+		for (int32 Index = 0; Index < FDualSenseUsageSnapshot::ButtonCount; ++Index)
+		{
+			if (ChangedButtons & (1u << Index))
+			{
+				ExpectedPresses[Index] += (Report.Buttons & (1u << Index)) ? 1 : 0;
+				ExpectedReleases += (Report.Buttons & (1u << Index)) ? 0 : 1;
+			}
+		}
+		LastButtons = Report.Buttons;
+	}
+
+	FDualSenseUsageSnapshot Usage;
+	Usage.Capture(Tracker.GetCounters());
+
+	uint64 Releases = 0;
+	for (uint64 Holds : Usage.Holds)
+	{
+		Releases += Holds;
+	}
+
+	TestEqual(TEXT("Reports"), Usage.Reports, (uint64)Recording.Num());
+	TestEqual(TEXT("Releases"), Releases, ExpectedReleases);
+	for (int32 Index = 0; Index < FDualSenseUsageSnapshot::ButtonCount; ++Index)
+	{
+		TestEqual(FString::Printf(TEXT("Button %d presses"), Index), Usage.Presses[Index], ExpectedPresses[Index]);
+	}
+
+	const TCHAR* MapNames[] = { TEXT("Left stick"), TEXT("Right stick"), TEXT("Left trigger"), TEXT("Right trigger"), TEXT("Gyro") };
+	const TArrayView<const uint64> Maps[] = { MakeArrayView(Usage.LeftStick), MakeArrayView(Usage.RightStick), MakeArrayView(Usage.LeftTrigger), MakeArrayView(Usage.RightTrigger), MakeArrayView(Usage.Gyro) };
+	for (int32 Map = 0; Map < (int32)UE_ARRAY_COUNT(Maps); ++Map)
+	{
+		uint64 Total = 0;
+		for (uint64 Value : Maps[Map])
+		{
+			Total += Value;
+		}
+		TestEqual(FString::Printf(TEXT("%s map total"), MapNames[Map]), Total, Usage.Reports);
+	}
+	return true;
+}
+
+#endif
@@ -9,8 +9,24 @@
 #include "GenericPlatform/GenericApplicationMessageHandler.h"
 #include "GenericPlatform/GenericApplication.h"
 #include <GameFramework/InputSettings.h>
+#include "Async/Async.h"
 #include <Windows.h>
 
+namespace
+{
+	enum class ELibraryState : uint8
+	{
+		Unloaded,
+		Loading,
+		Loaded,
+		//Shut down before the load finished, the load task frees the library itself
+		Abandoned
+	};
+
+	//Moved by the library load task and ShutdownModule, read by the IO thread before it touches DS5W
+	std::atomic<ELibraryState> LibraryState{ ELibraryState::Unloaded };
+}
+
 //#define LOCTEXT_NAMESPACE "InputKeys"
 //const FKey EKeys::PS5_Logo("PS5_Logo");
 //const FKey EKeys::PS5_Mic("PS5_Mic");
@@ -21,39 +37,81 @@
 #pragma region Dual Sense [Plugin]
 void FWinDualSensePlugin::StartupModule()
 {
+	const double StartTime = FPlatformTime::Seconds();
+
 	IInputDeviceModule::StartupModule();
 	
 	//Binding Additional Keys
 	EKeys::AddMenuCategoryDisplayInfo("PS5", LOCTEXT("PS5SubCategory", "PS5"), TEXT("GraphEditor.PadEvent_16x"));
 	RegisterInputs();
 
-	UE_LOG(LogWinDualSense, Warning, TEXT("StartupModule"));
 	FString BaseDir = IPluginManager::Get().FindPlugin("WinDualSense")->GetBaseDir();
 	FString LibraryPath = FPaths::Combine(*BaseDir, TEXT("Binaries/ThirdParty/WinDualSenseLibrary/Win64/ds5w_x64.dll"));
 
-	WinDualSenseLibraryHandle = !LibraryPath.IsEmpty() ? FPlatformProcess::GetDllHandle(*LibraryPath) : nullptr;
+	//Loading the DLL used to block engine startup, the IO thread enumerates controllers once it is in
+	LibraryState.store(ELibraryState::Loading, std::memory_order_release);
+	LibraryLoad = Async(EAsyncExecution::ThreadPool, [LibraryPath]() -> void*
+	{
+		const double LoadStartTime = FPlatformTime::Seconds();
+		void* LibraryHandle = !LibraryPath.IsEmpty() ? FPlatformProcess::GetDllHandle(*LibraryPath) : nullptr;
 
-	if (!WinDualSenseLibraryHandle)
-		return;
-	
-	DS5W::DeviceEnumInfo infos[16];
-	unsigned int controllersCount = 0;
-	DS5W_ReturnValue rv = DS5W::enumDevices(infos, 16, &controllersCount);
+		ELibraryState ExpectedState = ELibraryState::Loading;
+		if (!LibraryHandle)
+		{
+			LibraryState.compare_exchange_strong(ExpectedState, ELibraryState::Unloaded, std::memory_order_acq_rel);
+			UE_LOG(LogWinDualSense, Error, TEXT("Can't Load DualSense Library! [%s]"), *LibraryPath);
+			return nullptr;
+		}
 
-	// check size
-	if (controllersCount == 0) {
-		UE_LOG(LogWinDualSense,Error,TEXT("Can't Find Any DualSense Controller!"));
-		return;
-	}
+		if (!LibraryState.compare_exchange_strong(ExpectedState, ELibraryState::Loaded, std::memory_order_acq_rel))
+		{
+			//ShutdownModule did not wait for us, nobody else will free it
+			FPlatformProcess::FreeDllHandle(LibraryHandle);
+			UE_LOG(LogWinDualSense, Log, TEXT("DualSense Library Loaded After Shutdown, Freed"));
+			return nullptr;
+		}
 
+		UE_LOG(LogWinDualSense, Log, TEXT("DualSense Library Loaded [%.2f ms] (Worker)"), (FPlatformTime::Seconds() - LoadStartTime) * 1000.0);
+		return LibraryHandle;
+	});
+
+	UE_LOG(LogWinDualSense, Log, TEXT("DualSense StartupModule [%.2f ms]"), (FPlatformTime::Seconds() - StartTime) * 1000.0);
 }
 
 void FWinDualSensePlugin::ShutdownModule()
 {
 	UE_LOG(LogWinDualSense, Warning, TEXT("ShutdownModule"));
-	
-	FPlatformProcess::FreeDllHandle(WinDualSenseLibraryHandle);
-	WinDualSenseLibraryHandle = nullptr;
+
+	//The load may still be running when the editor closes right away. Shutdown does not wait for it, the load task frees the library
+	ELibraryState ExpectedState = ELibraryState::Loading;
+	if (LibraryState.compare_exchange_strong(ExpectedState, ELibraryState::Abandoned, std::memory_order_acq_rel))
+	{
+		LibraryLoad.Reset();
+		return;
+	}
+
+	//Finished one way or the other, the result is set right after the state
+	void* WinDualSenseLibraryHandle = LibraryLoad.IsValid() ? LibraryLoad.Get() : nullptr;
+	LibraryLoad.Reset();
+	LibraryState.store(ELibraryState::Unloaded, std::memory_order_release);
+
+	if (WinDualSenseLibraryHandle)
+	{
+		FPlatformProcess::FreeDllHandle(WinDualSenseLibraryHandle);
+	}
+}
+
+TSharedPtr<class IInputDevice> FWinDualSensePlugin::CreateInputDevice(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	TSharedPtr<class IInputDevice> Device(new FWinDualSenseDevice(InMessageHandler));
+	UE_LOG(LogWinDualSense, Log, TEXT("DualSense Input Device Created [%.2f ms]"), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return Device;
+}
+
+bool FWinDualSensePlugin::IsLibraryLoaded()
+{
+	return LibraryState.load(std::memory_order_acquire) == ELibraryState::Loaded;
 }
 
 void FWinDualSensePlugin::AddInput(FString InputName, uint8 keyFlags)
@@ -0,0 +1,161 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseBank.h"
+#include "WinDualSenseReport.h"
+#include "WinDualSenseCalibration.h"
+
+namespace
+{
+	//Output range of each analog row (EDualSenseAnalogType order)
+	constexpr float AnalogMins[FDualSenseControllerBank::AnalogCount] = { -1.f, -1.f, -1.f, -1.f, 0.f, 0.f };
+	constexpr float AnalogMaxs[FDualSenseControllerBank::AnalogCount] = { 1.f, 1.f, 1.f, 1.f, 1.f, 1.f };
+
+	//deg/s and g per count
+	constexpr float MotionScales[FDualSenseControllerBank::MotionCount] =
+	{
+		1.f / DualSenseReport::GyroCountsPerDegreePerSecond, 1.f / DualSenseReport::GyroCountsPerDegreePerSecond, 1.f / DualSenseReport::GyroCountsPerDegreePerSecond,
+		1.f / DualSenseReport::AccelCountsPerG, 1.f / DualSenseReport::AccelCountsPerG, 1.f / DualSenseReport::AccelCountsPerG
+	};
+
+	//Clamped linear map of (Raw - Center) folded into a per lane Scale / Offset
+	FORCEINLINE void SetRange(float& OutScale, float& OutOffset, float Center, float InMin, float InMax, float OutMin, float OutMax)
+	{
+		OutScale = (OutMax - OutMin) / FMath::Max(InMax - InMin, KINDA_SMALL_NUMBER);
+		OutOffset = OutMin - (InMin + Center) * OutScale;
+	}
+
+	//Lanes are processed 4 at a time, rows are MaxControllers long so the last group never runs past them
+	FORCEINLINE int32 GetVectorLanes(int32 LaneCount)
+	{
+		return FMath::Min(Align(LaneCount, 4), FDualSenseControllerBank::MaxControllers);
+	}
+}
+
+#pragma region Dual Sense [Controller Bank]
+FDualSenseControllerBank::FDualSenseControllerBank()
+{
+	FMemory::Memzero(this, sizeof(FDualSenseControllerBank));
+}
+
+void FDualSenseControllerBank::ResetLane(int32 ControllerId)
+{
+	Buttons[ControllerId] = 0;
+	PreviousButtons[ControllerId] = 0;
+	PressedButtons[ControllerId] = 0;
+	ReleasedButtons[ControllerId] = 0;
+
+	//Motion is only set by new reports, a reused lane would read the last controller's rows until its first one
+	for (int32 Axis = 0; Axis < MotionCount; ++Axis)
+	{
+		Motion[Axis][ControllerId] = 0;
+		MotionOffsets[Axis][ControllerId] = 0.f;
+		MotionValues[Axis][ControllerId] = 0.f;
+	}
+	for (int32 Analog = 0; Analog < AnalogCount; ++Analog)
+	{
+		Analogs[Analog][ControllerId] = 0;
+		AnalogScales[Analog][ControllerId] = 0.f;
+		AnalogOffsets[Analog][ControllerId] = 0.f;
+		AnalogValues[Analog][ControllerId] = 0.f;
+	}
+}
+
+void FDualSenseControllerBank::SetInput(int32 ControllerId, uint32 InButtons, const DS5W::DS5InputState& State, const FDualSenseCalibration& Calibration, bool bIsStalled)
+{
+	Buttons[ControllerId] = bIsStalled ? 0 : InButtons;
+
+	Analogs[0][ControllerId] = State.leftStick.x;
+	Analogs[1][ControllerId] = State.leftStick.y;
+	Analogs[2][ControllerId] = State.rightStick.x;
+	Analogs[3][ControllerId] = State.rightStick.y;
+	Analogs[4][ControllerId] = State.leftTrigger;
+	Analogs[5][ControllerId] = State.rightTrigger;
+
+	SetRange(AnalogScales[0][ControllerId], AnalogOffsets[0][ControllerId], Calibration.LeftStickCenter.X, -128.f, 127.f, -1.f, 1.f);
+	SetRange(AnalogScales[1][ControllerId], AnalogOffsets[1][ControllerId], Calibration.LeftStickCenter.Y, -128.f, 127.f, -1.f, 1.f);
+	SetRange(AnalogScales[2][ControllerId], AnalogOffsets[2][ControllerId], Calibration.RightStickCenter.X, -128.f, 127.f, -1.f, 1.f);
+	SetRange(AnalogScales[3][ControllerId], AnalogOffsets[3][ControllerId], Calibration.RightStickCenter.Y, -128.f, 127.f, -1.f, 1.f);
+	SetRange(AnalogScales[4][ControllerId], AnalogOffsets[4][ControllerId], 0.f, Calibration.TriggerRest.X, Calibration.GetTriggerFullPull(false), 0.f, 1.f);
+	SetRange(AnalogScales[5][ControllerId], AnalogOffsets[5][ControllerId], 0.f, Calibration.TriggerRest.Y, Calibration.GetTriggerFullPull(true), 0.f, 1.f);
+
+	//Frozen controller, every analog reads 0 instead of repeating the last state
+	if (bIsStalled)
+	{
+		for (int32 Analog = 0; Analog < AnalogCount; ++Analog)
+		{
+			AnalogScales[Analog][ControllerId] = 0.f;
+			AnalogOffsets[Analog][ControllerId] = 0.f;
+		}
+	}
+}
+
+void FDualSenseControllerBank::SetMotion(int32 ControllerId, const FDualSenseInputReport& Report, const FVector& GyroBias)
+{
+	Motion[0][ControllerId] = Report.Gyroscope.x;
+	Motion[1][ControllerId] = Report.Gyroscope.y;
+	Motion[2][ControllerId] = Report.Gyroscope.z;
+	Motion[3][ControllerId] = Report.Accelerometer.x;
+	Motion[4][ControllerId] = Report.Accelerometer.y;
+	Motion[5][ControllerId] = Report.Accelerometer.z;
+
+	MotionOffsets[0][ControllerId] = -GyroBias.X * MotionScales[0];
+	MotionOffsets[1][ControllerId] = -GyroBias.Y * MotionScales[1];
+	MotionOffsets[2][ControllerId] = -GyroBias.Z * MotionScales[2];
+}
+
+void FDualSenseControllerBank::Update(int32 LaneCount)
+{
+	const int32 VectorLanes = GetVectorLanes(LaneCount);
+
+	for (int32 Lane = 0; Lane < VectorLanes; Lane += 4)
+	{
+		const VectorRegisterInt Current = VectorIntLoad(Buttons + Lane);
+		const VectorRegisterInt Previous = VectorIntLoad(PreviousButtons + Lane);
+		VectorIntStore(VectorIntAndNot(Previous, Current), PressedButtons + Lane);
+		VectorIntStore(VectorIntAndNot(Current, Previous), ReleasedButtons + Lane);
+		VectorIntStore(Current, PreviousButtons + Lane);
+	}
+
+	for (int32 Analog = 0; Analog < AnalogCount; ++Analog)
+	{
+		const VectorRegister Min = VectorSetFloat1(AnalogMins[Analog]);
+		const VectorRegister Max = VectorSetFloat1(AnalogMaxs[Analog]);
+		for (int32 Lane = 0; Lane < VectorLanes; Lane += 4)
+		{
+			const VectorRegister Raw = VectorIntToFloat(VectorIntLoad(Analogs[Analog] + Lane));
+			const VectorRegister Value = VectorMultiplyAdd(Raw, VectorLoadAligned(AnalogScales[Analog] + Lane), VectorLoadAligned(AnalogOffsets[Analog] + Lane));
+			VectorStoreAligned(VectorMin(VectorMax(Value, Min), Max), AnalogValues[Analog] + Lane);
+		}
+	}
+
+	for (int32 Axis = 0; Axis < MotionCount; ++Axis)
+	{
+		const VectorRegister Scale = VectorSetFloat1(MotionScales[Axis]);
+		for (int32 Lane = 0; Lane < VectorLanes; Lane += 4)
+		{
+			const VectorRegister Raw = VectorIntToFloat(VectorIntLoad(Motion[Axis] + Lane));
+			VectorStoreAligned(VectorMultiplyAdd(Raw, Scale, VectorLoadAligned(MotionOffsets[Axis] + Lane)), MotionValues[Axis] + Lane);
+		}
+	}
+}
+
+void FDualSenseControllerBank::UpdateScalar(int32 LaneCount)
+{
+	for (int32 Lane = 0; Lane < LaneCount; ++Lane)
+	{
+		PressedButtons[Lane] = Buttons[Lane] & ~PreviousButtons[Lane];
+		ReleasedButtons[Lane] = PreviousButtons[Lane] & ~Buttons[Lane];
+		PreviousButtons[Lane] = Buttons[Lane];
+
+		for (int32 Analog = 0; Analog < AnalogCount; ++Analog)
+		{
+			AnalogValues[Analog][Lane] = FMath::Clamp((float)Analogs[Analog][Lane] * AnalogScales[Analog][Lane] + AnalogOffsets[Analog][Lane], AnalogMins[Analog], AnalogMaxs[Analog]);
+		}
+
+		for (int32 Axis = 0; Axis < MotionCount; ++Axis)
+		{
+			MotionValues[Axis][Lane] = (float)Motion[Axis][Lane] * MotionScales[Axis] + MotionOffsets[Axis][Lane];
+		}
+	}
+}
+#pragma endregion
@@ -0,0 +1,1684 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseBenchmark.h"
+#include "WinDualSensePCH.h"
+#include "WinDualSenseIO.h"
+#include "WinDualSenseDevice.h"
+#include "GenericPlatform/GenericApplicationMessageHandler.h"
+#include "WinDualSenseReport.h"
+#include "WinDualSenseMotion.h"
+#include "WinDualSenseOutput.h"
+#include "WinDualSenseStream.h"
+#include "WinDualSenseSession.h"
+#include "WinDualSenseColumnar.h"
+#include "WinDualSenseHistory.h"
+#include "WinDualSenseBank.h"
+#include "WinDualSenseDrift.h"
+#include "WinDualSenseUsage.h"
+#include "WinDualSenseResample.h"
+#include "WinDualSensePointer.h"
+#include "WinDualSenseMotionGesture.h"
+#include "WinDualSenseScope.h"
+#include "WinDualSenseReplay.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Containers/CircularQueue.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include <atomic>
+
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <Windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+
+#pragma region Dual Sense [Benchmark]
+namespace
+{
+	//Fills the state of one report, returns true when the report starts a new input edge
+	typedef TFunction<bool(uint32 ReportIndex, DS5W::DS5InputState& State)> FFakeStateGenerator;
+
+	//Writes synthetic USB input reports into one named pipe per fake controller
+	class FFakeDualSenseWriter : public FRunnable
+	{
+	public:
+		FFakeDualSenseWriter(int32 InDeviceCount, int32 InReportRate, FFakeStateGenerator InStateGenerator = nullptr)
+			: DeviceCount(InDeviceCount)
+			, ReportRate(FMath::Max(InReportRate, 1))
+			, StateGenerator(MoveTemp(InStateGenerator))
+		{
+			static int32 RunIndex = 0;
+			++RunIndex;
+
+			for (int32 Device = 0; Device < DeviceCount; ++Device)
+			{
+				PipeNames.Add(FString::Printf(TEXT("\\\\.\\pipe\\DualSenseFake_%u_%d_%d"), FPlatformProcess::GetCurrentProcessId(), RunIndex, Device));
+				Pipes.Add(INVALID_HANDLE_VALUE);
+
+				for (std::atomic<uint64>& Cycles : WriteCycles[Device])
+				{
+					Cycles.store(0, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		~FFakeDualSenseWriter()
+		{
+			Finish();
+		}
+
+		bool CreatePipes()
+		{
+			for (int32 Device = 0; Device < DeviceCount; ++Device)
+			{
+				Pipes[Device] = CreateNamedPipeW(*PipeNames[Device], PIPE_ACCESS_OUTBOUND, PIPE_TYPE_MESSAGE | PIPE_WAIT, 1,
+					DualSenseReport::USBReportLength * 64, DualSenseReport::USBReportLength * 64, 0, nullptr);
+
+				if (Pipes[Device] == INVALID_HANDLE_VALUE)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		//Skips the pipes, reports go straight into the IO thread queues (slots opened with OpenInjectedStream)
+		void InjectInto(FDualSenseIOThread* InIOThread)
+		{
+			InjectTarget = InIOThread;
+		}
+
+		const FString& GetPipeName(int32 Device) const
+		{
+			return PipeNames[Device];
+		}
+
+		uint64 GetWriteCycles(int32 Device, uint8 Sequence) const
+		{
+			return WriteCycles[Device][Sequence].load(std::memory_order_relaxed);
+		}
+
+		//Write time of the last report the generator flagged as an edge
+		uint32 GetEdgeCount() const
+		{
+			return EdgeCount.load(std::memory_order_acquire);
+		}
+
+		uint64 GetEdgeCycles() const
+		{
+			return EdgeCycles.load(std::memory_order_relaxed);
+		}
+
+		//Readers must be connected first
+		void Start()
+		{
+			Thread = FRunnableThread::Create(this, TEXT("DualSenseFakeWriter"), 0, TPri_AboveNormal);
+		}
+
+		//Stops writing and closes the pipes, readers see a broken pipe
+		void Finish()
+		{
+			if (Thread)
+			{
+				Thread->Kill(true);
+				delete Thread;
+				Thread = nullptr;
+			}
+
+			for (HANDLE& Pipe : Pipes)
+			{
+				if (Pipe != INVALID_HANDLE_VALUE)
+				{
+					CloseHandle(Pipe);
+					Pipe = INVALID_HANDLE_VALUE;
+				}
+			}
+		}
+
+		virtual uint32 Run() override
+		{
+			if (!InjectTarget)
+			{
+				for (HANDLE Pipe : Pipes)
+				{
+					if (!ConnectNamedPipe(Pipe, nullptr) && GetLastError() != ERROR_PIPE_CONNECTED)
+					{
+						return 1;
+					}
+				}
+			}
+
+			DS5W::DS5InputState State;
+			FMemory::Memzero(State);
+
+			uint8 Report[DualSenseReport::USBReportLength];
+			const double Interval = 1.0 / ReportRate;
+			const uint32 TimestampStep = (uint32)(DualSenseReport::SensorTicksPerSecond * Interval);
+
+			uint32 ReportIndex = 0;
+			uint8 Sequence = 0;
+			uint32 SensorTimestamp = 0;
+			double NextReportTime = FPlatformTime::Seconds();
+
+			while (!bStopping.load(std::memory_order_relaxed))
+			{
+				const bool bIsEdge = StateGenerator ? StateGenerator(ReportIndex, State) : false;
+				DualSenseReport::EncodeUSBReport(State, Sequence, SensorTimestamp, Report);
+
+				if (bIsEdge)
+				{
+					EdgeCycles.store(FPlatformTime::Cycles64(), std::memory_order_relaxed);
+					EdgeCount.fetch_add(1, std::memory_order_release);
+				}
+
+				for (int32 Device = 0; Device < DeviceCount; ++Device)
+				{
+					WriteCycles[Device][Sequence].store(FPlatformTime::Cycles64(), std::memory_order_relaxed);
+
+					if (InjectTarget)
+					{
+						FDualSenseInputReport InjectedReport;
+						DualSenseReport::DecodeReport(Report + DualSenseReport::USBPayloadOffset, InjectedReport);
+						InjectTarget->InjectReport(Device, InjectedReport);
+					}
+					else
+					{
+						DWORD BytesWritten = 0;
+						WriteFile(Pipes[Device], Report, sizeof(Report), &BytesWritten, nullptr);
+					}
+				}
+
+				++ReportIndex;
+				++Sequence;
+				SensorTimestamp += TimestampStep;
+
+				NextReportTime += Interval;
+				const double WaitTime = NextReportTime - FPlatformTime::Seconds();
+				if (WaitTime > 0.0)
+				{
+					FPlatformProcess::SleepNoStats((float)WaitTime);
+				}
+			}
+			return 0;
+		}
+
+		virtual void Stop() override
+		{
+			bStopping.store(true);
+		}
+
+	private:
+		int32 DeviceCount;
+		int32 ReportRate;
+
+		TArray<FString> PipeNames;
+		TArray<HANDLE> Pipes;
+
+		FFakeStateGenerator StateGenerator;
+		FDualSenseIOThread* InjectTarget = nullptr;
+
+		//Write time per sequence number, used to measure delivery latency
+		std::atomic<uint64> WriteCycles[FDualSenseIOThread::MaxDevices][256];
+
+		std::atomic<uint64> EdgeCycles{ 0 };
+		std::atomic<uint32> EdgeCount{ 0 };
+
+		std::atomic<bool> bStopping{ false };
+		FRunnableThread* Thread = nullptr;
+	};
+
+	//The model the IO thread replaces, one blocking ReadFile loop per controller
+	class FBlockingDualSenseReader : public FRunnable
+	{
+	public:
+		FBlockingDualSenseReader(const FString& Path) : Reports(FDualSenseIOThread::ReportQueueSize)
+		{
+			Handle = CreateFileW(*Path, GENERIC_READ, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+		}
+
+		~FBlockingDualSenseReader()
+		{
+			if (Thread)
+			{
+				Thread->Kill(true);
+				delete Thread;
+			}
+
+			if (Handle != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(Handle);
+			}
+		}
+
+		bool IsOpen() const
+		{
+			return Handle != INVALID_HANDLE_VALUE;
+		}
+
+		void Start(int32 Index)
+		{
+			Thread = FRunnableThread::Create(this, *FString::Printf(TEXT("DualSenseBlockingReader%d"), Index), 0, TPri_AboveNormal);
+		}
+
+		bool DequeueReport(FDualSenseInputReport& OutReport)
+		{
+			return Reports.Dequeue(OutReport);
+		}
+
+		//Runs until the writer closes the pipe
+		virtual uint32 Run() override
+		{
+			uint8 Buffer[DualSenseReport::USBReportLength];
+			DWORD BytesRead = 0;
+
+			while (ReadFile(Handle, Buffer, sizeof(Buffer), &BytesRead, nullptr) && BytesRead > 0)
+			{
+				FDualSenseInputReport Report;
+				DualSenseReport::DecodeReport(Buffer + DualSenseReport::USBPayloadOffset, Report);
+				Reports.Enqueue(Report);
+			}
+			return 0;
+		}
+
+	private:
+		HANDLE Handle = INVALID_HANDLE_VALUE;
+		FRunnableThread* Thread = nullptr;
+		TCircularQueue<FDualSenseInputReport> Reports;
+	};
+
+	struct FIOBenchmarkResult
+	{
+		int32 Threads = 0;
+		double Seconds = 0.0;
+		//Write to read completion, in microseconds
+		TArray<double> Latencies;
+	};
+
+	template<typename DequeueFunctionType>
+	void MeasureReports(const FFakeDualSenseWriter& Writer, int32 DeviceCount, float Seconds, DequeueFunctionType&& DequeueFunction, FIOBenchmarkResult& Result)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		const double EndTime = StartTime + Seconds;
+
+		FDualSenseInputReport Report;
+		while (FPlatformTime::Seconds() < EndTime)
+		{
+			for (int32 Device = 0; Device < DeviceCount; ++Device)
+			{
+				while (DequeueFunction(Device, Report))
+				{
+					const uint64 WriteCycles = Writer.GetWriteCycles(Device, Report.Sequence);
+					if (WriteCycles != 0 && Report.ReceiveCycles >= WriteCycles)
+					{
+						Result.Latencies.Add(FPlatformTime::ToMilliseconds64(Report.ReceiveCycles - WriteCycles) * 1000.0);
+					}
+				}
+			}
+
+			FPlatformProcess::SleepNoStats(0.001f);
+		}
+
+		Result.Seconds = FPlatformTime::Seconds() - StartTime;
+	}
+
+	//Sorts the samples, formats count / mean / percentiles
+	FString DescribeLatencies(TArray<double>& Latencies)
+	{
+		if (Latencies.Num() == 0)
+		{
+			return TEXT("No Samples!");
+		}
+
+		Latencies.Sort();
+
+		double Sum = 0.0;
+		for (double Latency : Latencies)
+		{
+			Sum += Latency;
+		}
+
+		const int32 Count = Latencies.Num();
+		return FString::Printf(TEXT("Samples [%d] | Latency (us) Mean [%.1f] | P50 [%.1f] | P90 [%.1f] | P99 [%.1f] | Max [%.1f]"),
+			Count, Sum / Count, Latencies[Count / 2], Latencies[FMath::Min(Count - 1, (Count * 90) / 100)],
+			Latencies[FMath::Min(Count - 1, (Count * 99) / 100)], Latencies.Last());
+	}
+
+	void LogResult(FOutputDevice& Ar, const TCHAR* Name, FIOBenchmarkResult& Result)
+	{
+		const double ReportsPerSecond = Result.Latencies.Num() / FMath::Max(Result.Seconds, KINDA_SMALL_NUMBER);
+		Ar.Logf(TEXT("%s | Threads [%d] | %.0f Reports/s | %s"), Name, Result.Threads, ReportsPerSecond, *DescribeLatencies(Result.Latencies));
+	}
+
+	//Records when the input pipeline dispatched the edges the fake device wrote
+	class FLatencyMessageHandler : public FGenericApplicationMessageHandler
+	{
+	public:
+		FLatencyMessageHandler(const FFakeDualSenseWriter* InWriter) : Writer(InWriter)
+		{
+		}
+
+		virtual bool OnControllerButtonPressed(FGamepadKeyNames::Type KeyName, int32 ControllerId, bool IsRepeat) override
+		{
+			if (!IsRepeat && KeyName == FGamepadKeyNames::FaceButtonBottom)
+			{
+				AddSample(PressLatencies, LastPressEdge);
+			}
+			return true;
+		}
+
+		virtual bool OnControllerAnalog(FGamepadKeyNames::Type KeyName, int32 ControllerId, float AnalogValue) override
+		{
+			if (KeyName == FGamepadKeyNames::LeftAnalogX && AnalogValue != 0.f)
+			{
+				AddSample(AnalogLatencies, LastAnalogEdge);
+			}
+			return true;
+		}
+
+		TArray<double> PressLatencies;
+		TArray<double> AnalogLatencies;
+
+	private:
+		//One sample per edge, the first dispatch that shows it
+		void AddSample(TArray<double>& Latencies, uint32& LastEdge)
+		{
+			const uint32 EdgeCount = Writer->GetEdgeCount();
+			if (EdgeCount == LastEdge)
+			{
+				return;
+			}
+
+			LastEdge = EdgeCount;
+			Latencies.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - Writer->GetEdgeCycles()) * 1000.0);
+		}
+
+		const FFakeDualSenseWriter* Writer;
+		uint32 LastPressEdge = 0;
+		uint32 LastAnalogEdge = 0;
+	};
+
+	//Per controller decode state the way the plugin first kept it : TMaps keyed by type, each value carrying its FKey
+	struct FMapDecodeState
+	{
+		TMap<EDualSenseButtonType, FDualSenseButtonData> Buttons;
+		TMap<EDualSenseAnalogType, FDualSenseAnalogData> Analogs;
+		TMap<EDualSenseVectorType, FDualSenseVectorData> Vectors;
+	};
+}
+
+void DualSenseBenchmark::RunIOBenchmark(FOutputDevice& Ar, int32 DeviceCount, float Seconds, int32 ReportRate)
+{
+	Ar.Logf(TEXT("DualSense IO Benchmark | Devices [%d] | Rate [%d Hz] | Seconds [%.1f]"), DeviceCount, ReportRate, Seconds);
+
+	//Single thread on a completion port
+	{
+		FFakeDualSenseWriter Writer(DeviceCount, ReportRate);
+		if (!Writer.CreatePipes())
+		{
+			Ar.Logf(TEXT("Can't Create Fake DualSense Pipes! [%u]"), GetLastError());
+			return;
+		}
+
+		FDualSenseIOThread IOThread(false);
+		for (int32 Device = 0; Device < DeviceCount; ++Device)
+		{
+			if (!IOThread.OpenReportStream(Device, *Writer.GetPipeName(Device), DS5W::DeviceConnection::USB))
+			{
+				Ar.Logf(TEXT("Can't Open Fake DualSense Pipe! [%u]"), GetLastError());
+				return;
+			}
+		}
+
+		IOThread.Start(TEXT("DualSenseIOBenchmark"));
+		Writer.Start();
+
+		FIOBenchmarkResult Result;
+		Result.Threads = 1;
+		Result.Latencies.Reserve(FMath::CeilToInt(DeviceCount * ReportRate * (Seconds + 1.f)));
+		MeasureReports(Writer, DeviceCount, Seconds, [&IOThread](int32 Device, FDualSenseInputReport& Report) { return IOThread.DequeueReport(Device, Report); }, Result);
+
+		Writer.Finish();
+		LogResult(Ar, TEXT("Completion Port"), Result);
+	}
+
+	//One blocking reader thread per device
+	{
+		FFakeDualSenseWriter Writer(DeviceCount, ReportRate);
+		if (!Writer.CreatePipes())
+		{
+			Ar.Logf(TEXT("Can't Create Fake DualSense Pipes! [%u]"), GetLastError());
+			return;
+		}
+
+		TArray<TUniquePtr<FBlockingDualSenseReader>> Readers;
+		for (int32 Device = 0; Device < DeviceCount; ++Device)
+		{
+			Readers.Add(MakeUnique<FBlockingDualSenseReader>(Writer.GetPipeName(Device)));
+			if (!Readers.Last()->IsOpen())
+			{
+				Ar.Logf(TEXT("Can't Open Fake DualSense Pipe! [%u]"), GetLastError());
+				return;
+			}
+		}
+
+		for (int32 Device = 0; Device < DeviceCount; ++Device)
+		{
+			Readers[Device]->Start(Device);
+		}
+		Writer.Start();
+
+		FIOBenchmarkResult Result;
+		Result.Threads = DeviceCount;
+		Result.Latencies.Reserve(FMath::CeilToInt(DeviceCount * ReportRate * (Seconds + 1.f)));
+		MeasureReports(Writer, DeviceCount, Seconds, [&Readers](int32 Device, FDualSenseInputReport& Report) { return Readers[Device]->DequeueReport(Report); }, Result);
+
+		//Readers exit on the broken pipe
+		Writer.Finish();
+		Readers.Reset();
+		LogResult(Ar, TEXT("Thread Per Device"), Result);
+	}
+}
+
+void DualSenseBenchmark::RunLatencyBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate)
+{
+	Ar.Logf(TEXT("DualSense Latency Benchmark | Rate [%d Hz] | Seconds [%.1f]"), ReportRate, Seconds);
+
+	//Cross + left stick held for 50ms, released for 50ms
+	const uint32 HalfPeriod = FMath::Max(1, FMath::RoundToInt(ReportRate * 0.05f));
+	FFakeStateGenerator StateGenerator = [HalfPeriod](uint32 ReportIndex, DS5W::DS5InputState& State)
+	{
+		const bool bIsPressed = (ReportIndex / HalfPeriod) % 2 == 0;
+		State.buttonsAndDpad = bIsPressed ? DS5W_ISTATE_BTX_CROSS : 0;
+		State.leftStick.x = bIsPressed ? 100 : 0;
+		return bIsPressed && ReportIndex % HalfPeriod == 0;
+	};
+
+	const int32 FrameRates[] = { 30, 60, 144 };
+	const bool bInjectedModes[] = { false, true };
+
+	for (int32 FrameRate : FrameRates)
+	{
+		for (bool bInjected : bInjectedModes)
+		{
+			FFakeDualSenseWriter Writer(1, ReportRate, StateGenerator);
+			TUniquePtr<FDualSenseIOThread> IOThread = MakeUnique<FDualSenseIOThread>(false);
+
+			if (bInjected)
+			{
+				IOThread->OpenInjectedStream(0);
+				Writer.InjectInto(IOThread.Get());
+			}
+			else if (!Writer.CreatePipes() || !IOThread->OpenReportStream(0, *Writer.GetPipeName(0), DS5W::DeviceConnection::USB))
+			{
+				Ar.Logf(TEXT("Can't Open Fake DualSense Pipe! [%u]"), GetLastError());
+				return;
+			}
+
+			TSharedRef<FLatencyMessageHandler> MessageHandler = MakeShared<FLatencyMessageHandler>(&Writer);
+			{
+				FWinDualSenseDevice Device(MessageHandler, MoveTemp(IOThread));
+				Writer.Start();
+
+				//Game loop at a fixed frame rate
+				const double FrameTime = 1.0 / FrameRate;
+				const double EndTime = FPlatformTime::Seconds() + Seconds;
+				double NextFrameTime = FPlatformTime::Seconds();
+
+				while (FPlatformTime::Seconds() < EndTime)
+				{
+					Device.SendControllerEvents();
+
+					NextFrameTime += FrameTime;
+					const double WaitTime = NextFrameTime - FPlatformTime::Seconds();
+					if (WaitTime > 0.0)
+					{
+						FPlatformProcess::SleepNoStats((float)WaitTime);
+					}
+				}
+
+				Writer.Finish();
+			}
+
+			const TCHAR* ModeName = bInjected ? TEXT("Injected") : TEXT("Completion Port");
+			Ar.Logf(TEXT("[%3d fps] %-16s Press  | %s"), FrameRate, ModeName, *DescribeLatencies(MessageHandler->PressLatencies));
+			Ar.Logf(TEXT("[%3d fps] %-16s Analog | %s"), FrameRate, ModeName, *DescribeLatencies(MessageHandler->AnalogLatencies));
+		}
+	}
+}
+
+void DualSenseBenchmark::RunCallbackBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate, int32 FrameRate)
+{
+	Ar.Logf(TEXT("DualSense Callback Benchmark | Rate [%d Hz] | Frame Rate [%d fps] | Seconds [%.1f]"), ReportRate, FrameRate, Seconds);
+
+	//Cross held for 50ms, released for 50ms
+	const uint32 HalfPeriod = FMath::Max(1, FMath::RoundToInt(ReportRate * 0.05f));
+	FFakeStateGenerator StateGenerator = [HalfPeriod](uint32 ReportIndex, DS5W::DS5InputState& State)
+	{
+		const bool bIsPressed = (ReportIndex / HalfPeriod) % 2 == 0;
+		State.buttonsAndDpad = bIsPressed ? DS5W_ISTATE_BTX_CROSS : 0;
+		return bIsPressed && ReportIndex % HalfPeriod == 0;
+	};
+
+	FFakeDualSenseWriter Writer(1, ReportRate, StateGenerator);
+	TUniquePtr<FDualSenseIOThread> IOThread = MakeUnique<FDualSenseIOThread>(false);
+	if (!Writer.CreatePipes() || !IOThread->OpenReportStream(0, *Writer.GetPipeName(0), DS5W::DeviceConnection::USB))
+	{
+		Ar.Logf(TEXT("Can't Open Fake DualSense Pipe! [%u]"), GetLastError());
+		return;
+	}
+
+	const uint32 CrossMask = DualSenseReport::GetButtonMask(EDualSenseButtonType::CROSS);
+	TArray<double> CallbackLatencies;
+	TArray<double> EventLatencies;
+	TSharedRef<FLatencyMessageHandler> MessageHandler = MakeShared<FLatencyMessageHandler>(&Writer);
+	{
+		FWinDualSenseDevice Device(MessageHandler, MoveTemp(IOThread));
+
+		//Read thread : latency at the callback rides in the posted value, the game thread adds its own
+		const int32 CallbackId = Device.RegisterInputCallback(EDualSenseCallbackTrigger::ButtonEdge, CrossMask,
+			[&Writer, CrossMask](const FDualSenseCallbackContext& Context)
+			{
+				if (Context.PressedButtons & CrossMask)
+				{
+					Context.Post((int64)(FPlatformTime::Cycles64() - Writer.GetEdgeCycles()));
+				}
+			},
+			[&Writer, &CallbackLatencies, &EventLatencies](int32 ControllerId, const FDualSenseCallbackEvent& Event)
+			{
+				CallbackLatencies.Add(FPlatformTime::ToMilliseconds64((uint64)Event.Value) * 1000.0);
+				EventLatencies.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - Writer.GetEdgeCycles()) * 1000.0);
+			});
+
+		Writer.Start();
+
+		const double FrameTime = 1.0 / FrameRate;
+		const double EndTime = FPlatformTime::Seconds() + Seconds;
+		double NextFrameTime = FPlatformTime::Seconds();
+
+		while (FPlatformTime::Seconds() < EndTime)
+		{
+			Device.SendControllerEvents();
+
+			NextFrameTime += FrameTime;
+			const double WaitTime = NextFrameTime - FPlatformTime::Seconds();
+			if (WaitTime > 0.0)
+			{
+				FPlatformProcess::SleepNoStats((float)WaitTime);
+			}
+		}
+
+		Writer.Finish();
+
+		const FDualSenseCallbackStats& Stats = Device.FindInputCallback(CallbackId)->Stats;
+		Ar.Logf(TEXT("Read Thread Callback | %s"), *DescribeLatencies(CallbackLatencies));
+		Ar.Logf(TEXT("Game Thread Event    | %s"), *DescribeLatencies(EventLatencies));
+		Ar.Logf(TEXT("Frame Dispatch       | %s"), *DescribeLatencies(MessageHandler->PressLatencies));
+		Ar.Logf(TEXT("Callback Cost | Calls [%llu] | Mean [%.2f us] | Max [%.2f us] | Posted [%llu] | Dropped [%llu]"),
+			Stats.Calls.load(), Stats.GetMeanMicroseconds(), Stats.GetMaxMicroseconds(), Stats.PostedEvents.load(), Stats.DroppedEvents.load());
+	}
+}
+
+void DualSenseBenchmark::RunLatchBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate, int32 FrameRate)
+{
+	Ar.Logf(TEXT("DualSense Late Latch Benchmark | Rate [%d Hz] | Frame Rate [%d fps] | Seconds [%.1f]"), ReportRate, FrameRate, Seconds);
+
+	//Cross held for 50ms, released for 50ms
+	const uint32 HalfPeriod = FMath::Max(1, FMath::RoundToInt(ReportRate * 0.05f));
+	FFakeStateGenerator StateGenerator = [HalfPeriod](uint32 ReportIndex, DS5W::DS5InputState& State)
+	{
+		const bool bIsPressed = (ReportIndex / HalfPeriod) % 2 == 0;
+		State.buttonsAndDpad = bIsPressed ? DS5W_ISTATE_BTX_CROSS : 0;
+		return bIsPressed && ReportIndex % HalfPeriod == 0;
+	};
+
+	double AgeMeans[2] = { 0.0, 0.0 };
+	const bool bLatchModes[] = { false, true };
+
+	for (bool bLatch : bLatchModes)
+	{
+		FFakeDualSenseWriter Writer(1, ReportRate, StateGenerator);
+		TUniquePtr<FDualSenseIOThread> IOThread = MakeUnique<FDualSenseIOThread>(false);
+		if (!Writer.CreatePipes() || !IOThread->OpenReportStream(0, *Writer.GetPipeName(0), DS5W::DeviceConnection::USB))
+		{
+			Ar.Logf(TEXT("Can't Open Fake DualSense Pipe! [%u]"), GetLastError());
+			return;
+		}
+
+		TSharedRef<FLatencyMessageHandler> MessageHandler = MakeShared<FLatencyMessageHandler>(&Writer);
+		{
+			FWinDualSenseDevice Device(MessageHandler, MoveTemp(IOThread));
+			Device.LatchSettings.bEnabled = bLatch;
+			Writer.Start();
+
+			const double FrameTime = 1.0 / FrameRate;
+			const double EndTime = FPlatformTime::Seconds() + Seconds;
+			double NextFrameTime = FPlatformTime::Seconds();
+			int32 Frames = 0;
+
+			while (FPlatformTime::Seconds() < EndTime)
+			{
+				Device.SendControllerEvents();
+				++Frames;
+
+				NextFrameTime += FrameTime;
+				const double WaitTime = NextFrameTime - FPlatformTime::Seconds();
+				if (WaitTime > 0.0)
+				{
+					FPlatformProcess::SleepNoStats((float)WaitTime);
+				}
+			}
+
+			Writer.Finish();
+
+			const FDualSenseLatchStats& LatchStats = Device.GetController(0).LatchStats;
+			AgeMeans[bLatch ? 1 : 0] = LatchStats.GetAgeMean();
+
+			const TCHAR* ModeName = bLatch ? TEXT("Late Latch") : TEXT("Fixed Point");
+			Ar.Logf(TEXT("%-11s Input Age | Mean [%.1f us] | Max [%.1f us] | Dispatches [%llu]"), ModeName, LatchStats.GetAgeMean(), LatchStats.AgeMax, LatchStats.Dispatches);
+			Ar.Logf(TEXT("%-11s Press     | %s"), ModeName, *DescribeLatencies(MessageHandler->PressLatencies));
+			if (bLatch)
+			{
+				Ar.Logf(TEXT("%-11s Waits     | [%llu] of [%d] frames | Caught [%llu] | Mean [%.1f us] | Per Frame [%.1f us] | Budget [%.1f us]"), ModeName,
+					LatchStats.Waits, Frames, LatchStats.CaughtReports, LatchStats.GetWaitMean(), Frames > 0 ? LatchStats.WaitSum / Frames : 0.0,
+					DualSenseLatch::GetWaitBudget(Device.LatchSettings, Device.FramePacing));
+				Ar.Logf(TEXT("%-11s Overshoot | Mean [%.1f us] | Max [%.1f us]"), ModeName, LatchStats.GetOvershootMean(), LatchStats.OvershootMax);
+			}
+		}
+	}
+
+	Ar.Logf(TEXT("Input Age | [%.1f us] -> [%.1f us] (%+.1f%%)"), AgeMeans[0], AgeMeans[1], AgeMeans[0] > 0.0 ? (AgeMeans[1] - AgeMeans[0]) * 100.0 / AgeMeans[0] : 0.0);
+}
+
+void DualSenseBenchmark::RunOutputStress(FOutputDevice& Ar, int32 ProducerCount, int32 CommandsPerProducer)
+{
+	//One controller id per producer, sequence numbers fit the 24 bit color
+	ProducerCount = FMath::Clamp(ProducerCount, 1, FDualSenseIOThread::MaxDevices);
+	CommandsPerProducer = FMath::Clamp(CommandsPerProducer, 1, (1 << 24) - 1);
+
+	Ar.Logf(TEXT("DualSense Output Stress | Producers [%d] | Commands [%d] Each"), ProducerCount, CommandsPerProducer);
+
+	FDualSenseOutputQueue Queue;
+	std::atomic<bool> bStart{ false };
+
+	TArray<TUniquePtr<FDualSenseOutputCommandProducer>> Producers;
+	for (int32 Producer = 0; Producer < ProducerCount; ++Producer)
+	{
+		Producers.Add(MakeUnique<FDualSenseOutputCommandProducer>(Queue, Producer, CommandsPerProducer, bStart));
+	}
+
+	DS5W::DS5OutputState States[FDualSenseIOThread::MaxDevices];
+	FMemory::Memzero(States);
+	int64 Received = 0;
+	int32 MaxBatch = 0;
+
+	const int64 Expected = (int64)ProducerCount * CommandsPerProducer;
+	const double StartTime = FPlatformTime::Seconds();
+	const double TimeoutTime = StartTime + 60.0;
+	bStart.store(true, std::memory_order_release);
+
+	//The single output stage, draining while the producers run
+	while (Received < Expected && FPlatformTime::Seconds() < TimeoutTime)
+	{
+		const int32 Batch = Queue.Drain([&States](const FDualSenseOutputCommand& Command)
+		{
+			Command.Apply(States[Command.ControllerId]);
+		});
+
+		Received += Batch;
+		MaxBatch = FMath::Max(MaxBatch, Batch);
+	}
+
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+	uint64 FullRetries = 0;
+	for (TUniquePtr<FDualSenseOutputCommandProducer>& Producer : Producers)
+	{
+		Producer->Join();
+		FullRetries += Producer->FullRetries;
+	}
+	Producers.Reset();
+
+	Ar.Logf(TEXT("Received [%lld / %lld] | %.2f M Commands/s | Max Batch [%d] | Queue Full [%llu]"),
+		Received, Expected, Received / FMath::Max(Seconds, 0.000001) / 1000000.0, MaxBatch, FullRetries);
+}
+
+void DualSenseBenchmark::RunFrameBenchmark(FOutputDevice& Ar, int32 ControllerCount, int32 Frames)
+{
+#if DUALSENSE_TRACE_ENABLED
+	const TCHAR* TraceState = DUALSENSE_TRACE_IS_ENABLED() ? TEXT("ON") : TEXT("OFF");
+#else
+	const TCHAR* TraceState = TEXT("COMPILED OUT");
+#endif
+	Ar.Logf(TEXT("DualSense Frame Benchmark | Controllers [%d] | Frames [%d] | Trace Channel [%s]"), ControllerCount, Frames, TraceState);
+
+	TUniquePtr<FDualSenseIOThread> IOThread = MakeUnique<FDualSenseIOThread>(false);
+	FDualSenseIOThread* Injector = IOThread.Get();
+	for (int32 Controller = 0; Controller < ControllerCount; ++Controller)
+	{
+		Injector->OpenInjectedStream(Controller);
+	}
+
+	FWinDualSenseDevice Device(MakeShared<FGenericApplicationMessageHandler>(), MoveTemp(IOThread));
+	FDualSenseSyntheticFrameProducer Producer(Device, Injector, ControllerCount);
+
+	for (int32 Frame = 0; Frame < 60; ++Frame)
+	{
+		Producer.Produce(Frame);
+		Device.SendControllerEvents();
+	}
+
+	TArray<double> FrameTimes;
+	FrameTimes.Reserve(Frames);
+	for (int32 Frame = 60; Frame < 60 + Frames; ++Frame)
+	{
+		Producer.Produce(Frame);
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		Device.SendControllerEvents();
+		FrameTimes.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0);
+	}
+
+	Ar.Logf(TEXT("SendControllerEvents | %s"), *DescribeLatencies(FrameTimes));
+}
+
+void DualSenseBenchmark::RunStreamBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate, int32 Redundancy, float Loss, int32 Port)
+{
+	ReportRate = FMath::Max(ReportRate, 1);
+	Ar.Logf(TEXT("DualSense Stream Benchmark | Rate [%d Hz] | Seconds [%.1f] | Redundancy [%d] | Loss [%.0f%%]"), ReportRate, Seconds, Redundancy, Loss * 100.f);
+
+	TArray<FDualSenseInputReport> Reports;
+	DualSenseReplay::MakeSessionRecording(Seconds, ReportRate, Reports);
+
+	TMap<uint32, int32> ReportIndices;
+	ReportIndices.Reserve(Reports.Num());
+	for (int32 Index = 0; Index < Reports.Num(); ++Index)
+	{
+		ReportIndices.Add(Reports[Index].SensorTimestamp, Index);
+	}
+
+	FDualSenseIOThread IOThread(false);
+	FDualSenseStreamHost Host(IOThread, 0);
+	if (!Host.Start(Port))
+	{
+		Ar.Logf(TEXT("Can't Start Stream Host [Port %d]"), Port);
+		return;
+	}
+
+	FDualSenseStreamClient Client;
+	if (!Client.Connect(TEXT("127.0.0.1"), Port))
+	{
+		Ar.Logf(TEXT("Can't Connect Stream Client [Port %d]"), Port);
+		return;
+	}
+	Client.Encoder.Redundancy = Redundancy;
+	Client.DropRate = Loss;
+
+	TArray<uint64> SendCycles;
+	SendCycles.SetNumZeroed(Reports.Num());
+	TArray<double> Latencies;
+	Latencies.Reserve(Reports.Num());
+	int32 Received = 0;
+
+	auto DrainHost = [&]()
+	{
+		FDualSenseInputReport Decoded;
+		while (IOThread.DequeueReport(0, Decoded))
+		{
+			if (const int32* Index = ReportIndices.Find(Decoded.SensorTimestamp))
+			{
+				++Received;
+				Latencies.Add(FPlatformTime::ToMilliseconds64(Decoded.ReceiveCycles - SendCycles[*Index]) * 1000.0);
+			}
+		}
+	};
+
+	//Paced like the controller would send them
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < Reports.Num(); ++Index)
+	{
+		const double SendTime = StartTime + (double)Index / ReportRate;
+		while (FPlatformTime::Seconds() < SendTime)
+		{
+			DrainHost();
+			FPlatformProcess::SleepNoStats(0.0005f);
+		}
+
+		SendCycles[Index] = FPlatformTime::Cycles64();
+		Client.Send(Reports[Index]);
+	}
+	const double Elapsed = FMath::Max(FPlatformTime::Seconds() - StartTime, 0.000001);
+
+	const double DrainEndTime = FPlatformTime::Seconds() + 0.5;
+	while (FPlatformTime::Seconds() < DrainEndTime)
+	{
+		DrainHost();
+		FPlatformProcess::SleepNoStats(0.001f);
+	}
+
+	const uint64 SentReports = Client.SentReports.load();
+	const uint64 DroppedDatagrams = Client.DroppedDatagrams.load();
+	const uint64 SentBytes = Client.SentBytes.load();
+	const uint64 SentDatagrams = SentReports - DroppedDatagrams;
+	const double BytesPerReport = (double)SentBytes / FMath::Max<uint64>(SentDatagrams, 1);
+	const double RawBytesPerSecond = (double)DualSenseReport::USBReportLength * ReportRate;
+
+	Ar.Logf(TEXT("Sent [%llu] | Dropped [%llu] | Received [%d] | Recovered [%llu] | Undecodable [%llu] | Key Frames [%llu]"),
+		SentReports, DroppedDatagrams, Received, Host.Decoder.RecoveredPackets, Host.Decoder.UndecodablePackets, Client.Encoder.KeyFrames.load());
+	Ar.Logf(TEXT("%.1f Bytes/Report | %.0f Bytes/s | Raw USB %.0f Bytes/s (%.1fx) | %s"), BytesPerReport, SentBytes / Elapsed,
+		RawBytesPerSecond, RawBytesPerSecond / FMath::Max(SentBytes / Elapsed, 1.0), *DescribeLatencies(Latencies));
+}
+
+void DualSenseBenchmark::RunSharedStateBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate, int32 ReaderCount)
+{
+	ReportRate = FMath::Max(ReportRate, 1);
+	Ar.Logf(TEXT("DualSense Shared State Benchmark | Rate [%d Hz] x %u Controllers | Seconds [%.1f] | Readers [%d]"), ReportRate, DualSenseShared::MaxControllers, Seconds, ReaderCount);
+
+	const FString Name = FString::Printf(TEXT("Local\\DualSenseStateBench_%u"), FPlatformProcess::GetCurrentProcessId());
+	FDualSenseSharedStateWriter Writer;
+	if (!Writer.Open(Name))
+	{
+		Ar.Logf(TEXT("Can't Open DualSense Shared State [%s]"), *Name);
+		return;
+	}
+
+	uint64 NextIndex = 0;
+
+	//Same run without and with readers, the writer's cost must not care
+	for (int32 Pass = 0; Pass < 2; ++Pass)
+	{
+		const int32 PassReaders = Pass == 0 ? 0 : ReaderCount;
+
+		TArray<TUniquePtr<FDualSenseSharedStateReaderThread>> Readers;
+		for (int32 Reader = 0; Reader < PassReaders; ++Reader)
+		{
+			Readers.Add(MakeUnique<FDualSenseSharedStateReaderThread>(Name, Reader));
+		}
+
+		TArray<double> PublishTimes;
+		PublishTimes.Reserve((FMath::CeilToInt(Seconds * ReportRate) + 1) * DualSenseShared::MaxControllers);
+
+		const double Interval = 1.0 / ReportRate;
+		const double EndTime = FPlatformTime::Seconds() + Seconds;
+		double NextReportTime = FPlatformTime::Seconds();
+		while (FPlatformTime::Seconds() < EndTime)
+		{
+			const uint64 Index = NextIndex++;
+			for (int32 Controller = 0; Controller < (int32)DualSenseShared::MaxControllers; ++Controller)
+			{
+				const FDualSenseInputReport Report = DualSenseReplay::MakeIndexedReport(Index);
+				const uint64 StartCycles = FPlatformTime::Cycles64();
+				Writer.Publish(Controller, Report);
+				PublishTimes.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0);
+			}
+			Writer.Heartbeat();
+
+			NextReportTime += Interval;
+			const double WaitTime = NextReportTime - FPlatformTime::Seconds();
+			if (WaitTime > 0.0)
+			{
+				FPlatformProcess::SleepNoStats((float)WaitTime);
+			}
+		}
+
+		uint64 ReadRecords = 0;
+		uint64 MissedRecords = 0;
+		TArray<double> ReadLatencies;
+		for (TUniquePtr<FDualSenseSharedStateReaderThread>& Reader : Readers)
+		{
+			Reader->Finish();
+			ReadRecords += Reader->ReadRecords;
+			MissedRecords += Reader->MissedRecords;
+			ReadLatencies.Append(Reader->Latencies);
+		}
+
+		Ar.Logf(TEXT("[%d Readers] Publish | %s"), PassReaders, *DescribeLatencies(PublishTimes));
+		if (PassReaders == 0)
+			continue;
+
+		Ar.Logf(TEXT("[%d Readers] Publish To Read | %s"), PassReaders, *DescribeLatencies(ReadLatencies));
+		Ar.Logf(TEXT("[%d Readers] Read [%llu] | Missed [%llu]"), PassReaders, ReadRecords, MissedRecords);
+	}
+
+	Writer.Close();
+}
+
+void DualSenseBenchmark::RunHistoryBenchmark(FOutputDevice& Ar, int32 Frames, int32 Window)
+{
+	Ar.Logf(TEXT("DualSense History Benchmark | Frames [%d] | Window [%d] | %d Bytes Per Controller"), Frames, Window, (int32)sizeof(FDualSenseInputHistory));
+
+	TArray<FDualSenseDispatchedInput> Inputs;
+	DualSenseReplay::MakeDispatchedInputs(Frames, Inputs);
+
+	//Timed over the whole run, a clock read per frame would cost more than the work
+	FDualSenseInputHistory History;
+	const double CaptureStart = FPlatformTime::Seconds();
+	for (int32 Frame = 0; Frame < Frames; ++Frame)
+	{
+		const FDualSenseDispatchedInput& Input = Inputs[Frame];
+		History.Capture(Frame, FDualSenseInputSnapshot::Make(Input.Buttons, Input.LeftStick, Input.RightStick, Input.Triggers[0], Input.Triggers[1]));
+	}
+	const double CaptureSeconds = FPlatformTime::Seconds() - CaptureStart;
+
+	//Same capture, plus a remote peer's prediction of the last Window frames (the input it had before them, repeated) checked every frame
+	TArray<FDualSenseInputSnapshot> Predicted;
+	Predicted.SetNumUninitialized(Window);
+	int64 Rollbacks = 0;
+
+	History.Reset();
+	const double RollbackStart = FPlatformTime::Seconds();
+	for (int32 Frame = 0; Frame < Frames; ++Frame)
+	{
+		const FDualSenseDispatchedInput& Input = Inputs[Frame];
+		History.Capture(Frame, FDualSenseInputSnapshot::Make(Input.Buttons, Input.LeftStick, Input.RightStick, Input.Triggers[0], Input.Triggers[1]));
+
+		if (Frame < Window)
+			continue;
+
+		const uint64 FirstFrame = Frame - Window + 1;
+		const FDualSenseInputSnapshot LastKnown = *History.Find(FirstFrame - 1);
+		for (FDualSenseInputSnapshot& Snapshot : Predicted)
+		{
+			Snapshot = LastKnown;
+		}
+		Rollbacks += History.FindFirstDifference(FirstFrame, Predicted.GetData(), Window) != INDEX_NONE ? 1 : 0;
+	}
+	const double CompareSeconds = FMath::Max(0.0, FPlatformTime::Seconds() - RollbackStart - CaptureSeconds);
+
+	const double CaptureNanoseconds = CaptureSeconds * 1000000000.0 / Frames;
+	const double CompareNanoseconds = CompareSeconds * 1000000000.0 / FMath::Max(1, Frames - Window);
+	Ar.Logf(TEXT("Capture [%.1f ns/frame] | Compare %d Frames [%.1f ns/frame] | Rollbacks [%lld]"), CaptureNanoseconds, Window, CompareNanoseconds, Rollbacks);
+}
+
+void DualSenseBenchmark::RunDriftBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate)
+{
+	Ar.Logf(TEXT("DualSense Drift Benchmark | Rate [%d Hz] | Seconds [%.1f]"), ReportRate, Seconds);
+
+	const FDualSenseStickProfile Profiles[] =
+	{
+		{ TEXT("Healthy"), FVector2D(0.4f, -0.6f), FVector2D(0.4f, -0.6f), 0.5f, 0.5f },
+		{ TEXT("Worn"), FVector2D(7.f, -5.f), FVector2D(7.f, -5.f), 1.5f, 3.f },
+		{ TEXT("Drifting"), FVector2D::ZeroVector, FVector2D(36.f, -12.f), 1.f, 1.5f }
+	};
+
+	//The default FDualSenseAnalogData deadzone, no recentering
+	const float FixedDeadZoneRatio = FDualSenseAnalogData().DeadZoneRatio;
+	//Time to learn before anything is scored
+	const int32 WarmUpSamples = FMath::Min(10 * ReportRate, FMath::CeilToInt(Seconds * ReportRate) / 2);
+
+	for (const FDualSenseStickProfile& Profile : Profiles)
+	{
+		TArray<FDualSenseStickSample> Samples;
+		DualSenseReplay::MakeStickSamples(Profile, Seconds, ReportRate, Samples);
+
+		//Read thread cost alone
+		FDualSenseDriftEstimator Estimator;
+		uint32 Published = 0;
+		const double StartTime = FPlatformTime::Seconds();
+		for (const FDualSenseStickSample& Sample : Samples)
+		{
+			Published += Estimator.AddSample(Sample.X, Sample.Y) ? 1 : 0;
+		}
+		const double CostNanoseconds = (FPlatformTime::Seconds() - StartTime) * 1000000000.0 / FMath::Max(Samples.Num(), 1);
+
+		const FDualSenseDriftScore Score = DualSenseReplay::ScoreDrift(Samples, WarmUpSamples, FixedDeadZoneRatio);
+		Ar.Logf(TEXT("%-8s | Drift [%.3f] | Center Error [%.2f] | Noise [%.2f] | Dead Zone [%.3f] | Published [%u] | Cost [%.1f ns/report]"),
+			Profile.Name, Score.Drift.GetDriftRatio(), Score.MeanCenterError, Score.Drift.Noise, Score.Drift.DeadZoneRatio, Published, CostNanoseconds);
+		Ar.Logf(TEXT("%-8s | Rest Leaks Fixed [%.2f%%] Adaptive [%.2f%%] | Small Input Lost Fixed [%.2f%%] Adaptive [%.2f%%]"), Profile.Name,
+			Score.GetLeakPercent(false), Score.GetLeakPercent(true), Score.GetLostPercent(false), Score.GetLostPercent(true));
+	}
+}
+
+void DualSenseBenchmark::RunUsageBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate)
+{
+	Ar.Logf(TEXT("DualSense Usage Benchmark | Rate [%d Hz] | Seconds [%.1f]"), ReportRate, Seconds);
+
+	TArray<FDualSenseInputReport> Recording;
+	DualSenseReplay::MakeTapSessionRecording(Seconds, ReportRate, Recording);
+
+	FDualSenseUsageTracker Tracker;
+	const double StartTime = FPlatformTime::Seconds();
+	for (const FDualSenseInputReport& Report : Recording)
+	{
+		Tracker.AddReport(Report);
+	}
+	const double CostNanoseconds = (FPlatformTime::Seconds() - StartTime) * 1000000000.0 / FMath::Max(Recording.Num(), 1);
+
+	FDualSenseUsageSnapshot Usage;
+	Usage.Capture(Tracker.GetCounters());
+	Usage.Log(Ar, 0);
+	Ar.Logf(TEXT("Cost [%.1f ns/report]"), CostNanoseconds);
+}
+
+void DualSenseBenchmark::RunResampleBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate, int32 StepRate)
+{
+	Ar.Logf(TEXT("DualSense Resample Benchmark | Rate [%d Hz] | Step Rate [%d Hz] | Seconds [%.1f]"), ReportRate, StepRate, Seconds);
+
+	TArray<FDualSenseInputReport> Recording;
+	DualSenseReplay::MakeSessionRecording(Seconds, ReportRate, Recording);
+	if (Recording.Num() < 2)
+		return;
+
+	//The same recording read by games at different, jittering frame rates
+	const int32 FrameRates[] = { 20, 60, 144 };
+	const FDualSenseCalibration Calibration;
+
+	for (int32 FrameRate : FrameRates)
+	{
+		FDualSenseResampler Resampler;
+		FDualSenseResampleCursor Cursor(1.0 / StepRate);
+		int32 Steps = 0;
+		double StepSeconds = 0.0;
+
+		DualSenseReplay::ReplayFrames(Recording, FrameRate, 0.5f,
+			[&Resampler, &Calibration](const FDualSenseInputReport& Report)
+			{
+				Resampler.AddSample(Report.SensorTimestamp, FDualSenseResampleSample::Make(Report, Calibration, FVector::ZeroVector));
+			},
+			[&Resampler, &Cursor, &Steps, &StepSeconds](int32 LastIndex)
+			{
+				const double StartTime = FPlatformTime::Seconds();
+				FDualSenseResampledStep Step;
+				while (Resampler.ConsumeStep(Cursor, Step))
+				{
+					++Steps;
+				}
+				StepSeconds += FPlatformTime::Seconds() - StartTime;
+			});
+
+		Ar.Logf(TEXT("%3d fps | Steps [%d] | Skipped [%lld] | Cost [%.1f ns/step]"), FrameRate, Steps, Cursor.SkippedSteps,
+			Steps > 0 ? StepSeconds * 1000000000.0 / Steps : 0.0);
+	}
+}
+
+void DualSenseBenchmark::RunPointerBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate)
+{
+	//Whole seconds, each one holds the same gestures
+	Seconds = FMath::Max(FMath::RoundToFloat(Seconds), 1.f);
+
+	TArray<FDualSenseInputReport> Recording;
+	DualSenseReplay::MakePointerRecording(Seconds, ReportRate, Recording);
+
+	Ar.Logf(TEXT("DualSense Pointer Benchmark | Rate [%d Hz] | Seconds [%.1f] | Reports [%d]"), ReportRate, Seconds, Recording.Num());
+	if (Recording.Num() < 2)
+		return;
+
+	FDualSenseTouchPointerSettings Settings;
+	Settings.bEnabled = true;
+
+	//Read thread cost alone
+	{
+		FDualSenseTouchPointer Pointer;
+		Pointer.Settings = Settings;
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (const FDualSenseInputReport& Report : Recording)
+		{
+			Pointer.AddSample(Report);
+		}
+		Ar.Logf(TEXT("AddSample | Cost [%.1f ns/report]"), (FPlatformTime::Seconds() - StartTime) * 1000000000.0 / Recording.Num());
+	}
+
+	//Game thread consuming at jittering frame rates
+	const int32 FrameRates[] = { 20, 60, 144 };
+	for (int32 FrameRate : FrameRates)
+	{
+		FDualSenseTouchPointer Pointer;
+		Pointer.Settings = Settings;
+
+		FIntPoint Total = FIntPoint::ZeroValue;
+		int32 ClickCount = 0;
+		int32 Frames = 0;
+		double ConsumeSeconds = 0.0;
+
+		DualSenseReplay::ReplayFrames(Recording, FrameRate, 0.5f,
+			[&Pointer](const FDualSenseInputReport& Report)
+			{
+				Pointer.AddSample(Report);
+			},
+			[&](int32 LastIndex)
+			{
+				EDualSensePointerClick Clicks[FDualSenseTouchPointer::MaxPendingClicks];
+				const double StartTime = FPlatformTime::Seconds();
+				Total += Pointer.ConsumeDelta();
+				ClickCount += Pointer.ConsumeClicks(Clicks);
+				ConsumeSeconds += FPlatformTime::Seconds() - StartTime;
+				++Frames;
+			});
+
+		Ar.Logf(TEXT("%3d fps | Frames [%d] | Total [%d, %d] px | Clicks [%d] | Consume [%.1f ns/frame]"), FrameRate, Frames, Total.X, Total.Y, ClickCount,
+			Frames > 0 ? ConsumeSeconds * 1000000000.0 / Frames : 0.0);
+	}
+}
+
+void DualSenseBenchmark::RunMotionGestureBenchmark(FOutputDevice& Ar, float BudgetNanoseconds, const FString& File)
+{
+	Ar.Logf(TEXT("DualSense Motion Gesture Benchmark | Budget [%.0f ns/report]"), BudgetNanoseconds);
+
+	FDualSenseMotionGestureSettings Settings;
+	Settings.bEnabled = true;
+
+	const int32 ReportRates[] = { 250, 1000 };
+	for (int32 ReportRate : ReportRates)
+	{
+		TArray<FDualSenseInputReport> Recording;
+		TArray<FDualSenseScriptedMotionGesture> Script;
+		DualSenseReplay::MakeMotionRecording(ReportRate, Recording, Script);
+
+		//Cost per report, over about two million of them
+		const int32 Passes = FMath::Max(1, 2000000 / Recording.Num());
+		int32 Fired = 0;
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Pass = 0; Pass < Passes; ++Pass)
+		{
+			FDualSenseMotionGestureDetector Detector;
+			for (const FDualSenseInputReport& Report : Recording)
+			{
+				Detector.Update(Settings, Report, [&Fired](EDualSenseMotionGesture Gesture) { ++Fired; });
+			}
+		}
+		const double Nanoseconds = (FPlatformTime::Seconds() - StartTime) * 1000000000.0 / ((double)Passes * Recording.Num());
+
+		Ar.Logf(TEXT("%4d Hz | Reports [%d] | Gestures [%d] | Cost [%.1f ns/report] | %s"), ReportRate, Recording.Num(), Fired / Passes, Nanoseconds,
+			Nanoseconds <= BudgetNanoseconds ? TEXT("Within Budget") : TEXT("Over Budget!"));
+	}
+
+	if (File.IsEmpty())
+		return;
+
+	FDualSenseSession Session;
+	if (!Session.Load(File) || Session.Reports.Num() == 0)
+	{
+		Ar.Logf(TEXT("Can't Load DualSense Session [%s]"), *File);
+		return;
+	}
+
+	//Unwrapped against the first report, sessions can be longer than the sensor clock wrap
+	int32 Found = 0;
+	double SessionTime = 0.0;
+	FDualSenseMotionGestureDetector Detector;
+	for (int32 Index = 0; Index < Session.Reports.Num(); ++Index)
+	{
+		const FDualSenseInputReport& Report = Session.Reports[Index];
+		SessionTime += Index > 0 ? (double)(Report.SensorTimestamp - Session.Reports[Index - 1].SensorTimestamp) / DualSenseReport::SensorTicksPerSecond : 0.0;
+		Detector.Update(Settings, Report, [&Ar, &Found, SessionTime](EDualSenseMotionGesture Gesture)
+		{
+			Ar.Logf(TEXT("    %8.3f s | %s"), SessionTime, *DualSenseMotionGesture::GetKey(Gesture).ToString());
+			++Found;
+		});
+	}
+	Ar.Logf(TEXT("Session [%s] | Reports [%d] | Gestures [%d]"), *File, Session.Reports.Num(), Found);
+}
+
+void DualSenseBenchmark::RunScopeBenchmark(FOutputDevice& Ar, float Seconds, int32 DisplayRate)
+{
+	Ar.Logf(TEXT("DualSense Scope Benchmark | Seconds [%.1f] | Display Rate [%d Hz] | %d Bytes Per Sample"), Seconds, DisplayRate, (int32)sizeof(FDualSenseScopeSample));
+
+	TUniquePtr<FDualSenseScopeBuffer> Buffer = MakeUnique<FDualSenseScopeBuffer>();
+	constexpr int32 CostReports = 1000000;
+
+	//Producer cost with the scope closed, then open with nobody reading
+	auto MeasureCost = [&Buffer](uint64& NextIndex)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < CostReports; ++Index)
+		{
+			Buffer->AddReport(DualSenseReplay::MakeIndexedReport(NextIndex++));
+		}
+		return (FPlatformTime::Seconds() - StartTime) * 1000000000.0 / CostReports;
+	};
+
+	//Report construction alone, taken off both
+	uint64 NextIndex = 0;
+	double BaseNanoseconds = 0.0;
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		volatile uint32 Checksum = 0;
+		for (int32 Index = 0; Index < CostReports; ++Index)
+		{
+			Checksum = Checksum + DualSenseReplay::MakeIndexedReport(Index).SensorTimestamp;
+		}
+		BaseNanoseconds = (FPlatformTime::Seconds() - StartTime) * 1000000000.0 / CostReports;
+	}
+
+	const double ClosedNanoseconds = MeasureCost(NextIndex) - BaseNanoseconds;
+
+	Buffer->AddReader();
+	const double OpenNanoseconds = MeasureCost(NextIndex) - BaseNanoseconds;
+
+	//Producer flat out against a display rate reader, the ring is lapped between reads
+	FDualSenseScopeReaderThread Reader(*Buffer, FMath::Max(DisplayRate, 1));
+	const double EndTime = FPlatformTime::Seconds() + Seconds;
+	uint64 Written = 0;
+	while (FPlatformTime::Seconds() < EndTime)
+	{
+		for (int32 Index = 0; Index < 1000; ++Index)
+		{
+			Buffer->AddReport(DualSenseReplay::MakeIndexedReport(NextIndex++));
+		}
+		Written += 1000;
+	}
+	Reader.Finish();
+	Buffer->RemoveReader();
+
+	Ar.Logf(TEXT("Producer | Closed [%.1f ns/report] | Open [%.1f ns/report]"), ClosedNanoseconds, OpenNanoseconds);
+	Ar.Logf(TEXT("Written [%llu] | Reads [%llu] | Seen [%llu] | Lapped [%llu]"), Written, Reader.Reads, Reader.SeenSamples, Reader.MissedSamples);
+	Ar.Logf(TEXT("Read | %s"), *DescribeLatencies(Reader.ReadTimes));
+}
+
+void DualSenseBenchmark::RunBankBenchmark(FOutputDevice& Ar, int32 Frames)
+{
+	Ar.Logf(TEXT("DualSense Bank Benchmark | Frames [%d]"), Frames);
+
+	constexpr int32 MaxControllers = FDualSenseControllerBank::MaxControllers;
+	constexpr int32 InputFrames = 64;
+
+	//A few frames of moving input per controller, replayed in a loop
+	TArray<FDualSenseBankInput> Inputs;
+	FDualSenseCalibration Calibrations[MaxControllers];
+	FVector GyroBiases[MaxControllers];
+	DualSenseReplay::MakeBankInputs(InputFrames, Inputs, Calibrations, GyroBiases);
+
+	const int32 ControllerCounts[] = { 1, 4, 16 };
+	for (int32 ControllerCount : ControllerCounts)
+	{
+		double Seconds[3];
+
+		//Original layout, every controller's maps allocated on their own
+		{
+			TArray<TUniquePtr<FMapDecodeState>> States;
+			for (int32 Controller = 0; Controller < ControllerCount; ++Controller)
+			{
+				FMapDecodeState& State = *States.Add_GetRef(MakeUnique<FMapDecodeState>());
+				for (int32 Type = 0; Type < (int32)EDualSenseButtonType::MAX_COUNT; ++Type)
+				{
+					State.Buttons.Add((EDualSenseButtonType)Type, FDualSenseButtonData(FKey(*FString::Printf(TEXT("DualSense_Bench_Button%d"), Type))));
+				}
+				for (int32 Type = 0; Type <= (int32)EDualSenseAnalogType::RIGHT_TRIGGER; ++Type)
+				{
+					State.Analogs.Add((EDualSenseAnalogType)Type, FDualSenseAnalogData(FKey(*FString::Printf(TEXT("DualSense_Bench_Analog%d"), Type))));
+				}
+				State.Vectors.Add(EDualSenseVectorType::GYROSCOPE, FDualSenseVectorData());
+				State.Vectors.Add(EDualSenseVectorType::ACCELERATION, FDualSenseVectorData());
+			}
+
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Frame = 0; Frame < Frames; ++Frame)
+			{
+				for (int32 Controller = 0; Controller < ControllerCount; ++Controller)
+				{
+					const FDualSenseBankInput& Input = Inputs[(Frame % InputFrames) * MaxControllers + Controller];
+					FMapDecodeState& State = *States[Controller];
+
+					for (TPair<EDualSenseButtonType, FDualSenseButtonData>& Button : State.Buttons)
+					{
+						Button.Value.UpdateButtonState((Input.Buttons & DualSenseReport::GetButtonMask(Button.Key)) != 0);
+					}
+
+					for (TPair<EDualSenseAnalogType, FDualSenseAnalogData>& Analog : State.Analogs)
+					{
+						Analog.Value.UpdateAnalogState(DualSenseReplay::DecodeAnalog(Analog.Key, Input.State, Calibrations[Controller]));
+					}
+
+					for (TPair<EDualSenseVectorType, FDualSenseVectorData>& Vector : State.Vectors)
+					{
+						Vector.Value.UpdateVectorState(DualSenseReplay::DecodeVector(Vector.Key, Input.Report, GyroBiases[Controller]));
+					}
+				}
+			}
+			Seconds[0] = FPlatformTime::Seconds() - StartTime;
+		}
+
+		//Flattened bindings per controller (FDualSenseController before the bank) and the bank
+		for (int32 Layout = 1; Layout < 3; ++Layout)
+		{
+			const bool bBank = Layout == 2;
+			TArray<TUniquePtr<FDualSenseController>> States;
+			for (int32 Controller = 0; Controller < ControllerCount; ++Controller)
+			{
+				FDualSenseController& State = *States.Add_GetRef(MakeUnique<FDualSenseController>());
+				for (int32 Type = 0; Type < (int32)EDualSenseButtonType::MAX_COUNT; ++Type)
+				{
+					State.Buttons.Add({ (EDualSenseButtonType)Type, DualSenseReport::GetButtonMask((EDualSenseButtonType)Type), NAME_None, FDualSenseButtonData() });
+				}
+				for (int32 Type = 0; Type <= (int32)EDualSenseAnalogType::RIGHT_TRIGGER; ++Type)
+				{
+					State.Analogs.Add({ (EDualSenseAnalogType)Type, NAME_None, FDualSenseAnalogData() });
+				}
+				State.Vectors.Add({ EDualSenseVectorType::GYROSCOPE, FDualSenseVectorData() });
+				State.Vectors.Add({ EDualSenseVectorType::ACCELERATION, FDualSenseVectorData() });
+			}
+			TUniquePtr<FDualSenseControllerBank> Bank = MakeUnique<FDualSenseControllerBank>();
+
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Frame = 0; Frame < Frames; ++Frame)
+			{
+				const FDualSenseBankInput* FrameInputs = &Inputs[(Frame % InputFrames) * MaxControllers];
+
+				if (bBank)
+				{
+					for (int32 Controller = 0; Controller < ControllerCount; ++Controller)
+					{
+						Bank->SetInput(Controller, FrameInputs[Controller].Buttons, FrameInputs[Controller].State, Calibrations[Controller], false);
+						Bank->SetMotion(Controller, FrameInputs[Controller].Report, GyroBiases[Controller]);
+					}
+					Bank->Update(ControllerCount);
+				}
+
+				for (int32 Controller = 0; Controller < ControllerCount; ++Controller)
+				{
+					const FDualSenseBankInput& Input = FrameInputs[Controller];
+					FDualSenseController& State = *States[Controller];
+
+					const uint32 Buttons = bBank ? Bank->Buttons[Controller] : Input.Buttons;
+					for (FDualSenseButtonBinding& Binding : State.Buttons)
+					{
+						Binding.Data.UpdateButtonState((Buttons & Binding.Mask) != 0);
+					}
+
+					for (FDualSenseAnalogBinding& Binding : State.Analogs)
+					{
+						Binding.Data.UpdateAnalogState(bBank ? Bank->GetAnalog(Binding.Type, Controller) : DualSenseReplay::DecodeAnalog(Binding.Type, Input.State, Calibrations[Controller]));
+					}
+
+					for (FDualSenseVectorBinding& Binding : State.Vectors)
+					{
+						if (bBank)
+						{
+							Binding.Data.UpdateVectorState(Binding.Type == EDualSenseVectorType::GYROSCOPE ? Bank->GetAngularVelocity(Controller) : Bank->GetAcceleration(Controller));
+						}
+						else
+						{
+							Binding.Data.UpdateVectorState(DualSenseReplay::DecodeVector(Binding.Type, Input.Report, GyroBiases[Controller]));
+						}
+					}
+				}
+			}
+			Seconds[Layout] = FPlatformTime::Seconds() - StartTime;
+		}
+
+		Ar.Logf(TEXT("[%2d Controllers] TMap [%.1f ns/frame] | Bindings [%.1f ns/frame] | Bank [%.1f ns/frame]"), ControllerCount,
+			Seconds[0] * 1000000000.0 / Frames, Seconds[1] * 1000000000.0 / Frames, Seconds[2] * 1000000000.0 / Frames);
+	}
+}
+
+void DualSenseBenchmark::RunExportBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate)
+{
+	ReportRate = FMath::Max(ReportRate, 1);
+
+	FDualSenseSession Session;
+	DualSenseReplay::MakeSessionRecording(Seconds, ReportRate, Session.Reports);
+	Session.Calibration.LeftStickCenter = FVector2D(1.5f, -0.5f);
+	Session.Calibration.TriggerRest = FVector2D(2.f, 3.f);
+	Session.Calibration.GyroBias = FVector(5.f, -3.f, 2.f);
+
+	Ar.Logf(TEXT("DualSense Export Benchmark | Rate [%d Hz] | Seconds [%.0f] | Reports [%d]"), ReportRate, Seconds, Session.Reports.Num());
+
+	FDualSenseColumnarTable Tables[2];
+	const TCHAR* KernelNames[2] = { TEXT("Scalar"), TEXT("Vectorized") };
+	for (int32 Kernel = 0; Kernel < 2; ++Kernel)
+	{
+		//Best of a few runs, the first one also pays for page faults
+		double BestSeconds = MAX_dbl;
+		for (int32 Run = 0; Run < 3; ++Run)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			DualSenseColumnar::BuildTable(Session, Kernel == 1, Tables[Kernel]);
+			BestSeconds = FMath::Min(BestSeconds, FPlatformTime::Seconds() - StartTime);
+		}
+
+		Ar.Logf(TEXT("[%s] %.2f M Reports/s | Columns [%d]"), KernelNames[Kernel], Session.Reports.Num() / FMath::Max(BestSeconds, 0.000001) / 1000000.0, Tables[Kernel].Columns.Num());
+	}
+
+	const FString File = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("DualSense"), TEXT("Sessions"), TEXT("ExportBenchmark.dscol"));
+	const double WriteStartTime = FPlatformTime::Seconds();
+	if (!DualSenseColumnar::WriteFile(Tables[1], File))
+	{
+		Ar.Logf(TEXT("Can't Write [%s]"), *File);
+		return;
+	}
+	const double WriteSeconds = FMath::Max(FPlatformTime::Seconds() - WriteStartTime, 0.000001);
+	IFileManager::Get().Delete(*File);
+
+	Ar.Logf(TEXT("Write %.2f M Reports/s"), Session.Reports.Num() / WriteSeconds / 1000000.0);
+}
+#pragma endregion
+
+#pragma region Dual Sense [Benchmark Commands]
+namespace
+{
+	//DUALSENSE BENCH <Name> handlers, arguments parsed from the rest of the line with defaults for everything
+	bool BenchIO(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		int32 DeviceCount = 16;
+		float Seconds = 5.f;
+		int32 ReportRate = 250;
+		FParse::Value(Cmd, TEXT("Devices="), DeviceCount);
+		FParse::Value(Cmd, TEXT("Seconds="), Seconds);
+		FParse::Value(Cmd, TEXT("Rate="), ReportRate);
+
+		DualSenseBenchmark::RunIOBenchmark(Ar, FMath::Clamp(DeviceCount, 1, FDualSenseIOThread::MaxDevices), Seconds, ReportRate);
+		return true;
+	}
+
+	bool BenchLatency(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		float Seconds = 5.f;
+		int32 ReportRate = 250;
+		FParse::Value(Cmd, TEXT("Seconds="), Seconds);
+		FParse::Value(Cmd, TEXT("Rate="), ReportRate);
+
+		DualSenseBenchmark::RunLatencyBenchmark(Ar, Seconds, ReportRate);
+		return true;
+	}
+
+	bool BenchCallback(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		float Seconds = 5.f;
+		int32 ReportRate = 250;
+		int32 FrameRate = 60;
+		FParse::Value(Cmd, TEXT("Seconds="), Seconds);
+		FParse::Value(Cmd, TEXT("Rate="), ReportRate);
+		FParse::Value(Cmd, TEXT("FrameRate="), FrameRate);
+
+		DualSenseBenchmark::RunCallbackBenchmark(Ar, Seconds, ReportRate, FMath::Max(FrameRate, 1));
+		return true;
+	}
+
+	bool BenchLatch(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		float Seconds = 5.f;
+		int32 ReportRate = 250;
+		int32 FrameRate = 60;
+		FParse::Value(Cmd, TEXT("Seconds="), Seconds);
+		FParse::Value(Cmd, TEXT("Rate="), ReportRate);
+		FParse::Value(Cmd, TEXT("FrameRate="), FrameRate);
+
+		DualSenseBenchmark::RunLatchBenchmark(Ar, Seconds, FMath::Max(ReportRate, 1), FMath::Max(FrameRate, 1));
+		return true;
+	}
+
+	bool BenchPointer(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		float Seconds = 10.f;
+		int32 ReportRate = 250;
+		FParse::Value(Cmd, TEXT("Seconds="), Seconds);
+		FParse::Value(Cmd, TEXT("Rate="), ReportRate);
+
+		DualSenseBenchmark::RunPointerBenchmark(Ar, Seconds, FMath::Max(ReportRate, 1));
+		return true;
+	}
+
+	bool BenchFrame(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		int32 ControllerCount = 4;
+		int32 Frames = 10000;
+		FParse::Value(Cmd, TEXT("Controllers="), ControllerCount);
+		FParse::Value(Cmd, TEXT("Frames="), Frames);
+
+		DualSenseBenchmark::RunFrameBenchmark(Ar, FMath::Clamp(ControllerCount, 1, FDualSenseIOThread::MaxDevices), FMath::Max(Frames, 1));
+		return true;
+	}
+
+	bool BenchStream(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		float Seconds = 5.f;
+		int32 ReportRate = 250;
+		int32 Redundancy = 1;
+		float Loss = 0.f;
+		int32 Port = DualSenseStream::DefaultPort + 1;
+		FParse::Value(Cmd, TEXT("Seconds="), Seconds);
+		FParse::Value(Cmd, TEXT("Rate="), ReportRate);
+		FParse::Value(Cmd, TEXT("Redundancy="), Redundancy);
+		FParse::Value(Cmd, TEXT("Loss="), Loss);
+		FParse::Value(Cmd, TEXT("Port="), Port);
+
+		DualSenseBenchmark::RunStreamBenchmark(Ar, Seconds, ReportRate, FMath::Clamp(Redundancy, 0, DualSenseStream::MaxRedundancy), FMath::Clamp(Loss, 0.f, 1.f), Port);
+		return true;
+	}
+
+	bool BenchShare(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		float Seconds = 5.f;
+		int32 ReportRate = 1000;
+		int32 ReaderCount = 2;
+		FParse::Value(Cmd, TEXT("Seconds="), Seconds);
+		FParse::Value(Cmd, TEXT("Rate="), ReportRate);
+		FParse::Value(Cmd, TEXT("Readers="), ReaderCount);
+
+		DualSenseBenchmark::RunSharedStateBenchmark(Ar, Seconds, ReportRate, FMath::Clamp(ReaderCount, 1, 16));
+		return true;
+	}
+
+	bool BenchDrift(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		float Seconds = 120.f;
+		int32 ReportRate = 250;
+		FParse::Value(Cmd, TEXT("Seconds="), Seconds);
+		FParse::Value(Cmd, TEXT("Rate="), ReportRate);
+
+		DualSenseBenchmark::RunDriftBenchmark(Ar, FMath::Max(Seconds, 1.f), FMath::Max(ReportRate, 1));
+		return true;
+	}
+
+	bool BenchUsage(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		float Seconds = 600.f;
+		int32 ReportRate = 250;
+		FParse::Value(Cmd, TEXT("Seconds="), Seconds);
+		FParse::Value(Cmd, TEXT("Rate="), ReportRate);
+
+		DualSenseBenchmark::RunUsageBenchmark(Ar, FMath::Max(Seconds, 1.f), FMath::Max(ReportRate, 1));
+		return true;
+	}
+
+	bool BenchResample(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		float Seconds = 60.f;
+		int32 ReportRate = 250;
+		int32 StepRate = 120;
+		FParse::Value(Cmd, TEXT("Seconds="), Seconds);
+		FParse::Value(Cmd, TEXT("Rate="), ReportRate);
+		FParse::Value(Cmd, TEXT("Step="), StepRate);
+
+		DualSenseBenchmark::RunResampleBenchmark(Ar, FMath::Max(Seconds, 1.f), FMath::Max(ReportRate, 1), FMath::Clamp(StepRate, 1, 10000));
+		return true;
+	}
+
+	bool BenchMotion(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		float BudgetNanoseconds = 1000.f;
+		FString File;
+		FParse::Value(Cmd, TEXT("Budget="), BudgetNanoseconds);
+		FParse::Value(Cmd, TEXT("File="), File);
+
+		DualSenseBenchmark::RunMotionGestureBenchmark(Ar, BudgetNanoseconds, File);
+		return true;
+	}
+
+	bool BenchScope(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		float Seconds = 2.f;
+		int32 DisplayRate = 144;
+		FParse::Value(Cmd, TEXT("Seconds="), Seconds);
+		FParse::Value(Cmd, TEXT("Rate="), DisplayRate);
+
+		DualSenseBenchmark::RunScopeBenchmark(Ar, FMath::Max(Seconds, 0.1f), FMath::Max(DisplayRate, 1));
+		return true;
+	}
+
+	bool BenchBank(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		int32 Frames = 100000;
+		FParse::Value(Cmd, TEXT("Frames="), Frames);
+
+		DualSenseBenchmark::RunBankBenchmark(Ar, FMath::Max(Frames, 1));
+		return true;
+	}
+
+	bool BenchHistory(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		int32 Frames = 1000000;
+		int32 Window = 8;
+		FParse::Value(Cmd, TEXT("Frames="), Frames);
+		FParse::Value(Cmd, TEXT("Window="), Window);
+
+		DualSenseBenchmark::RunHistoryBenchmark(Ar, FMath::Max(Frames, 1), FMath::Clamp(Window, 1, FDualSenseInputHistory::Capacity - 1));
+		return true;
+	}
+
+	bool BenchExport(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		float Seconds = 3600.f;
+		int32 ReportRate = 250;
+		FParse::Value(Cmd, TEXT("Seconds="), Seconds);
+		FParse::Value(Cmd, TEXT("Rate="), ReportRate);
+
+		DualSenseBenchmark::RunExportBenchmark(Ar, Seconds, ReportRate);
+		return true;
+	}
+
+	bool BenchOutput(const TCHAR* Cmd, FOutputDevice& Ar)
+	{
+		int32 ProducerCount = 8;
+		int32 CommandsPerProducer = 100000;
+		FParse::Value(Cmd, TEXT("Producers="), ProducerCount);
+		FParse::Value(Cmd, TEXT("Commands="), CommandsPerProducer);
+
+		DualSenseBenchmark::RunOutputStress(Ar, ProducerCount, CommandsPerProducer);
+		return true;
+	}
+}
+
+bool DualSenseBenchmark::Exec(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	using FBenchHandler = bool (*)(const TCHAR* Cmd, FOutputDevice& Ar);
+	static const TPair<const TCHAR*, FBenchHandler> Handlers[] =
+	{
+		{ TEXT("IO"), &BenchIO },
+		{ TEXT("LATENCY"), &BenchLatency },
+		{ TEXT("CALLBACK"), &BenchCallback },
+		{ TEXT("LATCH"), &BenchLatch },
+		{ TEXT("POINTER"), &BenchPointer },
+		{ TEXT("FRAME"), &BenchFrame },
+		{ TEXT("STREAM"), &BenchStream },
+		{ TEXT("SHARE"), &BenchShare },
+		{ TEXT("DRIFT"), &BenchDrift },
+		{ TEXT("USAGE"), &BenchUsage },
+		{ TEXT("RESAMPLE"), &BenchResample },
+		{ TEXT("MOTION"), &BenchMotion },
+		{ TEXT("SCOPE"), &BenchScope },
+		{ TEXT("BANK"), &BenchBank },
+		{ TEXT("HISTORY"), &BenchHistory },
+		{ TEXT("EXPORT"), &BenchExport },
+		{ TEXT("OUTPUT"), &BenchOutput }
+	};
+
+	for (const TPair<const TCHAR*, FBenchHandler>& Handler : Handlers)
+	{
+		if (FParse::Command(&Cmd, Handler.Key))
+		{
+			return Handler.Value(Cmd, Ar);
+		}
+	}
+	return false;
+}
+#pragma endregion
@@ -0,0 +1,167 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseCalibration.h"
+#include "WinDualSensePCH.h"
+#include "Async/Async.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Hash/CityHash.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	//Released triggers stay this close to their rest value
+	constexpr float TriggerRestRange = 16.f;
+
+	//Time constant of the rest average, seconds
+	constexpr float RefineTimeConstant = 2.f;
+
+	constexpr uint32 CacheMagic = 0x44534341;
+
+	//Newest async save of each cache file, a load or a sync save of the same file waits for it first.
+	//A pad that reconnects right after a disconnect would otherwise read the file before its last save landed
+	FCriticalSection PendingSavesLock;
+	TMap<FString, TSharedFuture<bool>> PendingSaves;
+
+	TSharedFuture<bool> GetPendingSave(const FString& CacheFile)
+	{
+		FScopeLock Lock(&PendingSavesLock);
+		const TSharedFuture<bool>* PendingSave = PendingSaves.Find(CacheFile);
+		return PendingSave ? *PendingSave : TSharedFuture<bool>();
+	}
+
+	bool WriteCacheFile(const FString& CacheFile, const FString& DevicePath, const FDualSenseCalibration& Calibration)
+	{
+		TArray<uint8> Data;
+		FMemoryWriter Writer(Data);
+		uint32 Magic = CacheMagic;
+		uint32 Version = FDualSenseCalibration::CurrentVersion;
+		FString StoredPath = DevicePath;
+		FDualSenseCalibration StoredCalibration = Calibration;
+		Writer << Magic << Version << StoredPath << StoredCalibration;
+
+		if (!FFileHelper::SaveArrayToFile(Data, *CacheFile))
+		{
+			UE_LOG(LogWinDualSense, Warning, TEXT("Can't Save DualSense Calibration [%s]"), *CacheFile);
+			return false;
+		}
+		return true;
+	}
+
+	void RefineAxis(float& Center, float Value, float Range, float Alpha, bool& bOutChanged)
+	{
+		if (FMath::Abs(Value - Center) < Range && Value != Center)
+		{
+			Center = FMath::Lerp(Center, Value, Alpha);
+			bOutChanged = true;
+		}
+	}
+}
+
+#pragma region Dual Sense [Calibration]
+FString DualSenseCalibration::GetCacheFile(const FString& DevicePath)
+{
+	//Paths hold characters files can't, the hash names the file and the path inside checks it
+	const uint64 Hash = CityHash64((const char*)*DevicePath.ToLower(), DevicePath.Len() * sizeof(TCHAR));
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("DualSense"), TEXT("Calibration"), FString::Printf(TEXT("%016llx.bin"), Hash));
+}
+
+TFuture<TOptional<FDualSenseCalibration>> DualSenseCalibration::LoadAsync(const FString& DevicePath)
+{
+	const FString CacheFile = GetCacheFile(DevicePath);
+	const TSharedFuture<bool> PendingSave = GetPendingSave(CacheFile);
+	return Async(EAsyncExecution::ThreadPool, [DevicePath, CacheFile, PendingSave]() -> TOptional<FDualSenseCalibration>
+	{
+		if (PendingSave.IsValid())
+		{
+			PendingSave.Wait();
+		}
+
+		TArray<uint8> Data;
+		if (!FFileHelper::LoadFileToArray(Data, *CacheFile, FILEREAD_Silent))
+		{
+			return TOptional<FDualSenseCalibration>();
+		}
+
+		FMemoryReader Reader(Data);
+		uint32 Magic = 0;
+		uint32 Version = 0;
+		FString StoredPath;
+		FDualSenseCalibration Calibration;
+		Reader << Magic << Version << StoredPath << Calibration;
+
+		if (Reader.IsError() || Magic != CacheMagic || Version != FDualSenseCalibration::CurrentVersion || !StoredPath.Equals(DevicePath, ESearchCase::IgnoreCase))
+		{
+			return TOptional<FDualSenseCalibration>();
+		}
+		return Calibration;
+	});
+}
+
+bool DualSenseCalibration::Save(const FString& DevicePath, const FDualSenseCalibration& Calibration)
+{
+	//An older async save landing afterwards would undo this one
+	const FString CacheFile = GetCacheFile(DevicePath);
+	const TSharedFuture<bool> PendingSave = GetPendingSave(CacheFile);
+	if (PendingSave.IsValid())
+	{
+		PendingSave.Wait();
+	}
+	return WriteCacheFile(CacheFile, DevicePath, Calibration);
+}
+
+void DualSenseCalibration::SaveAsync(const FString& DevicePath, const FDualSenseCalibration& Calibration)
+{
+	const FString CacheFile = GetCacheFile(DevicePath);
+
+	FScopeLock Lock(&PendingSavesLock);
+	for (auto It = PendingSaves.CreateIterator(); It; ++It)
+	{
+		if (It.Value().IsReady())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	//Chained after the previous save of the same file, so saves land in order
+	TSharedFuture<bool> PreviousSave = PendingSaves.FindRef(CacheFile);
+	PendingSaves.Add(CacheFile, Async(EAsyncExecution::ThreadPool, [CacheFile, DevicePath, Calibration, PreviousSave]()
+	{
+		if (PreviousSave.IsValid())
+		{
+			PreviousSave.Wait();
+		}
+		return WriteCacheFile(CacheFile, DevicePath, Calibration);
+	}).Share());
+}
+
+bool FDualSenseCalibrator::AddSample(const DS5W::DS5InputState& State, uint32 Buttons, bool bIsAtRest, float DeltaTime, FDualSenseCalibration& Calibration)
+{
+	bool bChanged = false;
+
+	//Deep pulls are rare, take them whenever they show up
+	if (State.leftTrigger > Calibration.TriggerMax.X || State.rightTrigger > Calibration.TriggerMax.Y)
+	{
+		Calibration.TriggerMax.X = FMath::Max(Calibration.TriggerMax.X, (float)State.leftTrigger);
+		Calibration.TriggerMax.Y = FMath::Max(Calibration.TriggerMax.Y, (float)State.rightTrigger);
+		bChanged = true;
+	}
+
+	//Only a pad lying still with nothing pressed says where "released" is
+	if (!bIsAtRest || Buttons != 0 || DeltaTime <= 0.f)
+	{
+		return bChanged;
+	}
+
+	const float Alpha = FMath::Min(1.f, DeltaTime / RefineTimeConstant);
+	//Stick centers come from the read thread's drift estimate, which also sees rest while the pad is held
+	RefineAxis(Calibration.TriggerRest.X, (float)State.leftTrigger, TriggerRestRange, Alpha, bChanged);
+	RefineAxis(Calibration.TriggerRest.Y, (float)State.rightTrigger, TriggerRestRange, Alpha, bChanged);
+
+	//Gyro bias is learned over the same rest time
+	Calibration.RestSeconds += DeltaTime;
+	return true;
+}
+#pragma endregion
@@ -0,0 +1,88 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseCallback.h"
+
+#pragma region Dual Sense [Input Callback]
+bool FDualSenseCallbackContext::Post(int64 Value) const
+{
+	FDualSenseCallbackEvent Event;
+	Event.CallbackId = Callback.Id;
+	Event.SensorTimestamp = Report.SensorTimestamp;
+	Event.ReceiveCycles = Report.ReceiveCycles;
+	Event.PressedButtons = PressedButtons;
+	Event.ReleasedButtons = ReleasedButtons;
+	Event.Value = Value;
+
+	if (!Events.Enqueue(Event))
+	{
+		Callback.Stats.DroppedEvents.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	Callback.Stats.PostedEvents.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+void FDualSenseCallbackStats::Reset()
+{
+	Calls.store(0, std::memory_order_relaxed);
+	Cycles.store(0, std::memory_order_relaxed);
+	MaxCycles.store(0, std::memory_order_relaxed);
+	PostedEvents.store(0, std::memory_order_relaxed);
+	DroppedEvents.store(0, std::memory_order_relaxed);
+}
+
+void FDualSenseCallbackStats::AddCall(uint64 CallCycles)
+{
+	Calls.fetch_add(1, std::memory_order_relaxed);
+	Cycles.fetch_add(CallCycles, std::memory_order_relaxed);
+
+	//Several producers may race here, keep the larger one
+	uint64 CurrentMax = MaxCycles.load(std::memory_order_relaxed);
+	while (CallCycles > CurrentMax && !MaxCycles.compare_exchange_weak(CurrentMax, CallCycles, std::memory_order_relaxed))
+	{
+	}
+}
+
+void FDualSenseCallbackSet::Add(FDualSenseInputCallback* Callback)
+{
+	Callbacks.Add(Callback);
+
+	if (Callback->Trigger == EDualSenseCallbackTrigger::EveryReport)
+	{
+		bHasEveryReport = true;
+	}
+	else
+	{
+		EdgeButtons |= Callback->Buttons != 0 ? Callback->Buttons : ~0u;
+	}
+}
+
+void FDualSenseCallbackSet::Dispatch(int32 ControllerId, const FDualSenseInputReport& Report, uint32 LastButtons, FDualSenseCallbackEventQueue& Events) const
+{
+	const uint32 ChangedButtons = Report.Buttons ^ LastButtons;
+	if (!bHasEveryReport && (ChangedButtons & EdgeButtons) == 0)
+	{
+		return;
+	}
+
+	const uint32 PressedButtons = ChangedButtons & Report.Buttons;
+	const uint32 ReleasedButtons = ChangedButtons & LastButtons;
+
+	for (FDualSenseInputCallback* Callback : Callbacks)
+	{
+		if (Callback->Trigger == EDualSenseCallbackTrigger::ButtonEdge)
+		{
+			const uint32 WatchedButtons = Callback->Buttons != 0 ? Callback->Buttons : ~0u;
+			if ((ChangedButtons & WatchedButtons) == 0)
+			{
+				continue;
+			}
+		}
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		Callback->Function(FDualSenseCallbackContext(ControllerId, Report, PressedButtons, ReleasedButtons, *Callback, Events));
+		Callback->Stats.AddCall(FPlatformTime::Cycles64() - StartCycles);
+	}
+}
+#pragma endregion
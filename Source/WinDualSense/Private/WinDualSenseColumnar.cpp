@@ -0,0 +1,226 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseColumnar.h"
+#include "WinDualSensePCH.h"
+#include "WinDualSenseSession.h"
+#include "HAL/FileManager.h"
+
+namespace
+{
+	//Integer signal of a report and the linear map to its float column
+	struct FColumnConversion
+	{
+		const TCHAR* Name;
+		int32 (*Read)(const FDualSenseInputReport& Report);
+		float Scale;
+		float Offset;
+		float Min;
+		float Max;
+	};
+
+	//MapRangeClamped(Value - Center, InMin, InMax, OutMin, OutMax) as Scale / Offset
+	FColumnConversion MakeRangeConversion(const TCHAR* Name, int32 (*Read)(const FDualSenseInputReport&), float Center, float InMin, float InMax, float OutMin, float OutMax)
+	{
+		const float Scale = (OutMax - OutMin) / FMath::Max(InMax - InMin, KINDA_SMALL_NUMBER);
+		return { Name, Read, Scale, OutMin - (InMin + Center) * Scale, FMath::Min(OutMin, OutMax), FMath::Max(OutMin, OutMax) };
+	}
+
+	FColumnConversion MakeLinearConversion(const TCHAR* Name, int32 (*Read)(const FDualSenseInputReport&), float Bias, float CountsPerUnit)
+	{
+		return { Name, Read, 1.f / CountsPerUnit, -Bias / CountsPerUnit, -MAX_flt, MAX_flt };
+	}
+
+	void MakeConversions(const FDualSenseCalibration& Calibration, TArray<FColumnConversion>& OutConversions)
+	{
+		OutConversions =
+		{
+			MakeRangeConversion(TEXT("LeftStickX"), [](const FDualSenseInputReport& Report) { return (int32)Report.State.leftStick.x; }, Calibration.LeftStickCenter.X, -128.f, 127.f, -1.f, 1.f),
+			MakeRangeConversion(TEXT("LeftStickY"), [](const FDualSenseInputReport& Report) { return (int32)Report.State.leftStick.y; }, Calibration.LeftStickCenter.Y, -128.f, 127.f, -1.f, 1.f),
+			MakeRangeConversion(TEXT("RightStickX"), [](const FDualSenseInputReport& Report) { return (int32)Report.State.rightStick.x; }, Calibration.RightStickCenter.X, -128.f, 127.f, -1.f, 1.f),
+			MakeRangeConversion(TEXT("RightStickY"), [](const FDualSenseInputReport& Report) { return (int32)Report.State.rightStick.y; }, Calibration.RightStickCenter.Y, -128.f, 127.f, -1.f, 1.f),
+			MakeRangeConversion(TEXT("LeftTrigger"), [](const FDualSenseInputReport& Report) { return (int32)Report.State.leftTrigger; }, 0.f, Calibration.TriggerRest.X, Calibration.GetTriggerFullPull(false), 0.f, 1.f),
+			MakeRangeConversion(TEXT("RightTrigger"), [](const FDualSenseInputReport& Report) { return (int32)Report.State.rightTrigger; }, 0.f, Calibration.TriggerRest.Y, Calibration.GetTriggerFullPull(true), 0.f, 1.f),
+
+			//deg/s and g
+			MakeLinearConversion(TEXT("GyroscopeX"), [](const FDualSenseInputReport& Report) { return (int32)Report.Gyroscope.x; }, Calibration.GyroBias.X, DualSenseReport::GyroCountsPerDegreePerSecond),
+			MakeLinearConversion(TEXT("GyroscopeY"), [](const FDualSenseInputReport& Report) { return (int32)Report.Gyroscope.y; }, Calibration.GyroBias.Y, DualSenseReport::GyroCountsPerDegreePerSecond),
+			MakeLinearConversion(TEXT("GyroscopeZ"), [](const FDualSenseInputReport& Report) { return (int32)Report.Gyroscope.z; }, Calibration.GyroBias.Z, DualSenseReport::GyroCountsPerDegreePerSecond),
+			MakeLinearConversion(TEXT("AccelerometerX"), [](const FDualSenseInputReport& Report) { return (int32)Report.Accelerometer.x; }, 0.f, DualSenseReport::AccelCountsPerG),
+			MakeLinearConversion(TEXT("AccelerometerY"), [](const FDualSenseInputReport& Report) { return (int32)Report.Accelerometer.y; }, 0.f, DualSenseReport::AccelCountsPerG),
+			MakeLinearConversion(TEXT("AccelerometerZ"), [](const FDualSenseInputReport& Report) { return (int32)Report.Accelerometer.z; }, 0.f, DualSenseReport::AccelCountsPerG),
+
+			//0 - 1 across the pad
+			MakeRangeConversion(TEXT("Touch1X"), [](const FDualSenseInputReport& Report) { return (int32)Report.State.touchPoint1.x; }, 0.f, 0.f, (float)(DualSenseReport::TouchpadWidth - 1), 0.f, 1.f),
+			MakeRangeConversion(TEXT("Touch1Y"), [](const FDualSenseInputReport& Report) { return (int32)Report.State.touchPoint1.y; }, 0.f, 0.f, (float)(DualSenseReport::TouchpadHeight - 1), 0.f, 1.f),
+			MakeRangeConversion(TEXT("Touch2X"), [](const FDualSenseInputReport& Report) { return (int32)Report.State.touchPoint2.x; }, 0.f, 0.f, (float)(DualSenseReport::TouchpadWidth - 1), 0.f, 1.f),
+			MakeRangeConversion(TEXT("Touch2Y"), [](const FDualSenseInputReport& Report) { return (int32)Report.State.touchPoint2.y; }, 0.f, 0.f, (float)(DualSenseReport::TouchpadHeight - 1), 0.f, 1.f),
+		};
+	}
+
+	FDualSenseColumn& AddColumn(FDualSenseColumnarTable& Table, const TCHAR* Name, EDualSenseColumnType Type)
+	{
+		FDualSenseColumn& Column = Table.Columns.AddDefaulted_GetRef();
+		Column.Name = Name;
+		Column.Type = Type;
+		Column.Data.SetNumUninitialized(Table.RowCount * (Type == EDualSenseColumnType::Float64 ? sizeof(double) : sizeof(uint32)));
+		return Column;
+	}
+
+	FORCEINLINE int64 GetColumnBytes(const FDualSenseColumnarTable& Table, const FDualSenseColumn& Column)
+	{
+		return Table.RowCount * (Column.Type == EDualSenseColumnType::Float64 ? sizeof(double) : sizeof(uint32));
+	}
+}
+
+#pragma region Dual Sense [Columnar Export]
+const FDualSenseColumn* FDualSenseColumnarTable::FindColumn(const TCHAR* Name) const
+{
+	return Columns.FindByPredicate([Name](const FDualSenseColumn& Column) { return Column.Name == Name; });
+}
+
+void DualSenseColumnar::ConvertScalar(const int32* In, float* Out, int32 Count, float Scale, float Offset, float Min, float Max)
+{
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		Out[Index] = FMath::Clamp((float)In[Index] * Scale + Offset, Min, Max);
+	}
+}
+
+void DualSenseColumnar::ConvertVectorized(const int32* In, float* Out, int32 Count, float Scale, float Offset, float Min, float Max)
+{
+	const VectorRegister VScale = VectorSetFloat1(Scale);
+	const VectorRegister VOffset = VectorSetFloat1(Offset);
+	const VectorRegister VMin = VectorSetFloat1(Min);
+	const VectorRegister VMax = VectorSetFloat1(Max);
+
+	int32 Index = 0;
+	for (; Index + 8 <= Count; Index += 8)
+	{
+		const VectorRegister Low = VectorMultiplyAdd(VectorIntToFloat(VectorIntLoad(In + Index)), VScale, VOffset);
+		const VectorRegister High = VectorMultiplyAdd(VectorIntToFloat(VectorIntLoad(In + Index + 4)), VScale, VOffset);
+		VectorStore(VectorMin(VectorMax(Low, VMin), VMax), Out + Index);
+		VectorStore(VectorMin(VectorMax(High, VMin), VMax), Out + Index + 4);
+	}
+
+	ConvertScalar(In + Index, Out + Index, Count - Index, Scale, Offset, Min, Max);
+}
+
+void DualSenseColumnar::BuildTable(const FDualSenseSession& Session, bool bVectorized, FDualSenseColumnarTable& OutTable)
+{
+	const TArray<FDualSenseInputReport>& Reports = Session.Reports;
+	const int32 RowCount = Reports.Num();
+
+	TArray<FColumnConversion> Conversions;
+	MakeConversions(Session.Calibration, Conversions);
+
+	OutTable.RowCount = RowCount;
+	OutTable.Columns.Reset(Conversions.Num() + 2);
+
+	//Seconds since the first report, the 32 bit sensor clock unwrapped
+	double* Time = AddColumn(OutTable, TEXT("Time"), EDualSenseColumnType::Float64).GetValues<double>();
+	uint32* Buttons = AddColumn(OutTable, TEXT("Buttons"), EDualSenseColumnType::UInt32).GetValues<uint32>();
+
+	//One integer column per signal, filled in one pass over the reports
+	TArray<int32, TAlignedHeapAllocator<64>> Integers;
+	Integers.SetNumUninitialized(Conversions.Num() * RowCount);
+
+	uint64 Ticks = 0;
+	for (int32 Row = 0; Row < RowCount; ++Row)
+	{
+		const FDualSenseInputReport& Report = Reports[Row];
+		Ticks += Row > 0 ? (uint64)(Report.SensorTimestamp - Reports[Row - 1].SensorTimestamp) : 0;
+		Time[Row] = (double)Ticks / DualSenseReport::SensorTicksPerSecond;
+		Buttons[Row] = DualSenseReport::PackButtons(Report.State);
+
+		for (int32 Column = 0; Column < Conversions.Num(); ++Column)
+		{
+			Integers[Column * RowCount + Row] = Conversions[Column].Read(Report);
+		}
+	}
+
+	for (int32 Column = 0; Column < Conversions.Num(); ++Column)
+	{
+		const FColumnConversion& Conversion = Conversions[Column];
+		float* Values = AddColumn(OutTable, Conversion.Name, EDualSenseColumnType::Float32).GetValues<float>();
+		const int32* Source = Integers.GetData() + Column * RowCount;
+
+		if (bVectorized)
+		{
+			ConvertVectorized(Source, Values, RowCount, Conversion.Scale, Conversion.Offset, Conversion.Min, Conversion.Max);
+		}
+		else
+		{
+			ConvertScalar(Source, Values, RowCount, Conversion.Scale, Conversion.Offset, Conversion.Min, Conversion.Max);
+		}
+	}
+}
+
+bool DualSenseColumnar::WriteFile(const FDualSenseColumnarTable& Table, const FString& File)
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*File));
+	if (!Writer)
+	{
+		UE_LOG(LogWinDualSense, Warning, TEXT("Can't Write DualSense Columns [%s]"), *File);
+		return false;
+	}
+
+	const int32 DirectoryEntrySize = ColumnNameSize + sizeof(uint32) * 2 + sizeof(uint64);
+	int64 Offset = Align(HeaderSize + DirectoryEntrySize * Table.Columns.Num(), ColumnAlignment);
+
+	uint8 Header[HeaderSize] = {};
+	const uint64 RowCount = Table.RowCount;
+	const uint32 ColumnCount = Table.Columns.Num();
+	FMemory::Memcpy(Header, &Magic, sizeof(uint32));
+	FMemory::Memcpy(Header + 4, &Version, sizeof(uint32));
+	FMemory::Memcpy(Header + 8, &RowCount, sizeof(uint64));
+	FMemory::Memcpy(Header + 16, &ColumnCount, sizeof(uint32));
+	Writer->Serialize(Header, HeaderSize);
+
+	for (const FDualSenseColumn& Column : Table.Columns)
+	{
+		uint8 Entry[ColumnNameSize + sizeof(uint32) * 2 + sizeof(uint64)] = {};
+		const FTCHARToUTF8 Name(*Column.Name);
+		//Cut on a character boundary, never inside a multi byte sequence
+		int32 NameLength = FMath::Min(Name.Length(), ColumnNameSize - 1);
+		while (NameLength > 0 && ((uint8)Name.Get()[NameLength] & 0xC0) == 0x80)
+		{
+			--NameLength;
+		}
+		FMemory::Memcpy(Entry, Name.Get(), NameLength);
+		const uint32 Type = (uint32)Column.Type;
+		const uint64 ColumnOffset = Offset;
+		FMemory::Memcpy(Entry + ColumnNameSize, &Type, sizeof(uint32));
+		FMemory::Memcpy(Entry + ColumnNameSize + sizeof(uint32) * 2, &ColumnOffset, sizeof(uint64));
+		Writer->Serialize(Entry, sizeof(Entry));
+
+		Offset = Align(Offset + GetColumnBytes(Table, Column), ColumnAlignment);
+	}
+
+	static uint8 Padding[ColumnAlignment] = {};
+	for (const FDualSenseColumn& Column : Table.Columns)
+	{
+		Writer->Serialize(Padding, Align(Writer->Tell(), ColumnAlignment) - Writer->Tell());
+		Writer->Serialize(const_cast<uint8*>(Column.Data.GetData()), GetColumnBytes(Table, Column));
+	}
+
+	return Writer->Close();
+}
+
+bool DualSenseColumnar::Export(const FDualSenseSession& Session, const FString& File)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	FDualSenseColumnarTable Table;
+	BuildTable(Session, true, Table);
+	const double BuildSeconds = FMath::Max(FPlatformTime::Seconds() - StartTime, 0.000001);
+
+	if (!WriteFile(Table, File))
+	{
+		return false;
+	}
+	const double TotalSeconds = FMath::Max(FPlatformTime::Seconds() - StartTime, 0.000001);
+
+	UE_LOG(LogWinDualSense, Log, TEXT("DualSense Columns Exported [%s] | Reports [%lld] | Columns [%d] | Convert %.2f M Reports/s | Total (With Write) %.2f M Reports/s"),
+		*File, Table.RowCount, Table.Columns.Num(), Table.RowCount / BuildSeconds / 1000000.0, Table.RowCount / TotalSeconds / 1000000.0);
+	return true;
+}
+#pragma endregion
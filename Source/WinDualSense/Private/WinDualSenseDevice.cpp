@@ -3,11 +3,1455 @@
 #pragma once
 
 #include "WinDualSenseDevice.h"
-#include <Kismet/KismetMathLibrary.h>
+#include "WinDualSenseBenchmark.h"
+#include "WinDualSenseColumnar.h"
+#include "CoreGlobals.h"
+#include "Misc/FileHelper.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Widgets/SWindow.h"
+#include "WinDualSenseScopeWidget.h"
 
 #pragma region Dual Sense [Input Device]
-FWinDualSenseDevice::FWinDualSenseDevice(const TSharedRef< FGenericApplicationMessageHandler >& InMessageHandler) : MessageHandler(InMessageHandler)
+FWinDualSenseDevice::FWinDualSenseDevice(const TSharedRef< FGenericApplicationMessageHandler >& InMessageHandler, TUniquePtr<FDualSenseIOThread> InIOThread)
+	: IOThread(MoveTemp(InIOThread))
+	, MessageHandler(InMessageHandler)
 {
+	//Bindings and per controller state are built when the first controller connects
+	//Reading & device discovery run on the IO thread
+	if (!IOThread)
+	{
+		IOThread = MakeUnique<FDualSenseIOThread>();
+	}
+	IOThread->Start();
+}
+
+FWinDualSenseDevice::~FWinDualSenseDevice()
+{
+	UE_LOG(LogWinDualSense, Warning, TEXT("~FWinDualSense"));
+
+	for (TUniquePtr<FDualSenseController>& Controller : Controllers)
+	{
+		if (Controller && Controller->bConnected)
+		{
+			SaveCalibration(*Controller, false);
+		}
+	}
+
+	//Host injects into the IO thread
+	StreamHost.Reset();
+	IOThread.Reset();
+}
+
+void FWinDualSenseDevice::Tick(float DeltaTime)
+{
+
+}
+
+void FWinDualSenseDevice::SendControllerEvents()
+{
+	DUALSENSE_TRACE_SCOPE(SendControllerEvents);
+
+	FramePacing.AddFrame(FPlatformTime::Cycles64());
+	DrainOutputCommands();
+
+	if (RetiredObjects.Num() > 0)
+	{
+		RetiredObjects.Collect(*IOThread);
+	}
+
+	if (SharedState)
+	{
+		SharedState->Heartbeat();
+	}
+
+	static_assert(FDualSenseControllerBank::MaxControllers >= FDualSenseIOThread::MaxDevices, "Every IO slot needs a bank lane");
+
+	//Read every controller into the bank first
+	int32 LaneCount = 0;
+	for (int32 ControllerId = 0; ControllerId < FDualSenseIOThread::MaxDevices; ++ControllerId)
+	{
+		//Slots that never saw a controller have no state yet
+		if (!Controllers[ControllerId] && IOThread->GetSlotState(ControllerId) == EDualSenseSlotState::Free)
+			continue;
+
+		FDualSenseController& Controller = GetController(ControllerId);
+		UpdateConnection(Controller);
+
+		if (!Controller.bConnected)
+			continue;
+
+		// Get input state
+		UpdateCalibration(Controller);
+		UpdateReports(Controller);
+		UpdateDrift(Controller);
+		LaneCount = ControllerId + 1;
+	}
+
+	//Gameplay reads input right after this, a report due within the wait budget beats the one we have
+	LatchReports(LaneCount);
+
+	for (int32 ControllerId = 0; ControllerId < LaneCount; ++ControllerId)
+	{
+		if (!Controllers[ControllerId] || !Controllers[ControllerId]->bConnected)
+			continue;
+
+		const FDualSenseController& Controller = *Controllers[ControllerId];
+		Bank.SetInput(ControllerId, Controller.ButtonMask, Controller.inState, Controller.Calibration, Controller.ReportStats.IsStalled());
+	}
+
+	//Button diffs and normalization for every controller at once
+	{
+		DUALSENSE_TRACE_SCOPE(BankUpdate);
+		Bank.Update(LaneCount);
+	}
+
+	const uint64 DispatchCycles = FPlatformTime::Cycles64();
+	for (int32 ControllerId = 0; ControllerId < LaneCount; ++ControllerId)
+	{
+		if (!Controllers[ControllerId] || !Controllers[ControllerId]->bConnected)
+			continue;
+
+		FDualSenseController& Controller = *Controllers[ControllerId];
+		if (Controller.LastReportCycles != 0 && DispatchCycles > Controller.LastReportCycles)
+		{
+			Controller.LatchStats.AddDispatch(DualSenseLatch::CyclesToMicroseconds(DispatchCycles - Controller.LastReportCycles));
+		}
+		UpdateInputs(Controller);
+		CaptureHistory(Controller, GFrameCounter);
+		UpdateOutputs(Controller);
+	}
+
+	if (DUALSENSE_TRACE_IS_ENABLED())
+	{
+		uint64 ReceivedReports = 0;
+		for (const TUniquePtr<FDualSenseController>& Controller : Controllers)
+		{
+			if (Controller && Controller->bConnected)
+			{
+				ReceivedReports += Controller->ReportStats.ReceivedReports;
+			}
+		}
+		TraceCounters.EndFrame(ReceivedReports);
+	}
+}
+
+void FWinDualSenseDevice::SetMessageHandler(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler)
+{
+	//UE_LOG(LogWinDualSense, Warning, TEXT("SetMessageHandler"));
+	MessageHandler = InMessageHandler;
+}
+
+bool FWinDualSenseDevice::Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	if (!FParse::Command(&Cmd, TEXT("DUALSENSE")))
+	{
+		return false;
+	}
+
+	//One handler per subcommand, given the rest of the line
+	using FExecHandler = bool (FWinDualSenseDevice::*)(const TCHAR* Cmd, FOutputDevice& Ar);
+	static const TPair<const TCHAR*, FExecHandler> Handlers[] =
+	{
+		{ TEXT("STATS"), &FWinDualSenseDevice::ExecStats },
+		{ TEXT("RESETSTATS"), &FWinDualSenseDevice::ExecResetStats },
+		{ TEXT("USAGE"), &FWinDualSenseDevice::ExecUsage },
+		{ TEXT("DEBUG"), &FWinDualSenseDevice::ExecDebug },
+		{ TEXT("SCOPE"), &FWinDualSenseDevice::ExecScope },
+		{ TEXT("REMAP"), &FWinDualSenseDevice::ExecRemap },
+		{ TEXT("GESTURE"), &FWinDualSenseDevice::ExecGesture },
+		{ TEXT("MOTION"), &FWinDualSenseDevice::ExecMotion },
+		{ TEXT("GYRO"), &FWinDualSenseDevice::ExecGyro },
+		{ TEXT("POINTER"), &FWinDualSenseDevice::ExecPointer },
+		{ TEXT("DRIFT"), &FWinDualSenseDevice::ExecDrift },
+		{ TEXT("LATCH"), &FWinDualSenseDevice::ExecLatch },
+		{ TEXT("STREAM"), &FWinDualSenseDevice::ExecStream },
+		{ TEXT("RECORD"), &FWinDualSenseDevice::ExecRecord },
+		{ TEXT("EXPORT"), &FWinDualSenseDevice::ExecExport },
+		{ TEXT("SHARE"), &FWinDualSenseDevice::ExecShare },
+		{ TEXT("BENCH"), &FWinDualSenseDevice::ExecBench }
+	};
+
+	for (const TPair<const TCHAR*, FExecHandler>& Handler : Handlers)
+	{
+		if (FParse::Command(&Cmd, Handler.Key))
+		{
+			return (this->*Handler.Value)(Cmd, Ar);
+		}
+	}
+	return false;
+}
+
+bool FWinDualSenseDevice::ExecStats(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	for (const TUniquePtr<FDualSenseController>& ControllerPtr : Controllers)
+	{
+		if (!ControllerPtr || !ControllerPtr->bConnected)
+			continue;
+
+		const FDualSenseController& Controller = *ControllerPtr;
+		const FDualSenseReportStats& ReportStats = Controller.ReportStats;
+		Ar.Logf(TEXT("DualSense [%d] Reports | Received [%llu] | Dropped [%llu] | Duplicate [%llu] | Stalls [%llu] | %s"), Controller.ControllerId,
+			ReportStats.ReceivedReports, ReportStats.DroppedReports, ReportStats.DuplicateReports, ReportStats.Stalls,
+			ReportStats.IsStalled() ? TEXT("[STALLED]") : TEXT(""));
+		Ar.Logf(TEXT("DualSense [%d] Interval (us) | Mean [%.1f] | StdDev [%.1f] | Min [%.1f] | Max [%.1f]"), Controller.ControllerId,
+			ReportStats.IntervalMean, ReportStats.GetIntervalStdDev(), ReportStats.IntervalMin, ReportStats.IntervalMax);
+
+		Ar.Logf(TEXT("DualSense [%d] Button Edges | Replayed [%llu] | Sub Frame Taps [%llu]"), Controller.ControllerId, Controller.ReplayedEdges, Controller.SubFrameTaps);
+
+		const FDualSenseLatchStats& LatchStats = Controller.LatchStats;
+		Ar.Logf(TEXT("DualSense [%d] Input Age (us) | Mean [%.1f] | Max [%.1f] | Last [%.1f] | Latch Waits [%llu] | Caught [%llu] | Mean Wait [%.1f us]"), Controller.ControllerId,
+			LatchStats.GetAgeMean(), LatchStats.AgeMax, LatchStats.LastAge, LatchStats.Waits, LatchStats.CaughtReports, LatchStats.GetWaitMean());
+		Ar.Logf(TEXT("DualSense [%d] Latch Deadline Overshoot (us) | Mean [%.1f] | Max [%.1f]"), Controller.ControllerId,
+			LatchStats.GetOvershootMean(), LatchStats.OvershootMax);
+	}
+
+	Ar.Logf(TEXT("DualSense Frame Interval (us) | Mean [%.1f] | Latch Budget [%.1f us]"), FramePacing.IntervalMean, DualSenseLatch::GetWaitBudget(LatchSettings, FramePacing));
+	Ar.Logf(TEXT("DualSense Output Commands | Dropped [%llu]"), DroppedOutputCommands.load(std::memory_order_relaxed));
+
+	for (const TUniquePtr<FDualSenseInputCallback>& Callback : InputCallbacks)
+	{
+		const FDualSenseCallbackStats& Stats = Callback->Stats;
+		Ar.Logf(TEXT("DualSense Callback [%d] %s | Calls [%llu] | Mean [%.2f us] | Max [%.2f us] | Posted [%llu] | Dropped [%llu]"), Callback->Id,
+			Callback->Trigger == EDualSenseCallbackTrigger::EveryReport ? TEXT("Every Report") : TEXT("Button Edge"),
+			Stats.Calls.load(), Stats.GetMeanMicroseconds(), Stats.GetMaxMicroseconds(), Stats.PostedEvents.load(), Stats.DroppedEvents.load());
+	}
+	return true;
+}
+
+bool FWinDualSenseDevice::ExecResetStats(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	for (TUniquePtr<FDualSenseController>& Controller : Controllers)
+	{
+		if (Controller)
+		{
+			Controller->ReportStats.Reset();
+			Controller->LatchStats.Reset();
+			Controller->ReplayedEdges = 0;
+			Controller->SubFrameTaps = 0;
+		}
+	}
+
+	for (TUniquePtr<FDualSenseInputCallback>& Callback : InputCallbacks)
+	{
+		Callback->Stats.Reset();
+	}
+	return true;
+}
+
+bool FWinDualSenseDevice::ExecUsage(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	//DUALSENSE USAGE RESET
+	if (FParse::Command(&Cmd, TEXT("RESET")))
+	{
+		for (int32 ControllerId = 0; ControllerId < FDualSenseIOThread::MaxDevices; ++ControllerId)
+		{
+			UsageBaselines[ControllerId].Capture(IOThread->GetUsageCounters(ControllerId));
+		}
+		Ar.Logf(TEXT("DualSense Usage Reset"));
+		return true;
+	}
+
+	//DUALSENSE USAGE Controller=0 File=Path.csv (every controller that sent reports, logged only without File)
+	int32 OnlyControllerId = INDEX_NONE;
+	FParse::Value(Cmd, TEXT("Controller="), OnlyControllerId);
+	FString File;
+	const bool bWriteFile = FParse::Value(Cmd, TEXT("File="), File);
+
+	FString Csv = FDualSenseUsageSnapshot::CsvHeader;
+	for (int32 ControllerId = 0; ControllerId < FDualSenseIOThread::MaxDevices; ++ControllerId)
+	{
+		if (OnlyControllerId != INDEX_NONE && ControllerId != OnlyControllerId)
+			continue;
+
+		FDualSenseUsageSnapshot Usage;
+		Usage.Capture(IOThread->GetUsageCounters(ControllerId));
+		Usage.Subtract(UsageBaselines[ControllerId]);
+		if (Usage.Reports == 0)
+			continue;
+
+		Usage.Log(Ar, ControllerId);
+		if (bWriteFile)
+		{
+			Usage.AppendCsv(Csv, ControllerId);
+		}
+	}
+
+	if (bWriteFile)
+	{
+		if (FFileHelper::SaveStringToFile(Csv, *File))
+		{
+			Ar.Logf(TEXT("DualSense Usage Saved [%s]"), *File);
+		}
+		else
+		{
+			UE_LOG(LogWinDualSense, Warning, TEXT("Can't Write DualSense Usage [%s]"), *File);
+		}
+	}
+	return true;
+}
+
+bool FWinDualSenseDevice::ExecDebug(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	bDebugInputs = !bDebugInputs;
+	Ar.Logf(TEXT("DualSense Debug Inputs [%s]"), bDebugInputs ? TEXT("ON") : TEXT("OFF"));
+	return true;
+}
+
+bool FWinDualSenseDevice::ExecScope(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	//DUALSENSE SCOPE Controller=0 Window=2 : live plot in its own window, reports are only copied for it while it is open
+	int32 ControllerId = 0;
+	float WindowSeconds = 2.f;
+	FParse::Value(Cmd, TEXT("Controller="), ControllerId);
+	FParse::Value(Cmd, TEXT("Window="), WindowSeconds);
+
+	if (ControllerId < 0 || ControllerId >= FDualSenseIOThread::MaxDevices || !FSlateApplication::IsInitialized())
+	{
+		Ar.Logf(TEXT("DualSense Scope Can't Open [%d]"), ControllerId);
+		return true;
+	}
+
+	TSharedPtr<FDualSenseScopeBuffer, ESPMode::ThreadSafe>& Buffer = ScopeBuffers[ControllerId];
+	if (!Buffer.IsValid())
+	{
+		Buffer = MakeShared<FDualSenseScopeBuffer, ESPMode::ThreadSafe>();
+		IOThread->SetScopeBuffer(ControllerId, Buffer.Get());
+	}
+
+	TSharedRef<SWindow> Window = SNew(SWindow)
+		.Title(FText::FromString(FString::Printf(TEXT("DualSense Scope [%d]"), ControllerId)))
+		.ClientSize(FVector2D(900.f, 640.f))
+		.SupportsMaximize(true)
+		.SupportsMinimize(true)
+		[
+			SNew(SDualSenseScope)
+			.Buffer(Buffer)
+			.WindowSeconds(WindowSeconds)
+		];
+	FSlateApplication::Get().AddWindow(Window);
+
+	Ar.Logf(TEXT("DualSense Scope [%d] | Window [%.1f s]"), ControllerId, WindowSeconds);
+	return true;
+}
+
+bool FWinDualSenseDevice::ExecRemap(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	//DUALSENSE REMAP Controller=0 CROSS=CIRCLE BUMPER_LEFT<>BUMPER_RIGHT -MIC (no operation = identity)
+	int32 ControllerId = 0;
+	FParse::Value(Cmd, TEXT("Controller="), ControllerId);
+	ControllerId = FMath::Clamp(ControllerId, 0, FDualSenseIOThread::MaxDevices - 1);
+
+	FString Mapping;
+	FString Token;
+	while (FParse::Token(Cmd, Token, false))
+	{
+		if (!Token.StartsWith(TEXT("Controller="), ESearchCase::IgnoreCase))
+		{
+			Mapping += Token + TEXT(" ");
+		}
+	}
+
+	FDualSenseButtonRemap Remap;
+	if (!Remap.Compile(*Mapping))
+	{
+		Ar.Logf(TEXT("DualSense [%d] Remap Not Changed"), ControllerId);
+		return true;
+	}
+
+	SetButtonRemap(ControllerId, Remap);
+	for (int32 Index = 0; Index < FDualSenseButtonRemap::ButtonCount; ++Index)
+	{
+		if (Remap.DestinationMasks[Index] != 1u << Index)
+		{
+			Ar.Logf(TEXT("DualSense [%d] %s -> 0x%05X"), ControllerId, FDualSenseButtonRemap::GetButtonName((EDualSenseButtonType)Index), Remap.DestinationMasks[Index]);
+		}
+	}
+	return true;
+}
+
+bool FWinDualSenseDevice::ExecGesture(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	TArray<FDualSenseGesturePattern> Patterns = GesturePatterns;
+	bool bChanged = false;
+
+	//DUALSENSE GESTURE ADD Key=DualSense_DoubleCross Type=MultiTap Buttons=CROSS Taps=2 Window=0.25
+	if (FParse::Command(&Cmd, TEXT("ADD")))
+	{
+		FDualSenseGesturePattern& Pattern = Patterns.AddDefaulted_GetRef();
+
+		FString Key;
+		FString Type;
+		FString ButtonNames;
+		FParse::Value(Cmd, TEXT("Key="), Key);
+		FParse::Value(Cmd, TEXT("Type="), Type);
+		FParse::Value(Cmd, TEXT("Buttons="), ButtonNames);
+		FParse::Value(Cmd, TEXT("Hold="), Pattern.HoldTime);
+		FParse::Value(Cmd, TEXT("Taps="), Pattern.TapCount);
+
+		Pattern.Key = *Key;
+		Pattern.Type = Type == TEXT("Chord") ? EDualSenseGestureType::Chord : (Type == TEXT("MultiTap") ? EDualSenseGestureType::MultiTap : EDualSenseGestureType::LongPress);
+		FParse::Value(Cmd, TEXT("Window="), Pattern.Type == EDualSenseGestureType::Chord ? Pattern.ChordWindow : Pattern.TapWindow);
+
+		TArray<FString> Names;
+		ButtonNames.ParseIntoArray(Names, TEXT("+"));
+		for (const FString& Name : Names)
+		{
+			const uint32 ButtonMask = DualSenseReport::GetButtonMask(FDualSenseButtonRemap::FindButton(Name));
+			if (ButtonMask == 0)
+			{
+				Ar.Logf(TEXT("Unknown DualSense Button [%s]"), *Name);
+				return true;
+			}
+			Pattern.Buttons |= ButtonMask;
+		}
+
+		if (Key.IsEmpty() || Pattern.Buttons == 0 || (Pattern.Type == EDualSenseGestureType::MultiTap && FMath::CountBits(Pattern.Buttons) != 1))
+		{
+			Ar.Logf(TEXT("DualSense Gesture Needs A Key And Buttons (MultiTap : exactly one button)"));
+			return true;
+		}
+		bChanged = true;
+	}
+	else if (FParse::Command(&Cmd, TEXT("CLEAR")))
+	{
+		Patterns.Reset();
+		bChanged = true;
+	}
+
+	if (bChanged && !SetGesturePatterns(Patterns))
+	{
+		return true;
+	}
+
+	for (const FDualSenseGesturePattern& Pattern : GesturePatterns)
+	{
+		static const TCHAR* TypeNames[] = { TEXT("LongPress"), TEXT("MultiTap"), TEXT("Chord") };
+		Ar.Logf(TEXT("DualSense Gesture [%s] | %s | Buttons [0x%05X] | Hold [%.2f] | Taps [%d] | Tap Window [%.2f] | Chord Window [%.2f]"),
+			*Pattern.Key.ToString(), TypeNames[(int32)Pattern.Type], Pattern.Buttons, Pattern.HoldTime, Pattern.TapCount, Pattern.TapWindow, Pattern.ChordWindow);
+	}
+	LogDroppedGestures(Ar);
+	return true;
+}
+
+bool FWinDualSenseDevice::ExecMotion(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	FDualSenseMotionGestureSettings Settings = MotionGestureSettings;
+	FParse::Bool(Cmd, TEXT("Enable="), Settings.bEnabled);
+	FParse::Bool(Cmd, TEXT("Shake="), Settings.bShake);
+	FParse::Bool(Cmd, TEXT("Tap="), Settings.bTap);
+	FParse::Bool(Cmd, TEXT("Flick="), Settings.bFlick);
+	FParse::Bool(Cmd, TEXT("Snap="), Settings.bSnap);
+	FParse::Value(Cmd, TEXT("ShakeAccel="), Settings.ShakeAcceleration);
+	FParse::Value(Cmd, TEXT("ShakeReversals="), Settings.ShakeReversals);
+	FParse::Value(Cmd, TEXT("TapAccel="), Settings.TapAcceleration);
+	FParse::Value(Cmd, TEXT("TapTime="), Settings.TapTime);
+	FParse::Value(Cmd, TEXT("FlickSpeed="), Settings.FlickSpeed);
+	FParse::Value(Cmd, TEXT("FlickAngle="), Settings.FlickAngle);
+	FParse::Value(Cmd, TEXT("SnapAngle="), Settings.SnapAngle);
+	FParse::Value(Cmd, TEXT("Cooldown="), Settings.Cooldown);
+	SetMotionGestureSettings(Settings);
+
+	Ar.Logf(TEXT("DualSense Motion Gestures [%s] | Shake [%s, %.1f g x %d] | Tap [%s, %.2f g, %.3f s] | Flick [%s, %.0f deg/s, %.0f deg] | Snap [%s, %.0f deg] | Cooldown [%.2f s]"),
+		Settings.bEnabled ? TEXT("ON") : TEXT("OFF"), Settings.bShake ? TEXT("ON") : TEXT("OFF"), Settings.ShakeAcceleration, Settings.ShakeReversals,
+		Settings.bTap ? TEXT("ON") : TEXT("OFF"), Settings.TapAcceleration, Settings.TapTime, Settings.bFlick ? TEXT("ON") : TEXT("OFF"), Settings.FlickSpeed, Settings.FlickAngle,
+		Settings.bSnap ? TEXT("ON") : TEXT("OFF"), Settings.SnapAngle, Settings.Cooldown);
+	LogDroppedGestures(Ar);
+	return true;
+}
+
+void FWinDualSenseDevice::LogDroppedGestures(FOutputDevice& Ar) const
+{
+	for (int32 ControllerId = 0; ControllerId < FDualSenseIOThread::MaxDevices; ++ControllerId)
+	{
+		const uint64 DroppedGestures = IOThread->GetUsageCounters(ControllerId).DroppedGestures.load(std::memory_order_relaxed);
+		if (DroppedGestures == 0)
+			continue;
+
+		Ar.Logf(TEXT("DualSense [%d] Dropped Gesture Events [%llu] (queue of %u shared with motion gestures)"), ControllerId, DroppedGestures, FDualSenseIOThread::GestureQueueSize);
+	}
+}
+
+bool FWinDualSenseDevice::ExecGyro(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	FDualSenseGyroAimSettings& Settings = GyroAimSettings;
+	FParse::Bool(Cmd, TEXT("Enable="), Settings.bEnabled);
+	FParse::Value(Cmd, TEXT("MinSensitivity="), Settings.MinSensitivity);
+	FParse::Value(Cmd, TEXT("MaxSensitivity="), Settings.MaxSensitivity);
+	FParse::Value(Cmd, TEXT("MinSpeed="), Settings.MinSensitivitySpeed);
+	FParse::Value(Cmd, TEXT("MaxSpeed="), Settings.MaxSensitivitySpeed);
+	FParse::Value(Cmd, TEXT("Curve="), Settings.CurveExponent);
+	FParse::Value(Cmd, TEXT("SmoothThreshold="), Settings.SmoothThreshold);
+	FParse::Value(Cmd, TEXT("SmoothTime="), Settings.SmoothTime);
+	FParse::Bool(Cmd, TEXT("InvertYaw="), Settings.bInvertYaw);
+	FParse::Bool(Cmd, TEXT("InvertPitch="), Settings.bInvertPitch);
+
+	//Button index of EDualSenseButtonType, out of range = no ratchet
+	int32 RatchetButton = (int32)Settings.RatchetButton;
+	if (FParse::Value(Cmd, TEXT("Ratchet="), RatchetButton))
+	{
+		Settings.RatchetButton = (RatchetButton >= 0 && RatchetButton < (int32)EDualSenseButtonType::MAX_COUNT) ? (EDualSenseButtonType)RatchetButton : EDualSenseButtonType::MAX_COUNT;
+	}
+
+	for (TUniquePtr<FDualSenseController>& Controller : Controllers)
+	{
+		if (Controller)
+		{
+			Controller->Motion.AimSettings = Settings;
+		}
+	}
+
+	Ar.Logf(TEXT("DualSense Gyro Aim [%s] | Sensitivity [%.2f - %.2f] over [%.1f - %.1f] deg/s | Curve [%.2f] | Smooth [%.1f deg/s, %.3f s] | Ratchet [%d]"),
+		Settings.bEnabled ? TEXT("ON") : TEXT("OFF"), Settings.MinSensitivity, Settings.MaxSensitivity, Settings.MinSensitivitySpeed, Settings.MaxSensitivitySpeed,
+		Settings.CurveExponent, Settings.SmoothThreshold, Settings.SmoothTime, (int32)Settings.RatchetButton);
+	return true;
+}
+
+bool FWinDualSenseDevice::ExecPointer(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	FDualSenseTouchPointerSettings& Settings = TouchPointerSettings;
+	FParse::Bool(Cmd, TEXT("Enable="), Settings.bEnabled);
+	FParse::Value(Cmd, TEXT("MinSensitivity="), Settings.MinSensitivity);
+	FParse::Value(Cmd, TEXT("MaxSensitivity="), Settings.MaxSensitivity);
+	FParse::Value(Cmd, TEXT("MinSpeed="), Settings.MinSensitivitySpeed);
+	FParse::Value(Cmd, TEXT("MaxSpeed="), Settings.MaxSensitivitySpeed);
+	FParse::Value(Cmd, TEXT("Curve="), Settings.CurveExponent);
+	FParse::Bool(Cmd, TEXT("Tap="), Settings.bTapToClick);
+	FParse::Value(Cmd, TEXT("TapTime="), Settings.TapTime);
+	FParse::Value(Cmd, TEXT("TapDistance="), Settings.TapDistance);
+
+	for (TUniquePtr<FDualSenseController>& Controller : Controllers)
+	{
+		if (Controller)
+		{
+			Controller->TouchPointer.Settings = Settings;
+		}
+	}
+
+	Ar.Logf(TEXT("DualSense Touch Pointer [%s] | Sensitivity [%.2f - %.2f] px/count over [%.0f - %.0f] counts/s | Curve [%.2f] | Tap [%s, %.3f s, %.0f counts]"),
+		Settings.bEnabled ? TEXT("ON") : TEXT("OFF"), Settings.MinSensitivity, Settings.MaxSensitivity, Settings.MinSensitivitySpeed, Settings.MaxSensitivitySpeed,
+		Settings.CurveExponent, Settings.bTapToClick ? TEXT("ON") : TEXT("OFF"), Settings.TapTime, Settings.TapDistance);
+	return true;
+}
+
+bool FWinDualSenseDevice::ExecDrift(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	if (FParse::Bool(Cmd, TEXT("Adaptive="), bAdaptiveDeadZones))
+	{
+		for (TUniquePtr<FDualSenseController>& Controller : Controllers)
+		{
+			if (Controller && Controller->bConnected)
+			{
+				ApplyDeadZones(*Controller);
+			}
+		}
+	}
+
+	Ar.Logf(TEXT("DualSense Adaptive Dead Zones [%s]"), bAdaptiveDeadZones ? TEXT("ON") : TEXT("OFF"));
+	for (const TUniquePtr<FDualSenseController>& Controller : Controllers)
+	{
+		if (!Controller || !Controller->bConnected)
+			continue;
+
+		const FDualSenseStickDrift* Sticks[] = { &Controller->Drift.LeftStick, &Controller->Drift.RightStick };
+		for (int32 Stick = 0; Stick < 2; ++Stick)
+		{
+			const FDualSenseStickDrift& Drift = *Sticks[Stick];
+			Ar.Logf(TEXT("DualSense [%d] %s Stick | Drift [%.3f] | Center [%.2f, %.2f] | Noise [%.2f] | Dead Zone [%.3f] | Idle Reports [%u] %s"), Controller->ControllerId,
+				Stick == 0 ? TEXT("Left ") : TEXT("Right"), Drift.GetDriftRatio(), Drift.Center.X, Drift.Center.Y, Drift.Noise, Drift.DeadZoneRatio, Drift.IdleSamples,
+				Drift.bIsValid ? TEXT("") : TEXT("[LEARNING]"));
+		}
+	}
+	return true;
+}
+
+bool FWinDualSenseDevice::ExecLatch(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	FDualSenseLatchSettings& Settings = LatchSettings;
+	FParse::Bool(Cmd, TEXT("Enable="), Settings.bEnabled);
+	FParse::Value(Cmd, TEXT("MaxWait="), Settings.MaxWaitMicroseconds);
+	FParse::Value(Cmd, TEXT("FrameShare="), Settings.MaxFrameShare);
+	FParse::Value(Cmd, TEXT("Jitter="), Settings.JitterMicroseconds);
+
+	Ar.Logf(TEXT("DualSense Late Latch [%s] | Max Wait [%.0f us] | Frame Share [%.2f] | Jitter [%.0f us] | Budget [%.1f us]"),
+		Settings.bEnabled ? TEXT("ON") : TEXT("OFF"), Settings.MaxWaitMicroseconds, Settings.MaxFrameShare, Settings.JitterMicroseconds,
+		DualSenseLatch::GetWaitBudget(Settings, FramePacing));
+	return true;
+}
+
+bool FWinDualSenseDevice::ExecStream(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	//DUALSENSE STREAM SEND Host=192.168.0.10 Port=7765 Controller=0 Redundancy=1
+	if (FParse::Command(&Cmd, TEXT("SEND")))
+	{
+		FString Host = TEXT("127.0.0.1");
+		int32 Port = DualSenseStream::DefaultPort;
+		int32 ControllerId = 0;
+		int32 Redundancy = 1;
+		FParse::Value(Cmd, TEXT("Host="), Host);
+		FParse::Value(Cmd, TEXT("Port="), Port);
+		FParse::Value(Cmd, TEXT("Controller="), ControllerId);
+		FParse::Value(Cmd, TEXT("Redundancy="), Redundancy);
+
+		TUniquePtr<FDualSenseStreamClient> Client = MakeUnique<FDualSenseStreamClient>();
+		if (!Client->Connect(Host, Port))
+		{
+			Ar.Logf(TEXT("DualSense Stream Not Started"));
+			return true;
+		}
+
+		Client->Encoder.Redundancy = FMath::Clamp(Redundancy, 0, DualSenseStream::MaxRedundancy);
+		StreamControllerId = FMath::Clamp(ControllerId, 0, FDualSenseIOThread::MaxDevices - 1);
+
+		//Sent from the read thread as each report is decoded, the socket never costs the game thread
+		StopCallback(StreamCallbackId);
+		StreamClient = MoveTemp(Client);
+		FDualSenseStreamClient* Target = StreamClient.Get();
+		const int32 StreamedControllerId = StreamControllerId;
+		StreamCallbackId = RegisterInputCallback(EDualSenseCallbackTrigger::EveryReport, 0, [Target, StreamedControllerId](const FDualSenseCallbackContext& Context)
+		{
+			if (Context.ControllerId == StreamedControllerId)
+			{
+				Target->Send(Context.Report);
+			}
+		});
+		Ar.Logf(TEXT("DualSense Stream [%d] -> %s:%d | Redundancy [%d]"), StreamControllerId, *Host, Port, StreamClient->Encoder.Redundancy);
+		return true;
+	}
+
+	//DUALSENSE STREAM HOST Port=7765 Slot=15
+	if (FParse::Command(&Cmd, TEXT("HOST")))
+	{
+		int32 Port = DualSenseStream::DefaultPort;
+		int32 Slot = FDualSenseIOThread::MaxDevices - 1;
+		FParse::Value(Cmd, TEXT("Port="), Port);
+		FParse::Value(Cmd, TEXT("Slot="), Slot);
+
+		StreamHost.Reset();
+		TUniquePtr<FDualSenseStreamHost> Host = MakeUnique<FDualSenseStreamHost>(*IOThread, FMath::Clamp(Slot, 0, FDualSenseIOThread::MaxDevices - 1));
+		if (!Host->Start(Port))
+		{
+			Ar.Logf(TEXT("DualSense Stream Host Not Started"));
+			return true;
+		}
+
+		StreamHost = MoveTemp(Host);
+		Ar.Logf(TEXT("DualSense Stream Host | Port [%d] -> Controller [%d]"), Port, StreamHost->GetSlot());
+		return true;
+	}
+
+	if (FParse::Command(&Cmd, TEXT("STOP")))
+	{
+		StopCallback(StreamCallbackId);
+		StreamClient.Reset();
+		StreamHost.Reset();
+		return true;
+	}
+
+	if (StreamClient)
+	{
+		//Client counters are written by the read thread
+		const FDualSenseStreamEncoder& Encoder = StreamClient->Encoder;
+		Ar.Logf(TEXT("DualSense Stream Client | Reports [%llu] | Bytes [%llu] | Key Frames [%llu] | Requested [%llu] | Ack Timeouts [%llu]"), StreamClient->SentReports.load(), StreamClient->SentBytes.load(),
+			Encoder.KeyFrames.load(), Encoder.KeyFrameRequests.load(), Encoder.AckTimeouts.load());
+	}
+	if (StreamHost)
+	{
+		//Decoder counters are written by the host thread, close enough for a console readout
+		const FDualSenseStreamDecoder& Decoder = StreamHost->Decoder;
+		Ar.Logf(TEXT("DualSense Stream Host | Reports [%llu] | Bytes [%llu] | Recovered [%llu] | Undecodable [%llu] | Stale [%llu] | Malformed [%llu]"), StreamHost->ReceivedReports.load(), StreamHost->ReceivedBytes.load(),
+			Decoder.RecoveredPackets, Decoder.UndecodablePackets, Decoder.StalePackets, Decoder.MalformedDatagrams);
+	}
+	return true;
+}
+
+bool FWinDualSenseDevice::ExecRecord(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	//DUALSENSE RECORD STOP File=Path.dsession (default Saved/DualSense/Sessions)
+	if (FParse::Command(&Cmd, TEXT("STOP")))
+	{
+		if (!Recording)
+		{
+			Ar.Logf(TEXT("DualSense Not Recording"));
+			return true;
+		}
+
+		//The read thread is done with the session once its callback is gone
+		StopCallback(RecordingCallbackId);
+
+		//Whatever the controller learned while it was recorded
+		if (const TUniquePtr<FDualSenseController>& Controller = Controllers[RecordingControllerId])
+		{
+			Recording->Calibration = Controller->Calibration;
+			Recording->Calibration.GyroBias = Controller->Motion.GyroBias;
+		}
+
+		FString File = FDualSenseSession::MakeFileName();
+		FParse::Value(Cmd, TEXT("File="), File);
+		if (Recording->Save(File))
+		{
+			Ar.Logf(TEXT("DualSense Session Saved [%s] | Reports [%d] | Past The Cap [%llu]"), *File, Recording->Reports.Num(), RecordingOverflow.load());
+		}
+		Recording.Reset();
+		return true;
+	}
+
+	//DUALSENSE RECORD Controller=0 Seconds=300
+	int32 ControllerId = 0;
+	float Seconds = 300.f;
+	FParse::Value(Cmd, TEXT("Controller="), ControllerId);
+	FParse::Value(Cmd, TEXT("Seconds="), Seconds);
+	RecordingControllerId = FMath::Clamp(ControllerId, 0, FDualSenseIOThread::MaxDevices - 1);
+
+	//Capped and reserved up front, the read thread appends without ever growing the array
+	StopCallback(RecordingCallbackId);
+	Recording = MakeUnique<FDualSenseSession>();
+	Recording->Reports.Reserve(FMath::Clamp(FMath::CeilToInt(Seconds * MaxReportRate), 1, MaxRecordedReports));
+	RecordingOverflow.store(0);
+
+	FDualSenseSession* Target = Recording.Get();
+	std::atomic<uint64>* Overflow = &RecordingOverflow;
+	const int32 RecordedControllerId = RecordingControllerId;
+	RecordingCallbackId = RegisterInputCallback(EDualSenseCallbackTrigger::EveryReport, 0, [Target, Overflow, RecordedControllerId](const FDualSenseCallbackContext& Context)
+	{
+		if (Context.ControllerId != RecordedControllerId)
+			return;
+
+		if (Target->Reports.Num() < Target->Reports.Max())
+		{
+			Target->Reports.Add(Context.Report);
+		}
+		else
+		{
+			Overflow->fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+	Ar.Logf(TEXT("DualSense Recording [%d] | Up To [%d] Reports"), RecordingControllerId, Recording->Reports.Max());
+	return true;
+}
+
+bool FWinDualSenseDevice::ExecExport(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	//DUALSENSE EXPORT In=Path.dsession Out=Path.dscol (default next to the session)
+	FString InFile;
+	if (!FParse::Value(Cmd, TEXT("In="), InFile))
+	{
+		Ar.Logf(TEXT("DualSense Export Needs In=<Session File>"));
+		return true;
+	}
+
+	FString OutFile = FPaths::ChangeExtension(InFile, TEXT("dscol"));
+	FParse::Value(Cmd, TEXT("Out="), OutFile);
+
+	FDualSenseSession Session;
+	if (Session.Load(InFile))
+	{
+		DualSenseColumnar::Export(Session, OutFile);
+	}
+	return true;
+}
+
+bool FWinDualSenseDevice::ExecShare(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	if (FParse::Command(&Cmd, TEXT("STOP")))
+	{
+		StopSharedState();
+		Ar.Logf(TEXT("DualSense Shared State Stopped"));
+		return true;
+	}
+
+	FString Name = DualSenseShared::DefaultName;
+	FParse::Value(Cmd, TEXT("Name="), Name);
+	if (StartSharedState(Name))
+	{
+		Ar.Logf(TEXT("DualSense Shared State Published [%s]"), *Name);
+	}
+	return true;
+}
+
+bool FWinDualSenseDevice::ExecBench(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	return DualSenseBenchmark::Exec(Cmd, Ar);
+}
+
+void FWinDualSenseDevice::SetChannelValue(int32 ControllerId, FForceFeedbackChannelType ChannelType, float Value)
+{
+	//Left motor is the large one, right the small one
+	const bool bRight = ChannelType == FForceFeedbackChannelType::LEFT_SMALL || ChannelType == FForceFeedbackChannelType::RIGHT_SMALL;
+	EnqueueOutputCommand(FDualSenseOutputCommand::MakeRumble(ControllerId, bRight, (uint8)(FMath::Clamp(Value, 0.f, 1.f) * 255.f)));
+}
+
+void FWinDualSenseDevice::SetChannelValues(int32 ControllerId, const FForceFeedbackValues& values)
+{
+	const float LeftValue = FMath::Max(values.LeftLarge, values.RightLarge);
+	const float RightValue = FMath::Max(values.LeftSmall, values.RightSmall);
+	EnqueueOutputCommand(FDualSenseOutputCommand::MakeRumble(ControllerId, (uint8)(FMath::Clamp(LeftValue, 0.f, 1.f) * 255.f), (uint8)(FMath::Clamp(RightValue, 0.f, 1.f) * 255.f)));
+}
+
+bool FWinDualSenseDevice::SupportsForceFeedback(int32 ControllerId)
+{
+	//UE_LOG(LogWinDualSense, Warning, TEXT("SupportsForceFeedback"));
+	return true;
+}
+
+void FWinDualSenseDevice::SetLightColor(int32 ControllerId, FColor Color)
+{
+	EnqueueOutputCommand(FDualSenseOutputCommand::MakeLightBar(ControllerId, Color));
+}
+
+void FWinDualSenseDevice::ResetLightColor(int32 ControllerId)
+{
+	EnqueueOutputCommand(FDualSenseOutputCommand::MakeLightBar(ControllerId, DualSenseOutput::DefaultLightColor));
+}
+
+void FWinDualSenseDevice::SetDeviceProperty(int32 ControllerId, const FInputDeviceProperty* Property)
+{
+	//UE_LOG(LogWinDualSense, Warning, TEXT("SetDeviceProperty"));
+}
+
+class IHapticDevice* FWinDualSenseDevice::GetHapticDevice()
+{
+	//UE_LOG(LogWinDualSense, Warning, TEXT("GetHapticDevice"));
+	return nullptr;
+}
+
+bool FWinDualSenseDevice::IsGamepadAttached() const
+{
+	for (const TUniquePtr<FDualSenseController>& Controller : Controllers)
+	{
+		if (Controller && Controller->bConnected)
+			return true;
+	}
+	return false;
+}
+
+const FDualSenseInputHistory* FWinDualSenseDevice::GetInputHistory(int32 ControllerId) const
+{
+	return Controllers[ControllerId] ? &Controllers[ControllerId]->History : nullptr;
+}
+
+const FDualSenseDriftEstimate* FWinDualSenseDevice::GetStickDrift(int32 ControllerId) const
+{
+	return Controllers[ControllerId] ? &Controllers[ControllerId]->Drift : nullptr;
+}
+
+bool FWinDualSenseDevice::ConsumeFixedStep(int32 ControllerId, FDualSenseResampleCursor& Cursor, FDualSenseResampledStep& OutStep) const
+{
+	return Controllers[ControllerId] && Controllers[ControllerId]->Resampler.ConsumeStep(Cursor, OutStep);
+}
+
+double FWinDualSenseDevice::GetInputAge(int32 ControllerId) const
+{
+	return Controllers[ControllerId] ? Controllers[ControllerId]->LatchStats.LastAge : -1.0;
+}
+
+FDualSenseController& FWinDualSenseDevice::GetController(int32 ControllerId)
+{
+	TUniquePtr<FDualSenseController>& Controller = Controllers[ControllerId];
+	if (!Controller)
+	{
+		Controller = MakeUnique<FDualSenseController>();
+		Controller->ControllerId = ControllerId;
+		ZeroMemory(&Controller->outState, sizeof(DS5W::DS5OutputState));
+		Controller->outState.lightbar.r = DualSenseOutput::DefaultLightColor.R;
+		Controller->outState.lightbar.g = DualSenseOutput::DefaultLightColor.G;
+		Controller->outState.lightbar.b = DualSenseOutput::DefaultLightColor.B;
+	}
+	return *Controller;
+}
+
+void FWinDualSenseDevice::UpdateConnection(FDualSenseController& Controller)
+{
+	switch (IOThread->GetSlotState(Controller.ControllerId))
+	{
+	case EDualSenseSlotState::Connected:
+		if (!Controller.bConnected)
+		{
+			//Initialize In/Out State Buffer
+			ZeroMemory(&Controller.inState, sizeof(DS5W::DS5InputState));
+			//Output state set while disconnected goes out with the first report
+			Controller.bOutputDirty = true;
+			Controller.ReportStats.Reset();
+			Controller.LastReportCycles = 0;
+			Controller.ButtonMask = 0;
+			Controller.History.Reset();
+			Controller.Resampler.Reset();
+			Controller.LatchStats.Reset();
+			Controller.ReplayedEdges = 0;
+			Controller.SubFrameTaps = 0;
+			Controller.Drift = FDualSenseDriftEstimate();
+			Bank.ResetLane(Controller.ControllerId);
+
+			BindInputs(Controller);
+
+			Controller.Motion.Reset();
+			Controller.Motion.GyroBias = FVector::ZeroVector;
+			Controller.Motion.AimSettings = GyroAimSettings;
+
+			Controller.TouchPointer.Reset();
+			Controller.TouchPointer.Settings = TouchPointerSettings;
+
+			//Nominal until the cached calibration of this pad shows up
+			Controller.Calibration = FDualSenseCalibration();
+			Controller.bCalibrationDirty = false;
+			Controller.DevicePath = IOThread->GetDevicePath(Controller.ControllerId);
+			if (!Controller.DevicePath.IsEmpty())
+			{
+				Controller.PendingCalibration = DualSenseCalibration::LoadAsync(Controller.DevicePath);
+			}
+
+			Controller.bConnected = true;
+
+			if (SharedState)
+			{
+				SharedState->SetConnected(Controller.ControllerId, true);
+			}
+		}
+		break;
+	case EDualSenseSlotState::Lost:
+		if (Controller.bConnected)
+		{
+			UE_LOG(LogWinDualSense, Log, TEXT("DualSense Controller Disconnected [%d]"), Controller.ControllerId);
+			ReleaseInputs(Controller);
+			SaveCalibration(Controller, true);
+			Controller.bConnected = false;
+
+			if (SharedState)
+			{
+				SharedState->SetConnected(Controller.ControllerId, false);
+			}
+		}
+		IOThread->ReleaseSlot(Controller.ControllerId);
+		break;
+
+	case EDualSenseSlotState::Free:
+	default:
+		break;
+	}
+}
+
+void FWinDualSenseDevice::UpdateReports(FDualSenseController& Controller)
+{
+	DUALSENSE_TRACE_SCOPE(Read);
+
+	FDualSenseReportStats& ReportStats = Controller.ReportStats;
+	bool bHasNewReport = false;
+	int32 QueuedReports = 0;
+	const uint32 PointerButtons = GetPointerButtons(Controller);
+	const uint32 TouchpadMask = DualSenseReport::GetButtonMask(EDualSenseButtonType::TOUCHPAD);
+
+	FDualSenseInputReport Report;
+	while (IOThread->DequeueReport(Controller.ControllerId, Report))
+	{
+		++QueuedReports;
+		const bool bHadReport = ReportStats.bHasLastReport;
+		const uint32 LastSensorTimestamp = ReportStats.LastSensorTimestamp;
+
+		if (ReportStats.AddReport(Report.Sequence, Report.SensorTimestamp))
+		{
+			const float DeltaTime = bHadReport ? (float)((double)(Report.SensorTimestamp - LastSensorTimestamp) / DualSenseReport::SensorTicksPerSecond) : 0.f;
+			Controller.bCalibrationDirty |= Controller.Calibrator.AddSample(Report.State, Report.Buttons, Controller.Motion.IsAtRest(), DeltaTime, Controller.Calibration);
+
+			Controller.inState = Report.State;
+			Controller.LastReportCycles = Report.ReceiveCycles;
+			Controller.ButtonMask = Report.Buttons;
+			if (PointerButtons != 0)
+			{
+				//A touchpad press is a click in pointer mode : repacked without it, so another button driving the same destination still counts
+				const uint32 Buttons = DualSenseReport::PackButtons(Report.State) & ~TouchpadMask;
+				const FDualSenseButtonRemap* Remap = ButtonRemaps[Controller.ControllerId].Get();
+				Controller.ButtonMask = Remap ? Remap->Apply(Buttons) : Buttons;
+			}
+			Controller.Motion.AddSample(Report);
+			Controller.TouchPointer.AddSample(Report);
+			Bank.SetMotion(Controller.ControllerId, Report, Controller.Motion.GyroBias);
+			Controller.Resampler.AddSample(Report.SensorTimestamp, FDualSenseResampleSample::Make(Report, Controller.Calibration, Controller.Motion.GyroBias));
+			bHasNewReport = true;
+		}
+	}
+
+	if (DUALSENSE_TRACE_IS_ENABLED())
+	{
+		TraceCounters.ReportQueueDepth = FMath::Max(TraceCounters.ReportQueueDepth, QueuedReports);
+	}
+
+	//Nothing arrived this frame, count the reports the controller should have sent by now
+	if (!bHasNewReport && Controller.LastReportCycles != 0 && ReportStats.IntervalMean > 0.0)
+	{
+		const double MicrosecondsSinceReport = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - Controller.LastReportCycles) * 1000.0;
+		ReportStats.SetMissedReports(FMath::FloorToInt(MicrosecondsSinceReport / ReportStats.IntervalMean));
+	}
+}
+
+void FWinDualSenseDevice::UpdateDrift(FDualSenseController& Controller)
+{
+	bool bHasEstimate = false;
+	while (IOThread->DequeueDriftEstimate(Controller.ControllerId, Controller.Drift))
+	{
+		bHasEstimate = true;
+	}
+
+	if (!bHasEstimate)
+		return;
+
+	//Recentered from the next frame on, and cached with the rest of the calibration
+	if (Controller.Drift.LeftStick.bIsValid)
+	{
+		Controller.Calibration.LeftStickCenter = Controller.Drift.LeftStick.Center;
+		Controller.bCalibrationDirty = true;
+	}
+	if (Controller.Drift.RightStick.bIsValid)
+	{
+		Controller.Calibration.RightStickCenter = Controller.Drift.RightStick.Center;
+		Controller.bCalibrationDirty = true;
+	}
+
+	ApplyDeadZones(Controller);
+}
+
+void FWinDualSenseDevice::ApplyDeadZones(FDualSenseController& Controller)
+{
+	for (FDualSenseAnalogBinding& Binding : Controller.Analogs)
+	{
+		const FDualSenseStickDrift* Drift = nullptr;
+		switch (Binding.Type)
+		{
+		case EDualSenseAnalogType::LEFT_STICK_X:
+		case EDualSenseAnalogType::LEFT_STICK_Y:
+			Drift = &Controller.Drift.LeftStick;
+			break;
+		case EDualSenseAnalogType::RIGHT_STICK_X:
+		case EDualSenseAnalogType::RIGHT_STICK_Y:
+			Drift = &Controller.Drift.RightStick;
+			break;
+		default:
+			break;
+		}
+
+		if (!Drift)
+			continue;
+
+		Binding.Data.UpdateDeadZoneRatio(bAdaptiveDeadZones && Drift->bIsValid ? Drift->DeadZoneRatio : Analogs.FindChecked(Binding.Type).DeadZoneRatio);
+	}
+}
+
+void FWinDualSenseDevice::LatchReports(int32 LaneCount)
+{
+	const double WaitBudget = DualSenseLatch::GetWaitBudget(LatchSettings, FramePacing);
+	if (WaitBudget <= 0.0)
+		return;
+
+	DUALSENSE_TRACE_SCOPE(Latch);
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	uint32 AwaitedSlots = 0;
+	double LatestArrival = 0.0;
+
+	for (int32 ControllerId = 0; ControllerId < LaneCount; ++ControllerId)
+	{
+		const FDualSenseController* Controller = Controllers[ControllerId].Get();
+		if (!Controller || !Controller->bConnected || Controller->LastReportCycles == 0 || Controller->ReportStats.IsStalled())
+			continue;
+
+		//IntervalMean is measured on the sensor clock, which runs at the rate reports arrive
+		const double ReportInterval = Controller->ReportStats.IntervalMean;
+		const double TimeToNextReport = DualSenseLatch::GetTimeToNextReport(Controller->LastReportCycles, ReportInterval, StartCycles);
+		if (DualSenseLatch::ShouldWait(LatchSettings, TimeToNextReport, ReportInterval, WaitBudget))
+		{
+			AwaitedSlots |= 1u << ControllerId;
+			LatestArrival = FMath::Max(LatestArrival, TimeToNextReport);
+		}
+	}
+
+	if (AwaitedSlots == 0)
+		return;
+
+	//Until every awaited report is queued, the latest predicted arrival (plus jitter) or the budget, whichever comes first
+	const uint64 DeadlineCycles = StartCycles + DualSenseLatch::MicrosecondsToCycles(FMath::Min(WaitBudget, LatestArrival + LatchSettings.JitterMicroseconds));
+	const uint32 PendingSlots = IOThread->WaitForReports(AwaitedSlots, DeadlineCycles);
+
+	const uint64 EndCycles = FPlatformTime::Cycles64();
+	const double WaitTime = DualSenseLatch::CyclesToMicroseconds(EndCycles - StartCycles);
+	const double Overshoot = EndCycles > DeadlineCycles ? DualSenseLatch::CyclesToMicroseconds(EndCycles - DeadlineCycles) : 0.0;
+	for (uint32 Slots = AwaitedSlots; Slots != 0; Slots &= Slots - 1)
+	{
+		const int32 ControllerId = (int32)FMath::CountTrailingZeros(Slots);
+		FDualSenseController& Controller = *Controllers[ControllerId];
+		Controller.LatchStats.AddWait(WaitTime, (PendingSlots & (1u << ControllerId)) == 0, Overshoot);
+		UpdateReports(Controller);
+	}
+}
+
+void FWinDualSenseDevice::UpdateCalibration(FDualSenseController& Controller)
+{
+	if (!Controller.PendingCalibration.IsValid() || !Controller.PendingCalibration.IsReady())
+		return;
+
+	const TOptional<FDualSenseCalibration> Cached = Controller.PendingCalibration.Get();
+	Controller.PendingCalibration.Reset();
+
+	if (!Cached.IsSet())
+		return;
+
+	//The pad ran on live estimates until the file showed up, what they learned since connecting is newer than the file
+	FDualSenseCalibration Merged = Cached.GetValue();
+	const FDualSenseCalibration& Live = Controller.Calibration;
+
+	if (Controller.Drift.LeftStick.bIsValid)
+	{
+		Merged.LeftStickCenter = Live.LeftStickCenter;
+	}
+	if (Controller.Drift.RightStick.bIsValid)
+	{
+		Merged.RightStickCenter = Live.RightStickCenter;
+	}
+
+	//Rest averages are weighted by the rest time behind each side
+	if (Live.RestSeconds > 0.f)
+	{
+		const float LiveWeight = Live.RestSeconds / (Live.RestSeconds + Merged.RestSeconds);
+		Merged.GyroBias = FMath::Lerp(Merged.GyroBias, Controller.Motion.GyroBias, LiveWeight);
+		Merged.TriggerRest = FMath::Lerp(Merged.TriggerRest, Live.TriggerRest, LiveWeight);
+		Merged.RestSeconds += Live.RestSeconds;
+	}
+	Merged.TriggerMax.X = FMath::Max(Merged.TriggerMax.X, Live.TriggerMax.X);
+	Merged.TriggerMax.Y = FMath::Max(Merged.TriggerMax.Y, Live.TriggerMax.Y);
+
+	Controller.Calibration = Merged;
+	Controller.Motion.GyroBias = Merged.GyroBias;
+	UE_LOG(LogWinDualSense, Log, TEXT("DualSense Calibration Loaded [%d] | Rest [%.1f s]"), Controller.ControllerId, Controller.Calibration.RestSeconds);
+}
+
+void FWinDualSenseDevice::SaveCalibration(FDualSenseController& Controller, bool bAsync)
+{
+	//Only pads with a path, and only once they taught us something
+	if (Controller.DevicePath.IsEmpty() || !Controller.bCalibrationDirty)
+		return;
+
+	Controller.Calibration.GyroBias = Controller.Motion.GyroBias;
+	if (bAsync)
+	{
+		DualSenseCalibration::SaveAsync(Controller.DevicePath, Controller.Calibration);
+	}
+	else
+	{
+		DualSenseCalibration::Save(Controller.DevicePath, Controller.Calibration);
+	}
+	Controller.bCalibrationDirty = false;
+}
+
+void FWinDualSenseDevice::UpdateInputs(FDualSenseController& Controller)
+{
+	DUALSENSE_TRACE_SCOPE(Dispatch);
+
+	UpdateButtons(Controller);
+	UpdateGestures(Controller);
+	UpdateCallbacks(Controller);
+	UpdateAnalogs(Controller);
+	UpdateVectors(Controller);
+	UpdatePointer(Controller);
+
+	if (bDebugInputs)
+	{
+		DEBUG_Inputs(Controller);
+	}
+}
+
+void FWinDualSenseDevice::UpdateButtons(FDualSenseController& Controller)
+{
+	DUALSENSE_TRACE_SCOPE(UpdateButtons);
+
+	const uint32 ReplayedButtons = ReplayButtonEdges(Controller);
+
+	//Edges are the bank's diff against the previous frame, held buttons repeat.
+	//Stalled controllers have no buttons in the bank, everything gets released instead of repeating the last state
+	const int32 ControllerId = Controller.ControllerId;
+	const uint32 ButtonMask = Bank.Buttons[ControllerId];
+	const uint32 PressedButtons = Bank.PressedButtons[ControllerId];
+	const uint32 ReleasedButtons = Bank.ReleasedButtons[ControllerId];
+	const uint32 ActiveButtons = ButtonMask | ReleasedButtons;
+
+	//Nothing down and nothing let go, no binding has anything to send
+	if (ActiveButtons == 0)
+		return;
+
+	for (FDualSenseButtonBinding& Binding : Controller.Buttons)
+	{
+		if ((ActiveButtons & Binding.Mask) == 0)
+			continue;
+
+		FDualSenseButtonData& ButtonData = Binding.Data;
+		const bool bIsPressed = (ButtonMask & Binding.Mask) != 0;
+
+		//Already dispatched by the replay, and it ended where the frame's state is
+		if ((ReplayedButtons & Binding.Mask) != 0 && ButtonData.bIsPressed == bIsPressed)
+			continue;
+
+		ButtonData.UpdateButtonState(bIsPressed);
+
+		if ((PressedButtons & Binding.Mask) != 0)
+		{
+			MessageHandler->OnControllerButtonPressed(Binding.KeyName, ControllerId, false);
+		}
+		else if ((ReleasedButtons & Binding.Mask) != 0)
+		{
+			MessageHandler->OnControllerButtonReleased(Binding.KeyName, ControllerId, false);
+		}
+		else
+		{
+			MessageHandler->OnControllerButtonPressed(Binding.KeyName, ControllerId, true);
+		}
+	}
+}
+
+uint32 FWinDualSenseDevice::ReplayButtonEdges(FDualSenseController& Controller)
+{
+	const FDualSenseReportStats& ReportStats = Controller.ReportStats;
+	if (!ReportStats.bHasLastReport)
+		return 0;
+
+	uint32 ReplayedButtons = 0;
+	uint32 PressedButtons = 0;
+	//Edges are latched before the pointer sees the report, its touchpad press is not a button
+	const uint32 IgnoredButtons = GetPointerButtons(Controller);
+
+	//Only the edges of reports already read, later ones belong to the next frame's state
+	FDualSenseButtonEdge Edge;
+	while (IOThread->DequeueButtonEdge(Controller.ControllerId, ReportStats.LastSensorTimestamp, Edge))
+	{
+		Edge.PressedButtons &= ~IgnoredButtons;
+		Edge.ReleasedButtons &= ~IgnoredButtons;
+		for (FDualSenseButtonBinding& Binding : Controller.Buttons)
+		{
+			FDualSenseButtonData& ButtonData = Binding.Data;
+			const bool bIsDown = ButtonData.ButtonState == EDualSenseButtonState::PRESS || ButtonData.ButtonState == EDualSenseButtonState::REPEAT;
+
+			if ((Edge.PressedButtons & Binding.Mask) != 0 && !bIsDown)
+			{
+				ButtonData.UpdateButtonState(true);
+				MessageHandler->OnControllerButtonPressed(Binding.KeyName, Controller.ControllerId, false);
+				PressedButtons |= Binding.Mask;
+			}
+			else if ((Edge.ReleasedButtons & Binding.Mask) != 0 && bIsDown)
+			{
+				ButtonData.UpdateButtonState(false);
+				MessageHandler->OnControllerButtonReleased(Binding.KeyName, Controller.ControllerId, false);
+				Controller.SubFrameTaps += (PressedButtons & Binding.Mask) != 0 ? 1 : 0;
+			}
+			else
+			{
+				continue;
+			}
+
+			ReplayedButtons |= Binding.Mask;
+			++Controller.ReplayedEdges;
+		}
+	}
+	return ReplayedButtons;
+}
+
+uint32 FWinDualSenseDevice::GetPointerButtons(const FDualSenseController& Controller) const
+{
+	if (!Controller.TouchPointer.Settings.bEnabled)
+		return 0;
+
+	const int32 Touchpad = (int32)EDualSenseButtonType::TOUCHPAD;
+	const FDualSenseButtonRemap* Remap = ButtonRemaps[Controller.ControllerId].Get();
+	return Remap ? Remap->DestinationMasks[Touchpad] : DualSenseReport::GetButtonMask(EDualSenseButtonType::TOUCHPAD);
+}
+
+void FWinDualSenseDevice::UpdateAnalogs(FDualSenseController& Controller)
+{
+	DUALSENSE_TRACE_SCOPE(UpdateAnalogs);
+
+	//Calibrated and clamped by the bank, a stalled controller reads 0
+	for (FDualSenseAnalogBinding& Binding : Controller.Analogs)
+	{
+		FDualSenseAnalogData& AnalogData = Binding.Data;
+		AnalogData.UpdateAnalogState(Bank.GetAnalog(Binding.Type, Controller.ControllerId));
+
+		MessageHandler->OnControllerAnalog(Binding.KeyName, Controller.ControllerId, AnalogData.Ratio);
+	}
+}
+
+void FWinDualSenseDevice::UpdateVectors(FDualSenseController& Controller)
+{
+	DUALSENSE_TRACE_SCOPE(UpdateVectors);
+
+	const FDualSenseMotion& Motion = Controller.Motion;
+
+	for (FDualSenseVectorBinding& Binding : Controller.Vectors)
+	{
+		FDualSenseVectorData& VectorData = Binding.Data;
+
+		switch (Binding.Type)
+		{
+		case EDualSenseVectorType::GYROSCOPE:
+			VectorData.UpdateVectorState(Bank.GetAngularVelocity(Controller.ControllerId));
+			break;
+		case EDualSenseVectorType::ACCELERATION:
+			VectorData.UpdateVectorState(Bank.GetAcceleration(Controller.ControllerId));
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (Controller.ReportStats.IsStalled())
+		return;
+
+	//Tilt (Pitch, 0, Roll) from the gravity direction, rotation rate in rad/s, both accelerations in g
+	const FVector& Gravity = Motion.GetGravity();
+	const FVector Tilt(FMath::Atan2(Gravity.Z, FVector2D(Gravity.X, Gravity.Y).Size()), 0.f, FMath::Atan2(Gravity.X, Gravity.Y));
+	const FVector RotationRate = Motion.GetAngularVelocity() * (PI / 180.f);
+	MessageHandler->OnMotionDetected(Tilt, RotationRate, Gravity, Motion.GetAcceleration() - Gravity, Controller.ControllerId);
+
+	//Gyro aim, already integrated at report rate
+	const FIntPoint AimDelta = Controller.Motion.ConsumeAimDelta();
+	if (AimDelta != FIntPoint::ZeroValue)
+	{
+		MessageHandler->OnRawMouseMove(AimDelta.X, AimDelta.Y);
+	}
+}
+
+void FWinDualSenseDevice::UpdatePointer(FDualSenseController& Controller)
+{
+	//Integrated and clicked at report rate, the frame only applies what piled up
+	const FIntPoint Delta = Controller.TouchPointer.ConsumeDelta();
+	EDualSensePointerClick Clicks[FDualSenseTouchPointer::MaxPendingClicks];
+	const int32 ClickCount = Controller.TouchPointer.ConsumeClicks(Clicks);
+
+	if ((Delta == FIntPoint::ZeroValue && ClickCount == 0) || !FSlateApplication::IsInitialized())
+		return;
+
+	FSlateApplication& SlateApplication = FSlateApplication::Get();
+	const TSharedPtr<ICursor> Cursor = SlateApplication.GetPlatformCursor();
+	if (!Cursor.IsValid())
+		return;
+
+	if (Delta != FIntPoint::ZeroValue)
+	{
+		const FVector2D Position = Cursor->GetPosition();
+		Cursor->SetPosition(FMath::TruncToInt(Position.X) + Delta.X, FMath::TruncToInt(Position.Y) + Delta.Y);
+		MessageHandler->OnMouseMove();
+	}
+
+	const FVector2D CursorPosition = Cursor->GetPosition();
+	const TSharedPtr<SWindow> ActiveWindow = SlateApplication.GetActiveTopLevelWindow();
+	const TSharedPtr<FGenericWindow> NativeWindow = ActiveWindow.IsValid() ? ActiveWindow->GetNativeWindow() : nullptr;
+	for (int32 Index = 0; Index < ClickCount; ++Index)
+	{
+		switch (Clicks[Index])
+		{
+		case EDualSensePointerClick::LeftDown:
+			MessageHandler->OnMouseDown(NativeWindow, EMouseButtons::Left, CursorPosition);
+			break;
+		case EDualSensePointerClick::LeftUp:
+			MessageHandler->OnMouseUp(EMouseButtons::Left, CursorPosition);
+			break;
+		case EDualSensePointerClick::RightDown:
+			MessageHandler->OnMouseDown(NativeWindow, EMouseButtons::Right, CursorPosition);
+			break;
+		case EDualSensePointerClick::RightUp:
+			MessageHandler->OnMouseUp(EMouseButtons::Right, CursorPosition);
+			break;
+		}
+	}
+}
+
+void FWinDualSenseDevice::UpdateGestures(FDualSenseController& Controller)
+{
+	//Already matched at report rate, only dispatched here
+	FDualSenseGestureEvent Event;
+	while (IOThread->DequeueGestureEvent(Controller.ControllerId, Event))
+	{
+		MessageHandler->OnControllerButtonPressed(Event.Key, Controller.ControllerId, false);
+		MessageHandler->OnControllerButtonReleased(Event.Key, Controller.ControllerId, false);
+	}
+}
+
+void FWinDualSenseDevice::UpdateCallbacks(FDualSenseController& Controller)
+{
+	FDualSenseCallbackEvent Event;
+	while (IOThread->DequeueCallbackEvent(Controller.ControllerId, Event))
+	{
+		//Events of an unregistered callback may still be queued
+		const FDualSenseInputCallback* Callback = FindInputCallback(Event.CallbackId);
+		if (Callback && Callback->OnEvent)
+		{
+			Callback->OnEvent(Controller.ControllerId, Event);
+		}
+	}
+}
+
+void FWinDualSenseDevice::CaptureHistory(FDualSenseController& Controller, uint64 Frame)
+{
+	uint32 Buttons = 0;
+	for (const FDualSenseButtonBinding& Binding : Controller.Buttons)
+	{
+		Buttons |= Binding.Data.bIsPressed ? Binding.Mask : 0;
+	}
+
+	FVector2D LeftStick = FVector2D::ZeroVector;
+	FVector2D RightStick = FVector2D::ZeroVector;
+	float Triggers[2] = { 0.f, 0.f };
+	for (const FDualSenseAnalogBinding& Binding : Controller.Analogs)
+	{
+		switch (Binding.Type)
+		{
+		case EDualSenseAnalogType::LEFT_STICK_X:
+			LeftStick.X = Binding.Data.Ratio;
+			break;
+		case EDualSenseAnalogType::LEFT_STICK_Y:
+			LeftStick.Y = Binding.Data.Ratio;
+			break;
+		case EDualSenseAnalogType::RIGHT_STICK_X:
+			RightStick.X = Binding.Data.Ratio;
+			break;
+		case EDualSenseAnalogType::RIGHT_STICK_Y:
+			RightStick.Y = Binding.Data.Ratio;
+			break;
+		case EDualSenseAnalogType::LEFT_TRIGGER:
+			Triggers[0] = Binding.Data.Ratio;
+			break;
+		case EDualSenseAnalogType::RIGHT_TRIGGER:
+			Triggers[1] = Binding.Data.Ratio;
+			break;
+		default:
+			break;
+		}
+	}
+
+	Controller.History.Capture(Frame, FDualSenseInputSnapshot::Make(Buttons, LeftStick, RightStick, Triggers[0], Triggers[1]));
+}
+
+void FWinDualSenseDevice::ReleaseInputs(FDualSenseController& Controller)
+{
+	for (FDualSenseButtonBinding& Binding : Controller.Buttons)
+	{
+		FDualSenseButtonData& ButtonData = Binding.Data;
+		if (ButtonData.ButtonState == EDualSenseButtonState::PRESS || ButtonData.ButtonState == EDualSenseButtonState::REPEAT)
+		{
+			MessageHandler->OnControllerButtonReleased(Binding.KeyName, Controller.ControllerId, false);
+		}
+		ButtonData.ButtonState = EDualSenseButtonState::NONE;
+		ButtonData.bIsPressed = false;
+	}
+
+	for (FDualSenseAnalogBinding& Binding : Controller.Analogs)
+	{
+		FDualSenseAnalogData& AnalogData = Binding.Data;
+		if (AnalogData.Ratio != 0.f)
+		{
+			AnalogData.UpdateAnalogState(0.f);
+			MessageHandler->OnControllerAnalog(Binding.KeyName, Controller.ControllerId, AnalogData.Ratio);
+		}
+	}
+}
+
+void FWinDualSenseDevice::InitDefaultBindings()
+{
+	bHasDefaultBindings = true;
+
 	//////////////////////////////////////////////////////////////////////////
 	// Buttons
 	//////////////////////////////////////////////////////////////////////////
@@ -53,246 +1497,211 @@ FWinDualSenseDevice::FWinDualSenseDevice(const TSharedRef< FGenericApplicationMe
 	//////////////////////////////////////////////////////////////////////////
 	Vectors.Add(EDualSenseVectorType::GYROSCOPE, FDualSenseVectorData(EKeys::Tilt));
 	Vectors.Add(EDualSenseVectorType::ACCELERATION, FDualSenseVectorData(EKeys::Acceleration));
-
-	//Initialize In/Out State Buffer
-	ZeroMemory(&inState, sizeof(DS5W::DS5InputState));
-	ZeroMemory(&outState, sizeof(DS5W::DS5OutputState));
-}
-
-FWinDualSenseDevice::~FWinDualSenseDevice()
-{
-	UE_LOG(LogWinDualSense, Warning, TEXT("~FWinDualSense"));
 }
 
-void FWinDualSenseDevice::Tick(float DeltaTime)
+void FWinDualSenseDevice::BindInputs(FDualSenseController& Controller)
 {
+	if (!bHasDefaultBindings)
+	{
+		InitDefaultBindings();
+	}
 
-}
-
-void FWinDualSenseDevice::SendControllerEvents()
-{
-	// Get input state
-	if (DS5W_SUCCESS(DS5W::getDeviceInputState(&DualSenseController, &inState))) {
-		UpdateInputs();
-		UpdateOutputs();
+	//Reset keeps the capacity, so a reconnect does not allocate again
+	Controller.Buttons.Reset(Buttons.Num());
+	for (const TPair<EDualSenseButtonType, FDualSenseButtonData>& ButtonIterator : Buttons)
+	{
+		Controller.Buttons.Add({ ButtonIterator.Key, DualSenseReport::GetButtonMask(ButtonIterator.Key), ButtonIterator.Value.Key.GetFName(), ButtonIterator.Value });
 	}
-	else {
-		DS5W::enumDevices(infos, 16, &controllersCount);
-		DS5W::initDeviceContext(&infos[0], &DualSenseController);
-		DS5W::reconnectDevice(&DualSenseController);
+
+	Controller.Analogs.Reset(Analogs.Num());
+	for (const TPair<EDualSenseAnalogType, FDualSenseAnalogData>& AnalogIterator : Analogs)
+	{
+		Controller.Analogs.Add({ AnalogIterator.Key, AnalogIterator.Value.Key.GetFName(), AnalogIterator.Value });
 	}
-}
 
-void FWinDualSenseDevice::SetMessageHandler(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler)
-{
-	//UE_LOG(LogWinDualSense, Warning, TEXT("SetMessageHandler"));
-	MessageHandler = InMessageHandler;
+	Controller.Vectors.Reset(Vectors.Num());
+	for (const TPair<EDualSenseVectorType, FDualSenseVectorData>& VectorIterator : Vectors)
+	{
+		Controller.Vectors.Add({ VectorIterator.Key, VectorIterator.Value });
+	}
 }
 
-bool FWinDualSenseDevice::Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar)
+void FWinDualSenseDevice::SetButtonRemap(int32 ControllerId, const FDualSenseButtonRemap& Remap)
 {
-	UE_LOG(LogWinDualSense, Warning, TEXT("Exec"));
-	return true;
+	TUniquePtr<FDualSenseButtonRemap> PublishedRemap = MakeUnique<FDualSenseButtonRemap>(Remap);
+	IOThread->SetButtonRemap(ControllerId, PublishedRemap.Get());
+	RetiredObjects.Retire(MoveTemp(ButtonRemaps[ControllerId]), IOThread->AdvanceEpoch());
+	ButtonRemaps[ControllerId] = MoveTemp(PublishedRemap);
 }
 
-void FWinDualSenseDevice::SetChannelValue(int32 ControllerId, FForceFeedbackChannelType ChannelType, float Value)
+bool FWinDualSenseDevice::SetGesturePatterns(const TArray<FDualSenseGesturePattern>& Patterns)
 {
-	//UE_LOG(LogWinDualSense, Warning, TEXT("SetChannelValue"));
-}
+	TUniquePtr<FDualSenseGestureSet> Set = MakeUnique<FDualSenseGestureSet>();
+	if (!Set->Compile(Patterns))
+	{
+		UE_LOG(LogWinDualSense, Warning, TEXT("Can't Compile DualSense Gestures [%d Patterns]"), Patterns.Num());
+		return false;
+	}
 
-void FWinDualSenseDevice::SetChannelValues(int32 ControllerId, const FForceFeedbackValues& values)
-{
-	//UE_LOG(LogWinDualSense, Warning, TEXT("SetChannelValues"));
-}
+	for (const FDualSenseGesturePattern& Pattern : Patterns)
+	{
+		const FKey Key(Pattern.Key);
+		if (!EKeys::GetKeyDetails(Key).IsValid())
+		{
+			EKeys::AddKey(FKeyDetails(Key, FText::FromName(Pattern.Key), FKeyDetails::GamepadKey));
+		}
+	}
 
-bool FWinDualSenseDevice::SupportsForceFeedback(int32 ControllerId)
-{
-	//UE_LOG(LogWinDualSense, Warning, TEXT("SupportsForceFeedback"));
+	GesturePatterns = Patterns;
+	if (Patterns.Num() == 0)
+	{
+		Set.Reset();
+	}
+	IOThread->SetGestureSet(Set.Get());
+	RetiredObjects.Retire(MoveTemp(PublishedGestureSet), IOThread->AdvanceEpoch());
+	PublishedGestureSet = MoveTemp(Set);
 	return true;
 }
 
-void FWinDualSenseDevice::SetLightColor(int32 ControllerId, FColor Color)
+void FWinDualSenseDevice::SetMotionGestureSettings(const FDualSenseMotionGestureSettings& Settings)
 {
-	//UE_LOG(LogWinDualSense, Warning, TEXT("SetLightColor"));
-}
+	if (Settings.bEnabled)
+	{
+		for (int32 Gesture = 0; Gesture < (int32)EDualSenseMotionGesture::MAX_COUNT; ++Gesture)
+		{
+			const FName& KeyName = DualSenseMotionGesture::GetKey((EDualSenseMotionGesture)Gesture);
+			const FKey Key(KeyName);
+			if (!EKeys::GetKeyDetails(Key).IsValid())
+			{
+				EKeys::AddKey(FKeyDetails(Key, FText::FromName(KeyName), FKeyDetails::GamepadKey));
+			}
+		}
+	}
 
-void FWinDualSenseDevice::ResetLightColor(int32 ControllerId)
-{
-	//UE_LOG(LogWinDualSense, Warning, TEXT("ResetLightColor"));
+	MotionGestureSettings = Settings;
+	TUniquePtr<FDualSenseMotionGestureSettings> Published = Settings.bEnabled ? MakeUnique<FDualSenseMotionGestureSettings>(Settings) : nullptr;
+	IOThread->SetMotionGestureSettings(Published.Get());
+	RetiredObjects.Retire(MoveTemp(PublishedMotionGestureSettings), IOThread->AdvanceEpoch());
+	PublishedMotionGestureSettings = MoveTemp(Published);
 }
 
-void FWinDualSenseDevice::SetDeviceProperty(int32 ControllerId, const FInputDeviceProperty* Property)
+int32 FWinDualSenseDevice::RegisterInputCallback(EDualSenseCallbackTrigger Trigger, uint32 Buttons, FDualSenseCallbackFunction Function, FDualSenseCallbackEventHandler OnEvent)
 {
-	//UE_LOG(LogWinDualSense, Warning, TEXT("SetDeviceProperty"));
+	check(Function);
+
+	TUniquePtr<FDualSenseInputCallback> Callback = MakeUnique<FDualSenseInputCallback>();
+	Callback->Id = NextCallbackId++;
+	Callback->Trigger = Trigger;
+	Callback->Buttons = Buttons;
+	Callback->Function = MoveTemp(Function);
+	Callback->OnEvent = MoveTemp(OnEvent);
+
+	const int32 CallbackId = Callback->Id;
+	InputCallbacks.Add(MoveTemp(Callback));
+	PublishCallbacks();
+	return CallbackId;
 }
 
-class IHapticDevice* FWinDualSenseDevice::GetHapticDevice()
+void FWinDualSenseDevice::UnregisterInputCallback(int32 CallbackId)
 {
-	//UE_LOG(LogWinDualSense, Warning, TEXT("GetHapticDevice"));
-	return nullptr;
+	const int32 Index = InputCallbacks.IndexOfByPredicate([CallbackId](const TUniquePtr<FDualSenseInputCallback>& Callback) { return Callback->Id == CallbackId; });
+	if (Index == INDEX_NONE)
+		return;
+
+	//The set that still runs it is retired with the same epoch
+	TUniquePtr<FDualSenseInputCallback> Callback = MoveTemp(InputCallbacks[Index]);
+	InputCallbacks.RemoveAt(Index);
+	RetiredObjects.Retire(MoveTemp(Callback), PublishCallbacks());
 }
 
-bool FWinDualSenseDevice::IsGamepadAttached() const
+const FDualSenseInputCallback* FWinDualSenseDevice::FindInputCallback(int32 CallbackId) const
 {
-	return true;
+	//Few callbacks, in id order
+	for (const TUniquePtr<FDualSenseInputCallback>& Callback : InputCallbacks)
+	{
+		if (Callback->Id == CallbackId)
+		{
+			return Callback.Get();
+		}
+	}
+	return nullptr;
 }
 
-void FWinDualSenseDevice::UpdateInputs()
+bool FWinDualSenseDevice::StartSharedState(const FString& Name)
 {
-	UpdateButtons();
-	UpdateAnalogs();
-	UpdateVectors();
-	//DEBUG_Inputs();
-}
+	StopSharedState();
 
-void FWinDualSenseDevice::UpdateButtons()
-{
-	for (TPair<EDualSenseButtonType, FDualSenseButtonData>& ButtonIterator : Buttons)
+	TUniquePtr<FDualSenseSharedStateWriter> Writer = MakeUnique<FDualSenseSharedStateWriter>();
+	if (!Writer->Open(Name))
 	{
-		FDualSenseButtonData& ButtonData = ButtonIterator.Value;
-
-		switch (ButtonIterator.Key)
-		{
-		case EDualSenseButtonType::TRIANGLE:
-			ButtonData.UpdateButtonState(inState.buttonsAndDpad & DS5W_ISTATE_BTX_TRIANGLE);
-			break;
-		case EDualSenseButtonType::CROSS:
-			ButtonData.UpdateButtonState(inState.buttonsAndDpad & DS5W_ISTATE_BTX_CROSS);
-			break;
-		case EDualSenseButtonType::SQUARE:
-			ButtonData.UpdateButtonState(inState.buttonsAndDpad & DS5W_ISTATE_BTX_SQUARE);
-			break;
-		case EDualSenseButtonType::CIRCLE:
-			ButtonData.UpdateButtonState(inState.buttonsAndDpad & DS5W_ISTATE_BTX_CIRCLE);
-			break;
-		case EDualSenseButtonType::DPAD_UP:
-			ButtonData.UpdateButtonState(inState.buttonsAndDpad & DS5W_ISTATE_DPAD_UP);
-			break;
-		case EDualSenseButtonType::DPAD_DOWN:
-			ButtonData.UpdateButtonState(inState.buttonsAndDpad & DS5W_ISTATE_DPAD_DOWN);
-			break;
-		case EDualSenseButtonType::DPAD_LEFT:
-			ButtonData.UpdateButtonState(inState.buttonsAndDpad & DS5W_ISTATE_DPAD_LEFT);
-			break;
-		case EDualSenseButtonType::DPAD_RIGHT:
-			ButtonData.UpdateButtonState(inState.buttonsAndDpad & DS5W_ISTATE_DPAD_RIGHT);
-			break;
-		case EDualSenseButtonType::BUMPER_LEFT:
-			ButtonData.UpdateButtonState(inState.buttonsA & DS5W_ISTATE_BTN_A_LEFT_BUMPER);
-			break;
-		case EDualSenseButtonType::BUMPER_RIGHT:
-			ButtonData.UpdateButtonState(inState.buttonsA & DS5W_ISTATE_BTN_A_RIGHT_BUMPER);
-			break;
-		case EDualSenseButtonType::TRIGGER_LEFT:
-			ButtonData.UpdateButtonState(inState.buttonsA & DS5W_ISTATE_BTN_A_LEFT_TRIGGER);
-			break;
-		case EDualSenseButtonType::TRIGGER_RIGHT:
-			ButtonData.UpdateButtonState(inState.buttonsA & DS5W_ISTATE_BTN_A_RIGHT_TRIGGER);
-			break;
-		case EDualSenseButtonType::LEFT_STICK_PUSH:
-			ButtonData.UpdateButtonState(inState.buttonsA & DS5W_ISTATE_BTN_A_LEFT_STICK);
-			break;
-		case EDualSenseButtonType::RIGHT_STICK_PUSH:
-			ButtonData.UpdateButtonState(inState.buttonsA & DS5W_ISTATE_BTN_A_RIGHT_STICK);
-			break;
-		case EDualSenseButtonType::SELECT:
-			ButtonData.UpdateButtonState(inState.buttonsA & DS5W_ISTATE_BTN_A_SELECT);
-			break;
-		case EDualSenseButtonType::MENU:
-			ButtonData.UpdateButtonState(inState.buttonsA & DS5W_ISTATE_BTN_A_MENU);
-			break;
-		case EDualSenseButtonType::PLAYSTATION_LOGO:
-			ButtonData.UpdateButtonState(inState.buttonsB & DS5W_ISTATE_BTN_B_PLAYSTATION_LOGO);
-			break;
-		case EDualSenseButtonType::TOUCHPAD:
-			ButtonData.UpdateButtonState(inState.buttonsB & DS5W_ISTATE_BTN_B_PAD_BUTTON);
-			break;
-		case EDualSenseButtonType::MIC:
-			ButtonData.UpdateButtonState(inState.buttonsB & DS5W_ISTATE_BTN_B_MIC_BUTTON);
-			break;
+		return false;
+	}
 
-		case EDualSenseButtonType::MAX_COUNT:
-		default:
-			break;
-		}
+	SharedState = MoveTemp(Writer);
 
-		switch (ButtonData.ButtonState)
+	for (const TUniquePtr<FDualSenseController>& Controller : Controllers)
+	{
+		if (Controller && Controller->bConnected)
 		{
-		case EDualSenseButtonState::PRESS:
-			MessageHandler->OnControllerButtonPressed(ButtonData.Key.GetFName(), 0, false);
-			break;
-		case EDualSenseButtonState::REPEAT:
-			MessageHandler->OnControllerButtonPressed(ButtonData.Key.GetFName(), 0, true);
-			break;
-		case EDualSenseButtonState::RELEASE:
-			MessageHandler->OnControllerButtonReleased(ButtonData.Key.GetFName(), 0, false);
-			break;
-
-		case EDualSenseButtonState::NONE:
-		default:
-			break;
+			SharedState->SetConnected(Controller->ControllerId, true);
 		}
 	}
+
+	//Published where the report is decoded, the game thread is never involved
+	FDualSenseSharedStateWriter* Target = SharedState.Get();
+	SharedStateCallbackId = RegisterInputCallback(EDualSenseCallbackTrigger::EveryReport, 0, [Target](const FDualSenseCallbackContext& Context)
+	{
+		Target->Publish(Context.ControllerId, Context.Report);
+	});
+	return true;
 }
 
-void FWinDualSenseDevice::UpdateAnalogs()
+void FWinDualSenseDevice::StopSharedState()
 {
-	for (TPair<EDualSenseAnalogType, FDualSenseAnalogData>& AnalogIterator : Analogs)
-	{
-		FDualSenseAnalogData& AnalogData = AnalogIterator.Value;
+	if (!SharedState)
+		return;
 
-		switch (AnalogIterator.Key)
-		{
-		case EDualSenseAnalogType::LEFT_STICK_X:
-			AnalogData.UpdateAnalogState(UKismetMathLibrary::MapRangeClamped(static_cast<float>((int)inState.leftStick.x), -128.f, 127.f, -1.f, 1.f));
-			break;
-		case EDualSenseAnalogType::LEFT_STICK_Y:
-			AnalogData.UpdateAnalogState(UKismetMathLibrary::MapRangeClamped(static_cast<float>((int)inState.leftStick.y), -128.f, 127.f, -1.f, 1.f));
-			break;
-		case EDualSenseAnalogType::RIGHT_STICK_X:
-			AnalogData.UpdateAnalogState(UKismetMathLibrary::MapRangeClamped(static_cast<float>((int)inState.rightStick.x), -128.f, 127.f, -1.f, 1.f));
-			break;
-		case EDualSenseAnalogType::RIGHT_STICK_Y:
-			AnalogData.UpdateAnalogState(UKismetMathLibrary::MapRangeClamped(static_cast<float>((int)inState.rightStick.y), -128.f, 127.f, -1.f, 1.f));
-			break;
-		case EDualSenseAnalogType::LEFT_TRIGGER:
-			AnalogData.UpdateAnalogState(UKismetMathLibrary::MapRangeClamped(static_cast<float>((int)inState.leftTrigger), 0.f, 255.f, 0.f, 1.f));
-			break;
-		case EDualSenseAnalogType::RIGHT_TRIGGER:
-			AnalogData.UpdateAnalogState(UKismetMathLibrary::MapRangeClamped(static_cast<float>((int)inState.rightTrigger), 0.f, 255.f, 0.f, 1.f));
-			break;
-		default:
-			break;
-		}
+	//The report in flight may still publish, nothing may touch the region once it is closed
+	StopCallback(SharedStateCallbackId);
 
-		MessageHandler->OnControllerAnalog(AnalogData.Key.GetFName(), 0, AnalogData.Ratio);
-	}
+	//Readers see every controller gone, the name is free for the next writer right away
+	SharedState->Close();
+	SharedState.Reset();
 }
 
-void FWinDualSenseDevice::UpdateVectors()
+void FWinDualSenseDevice::StopCallback(int32& CallbackId)
 {
-	for (TPair<EDualSenseVectorType, FDualSenseVectorData>& VectorIterator : Vectors)
-	{
-		FDualSenseVectorData& VectorData = VectorIterator.Value;
+	if (CallbackId == INDEX_NONE)
+		return;
+
+	UnregisterInputCallback(CallbackId);
+	CallbackId = INDEX_NONE;
+	IOThread->WaitForEpoch(IOThread->AdvanceEpoch());
+}
 
-		switch (VectorIterator.Key)
+uint64 FWinDualSenseDevice::PublishCallbacks()
+{
+	TUniquePtr<FDualSenseCallbackSet> Set;
+	if (InputCallbacks.Num() > 0)
+	{
+		Set = MakeUnique<FDualSenseCallbackSet>();
+		for (const TUniquePtr<FDualSenseInputCallback>& Callback : InputCallbacks)
 		{
-		case EDualSenseVectorType::GYROSCOPE:
-			VectorData.UpdateVectorState(FVector(inState.gyroscope.x, inState.gyroscope.y, inState.gyroscope.z));
-			break;
-		case EDualSenseVectorType::ACCELERATION:
-			VectorData.UpdateVectorState(FVector(inState.accelerometer.x, inState.accelerometer.y, inState.accelerometer.z));
-			break;
-		default:
-			break;
+			Set->Add(Callback.Get());
 		}
-
-		//MessageHandler->OnControllerAnalog(VectorData.Key.GetFName(), 0, AnalogData.Ratio);
 	}
+
+	IOThread->SetCallbackSet(Set.Get());
+	const uint64 Epoch = IOThread->AdvanceEpoch();
+	RetiredObjects.Retire(MoveTemp(PublishedCallbackSet), Epoch);
+	PublishedCallbackSet = MoveTemp(Set);
+	return Epoch;
 }
 
-void FWinDualSenseDevice::DEBUG_Inputs()
+void FWinDualSenseDevice::DEBUG_Inputs(const FDualSenseController& Controller)
 {
+	const DS5W::DS5InputState& inState = Controller.inState;
+
 	//Left Stick Update
 	UE_LOG(LogWinDualSense, Warning, TEXT("Left Stick [X : %d] | [Y : %d] | %s"), (int)inState.leftStick.x, (int)inState.leftStick.y, (inState.buttonsA & DS5W_ISTATE_BTN_A_LEFT_STICK) ? TEXT("[PUSHED!]") : TEXT(""));
 	//Right Stick Update
@@ -353,71 +1762,53 @@ void FWinDualSenseDevice::DEBUG_Inputs()
 
 }
 
-FORCEINLINE void FWinDualSenseDevice::UpdateOutputs()
+void FWinDualSenseDevice::EnqueueOutputCommand(const FDualSenseOutputCommand& Command)
 {
-	//Bluetooth Multifly
-	btMul = DualSenseController._internal.connection == DS5W::DeviceConnection::BT ? 10 : 1;
-
-	//Rumble
-	LeftRumble = max(LeftRumble - 0x200 / btMul, 0);
-	RightRumble = max(RightRumble - 0x100 / btMul, 0);
+	if (Command.ControllerId >= 0 && Command.ControllerId < FDualSenseIOThread::MaxDevices && !OutputCommands.Enqueue(Command))
+	{
+		//The output stage is a whole queue behind, nothing waits for it
+		DroppedOutputCommands.fetch_add(1, std::memory_order_relaxed);
+	}
+}
 
-	outState.leftRumble = (LeftRumble & 0xFF00) >> 8UL;
-	outState.rightRumble = (RightRumble & 0xFF00) >> 8UL;
+void FWinDualSenseDevice::DrainOutputCommands()
+{
+	DUALSENSE_TRACE_SCOPE(OutputEncode);
 
-	//Light Bar
-	/*outState.lightbar = DS5W::color_R8G8B8_UCHAR_A32_FLOAT(255, 0, 0, intensity);
-	intensity -= 0.0025f / btMul;*/
-	if (Intensity_LED <= 0.0f) {
-		Intensity_LED = 1.0f;
+	int32 CommandCount = 0;
+	OutputCommands.Drain([this, &CommandCount](const FDualSenseOutputCommand& Command)
+	{
+		FDualSenseController& Controller = GetController(Command.ControllerId);
+		Controller.bOutputDirty |= Command.Apply(Controller.outState);
+		++CommandCount;
+	});
 
-		LeftRumble = 0xFF00;
-		RightRumble = 0xFF00;
+	if (DUALSENSE_TRACE_IS_ENABLED())
+	{
+		TraceCounters.OutputCommands += CommandCount;
 	}
+}
 
-	//Player LED
-	if (outState.rightRumble) {
-		outState.playerLeds.playerLedFade = true;
-		outState.playerLeds.bitmask = DS5W_OSTATE_PLAYER_LED_MIDDLE;
-		outState.playerLeds.brightness = DS5W::LedBrightness::HIGH;
-	}
-	else {
-		outState.playerLeds.bitmask = 0;
-	}
+FORCEINLINE void FWinDualSenseDevice::UpdateOutputs(FDualSenseController& Controller)
+{
+	//Output reports are blocking writes, only send what changed
+	if (!Controller.bOutputDirty)
+		return;
 
-	//Set Left Adaptive Trigger Force
-	if (inState.leftTrigger == 0xFF) {
-		LeftTriggerEffectType = DS5W::TriggerEffectType::ContinuousResitance;
-	}
-	else if (inState.leftTrigger == 0x00) {
-		LeftTriggerEffectType = DS5W::TriggerEffectType::NoResitance;
-	}
+	DS5W::DeviceContext* DeviceContext = IOThread->GetDeviceContext(Controller.ControllerId);
+	if (!DeviceContext)
+		return;
 
-	//Set Right Adaptive Trigger Force
-	if (inState.rightTrigger == 0xFF) {
-		RightTriggerEffectType = DS5W::TriggerEffectType::ContinuousResitance;
-	}
-	else if (inState.rightTrigger == 0x00) {
-		RightTriggerEffectType = DS5W::TriggerEffectType::NoResitance;
+	{
+		DUALSENSE_TRACE_SCOPE(SetDeviceOutputState);
+		DS5W::setDeviceOutputState(DeviceContext, &Controller.outState);
 	}
+	Controller.bOutputDirty = false;
 
-	// Mic led
-	if (inState.buttonsB & DS5W_ISTATE_BTN_B_MIC_BUTTON) {
-		outState.microphoneLed = DS5W::MicLed::ON;
-	}
-	else if (inState.buttonsB & DS5W_ISTATE_BTN_B_PLAYSTATION_LOGO) {
-		outState.microphoneLed = DS5W::MicLed::OFF;
+	if (DUALSENSE_TRACE_IS_ENABLED())
+	{
+		++TraceCounters.OutputReports;
 	}
-
-	outState.leftTriggerEffect.effectType = LeftTriggerEffectType;
-	outState.leftTriggerEffect.Section.startPosition = 0x00;
-	outState.leftTriggerEffect.Section.endPosition = 0x60;
-
-	outState.rightTriggerEffect.effectType = RightTriggerEffectType;
-	outState.rightTriggerEffect.Continuous.force = 0xFF;
-	outState.rightTriggerEffect.Continuous.startPosition = 0x00;
-
-	DS5W::setDeviceOutputState(&DualSenseController, &outState);
 }
 
 #pragma endregion
\ No newline at end of file
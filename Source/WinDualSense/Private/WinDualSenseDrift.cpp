@@ -0,0 +1,138 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseDrift.h"
+
+namespace
+{
+	//Decoded stick units to the -1..1 range the bank maps them to
+	constexpr float CountsToRatio = 2.f / 255.f;
+
+	//A stick inside this box (per axis) for StillReports reports is resting
+	constexpr int32 StillRange = 8;
+	constexpr uint32 StillReports = 25;
+	//No stick rests further out than this, whatever its wear
+	constexpr int32 MaxRestOffset = 48;
+
+	//Idle reports averaged before older ones fade out (about 4 s of rest at 250 Hz)
+	constexpr float TimeConstantReports = 1000.f;
+	constexpr uint32 MinIdleSamples = 250;
+
+	//Once valid, idle reports this far from the estimate are a thumb holding the stick still, not the stick resting
+	constexpr float MinGate = 8.f;
+	constexpr float GateSigmas = 3.f;
+	//Unless this many rest windows in a row land away from it at the same spot, then the stick's rest moved and it is learned again
+	constexpr uint32 ReacquireWindows = 4;
+
+	//Deadzone = DeadZoneSigmas standard deviations, plus the rounding of the decoded value
+	constexpr float DeadZoneSigmas = 4.f;
+	constexpr float QuantizationMargin = 1.5f;
+	constexpr float MinDeadZoneRatio = 0.02f;
+	constexpr float MaxDeadZoneRatio = 0.3f;
+}
+
+#pragma region Dual Sense [Stick Drift]
+float FDualSenseStickDrift::GetDriftRatio() const
+{
+	return Center.Size() * CountsToRatio;
+}
+
+void FDualSenseDriftEstimator::Reset()
+{
+	MeanX = 0.f;
+	MeanY = 0.f;
+	VarianceX = 0.f;
+	VarianceY = 0.f;
+	IdleSamples = 0;
+
+	RunMinX = RunMaxX = 0;
+	RunMinY = RunMaxY = 0;
+	RunLength = 0;
+	bRunRejected = false;
+
+	RejectedWindows = 0;
+	RejectedX = 0.f;
+	RejectedY = 0.f;
+}
+
+bool FDualSenseDriftEstimator::AddSample(int8 X, int8 Y)
+{
+	const int8 MinX = FMath::Min(RunMinX, X);
+	const int8 MaxX = FMath::Max(RunMaxX, X);
+	const int8 MinY = FMath::Min(RunMinY, Y);
+	const int8 MaxY = FMath::Max(RunMaxY, Y);
+
+	//Moved (or never stopped), a new run starts here
+	if (RunLength == 0 || MaxX - MinX > StillRange || MaxY - MinY > StillRange || FMath::Abs((int32)X) > MaxRestOffset || FMath::Abs((int32)Y) > MaxRestOffset)
+	{
+		RunMinX = RunMaxX = X;
+		RunMinY = RunMaxY = Y;
+		RunLength = 1;
+		bRunRejected = false;
+		return false;
+	}
+
+	RunMinX = MinX;
+	RunMaxX = MaxX;
+	RunMinY = MinY;
+	RunMaxY = MaxY;
+	if (++RunLength < StillReports)
+	{
+		return false;
+	}
+
+	const float DeltaX = X - MeanX;
+	const float DeltaY = Y - MeanY;
+	if (IdleSamples >= MinIdleSamples)
+	{
+		const float Gate = FMath::Max(MinGate, GateSigmas * FMath::Sqrt(FMath::Max(VarianceX, VarianceY)));
+		if (FMath::Abs(DeltaX) > Gate || FMath::Abs(DeltaY) > Gate)
+		{
+			//Counted once per window, the rest of the run is the same hold
+			if (bRunRejected)
+			{
+				return false;
+			}
+			bRunRejected = true;
+
+			if (RejectedWindows > 0 && (FMath::Abs(X - RejectedX) > Gate || FMath::Abs(Y - RejectedY) > Gate))
+			{
+				RejectedWindows = 0;
+			}
+			if (RejectedWindows == 0)
+			{
+				RejectedX = X;
+				RejectedY = Y;
+			}
+			if (++RejectedWindows < ReacquireWindows)
+			{
+				return false;
+			}
+
+			//Learned again from this report on, invalid until MinIdleSamples went in
+			IdleSamples = 0;
+		}
+	}
+	RejectedWindows = 0;
+
+	//Plain average until the window is full, exponentially weighted afterwards
+	++IdleSamples;
+	const float Alpha = FMath::Max(1.f / IdleSamples, 1.f / TimeConstantReports);
+	MeanX += Alpha * DeltaX;
+	MeanY += Alpha * DeltaY;
+	VarianceX = (1.f - Alpha) * (VarianceX + Alpha * DeltaX * DeltaX);
+	VarianceY = (1.f - Alpha) * (VarianceY + Alpha * DeltaY * DeltaY);
+
+	return IdleSamples % PublishInterval == 0;
+}
+
+FDualSenseStickDrift FDualSenseDriftEstimator::GetDrift() const
+{
+	FDualSenseStickDrift Drift;
+	Drift.Center = FVector2D(MeanX, MeanY);
+	Drift.Noise = FMath::Sqrt(FMath::Max(VarianceX, VarianceY));
+	Drift.DeadZoneRatio = FMath::Clamp((DeadZoneSigmas * Drift.Noise + QuantizationMargin) * CountsToRatio, MinDeadZoneRatio, MaxDeadZoneRatio);
+	Drift.IdleSamples = IdleSamples;
+	Drift.bIsValid = IdleSamples >= MinIdleSamples;
+	return Drift;
+}
+#pragma endregion
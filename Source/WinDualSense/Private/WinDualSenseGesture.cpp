@@ -0,0 +1,184 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseGesture.h"
+#include "WinDualSenseReport.h"
+
+namespace
+{
+	//0 is left for detectors that have not seen a set
+	std::atomic<uint32> NextGestureSetSerial{ 1 };
+}
+
+#pragma region Dual Sense [Gesture]
+bool FDualSenseGestureSet::Compile(const TArray<FDualSenseGesturePattern>& InPatterns)
+{
+	Patterns.Reset();
+	Serial = NextGestureSetSerial.fetch_add(1, std::memory_order_relaxed);
+	LongPressButtons = 0;
+	AllButtons = 0;
+
+	if (InPatterns.Num() > MaxPatterns)
+	{
+		return false;
+	}
+
+	for (const FDualSenseGesturePattern& Pattern : InPatterns)
+	{
+		if (Pattern.Buttons == 0 || Pattern.Type >= EDualSenseGestureType::MAX_COUNT)
+		{
+			return false;
+		}
+
+		FCompiledPattern& Compiled = Patterns.AddDefaulted_GetRef();
+		Compiled.Key = Pattern.Key;
+		Compiled.Type = Pattern.Type;
+		Compiled.Buttons = Pattern.Buttons;
+		Compiled.TapCount = FMath::Max(Pattern.TapCount, 1);
+		Compiled.HoldTicks = (uint64)(FMath::Max(Pattern.HoldTime, 0.f) * DualSenseReport::SensorTicksPerSecond);
+		Compiled.TapWindowTicks = (uint64)(FMath::Max(Pattern.TapWindow, 0.f) * DualSenseReport::SensorTicksPerSecond);
+		Compiled.ChordWindowTicks = (uint64)(FMath::Max(Pattern.ChordWindow, 0.f) * DualSenseReport::SensorTicksPerSecond);
+
+		LongPressButtons |= Pattern.Type == EDualSenseGestureType::LongPress ? Pattern.Buttons : 0;
+		AllButtons |= Pattern.Buttons;
+	}
+
+	return true;
+}
+
+void FDualSenseGestureDetector::Reset()
+{
+	bHasTime = false;
+	LastSensorTimestamp = 0;
+	Time = 0;
+
+	LastButtons = 0;
+	FMemory::Memzero(PressTimes);
+	FMemory::Memzero(ReleaseTimes);
+
+	SetSerial = 0;
+	FiredPatterns = 0;
+	FMemory::Memzero(TapCounts);
+}
+
+void FDualSenseGestureDetector::Update(const FDualSenseGestureSet& Set, uint32 Buttons, uint32 SensorTimestamp, TFunctionRef<void(const FDualSenseGestureSet::FCompiledPattern&)> Emit)
+{
+	//Timestamp wraps every ~24 minutes, unsigned deltas keep the clock monotonic
+	Time += bHasTime ? (uint64)(SensorTimestamp - LastSensorTimestamp) : 0;
+	LastSensorTimestamp = SensorTimestamp;
+	bHasTime = true;
+
+	//Republished patterns : bit and tap count Index belonged to another pattern. Button times stay, they are per button
+	if (Set.Serial != SetSerial)
+	{
+		SetSerial = Set.Serial;
+		FiredPatterns = 0;
+		FMemory::Memzero(TapCounts);
+	}
+
+	const uint32 Pressed = Buttons & ~LastButtons;
+	const uint32 Released = ~Buttons & LastButtons;
+	LastButtons = Buttons;
+
+	for (uint32 Mask = Pressed; Mask; Mask &= Mask - 1)
+	{
+		PressTimes[FMath::CountTrailingZeros(Mask)] = Time;
+	}
+	for (uint32 Mask = Released; Mask; Mask &= Mask - 1)
+	{
+		ReleaseTimes[FMath::CountTrailingZeros(Mask)] = Time;
+	}
+
+	//Nothing changed and no hold to time
+	if (((Pressed | Released) & Set.AllButtons) == 0 && (Buttons & Set.LongPressButtons) == 0)
+	{
+		return;
+	}
+
+	for (int32 Index = 0; Index < Set.Patterns.Num(); ++Index)
+	{
+		const FDualSenseGestureSet::FCompiledPattern& Pattern = Set.Patterns[Index];
+		const uint64 PatternBit = 1ull << Index;
+		const bool bIsHeld = (Buttons & Pattern.Buttons) == Pattern.Buttons;
+
+		switch (Pattern.Type)
+		{
+		case EDualSenseGestureType::LongPress:
+			if (!bIsHeld)
+			{
+				FiredPatterns &= ~PatternBit;
+			}
+			else if (!(FiredPatterns & PatternBit))
+			{
+				uint64 Earliest = 0;
+				uint64 Latest = 0;
+				GetPressTimes(Pattern.Buttons, Earliest, Latest);
+
+				if (Time - Latest >= Pattern.HoldTicks)
+				{
+					FiredPatterns |= PatternBit;
+					Emit(Pattern);
+				}
+			}
+			break;
+
+		case EDualSenseGestureType::MultiTap:
+			if (Pressed & Pattern.Buttons)
+			{
+				const int32 ButtonIndex = FMath::CountTrailingZeros(Pattern.Buttons);
+				const bool bContinues = TapCounts[Index] > 0 && Time - ReleaseTimes[ButtonIndex] <= Pattern.TapWindowTicks;
+				TapCounts[Index] = bContinues ? TapCounts[Index] + 1 : 1;
+
+				if (TapCounts[Index] >= Pattern.TapCount)
+				{
+					TapCounts[Index] = 0;
+					Emit(Pattern);
+				}
+			}
+			else if (Released & Pattern.Buttons)
+			{
+				//Held too long to be a tap
+				const int32 ButtonIndex = FMath::CountTrailingZeros(Pattern.Buttons);
+				if (Time - PressTimes[ButtonIndex] > Pattern.TapWindowTicks)
+				{
+					TapCounts[Index] = 0;
+				}
+			}
+			break;
+
+		case EDualSenseGestureType::Chord:
+			if (!bIsHeld)
+			{
+				FiredPatterns &= ~PatternBit;
+			}
+			else if ((Pressed & Pattern.Buttons) && !(FiredPatterns & PatternBit))
+			{
+				uint64 Earliest = 0;
+				uint64 Latest = 0;
+				GetPressTimes(Pattern.Buttons, Earliest, Latest);
+
+				if (Latest - Earliest <= Pattern.ChordWindowTicks)
+				{
+					FiredPatterns |= PatternBit;
+					Emit(Pattern);
+				}
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+void FDualSenseGestureDetector::GetPressTimes(uint32 Mask, uint64& OutEarliest, uint64& OutLatest) const
+{
+	OutEarliest = MAX_uint64;
+	OutLatest = 0;
+	for (; Mask; Mask &= Mask - 1)
+	{
+		const uint64 PressTime = PressTimes[FMath::CountTrailingZeros(Mask)];
+		OutEarliest = FMath::Min(OutEarliest, PressTime);
+		OutLatest = FMath::Max(OutLatest, PressTime);
+	}
+}
+#pragma endregion
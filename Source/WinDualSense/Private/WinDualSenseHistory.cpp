@@ -0,0 +1,108 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseHistory.h"
+
+namespace
+{
+	constexpr float StickSteps = 127.f;
+	constexpr float TriggerSteps = 63.f;
+
+	FORCEINLINE uint64 QuantizeStick(float Value)
+	{
+		return (uint64)(uint8)(int8)FMath::RoundToInt(FMath::Clamp(Value, -1.f, 1.f) * StickSteps);
+	}
+
+	FORCEINLINE uint64 QuantizeTrigger(float Value)
+	{
+		return (uint64)FMath::RoundToInt(FMath::Clamp(Value, 0.f, 1.f) * TriggerSteps);
+	}
+}
+
+#pragma region Dual Sense [Input History]
+FDualSenseInputSnapshot FDualSenseInputSnapshot::Make(uint32 Buttons, const FVector2D& LeftStick, const FVector2D& RightStick, float LeftTrigger, float RightTrigger)
+{
+	FDualSenseInputSnapshot Snapshot;
+	Snapshot.Bits = ((uint64)Buttons & ButtonMask)
+		| QuantizeStick(LeftStick.X) << StickShift
+		| QuantizeStick(LeftStick.Y) << (StickShift + StickBits)
+		| QuantizeStick(RightStick.X) << (StickShift + 2 * StickBits)
+		| QuantizeStick(RightStick.Y) << (StickShift + 3 * StickBits)
+		| QuantizeTrigger(LeftTrigger) << TriggerShift
+		| QuantizeTrigger(RightTrigger) << (TriggerShift + TriggerBits);
+	return Snapshot;
+}
+
+FVector2D FDualSenseInputSnapshot::GetLeftStick() const
+{
+	return FVector2D(GetStickSteps(0) / StickSteps, GetStickSteps(1) / StickSteps);
+}
+
+FVector2D FDualSenseInputSnapshot::GetRightStick() const
+{
+	return FVector2D(GetStickSteps(2) / StickSteps, GetStickSteps(3) / StickSteps);
+}
+
+float FDualSenseInputSnapshot::GetTrigger(bool bRight) const
+{
+	return GetTriggerSteps(bRight) / TriggerSteps;
+}
+
+EDualSenseSnapshotField FDualSenseInputSnapshot::Diff(const FDualSenseInputSnapshot& Other) const
+{
+	const uint64 Changed = Bits ^ Other.Bits;
+
+	EDualSenseSnapshotField Fields = (EDualSenseSnapshotField)0;
+	Fields |= (Changed & ButtonMask) ? EDualSenseSnapshotField::Buttons : (EDualSenseSnapshotField)0;
+	Fields |= (Changed & LeftStickMask) ? EDualSenseSnapshotField::LeftStick : (EDualSenseSnapshotField)0;
+	Fields |= (Changed & RightStickMask) ? EDualSenseSnapshotField::RightStick : (EDualSenseSnapshotField)0;
+	Fields |= (Changed & TriggerMask) ? EDualSenseSnapshotField::Triggers : (EDualSenseSnapshotField)0;
+	return Fields;
+}
+
+int32 FDualSenseInputSnapshot::GetMaxAnalogDistance(const FDualSenseInputSnapshot& Other) const
+{
+	int32 Distance = 0;
+	for (int32 Axis = 0; Axis < 4; ++Axis)
+	{
+		Distance = FMath::Max(Distance, FMath::Abs(GetStickSteps(Axis) - Other.GetStickSteps(Axis)));
+	}
+	Distance = FMath::Max(Distance, FMath::Abs(GetTriggerSteps(false) - Other.GetTriggerSteps(false)));
+	Distance = FMath::Max(Distance, FMath::Abs(GetTriggerSteps(true) - Other.GetTriggerSteps(true)));
+	return Distance;
+}
+
+void FDualSenseInputHistory::Reset()
+{
+	FMemory::Memzero(Snapshots);
+	//No frame number maps here, frame 0 must not look captured
+	FMemory::Memset(Frames, 0xFF);
+	LatestFrame = 0;
+	bHasFrames = false;
+}
+
+int64 FDualSenseInputHistory::FindFirstDifference(uint64 FirstFrame, const FDualSenseInputSnapshot* Predicted, int32 Count) const
+{
+	for (int32 Offset = 0; Offset < Count; ++Offset)
+	{
+		const FDualSenseInputSnapshot* Actual = Find(FirstFrame + Offset);
+		if (!Actual || *Actual != Predicted[Offset])
+		{
+			return (int64)(FirstFrame + Offset);
+		}
+	}
+	return INDEX_NONE;
+}
+
+int64 FDualSenseInputHistory::FindFirstDifference(uint64 FirstFrame, const FDualSenseInputSnapshot* Predicted, int32 Count, int32 Tolerance) const
+{
+	for (int32 Offset = 0; Offset < Count; ++Offset)
+	{
+		const FDualSenseInputSnapshot* Actual = Find(FirstFrame + Offset);
+		if (!Actual || !Actual->NearlyEquals(Predicted[Offset], Tolerance))
+		{
+			return (int64)(FirstFrame + Offset);
+		}
+	}
+	return INDEX_NONE;
+}
+#pragma endregion
@@ -0,0 +1,810 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseIO.h"
+#include "WinDualSensePCH.h"
+#include "WinDualSense.h"
+#include "WinDualSenseTrace.h"
+#include "HAL/Event.h"
+
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <Windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+
+namespace
+{
+	const FDualSenseButtonRemap IdentityButtonRemap;
+}
+
+#pragma region Dual Sense [IO Thread]
+struct FDualSenseIOThread::FSlot
+{
+	FSlot() : Reports(ReportQueueSize), GestureEvents(GestureQueueSize), CallbackEvents(CallbackQueueSize), DriftEstimates(DriftQueueSize), ButtonEdges(EdgeQueueSize)
+	{
+		FMemory::Memzero(Context);
+		FMemory::Memzero(Overlapped);
+	}
+
+	int32 Index = INDEX_NONE;
+	std::atomic<EDualSenseSlotState> State{ EDualSenseSlotState::Free };
+
+	//Owned by the IO thread while Free, by the game thread (output) afterwards
+	DS5W::DeviceContext Context;
+	//Context came from DS5W::initDeviceContext and goes back through DS5W::freeDeviceContext
+	bool bHasDeviceContext = false;
+	//HID path the slot was opened on by enumeration, read and written by the IO thread only. Enumeration compares against it,
+	//never against the context the game thread zeroes and frees while releasing a lost slot.
+	//Injected slots never set it. LoseSlot keeps it, so a controller that comes back is not opened twice before the lost slot is released.
+	//The release only clears bEnumerated, which stops the comparison, and the IO thread empties the path once it sees the slot free
+	FString EnumeratedPath;
+	std::atomic<bool> bEnumerated{ false };
+	DS5W::DeviceConnection Connection = DS5W::DeviceConnection::USB;
+
+	HANDLE ReadHandle = INVALID_HANDLE_VALUE;
+	OVERLAPPED Overlapped;
+	bool bReadPending = false;
+	uint8 Buffer[DualSenseReport::BTReportLength];
+
+	TCircularQueue<FDualSenseInputReport> Reports;
+
+	//Swapped by the game thread, read for every report
+	std::atomic<const FDualSenseButtonRemap*> ButtonRemap{ &IdentityButtonRemap };
+
+	//Publish epoch the producer saw when it started the report in flight, 0 between reports
+	std::atomic<uint64> ProducerEpoch{ 0 };
+
+	//Owned by whoever produces the reports (IO thread or injector)
+	FDualSenseGestureDetector GestureDetector;
+	TCircularQueue<FDualSenseGestureEvent> GestureEvents;
+	//Same owner, posts to GestureEvents too
+	FDualSenseMotionGestureDetector MotionGestureDetector;
+
+	//Same owner as the gesture detector, edges are taken against the previous report
+	uint32 LastCallbackButtons = 0;
+	FDualSenseCallbackEventQueue CallbackEvents;
+
+	//Same owner again, resting position of each stick
+	FDualSenseDriftEstimator LeftStickDrift;
+	FDualSenseDriftEstimator RightStickDrift;
+	TCircularQueue<FDualSenseDriftEstimate> DriftEstimates;
+
+	//Same owner, every button change, even when the report queue overflows
+	uint32 LastEdgeButtons = 0;
+	TCircularQueue<FDualSenseButtonEdge> ButtonEdges;
+
+	//Same owner, session usage
+	FDualSenseUsageTracker Usage;
+
+	//Swapped by the game thread, written by the report producer while a scope is open
+	std::atomic<FDualSenseScopeBuffer*> ScopeBuffer{ nullptr };
+};
+
+FDualSenseIOThread::FDualSenseIOThread(bool bInEnumerateDevices) : bEnumerateDevices(bInEnumerateDevices)
+{
+	for (int32 Index = 0; Index < MaxDevices; ++Index)
+	{
+		Slots[Index] = MakeUnique<FSlot>();
+		Slots[Index]->Index = Index;
+	}
+
+	ReportEvent = FPlatformProcess::GetSynchEventFromPool(false);
+
+	CompletionPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+	if (!CompletionPort)
+	{
+		UE_LOG(LogWinDualSense, Error, TEXT("Can't Create DualSense IO Completion Port! [%u]"), GetLastError());
+	}
+}
+
+FDualSenseIOThread::~FDualSenseIOThread()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+	else
+	{
+		CancelPendingReads();
+	}
+
+	for (int32 Index = 0; Index < MaxDevices; ++Index)
+	{
+		ReleaseSlot(Index);
+	}
+
+	if (CompletionPort)
+	{
+		CloseHandle(CompletionPort);
+		CompletionPort = nullptr;
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(ReportEvent);
+	ReportEvent = nullptr;
+}
+
+bool FDualSenseIOThread::Start(const TCHAR* ThreadName)
+{
+	if (!CompletionPort || Thread)
+	{
+		return false;
+	}
+
+	Thread = FRunnableThread::Create(this, ThreadName, 0, TPri_AboveNormal);
+	return Thread != nullptr;
+}
+
+bool FDualSenseIOThread::OpenReportStream(int32 Slot, const TCHAR* Path, DS5W::DeviceConnection Connection)
+{
+	check(!Thread);
+
+	if (!Slots[Slot] || Slots[Slot]->State.load() != EDualSenseSlotState::Free)
+	{
+		return false;
+	}
+
+	HANDLE Handle = CreateFileW(Path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+	if (Handle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	FSlot& SlotData = *Slots[Slot];
+	FCString::Strncpy(SlotData.Context._internal.devicePath, Path, UE_ARRAY_COUNT(SlotData.Context._internal.devicePath));
+	SlotData.Context._internal.connection = Connection;
+	SlotData.Connection = Connection;
+	SlotData.bHasDeviceContext = false;
+
+	if (!OpenSlot(Slot, Handle))
+	{
+		CloseHandle(Handle);
+		return false;
+	}
+	return true;
+}
+
+bool FDualSenseIOThread::OpenInjectedStream(int32 Slot)
+{
+	//Raced against the IO thread claiming the same free slot
+	EDualSenseSlotState Expected = EDualSenseSlotState::Free;
+	if (!Slots[Slot] || !Slots[Slot]->State.compare_exchange_strong(Expected, EDualSenseSlotState::Connected, std::memory_order_acq_rel))
+	{
+		return false;
+	}
+	return true;
+}
+
+void FDualSenseIOThread::CloseInjectedStream(int32 Slot)
+{
+	EDualSenseSlotState Expected = EDualSenseSlotState::Connected;
+	Slots[Slot]->State.compare_exchange_strong(Expected, EDualSenseSlotState::Lost, std::memory_order_acq_rel);
+}
+
+bool FDualSenseIOThread::InjectReport(int32 Slot, const FDualSenseInputReport& Report)
+{
+	FDualSenseInputReport RemappedReport = Report;
+	return ProduceReport(*Slots[Slot], RemappedReport);
+}
+
+void FDualSenseIOThread::SetButtonRemap(int32 Slot, const FDualSenseButtonRemap* Remap)
+{
+	Slots[Slot]->ButtonRemap.store(Remap ? Remap : &IdentityButtonRemap);
+}
+
+uint64 FDualSenseIOThread::AdvanceEpoch()
+{
+	//Anything swapped out before this is only reachable from reports started at an older epoch
+	return PublishEpoch.fetch_add(1) + 1;
+}
+
+bool FDualSenseIOThread::HasPassedEpoch(uint64 Epoch) const
+{
+	for (const TUniquePtr<FSlot>& Slot : Slots)
+	{
+		const uint64 ProducerEpoch = Slot->ProducerEpoch.load();
+		if (ProducerEpoch != 0 && ProducerEpoch < Epoch)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FDualSenseIOThread::WaitForEpoch(uint64 Epoch) const
+{
+	while (!HasPassedEpoch(Epoch))
+	{
+		FPlatformProcess::Yield();
+	}
+}
+
+void FDualSenseIOThread::SetGestureSet(const FDualSenseGestureSet* Set)
+{
+	GestureSet.store(Set);
+}
+
+void FDualSenseIOThread::SetMotionGestureSettings(const FDualSenseMotionGestureSettings* Settings)
+{
+	MotionGestureSettings.store(Settings);
+}
+
+void FDualSenseIOThread::SetCallbackSet(const FDualSenseCallbackSet* Set)
+{
+	CallbackSet.store(Set);
+}
+
+void FDualSenseIOThread::SetScopeBuffer(int32 Slot, FDualSenseScopeBuffer* Buffer)
+{
+	Slots[Slot]->ScopeBuffer.store(Buffer, std::memory_order_release);
+}
+
+EDualSenseSlotState FDualSenseIOThread::GetSlotState(int32 Slot) const
+{
+	return Slots[Slot]->State.load(std::memory_order_acquire);
+}
+
+DS5W::DeviceContext* FDualSenseIOThread::GetDeviceContext(int32 Slot)
+{
+	return Slots[Slot]->bHasDeviceContext ? &Slots[Slot]->Context : nullptr;
+}
+
+FString FDualSenseIOThread::GetDevicePath(int32 Slot) const
+{
+	return FString(Slots[Slot]->Context._internal.devicePath);
+}
+
+bool FDualSenseIOThread::DequeueReport(int32 Slot, FDualSenseInputReport& OutReport)
+{
+	return Slots[Slot]->Reports.Dequeue(OutReport);
+}
+
+bool FDualSenseIOThread::HasReport(int32 Slot) const
+{
+	return !Slots[Slot]->Reports.IsEmpty();
+}
+
+uint32 FDualSenseIOThread::WaitForReports(uint32 SlotMask, uint64 DeadlineCycles)
+{
+	//Paired with the fence in ProduceReport : either the producer sees the flag and triggers, or the queue check below sees its report
+	bReportAwaited.store(true, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	uint32 PendingSlots = SlotMask;
+	while (true)
+	{
+		for (uint32 Pending = PendingSlots; Pending != 0; Pending &= Pending - 1)
+		{
+			const int32 Slot = (int32)FMath::CountTrailingZeros(Pending);
+			if (HasReport(Slot))
+			{
+				PendingSlots &= ~(1u << Slot);
+			}
+		}
+
+		const uint64 NowCycles = FPlatformTime::Cycles64();
+		if (PendingSlots == 0 || NowCycles >= DeadlineCycles)
+			break;
+
+		//The timeout has millisecond granularity and the timer can wake a millisecond late, so it sleeps whole milliseconds
+		//only while more than one would be left, then yields until DeadlineCycles. Any slot's report triggers the event, the loop checks again
+		const uint32 SleepMilliseconds = (uint32)FPlatformTime::ToMilliseconds64(DeadlineCycles - NowCycles);
+		if (SleepMilliseconds > 1)
+		{
+			ReportEvent->Wait(SleepMilliseconds - 1);
+		}
+		else
+		{
+			FPlatformProcess::YieldThread();
+		}
+	}
+
+	bReportAwaited.store(false, std::memory_order_relaxed);
+	return PendingSlots;
+}
+
+bool FDualSenseIOThread::DequeueGestureEvent(int32 Slot, FDualSenseGestureEvent& OutEvent)
+{
+	return Slots[Slot]->GestureEvents.Dequeue(OutEvent);
+}
+
+bool FDualSenseIOThread::DequeueCallbackEvent(int32 Slot, FDualSenseCallbackEvent& OutEvent)
+{
+	return Slots[Slot]->CallbackEvents.Dequeue(OutEvent);
+}
+
+bool FDualSenseIOThread::DequeueButtonEdge(int32 Slot, uint32 UpToSensorTimestamp, FDualSenseButtonEdge& OutEdge)
+{
+	TCircularQueue<FDualSenseButtonEdge>& Edges = Slots[Slot]->ButtonEdges;
+	const FDualSenseButtonEdge* Edge = Edges.Peek();
+
+	//Sensor clock wraps, the signed distance keeps the order
+	if (!Edge || (int32)(Edge->SensorTimestamp - UpToSensorTimestamp) > 0)
+	{
+		return false;
+	}
+	return Edges.Dequeue(OutEdge);
+}
+
+bool FDualSenseIOThread::DequeueDriftEstimate(int32 Slot, FDualSenseDriftEstimate& OutEstimate)
+{
+	return Slots[Slot]->DriftEstimates.Dequeue(OutEstimate);
+}
+
+const FDualSenseUsageCounters& FDualSenseIOThread::GetUsageCounters(int32 Slot) const
+{
+	return Slots[Slot]->Usage.GetCounters();
+}
+
+void FDualSenseIOThread::ReleaseSlot(int32 Slot)
+{
+	FSlot& SlotData = *Slots[Slot];
+	if (SlotData.State.load(std::memory_order_acquire) == EDualSenseSlotState::Free)
+	{
+		return;
+	}
+
+	if (SlotData.bHasDeviceContext)
+	{
+		DS5W::freeDeviceContext(&SlotData.Context);
+		SlotData.bHasDeviceContext = false;
+	}
+	FMemory::Memzero(SlotData.Context);
+
+	FDualSenseInputReport Report;
+	while (SlotData.Reports.Dequeue(Report))
+	{
+	}
+
+	FDualSenseGestureEvent GestureEvent;
+	while (SlotData.GestureEvents.Dequeue(GestureEvent))
+	{
+	}
+	SlotData.GestureDetector.Reset();
+	SlotData.MotionGestureDetector.Reset();
+
+	FDualSenseCallbackEvent CallbackEvent;
+	while (SlotData.CallbackEvents.Dequeue(CallbackEvent))
+	{
+	}
+	SlotData.LastCallbackButtons = 0;
+
+	FDualSenseDriftEstimate DriftEstimate;
+	while (SlotData.DriftEstimates.Dequeue(DriftEstimate))
+	{
+	}
+	SlotData.LeftStickDrift.Reset();
+	SlotData.RightStickDrift.Reset();
+
+	FDualSenseButtonEdge ButtonEdge;
+	while (SlotData.ButtonEdges.Dequeue(ButtonEdge))
+	{
+	}
+	SlotData.LastEdgeButtons = 0;
+	SlotData.Usage.ResetTracking();
+
+	SlotData.bEnumerated.store(false, std::memory_order_relaxed);
+	SlotData.State.store(EDualSenseSlotState::Free, std::memory_order_release);
+}
+
+uint32 FDualSenseIOThread::Run()
+{
+	while (!bStopping.load())
+	{
+		DWORD Timeout = INFINITE;
+
+		if (bEnumerateDevices)
+		{
+			if (FPlatformTime::Seconds() >= NextEnumerateTime)
+			{
+				EnumerateDevices();
+				//Poll quickly until the library is in, so the first controllers don't wait a full interval
+				NextEnumerateTime = FPlatformTime::Seconds() + (bHasEnumerated ? EnumerateInterval : LibraryPollInterval);
+			}
+			Timeout = (DWORD)FMath::Max(0.0, (NextEnumerateTime - FPlatformTime::Seconds()) * 1000.0);
+		}
+
+		DWORD BytesRead = 0;
+		ULONG_PTR Key = 0;
+		LPOVERLAPPED Overlapped = nullptr;
+		const BOOL bSucceeded = GetQueuedCompletionStatus(CompletionPort, &BytesRead, &Key, &Overlapped, Timeout);
+
+		//Timeout or wake up from Stop()
+		if (!Overlapped)
+		{
+			continue;
+		}
+
+		FSlot& Slot = *Slots[Key];
+		Slot.bReadPending = false;
+
+		if (!bSucceeded || BytesRead == 0)
+		{
+			LoseSlot(Slot);
+			continue;
+		}
+
+		CompleteRead(Slot, BytesRead);
+
+		if (!IssueRead(Slot))
+		{
+			LoseSlot(Slot);
+		}
+	}
+
+	CancelPendingReads();
+	return 0;
+}
+
+void FDualSenseIOThread::Stop()
+{
+	bStopping.store(true);
+
+	if (CompletionPort)
+	{
+		PostQueuedCompletionStatus(CompletionPort, 0, 0, nullptr);
+	}
+}
+
+void FDualSenseIOThread::EnumerateDevices()
+{
+	//ds5w_x64.dll is delay loaded and still coming in on a worker
+	if (!FWinDualSensePlugin::IsLibraryLoaded())
+	{
+		return;
+	}
+
+	bool bHasFreeSlot = false;
+	for (const TUniquePtr<FSlot>& Slot : Slots)
+	{
+		bHasFreeSlot |= Slot->State.load(std::memory_order_acquire) == EDualSenseSlotState::Free;
+	}
+
+	if (!bHasFreeSlot)
+	{
+		return;
+	}
+
+	DS5W::DeviceEnumInfo Infos[MaxDevices];
+	unsigned int InfoCount = 0;
+	const double EnumerateStartTime = FPlatformTime::Seconds();
+	const DS5W_ReturnValue Result = DS5W::enumDevices(Infos, MaxDevices, &InfoCount);
+
+	if (!bHasEnumerated)
+	{
+		bHasEnumerated = true;
+		UE_LOG(LogWinDualSense, Log, TEXT("DualSense First Enumeration [%u Controllers] [%.2f ms] (IO Thread)"), InfoCount, (FPlatformTime::Seconds() - EnumerateStartTime) * 1000.0);
+	}
+	if (DS5W_FAILED(Result) && Result != DS5W_E_INSUFFICIENT_BUFFER)
+	{
+		return;
+	}
+
+	for (unsigned int InfoIndex = 0; InfoIndex < FMath::Min<unsigned int>(InfoCount, MaxDevices); ++InfoIndex)
+	{
+		DS5W::DeviceEnumInfo& Info = Infos[InfoIndex];
+
+		int32 FreeSlot = INDEX_NONE;
+		bool bIsKnown = false;
+		for (int32 Index = 0; Index < MaxDevices; ++Index)
+		{
+			FSlot& Slot = *Slots[Index];
+			if (Slot.State.load(std::memory_order_acquire) == EDualSenseSlotState::Free)
+			{
+				FreeSlot = FreeSlot == INDEX_NONE ? Index : FreeSlot;
+				Slot.EnumeratedPath.Empty();
+			}
+			else if (Slot.bEnumerated.load(std::memory_order_acquire) && Slot.EnumeratedPath.Equals(Info._internal.path, ESearchCase::CaseSensitive))
+			{
+				bIsKnown = true;
+			}
+		}
+
+		if (bIsKnown)
+		{
+			continue;
+		}
+
+		if (FreeSlot == INDEX_NONE)
+		{
+			break;
+		}
+
+		//Injected streams may take free slots from other threads
+		FSlot& Slot = *Slots[FreeSlot];
+		EDualSenseSlotState Expected = EDualSenseSlotState::Free;
+		if (!Slot.State.compare_exchange_strong(Expected, EDualSenseSlotState::Reserved, std::memory_order_acq_rel))
+		{
+			continue;
+		}
+
+		if (DS5W_FAILED(DS5W::initDeviceContext(&Info, &Slot.Context)))
+		{
+			Slot.State.store(EDualSenseSlotState::Free, std::memory_order_release);
+			continue;
+		}
+
+		//DS5W opens the device exclusive and blocking, swap in shared handles so reads can be overlapped
+		//while DS5W::setDeviceOutputState keeps writing through the context
+		CloseHandle(Slot.Context._internal.deviceHandle);
+		HANDLE ReadHandle = CreateFileW(Info._internal.path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+		HANDLE WriteHandle = CreateFileW(Info._internal.path, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
+		Slot.Context._internal.deviceHandle = WriteHandle;
+		Slot.Connection = Slot.Context._internal.connection;
+		Slot.bHasDeviceContext = true;
+		Slot.EnumeratedPath = Info._internal.path;
+		Slot.bEnumerated.store(true, std::memory_order_relaxed);
+
+		if (ReadHandle == INVALID_HANDLE_VALUE || WriteHandle == INVALID_HANDLE_VALUE || !OpenSlot(FreeSlot, ReadHandle))
+		{
+			UE_LOG(LogWinDualSense, Error, TEXT("Can't Open DualSense Controller! [%u]"), GetLastError());
+
+			if (ReadHandle != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(ReadHandle);
+			}
+			if (WriteHandle != INVALID_HANDLE_VALUE)
+			{
+				DS5W::freeDeviceContext(&Slot.Context);
+			}
+			FMemory::Memzero(Slot.Context);
+			Slot.bHasDeviceContext = false;
+			Slot.EnumeratedPath.Empty();
+			Slot.bEnumerated.store(false, std::memory_order_relaxed);
+			Slot.State.store(EDualSenseSlotState::Free, std::memory_order_release);
+			continue;
+		}
+
+		UE_LOG(LogWinDualSense, Log, TEXT("DualSense Controller Connected [%d] | %s"), FreeSlot, Slot.Connection == DS5W::DeviceConnection::BT ? TEXT("BT") : TEXT("USB"));
+	}
+}
+
+bool FDualSenseIOThread::OpenSlot(int32 Slot, void* Handle)
+{
+	if (!CreateIoCompletionPort(Handle, CompletionPort, (ULONG_PTR)Slot, 0))
+	{
+		return false;
+	}
+
+	FSlot& SlotData = *Slots[Slot];
+	SlotData.ReadHandle = Handle;
+
+	if (!IssueRead(SlotData))
+	{
+		SlotData.ReadHandle = INVALID_HANDLE_VALUE;
+		return false;
+	}
+
+	SlotData.State.store(EDualSenseSlotState::Connected, std::memory_order_release);
+	return true;
+}
+
+bool FDualSenseIOThread::IssueRead(FSlot& Slot)
+{
+	FMemory::Memzero(Slot.Overlapped);
+
+	//Completion always lands on the port, even when the read finishes right away
+	if (!ReadFile(Slot.ReadHandle, Slot.Buffer, DualSenseReport::GetReportLength(Slot.Connection), nullptr, &Slot.Overlapped) && GetLastError() != ERROR_IO_PENDING)
+	{
+		return false;
+	}
+
+	Slot.bReadPending = true;
+	return true;
+}
+
+void FDualSenseIOThread::CompleteRead(FSlot& Slot, uint32 BytesRead)
+{
+	DUALSENSE_TRACE_SCOPE(DecodeReport);
+
+	const int32 PayloadOffset = DualSenseReport::GetPayloadOffset(Slot.Connection);
+	if ((int32)BytesRead < PayloadOffset + DualSenseReport::MinPayloadLength || Slot.Buffer[0] != DualSenseReport::GetReportId(Slot.Connection))
+	{
+		return;
+	}
+
+	FDualSenseInputReport Report;
+	DualSenseReport::DecodeReport(Slot.Buffer + PayloadOffset, Report);
+
+	//Full queue means the game thread fell behind, the gap shows up in the sequence counter
+	ProduceReport(Slot, Report);
+}
+
+bool FDualSenseIOThread::ProduceReport(FSlot& Slot, FDualSenseInputReport& Report)
+{
+	//Sequentially consistent with the game thread's swap then AdvanceEpoch : either it sees this epoch,
+	//or every published object loaded below is already the new one
+	Slot.ProducerEpoch.store(PublishEpoch.load());
+
+	RemapReport(Slot, Report);
+	DetectGestures(Slot, Report);
+	DetectMotionGestures(Slot, Report);
+	RunCallbacks(Slot, Report);
+	EstimateDrift(Slot, Report);
+	LatchButtonEdges(Slot, Report);
+	Slot.Usage.AddReport(Report);
+	WriteScope(Slot, Report);
+
+	Slot.ProducerEpoch.store(0, std::memory_order_release);
+	const bool bQueued = Slot.Reports.Enqueue(Report);
+
+	//Only costs a wake up while a late latch waits
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (bReportAwaited.load(std::memory_order_relaxed))
+	{
+		ReportEvent->Trigger();
+	}
+	return bQueued;
+}
+
+void FDualSenseIOThread::RemapReport(const FSlot& Slot, FDualSenseInputReport& Report)
+{
+	Report.Buttons = Slot.ButtonRemap.load()->Apply(Report.Buttons);
+}
+
+void FDualSenseIOThread::DetectGestures(FSlot& Slot, const FDualSenseInputReport& Report)
+{
+	const FDualSenseGestureSet* Set = GestureSet.load();
+	if (!Set)
+	{
+		return;
+	}
+
+	Slot.GestureDetector.Update(*Set, Report.Buttons, Report.SensorTimestamp, [&Slot, &Report](const FDualSenseGestureSet::FCompiledPattern& Pattern)
+	{
+		FDualSenseGestureEvent Event;
+		Event.Key = Pattern.Key;
+		Event.Type = Pattern.Type;
+		Event.SensorTimestamp = Report.SensorTimestamp;
+		Event.ReceiveCycles = Report.ReceiveCycles;
+		if (!Slot.GestureEvents.Enqueue(Event))
+		{
+			Slot.Usage.AddDroppedGesture();
+		}
+	});
+}
+
+void FDualSenseIOThread::DetectMotionGestures(FSlot& Slot, const FDualSenseInputReport& Report)
+{
+	const FDualSenseMotionGestureSettings* Settings = MotionGestureSettings.load();
+	if (!Settings)
+	{
+		return;
+	}
+
+	Slot.MotionGestureDetector.Update(*Settings, Report, [&Slot, &Report](EDualSenseMotionGesture Gesture)
+	{
+		FDualSenseGestureEvent Event;
+		Event.Key = DualSenseMotionGesture::GetKey(Gesture);
+		Event.bIsMotion = true;
+		Event.SensorTimestamp = Report.SensorTimestamp;
+		Event.ReceiveCycles = Report.ReceiveCycles;
+		if (!Slot.GestureEvents.Enqueue(Event))
+		{
+			Slot.Usage.AddDroppedGesture();
+		}
+	});
+}
+
+void FDualSenseIOThread::RunCallbacks(FSlot& Slot, const FDualSenseInputReport& Report)
+{
+	const FDualSenseCallbackSet* Set = CallbackSet.load();
+	if (Set)
+	{
+		Set->Dispatch(Slot.Index, Report, Slot.LastCallbackButtons, Slot.CallbackEvents);
+	}
+	Slot.LastCallbackButtons = Report.Buttons;
+}
+
+void FDualSenseIOThread::EstimateDrift(FSlot& Slot, const FDualSenseInputReport& Report)
+{
+	const bool bLeftDue = Slot.LeftStickDrift.AddSample(Report.State.leftStick.x, Report.State.leftStick.y);
+	const bool bRightDue = Slot.RightStickDrift.AddSample(Report.State.rightStick.x, Report.State.rightStick.y);
+	if (!bLeftDue && !bRightDue)
+	{
+		return;
+	}
+
+	//Full queue : the game thread has not taken the previous ones, the next estimate replaces this one anyway
+	FDualSenseDriftEstimate Estimate;
+	Estimate.LeftStick = Slot.LeftStickDrift.GetDrift();
+	Estimate.RightStick = Slot.RightStickDrift.GetDrift();
+	Slot.DriftEstimates.Enqueue(Estimate);
+}
+
+void FDualSenseIOThread::LatchButtonEdges(FSlot& Slot, const FDualSenseInputReport& Report)
+{
+	const uint32 ChangedButtons = Report.Buttons ^ Slot.LastEdgeButtons;
+	if (ChangedButtons == 0)
+	{
+		return;
+	}
+
+	FDualSenseButtonEdge Edge;
+	Edge.PressedButtons = ChangedButtons & Report.Buttons;
+	Edge.ReleasedButtons = ChangedButtons & Slot.LastEdgeButtons;
+	Edge.SensorTimestamp = Report.SensorTimestamp;
+	Edge.ReceiveCycles = Report.ReceiveCycles;
+
+	//Full queue means the game thread stopped taking them, its per frame state pass still ends on the right buttons
+	Slot.ButtonEdges.Enqueue(Edge);
+	Slot.LastEdgeButtons = Report.Buttons;
+}
+
+void FDualSenseIOThread::WriteScope(const FSlot& Slot, const FDualSenseInputReport& Report)
+{
+	FDualSenseScopeBuffer* Buffer = Slot.ScopeBuffer.load(std::memory_order_acquire);
+	if (Buffer)
+	{
+		Buffer->AddReport(Report);
+	}
+}
+
+void FDualSenseIOThread::LoseSlot(FSlot& Slot)
+{
+	if (Slot.ReadHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(Slot.ReadHandle);
+		Slot.ReadHandle = INVALID_HANDLE_VALUE;
+	}
+
+	Slot.State.store(EDualSenseSlotState::Lost, std::memory_order_release);
+}
+
+void FDualSenseIOThread::CancelPendingReads()
+{
+	int32 PendingReads = 0;
+	for (TUniquePtr<FSlot>& Slot : Slots)
+	{
+		if (Slot->bReadPending)
+		{
+			CancelIoEx(Slot->ReadHandle, &Slot->Overlapped);
+			++PendingReads;
+		}
+	}
+
+	//Cancelled reads still complete on the port, the buffers must outlive them
+	while (PendingReads > 0 && CompletionPort)
+	{
+		DWORD BytesRead = 0;
+		ULONG_PTR Key = 0;
+		LPOVERLAPPED Overlapped = nullptr;
+		GetQueuedCompletionStatus(CompletionPort, &BytesRead, &Key, &Overlapped, 100);
+
+		if (!Overlapped)
+		{
+			if (GetLastError() == WAIT_TIMEOUT)
+			{
+				break;
+			}
+			continue;
+		}
+
+		Slots[Key]->bReadPending = false;
+		--PendingReads;
+	}
+
+	for (TUniquePtr<FSlot>& Slot : Slots)
+	{
+		if (Slot->ReadHandle != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(Slot->ReadHandle);
+			Slot->ReadHandle = INVALID_HANDLE_VALUE;
+		}
+	}
+}
+
+void FDualSenseRetireList::Collect(const FDualSenseIOThread& IOThread)
+{
+	//Retired in epoch order
+	int32 Count = 0;
+	while (Count < Objects.Num() && IOThread.HasPassedEpoch(Objects[Count]->Epoch))
+	{
+		++Count;
+	}
+
+	if (Count > 0)
+	{
+		Objects.RemoveAt(0, Count, false);
+	}
+}
+#pragma endregion
@@ -0,0 +1,86 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseLatch.h"
+
+namespace
+{
+	//Weight of the newest frame in the interval mean
+	constexpr double FrameSmoothing = 0.1;
+	//A hitch (loading, breakpoint) counts as this many mean frames at most
+	constexpr double MaxFrameOutlier = 4.0;
+}
+
+#pragma region Dual Sense [Late Latch]
+void FDualSenseFramePacing::Reset()
+{
+	IntervalMean = 0.0;
+	LastFrameCycles = 0;
+}
+
+void FDualSenseFramePacing::AddFrame(uint64 Cycles)
+{
+	if (LastFrameCycles != 0 && Cycles > LastFrameCycles)
+	{
+		const double Interval = DualSenseLatch::CyclesToMicroseconds(Cycles - LastFrameCycles);
+		IntervalMean = IntervalMean > 0.0
+			? IntervalMean + (FMath::Min(Interval, IntervalMean * MaxFrameOutlier) - IntervalMean) * FrameSmoothing
+			: Interval;
+	}
+	LastFrameCycles = Cycles;
+}
+
+void FDualSenseLatchStats::Reset()
+{
+	Dispatches = 0;
+	AgeSum = 0.0;
+	AgeMax = 0.0;
+	LastAge = -1.0;
+
+	Waits = 0;
+	CaughtReports = 0;
+	WaitSum = 0.0;
+	OvershootSum = 0.0;
+	OvershootMax = 0.0;
+}
+
+void FDualSenseLatchStats::AddDispatch(double AgeMicroseconds)
+{
+	++Dispatches;
+	AgeSum += AgeMicroseconds;
+	AgeMax = FMath::Max(AgeMax, AgeMicroseconds);
+	LastAge = AgeMicroseconds;
+}
+
+void FDualSenseLatchStats::AddWait(double WaitMicroseconds, bool bCaughtReport, double OvershootMicroseconds)
+{
+	++Waits;
+	CaughtReports += bCaughtReport ? 1 : 0;
+	WaitSum += WaitMicroseconds;
+	OvershootSum += OvershootMicroseconds;
+	OvershootMax = FMath::Max(OvershootMax, OvershootMicroseconds);
+}
+
+double DualSenseLatch::GetTimeToNextReport(uint64 LastReportCycles, double ReportIntervalMicroseconds, uint64 NowCycles)
+{
+	const double SinceReport = NowCycles >= LastReportCycles
+		? CyclesToMicroseconds(NowCycles - LastReportCycles)
+		: -CyclesToMicroseconds(LastReportCycles - NowCycles);
+	return ReportIntervalMicroseconds - SinceReport;
+}
+
+double DualSenseLatch::GetWaitBudget(const FDualSenseLatchSettings& Settings, const FDualSenseFramePacing& Pacing)
+{
+	//No pacing yet, no idea what a wait costs
+	if (!Settings.bEnabled || Pacing.IntervalMean <= 0.0)
+	{
+		return 0.0;
+	}
+	return FMath::Min((double)Settings.MaxWaitMicroseconds, Pacing.IntervalMean * Settings.MaxFrameShare);
+}
+
+bool DualSenseLatch::ShouldWait(const FDualSenseLatchSettings& Settings, double TimeToNextReport, double ReportIntervalMicroseconds, double WaitBudget)
+{
+	//Overdue by more than the jitter, the controller is late for another reason
+	return ReportIntervalMicroseconds > 0.0 && TimeToNextReport <= WaitBudget && TimeToNextReport > -Settings.JitterMicroseconds;
+}
+#pragma endregion
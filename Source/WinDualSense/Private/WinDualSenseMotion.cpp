@@ -0,0 +1,130 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseMotion.h"
+
+namespace
+{
+	//Longer gaps are reconnects or dropped bursts, not motion to integrate
+	constexpr float MaxSampleDeltaTime = 0.1f;
+
+	//Bias only follows the gyro after it stayed under RestSpeed for RestDelay
+	constexpr float RestSpeed = 2.f;
+	constexpr float RestDelay = 1.f;
+	constexpr float BiasTimeConstant = 2.f;
+
+	constexpr float GravityTimeConstant = 0.5f;
+}
+
+#pragma region Dual Sense [Motion]
+FDualSenseMotion::FDualSenseMotion()
+{
+	GyroBias = FVector::ZeroVector;
+	Reset();
+}
+
+void FDualSenseMotion::Reset()
+{
+	bHasLastSample = false;
+	LastSensorTimestamp = 0;
+
+	AngularVelocity = FVector::ZeroVector;
+	Acceleration = FVector::ZeroVector;
+	Gravity = FVector::ZeroVector;
+
+	RestTime = 0.f;
+	AimDelta = FVector2D::ZeroVector;
+
+	for (FVector2D& Sample : SmoothBuffer)
+	{
+		Sample = FVector2D::ZeroVector;
+	}
+	SmoothIndex = 0;
+}
+
+void FDualSenseMotion::AddSample(const FDualSenseInputReport& Report)
+{
+	const FVector RawGyro(Report.Gyroscope.x, Report.Gyroscope.y, Report.Gyroscope.z);
+	Acceleration = FVector(Report.Accelerometer.x, Report.Accelerometer.y, Report.Accelerometer.z) / DualSenseReport::AccelCountsPerG;
+
+	if (!bHasLastSample)
+	{
+		bHasLastSample = true;
+		LastSensorTimestamp = Report.SensorTimestamp;
+		AngularVelocity = (RawGyro - GyroBias) / DualSenseReport::GyroCountsPerDegreePerSecond;
+		Gravity = Acceleration;
+		return;
+	}
+
+	const float DeltaTime = (float)((double)(Report.SensorTimestamp - LastSensorTimestamp) / DualSenseReport::SensorTicksPerSecond);
+	LastSensorTimestamp = Report.SensorTimestamp;
+
+	if (DeltaTime <= 0.f || DeltaTime > MaxSampleDeltaTime)
+		return;
+
+	UpdateBias(RawGyro, DeltaTime);
+	AngularVelocity = (RawGyro - GyroBias) / DualSenseReport::GyroCountsPerDegreePerSecond;
+	Gravity = FMath::Lerp(Gravity, Acceleration, FMath::Min(1.f, DeltaTime / GravityTimeConstant));
+
+	if (!AimSettings.bEnabled)
+		return;
+
+	//Ratchet, the samples while held are simply not integrated
+	if (Report.Buttons & DualSenseReport::GetButtonMask(AimSettings.RatchetButton))
+		return;
+
+	//Yaw around the controller's vertical axis, pitch around its lateral axis (screen Y grows downwards)
+	FVector2D Velocity(-AngularVelocity.Y, -AngularVelocity.X);
+	Velocity.X *= AimSettings.bInvertYaw ? -1.f : 1.f;
+	Velocity.Y *= AimSettings.bInvertPitch ? -1.f : 1.f;
+
+	const float SensitivityAlpha = FMath::Clamp(FMath::GetRangePct(AimSettings.MinSensitivitySpeed, AimSettings.MaxSensitivitySpeed, Velocity.Size()), 0.f, 1.f);
+	const float Sensitivity = FMath::Lerp(AimSettings.MinSensitivity, AimSettings.MaxSensitivity, FMath::Pow(SensitivityAlpha, FMath::Max(AimSettings.CurveExponent, KINDA_SMALL_NUMBER)));
+
+	AimDelta += SmoothAim(Velocity, DeltaTime) * DeltaTime * Sensitivity;
+}
+
+bool FDualSenseMotion::IsAtRest() const
+{
+	return RestTime > RestDelay;
+}
+
+FIntPoint FDualSenseMotion::ConsumeAimDelta()
+{
+	const FIntPoint Counts(FMath::TruncToInt(AimDelta.X), FMath::TruncToInt(AimDelta.Y));
+	AimDelta -= FVector2D(Counts.X, Counts.Y);
+	return Counts;
+}
+
+void FDualSenseMotion::UpdateBias(const FVector& RawGyro, float DeltaTime)
+{
+	const float Speed = ((RawGyro - GyroBias) / DualSenseReport::GyroCountsPerDegreePerSecond).Size();
+	RestTime = Speed < RestSpeed ? RestTime + DeltaTime : 0.f;
+
+	if (RestTime > RestDelay)
+	{
+		GyroBias = FMath::Lerp(GyroBias, RawGyro, FMath::Min(1.f, DeltaTime / BiasTimeConstant));
+	}
+}
+
+FVector2D FDualSenseMotion::SmoothAim(const FVector2D& Velocity, float DeltaTime)
+{
+	const float Magnitude = Velocity.Size();
+	const float LowerTier = AimSettings.SmoothThreshold * 0.5f;
+	const float UpperTier = AimSettings.SmoothThreshold;
+	const float DirectWeight = UpperTier > LowerTier ? FMath::Clamp((Magnitude - LowerTier) / (UpperTier - LowerTier), 0.f, 1.f) : 1.f;
+
+	SmoothIndex = (SmoothIndex + 1) % SmoothBufferSize;
+	SmoothBuffer[SmoothIndex] = Velocity * (1.f - DirectWeight);
+
+	//Window in samples from the report interval, not from frames
+	const int32 WindowSize = FMath::Clamp(FMath::RoundToInt(AimSettings.SmoothTime / DeltaTime), 1, SmoothBufferSize);
+
+	FVector2D Smoothed = FVector2D::ZeroVector;
+	for (int32 Index = 0; Index < WindowSize; ++Index)
+	{
+		Smoothed += SmoothBuffer[(SmoothIndex - Index + SmoothBufferSize) % SmoothBufferSize];
+	}
+
+	return Velocity * DirectWeight + Smoothed / (float)WindowSize;
+}
+#pragma endregion
@@ -0,0 +1,320 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseMotionGesture.h"
+#include "WinDualSenseReport.h"
+
+namespace
+{
+	//Longer gaps are reconnects or dropped bursts, every gesture in progress is dropped
+	constexpr float MaxSampleDeltaTime = 0.1f;
+
+	//Slow enough to keep a 20ms jolt out of gravity, fast enough to follow a turned controller
+	constexpr float GravityTimeConstant = 0.2f;
+
+	//A jolt has settled under this share of TapAcceleration, a flick under this share of FlickSpeed
+	constexpr float TapReleaseRatio = 0.5f;
+	constexpr float FlickReleaseRatio = 0.25f;
+
+	//Accelerometer axes (X right, Y out of the face, Z towards the player) pointing up, positive then negative
+	const EDualSenseMotionGesture Orientations[3][2] =
+	{
+		{ EDualSenseMotionGesture::RightSideUp, EDualSenseMotionGesture::LeftSideUp },
+		{ EDualSenseMotionGesture::FaceUp, EDualSenseMotionGesture::FaceDown },
+		{ EDualSenseMotionGesture::TopDown, EDualSenseMotionGesture::TopUp }
+	};
+}
+
+#pragma region Dual Sense [Motion Gesture]
+const FName& DualSenseMotionGesture::GetKey(EDualSenseMotionGesture Gesture)
+{
+	static const FName Keys[(int32)EDualSenseMotionGesture::MAX_COUNT + 1] =
+	{
+		TEXT("DualSense_Motion_Shake"),
+		TEXT("DualSense_Motion_Tap"),
+		TEXT("DualSense_Motion_FlickLeft"),
+		TEXT("DualSense_Motion_FlickRight"),
+		TEXT("DualSense_Motion_FlickUp"),
+		TEXT("DualSense_Motion_FlickDown"),
+		TEXT("DualSense_Motion_FaceUp"),
+		TEXT("DualSense_Motion_FaceDown"),
+		TEXT("DualSense_Motion_RightSideUp"),
+		TEXT("DualSense_Motion_LeftSideUp"),
+		TEXT("DualSense_Motion_TopDown"),
+		TEXT("DualSense_Motion_TopUp"),
+		NAME_None
+	};
+	return Keys[FMath::Min((int32)Gesture, (int32)EDualSenseMotionGesture::MAX_COUNT)];
+}
+
+EDualSenseMotionGestureType DualSenseMotionGesture::GetType(EDualSenseMotionGesture Gesture)
+{
+	switch (Gesture)
+	{
+	case EDualSenseMotionGesture::Shake:
+		return EDualSenseMotionGestureType::Shake;
+	case EDualSenseMotionGesture::Tap:
+		return EDualSenseMotionGestureType::Tap;
+	case EDualSenseMotionGesture::FlickLeft:
+	case EDualSenseMotionGesture::FlickRight:
+	case EDualSenseMotionGesture::FlickUp:
+	case EDualSenseMotionGesture::FlickDown:
+		return EDualSenseMotionGestureType::Flick;
+	default:
+		return EDualSenseMotionGestureType::OrientationSnap;
+	}
+}
+
+void FDualSenseMotionGestureDetector::Reset()
+{
+	bHasLastSample = false;
+	LastSensorTimestamp = 0;
+	Time = 0.0;
+
+	Gravity = FVector::ZeroVector;
+	Orientation = INDEX_NONE;
+
+	for (double& FireTime : LastFireTimes)
+	{
+		FireTime = -MAX_dbl;
+	}
+
+	ResetTracking();
+}
+
+void FDualSenseMotionGestureDetector::ResetTracking()
+{
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		ShakeSigns[Axis] = 0;
+		ShakePeaks[Axis] = 0;
+		ShakePeakTimes[Axis] = 0.0;
+	}
+
+	TapQuietTime = 0.f;
+	bTapSpike = false;
+	bTapSpikeValid = false;
+	TapSpikeStart = 0.0;
+
+	bFlickActive = false;
+	FlickStart = 0.0;
+	FlickPeakSpeed = 0.f;
+	FlickRotation = FVector2D::ZeroVector;
+
+	PendingOrientation = INDEX_NONE;
+	PendingTime = 0.f;
+}
+
+void FDualSenseMotionGestureDetector::Update(const FDualSenseMotionGestureSettings& Settings, const FDualSenseInputReport& Report, TFunctionRef<void(EDualSenseMotionGesture)> Emit)
+{
+	const FVector Acceleration = FVector(Report.Accelerometer.x, Report.Accelerometer.y, Report.Accelerometer.z) / DualSenseReport::AccelCountsPerG;
+	//No bias here, it is a few deg/s against thresholds of hundreds
+	const FVector AngularVelocity = FVector(Report.Gyroscope.x, Report.Gyroscope.y, Report.Gyroscope.z) / DualSenseReport::GyroCountsPerDegreePerSecond;
+
+	if (!bHasLastSample)
+	{
+		bHasLastSample = true;
+		LastSensorTimestamp = Report.SensorTimestamp;
+		Gravity = Acceleration;
+		return;
+	}
+
+	const float DeltaTime = (float)((double)(Report.SensorTimestamp - LastSensorTimestamp) / DualSenseReport::SensorTicksPerSecond);
+	LastSensorTimestamp = Report.SensorTimestamp;
+
+	if (DeltaTime <= 0.f)
+		return;
+
+	if (DeltaTime > MaxSampleDeltaTime)
+	{
+		Gravity = Acceleration;
+		ResetTracking();
+		return;
+	}
+
+	Time += DeltaTime;
+	Gravity = FMath::Lerp(Gravity, Acceleration, FMath::Min(1.f, DeltaTime / GravityTimeConstant));
+	const FVector Linear = Acceleration - Gravity;
+
+	if (Settings.bShake)
+	{
+		UpdateShake(Settings, Linear, Emit);
+	}
+
+	if (Settings.bTap)
+	{
+		UpdateTap(Settings, Linear, AngularVelocity.Size(), DeltaTime, Emit);
+	}
+
+	if (Settings.bFlick)
+	{
+		//Yaw and pitch the way gyro aim turns them into screen axes
+		UpdateFlick(Settings, FVector2D(-AngularVelocity.Y, -AngularVelocity.X), DeltaTime, Emit);
+	}
+
+	if (Settings.bSnap)
+	{
+		UpdateSnap(Settings, DeltaTime, Emit);
+	}
+}
+
+bool FDualSenseMotionGestureDetector::CanEmit(EDualSenseMotionGestureType Type, float Cooldown) const
+{
+	return Time - LastFireTimes[(int32)Type] >= Cooldown;
+}
+
+void FDualSenseMotionGestureDetector::Fire(EDualSenseMotionGesture Gesture, TFunctionRef<void(EDualSenseMotionGesture)>& Emit)
+{
+	LastFireTimes[(int32)DualSenseMotionGesture::GetType(Gesture)] = Time;
+	Emit(Gesture);
+}
+
+void FDualSenseMotionGestureDetector::UpdateShake(const FDualSenseMotionGestureSettings& Settings, const FVector& Linear, TFunctionRef<void(EDualSenseMotionGesture)>& Emit)
+{
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		if (FMath::Abs(Linear[Axis]) < Settings.ShakeAcceleration)
+			continue;
+
+		//Only the first sample of every peak counts
+		const int8 Sign = Linear[Axis] > 0.f ? 1 : -1;
+		if (Sign == ShakeSigns[Axis])
+			continue;
+
+		const bool bContinues = ShakeSigns[Axis] != 0 && Time - ShakePeakTimes[Axis] <= Settings.ShakeReversalTime;
+		ShakePeaks[Axis] = bContinues ? ShakePeaks[Axis] + 1 : 1;
+		ShakeSigns[Axis] = Sign;
+		ShakePeakTimes[Axis] = Time;
+
+		if (ShakePeaks[Axis] > Settings.ShakeReversals && CanEmit(EDualSenseMotionGestureType::Shake, Settings.Cooldown))
+		{
+			//Starts over, a long shake fires again once it has enough new reversals
+			ShakePeaks[Axis] = 1;
+			Fire(EDualSenseMotionGesture::Shake, Emit);
+		}
+	}
+}
+
+bool FDualSenseMotionGestureDetector::IsShaking(float ShakeReversalTime) const
+{
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		if (ShakePeaks[Axis] > 1 && Time - ShakePeakTimes[Axis] <= ShakeReversalTime)
+			return true;
+	}
+	return false;
+}
+
+void FDualSenseMotionGestureDetector::UpdateTap(const FDualSenseMotionGestureSettings& Settings, const FVector& Linear, float RotationSpeed, float DeltaTime, TFunctionRef<void(EDualSenseMotionGesture)>& Emit)
+{
+	const float Magnitude = Linear.Size();
+
+	if (bTapSpike)
+	{
+		//Too long or turning : a move, not a knock on the shell
+		if (Time - TapSpikeStart > Settings.TapTime || RotationSpeed > Settings.TapMaxRotation)
+		{
+			bTapSpikeValid = false;
+		}
+
+		if (Magnitude < Settings.TapAcceleration * TapReleaseRatio)
+		{
+			bTapSpike = false;
+			if (bTapSpikeValid && !IsShaking(Settings.ShakeReversalTime) && CanEmit(EDualSenseMotionGestureType::Tap, Settings.Cooldown))
+			{
+				Fire(EDualSenseMotionGesture::Tap, Emit);
+			}
+		}
+		return;
+	}
+
+	if (Magnitude >= Settings.TapAcceleration)
+	{
+		bTapSpike = true;
+		bTapSpikeValid = TapQuietTime >= Settings.TapQuietTime && RotationSpeed <= Settings.TapMaxRotation;
+		TapSpikeStart = Time;
+		TapQuietTime = 0.f;
+	}
+	else if (Magnitude < Settings.TapAcceleration * TapReleaseRatio)
+	{
+		//In between holds it, the leading edge of a jolt usually lands there
+		TapQuietTime += DeltaTime;
+	}
+}
+
+void FDualSenseMotionGestureDetector::UpdateFlick(const FDualSenseMotionGestureSettings& Settings, const FVector2D& AimVelocity, float DeltaTime, TFunctionRef<void(EDualSenseMotionGesture)>& Emit)
+{
+	const float Speed = AimVelocity.Size();
+
+	if (Speed >= Settings.FlickSpeed * FlickReleaseRatio)
+	{
+		if (!bFlickActive)
+		{
+			bFlickActive = true;
+			FlickStart = Time;
+			FlickPeakSpeed = 0.f;
+			FlickRotation = FVector2D::ZeroVector;
+		}
+
+		FlickPeakSpeed = FMath::Max(FlickPeakSpeed, Speed);
+		FlickRotation += AimVelocity * DeltaTime;
+		return;
+	}
+
+	if (!bFlickActive)
+		return;
+
+	//Judged once the turn is over : fast enough, short enough, far enough
+	bFlickActive = false;
+	if (FlickPeakSpeed < Settings.FlickSpeed || Time - FlickStart > Settings.FlickTime || FlickRotation.Size() < Settings.FlickAngle
+		|| IsShaking(Settings.ShakeReversalTime) || !CanEmit(EDualSenseMotionGestureType::Flick, Settings.Cooldown))
+		return;
+
+	if (FMath::Abs(FlickRotation.X) >= FMath::Abs(FlickRotation.Y))
+	{
+		Fire(FlickRotation.X > 0.f ? EDualSenseMotionGesture::FlickRight : EDualSenseMotionGesture::FlickLeft, Emit);
+	}
+	else
+	{
+		Fire(FlickRotation.Y > 0.f ? EDualSenseMotionGesture::FlickDown : EDualSenseMotionGesture::FlickUp, Emit);
+	}
+}
+
+void FDualSenseMotionGestureDetector::UpdateSnap(const FDualSenseMotionGestureSettings& Settings, float DeltaTime, TFunctionRef<void(EDualSenseMotionGesture)>& Emit)
+{
+	const FVector Up = Gravity.GetSafeNormal();
+	const int32 Axis = FMath::Abs(Up.X) >= FMath::Abs(Up.Y) ? (FMath::Abs(Up.X) >= FMath::Abs(Up.Z) ? 0 : 2) : (FMath::Abs(Up.Y) >= FMath::Abs(Up.Z) ? 1 : 2);
+
+	//In between two faces counts as none
+	const int32 Candidate = FMath::Abs(Up[Axis]) >= FMath::Cos(FMath::DegreesToRadians(Settings.SnapAngle))
+		? (int32)Orientations[Axis][Up[Axis] > 0.f ? 0 : 1] : INDEX_NONE;
+
+	if (Candidate == INDEX_NONE || Candidate == Orientation)
+	{
+		PendingOrientation = INDEX_NONE;
+		PendingTime = 0.f;
+		return;
+	}
+
+	if (Candidate != PendingOrientation)
+	{
+		PendingOrientation = Candidate;
+		PendingTime = 0.f;
+		return;
+	}
+
+	PendingTime += DeltaTime;
+	if (PendingTime < Settings.SnapTime)
+		return;
+
+	//The orientation the controller starts in is not a snap
+	const bool bHadOrientation = Orientation != INDEX_NONE;
+	Orientation = Candidate;
+	PendingOrientation = INDEX_NONE;
+	PendingTime = 0.f;
+
+	if (bHadOrientation && CanEmit(EDualSenseMotionGestureType::OrientationSnap, Settings.Cooldown))
+	{
+		Fire((EDualSenseMotionGesture)Candidate, Emit);
+	}
+}
+#pragma endregion
@@ -0,0 +1,165 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseOutput.h"
+
+namespace
+{
+	constexpr uint32 OutputIndexMask = FDualSenseOutputQueue::Capacity - 1;
+	static_assert((FDualSenseOutputQueue::Capacity & OutputIndexMask) == 0, "Output queue capacity must be a power of two");
+
+	template <typename FieldType>
+	FORCEINLINE bool SetField(FieldType& Field, const FieldType& Value)
+	{
+		const bool bChanged = FMemory::Memcmp(&Field, &Value, sizeof(FieldType)) != 0;
+		Field = Value;
+		return bChanged;
+	}
+}
+
+#pragma region Dual Sense [Output Command]
+FDualSenseOutputCommand FDualSenseOutputCommand::MakeRumble(int32 ControllerId, bool bRight, uint8 Rumble)
+{
+	FDualSenseOutputCommand Command;
+	Command.ControllerId = ControllerId;
+	Command.Type = bRight ? EDualSenseOutputCommandType::RightRumble : EDualSenseOutputCommandType::LeftRumble;
+	Command.Rumble = Rumble;
+	return Command;
+}
+
+FDualSenseOutputCommand FDualSenseOutputCommand::MakeRumble(int32 ControllerId, uint8 LeftRumble, uint8 RightRumble)
+{
+	FDualSenseOutputCommand Command;
+	Command.ControllerId = ControllerId;
+	Command.Type = EDualSenseOutputCommandType::Rumble;
+	Command.Rumble = LeftRumble;
+	Command.RightRumble = RightRumble;
+	return Command;
+}
+
+FDualSenseOutputCommand FDualSenseOutputCommand::MakeLightBar(int32 ControllerId, FColor Color)
+{
+	FDualSenseOutputCommand Command;
+	Command.ControllerId = ControllerId;
+	Command.Type = EDualSenseOutputCommandType::LightBar;
+	Command.LightBar.r = Color.R;
+	Command.LightBar.g = Color.G;
+	Command.LightBar.b = Color.B;
+	return Command;
+}
+
+FDualSenseOutputCommand FDualSenseOutputCommand::MakePlayerLeds(int32 ControllerId, uint8 Bitmask, DS5W::LedBrightness Brightness, bool bFade)
+{
+	FDualSenseOutputCommand Command;
+	Command.ControllerId = ControllerId;
+	Command.Type = EDualSenseOutputCommandType::PlayerLeds;
+	Command.PlayerLeds.bitmask = Bitmask;
+	Command.PlayerLeds.brightness = Brightness;
+	Command.PlayerLeds.playerLedFade = bFade;
+	return Command;
+}
+
+FDualSenseOutputCommand FDualSenseOutputCommand::MakeTriggerEffect(int32 ControllerId, bool bRight, const DS5W::TriggerEffect& TriggerEffect)
+{
+	FDualSenseOutputCommand Command;
+	Command.ControllerId = ControllerId;
+	Command.Type = bRight ? EDualSenseOutputCommandType::RightTriggerEffect : EDualSenseOutputCommandType::LeftTriggerEffect;
+	Command.TriggerEffect = TriggerEffect;
+	return Command;
+}
+
+FDualSenseOutputCommand FDualSenseOutputCommand::MakeMicLed(int32 ControllerId, DS5W::MicLed MicLed)
+{
+	FDualSenseOutputCommand Command;
+	Command.ControllerId = ControllerId;
+	Command.Type = EDualSenseOutputCommandType::MicLed;
+	Command.MicLed = MicLed;
+	return Command;
+}
+
+bool FDualSenseOutputCommand::Apply(DS5W::DS5OutputState& OutState) const
+{
+	switch (Type)
+	{
+	case EDualSenseOutputCommandType::LeftRumble:
+		return SetField(OutState.leftRumble, Rumble);
+	case EDualSenseOutputCommandType::RightRumble:
+		return SetField(OutState.rightRumble, Rumble);
+	case EDualSenseOutputCommandType::Rumble:
+	{
+		//Both fields are set, whichever changed
+		const bool bLeftChanged = SetField(OutState.leftRumble, Rumble);
+		const bool bRightChanged = SetField(OutState.rightRumble, RightRumble);
+		return bLeftChanged || bRightChanged;
+	}
+	case EDualSenseOutputCommandType::LightBar:
+		return SetField(OutState.lightbar, LightBar);
+	case EDualSenseOutputCommandType::PlayerLeds:
+		return SetField(OutState.playerLeds, PlayerLeds);
+	case EDualSenseOutputCommandType::LeftTriggerEffect:
+		return SetField(OutState.leftTriggerEffect, TriggerEffect);
+	case EDualSenseOutputCommandType::RightTriggerEffect:
+		return SetField(OutState.rightTriggerEffect, TriggerEffect);
+	case EDualSenseOutputCommandType::MicLed:
+		return SetField(OutState.microphoneLed, MicLed);
+	default:
+		return false;
+	}
+}
+#pragma endregion
+
+#pragma region Dual Sense [Output Queue]
+FDualSenseOutputQueue::FDualSenseOutputQueue()
+{
+	for (uint32 Index = 0; Index < Capacity; ++Index)
+	{
+		Cells[Index].Sequence.store(Index, std::memory_order_relaxed);
+	}
+}
+
+bool FDualSenseOutputQueue::Enqueue(const FDualSenseOutputCommand& Command)
+{
+	uint32 Position = EnqueuePosition.load(std::memory_order_relaxed);
+	FCell* Cell = nullptr;
+	for (;;)
+	{
+		Cell = &Cells[Position & OutputIndexMask];
+		const int32 Distance = (int32)(Cell->Sequence.load(std::memory_order_acquire) - Position);
+		if (Distance == 0)
+		{
+			//Claim the position, another producer may have taken it first
+			if (EnqueuePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (Distance < 0)
+		{
+			//The cell still holds a command from a lap ago
+			return false;
+		}
+		else
+		{
+			Position = EnqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	Cell->Command = Command;
+	Cell->Sequence.store(Position + 1, std::memory_order_release);
+	return true;
+}
+
+bool FDualSenseOutputQueue::Dequeue(FDualSenseOutputCommand& OutCommand)
+{
+	FCell& Cell = Cells[DequeuePosition & OutputIndexMask];
+	if ((int32)(Cell.Sequence.load(std::memory_order_acquire) - (DequeuePosition + 1)) < 0)
+	{
+		return false;
+	}
+
+	OutCommand = Cell.Command;
+	//Free for the producer one lap ahead
+	Cell.Sequence.store(DequeuePosition + Capacity, std::memory_order_release);
+	++DequeuePosition;
+	return true;
+}
+#pragma endregion
@@ -0,0 +1,180 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSensePointer.h"
+
+namespace
+{
+	//Longer gaps are reconnects or dropped bursts, not a finger to integrate
+	constexpr float MaxSampleDeltaTime = 0.1f;
+
+	//Low 7 bits of a contact byte, a new number for every finger that lands
+	constexpr uint8 TouchIdMask = 0x7F;
+
+	FORCEINLINE FVector2D GetTouchPosition(const DS5W::Touch& Touch)
+	{
+		return FVector2D((float)Touch.x, (float)Touch.y);
+	}
+}
+
+#pragma region Dual Sense [Touch Pointer]
+FDualSenseTouchPointer::FDualSenseTouchPointer()
+{
+	Reset();
+}
+
+void FDualSenseTouchPointer::Reset()
+{
+	bHasLastSample = false;
+	LastSensorTimestamp = 0;
+
+	bIsTouching = false;
+	TouchContact = DualSenseReport::NoTouchContact;
+	LastPosition = FVector2D::ZeroVector;
+
+	TouchStartPosition = FVector2D::ZeroVector;
+	TouchTime = 0.f;
+	bIsTap = false;
+
+	bIsClicking = false;
+	ClickRelease = EDualSensePointerClick::LeftUp;
+
+	PointerDelta = FVector2D::ZeroVector;
+	ClickCount = 0;
+	PendingReleases = 0;
+	bSkippedPress[0] = false;
+	bSkippedPress[1] = false;
+}
+
+void FDualSenseTouchPointer::AddSample(const FDualSenseInputReport& Report)
+{
+	if (!Settings.bEnabled)
+	{
+		//Never leave a button down behind
+		if (bIsClicking)
+		{
+			AddClick(ClickRelease);
+			bIsClicking = false;
+		}
+		bIsTouching = false;
+		bHasLastSample = false;
+		return;
+	}
+
+	float DeltaTime = 0.f;
+	if (bHasLastSample)
+	{
+		DeltaTime = (float)((double)(Report.SensorTimestamp - LastSensorTimestamp) / DualSenseReport::SensorTicksPerSecond);
+	}
+	const bool bValidDelta = DeltaTime > 0.f && DeltaTime <= MaxSampleDeltaTime;
+
+	bHasLastSample = true;
+	LastSensorTimestamp = Report.SensorTimestamp;
+
+	//Touchpad press, on the physical button whatever it is remapped to : right click while a second finger is down
+	const bool bPressed = (Report.State.buttonsB & DS5W_ISTATE_BTN_B_PAD_BUTTON) != 0;
+	if (bPressed && !bIsClicking)
+	{
+		const bool bRightClick = DualSenseReport::IsTouching(Report.TouchContacts[1]);
+		AddClick(bRightClick ? EDualSensePointerClick::RightDown : EDualSensePointerClick::LeftDown);
+		ClickRelease = bRightClick ? EDualSensePointerClick::RightUp : EDualSensePointerClick::LeftUp;
+		bIsClicking = true;
+		bIsTap = false;
+	}
+	else if (!bPressed && bIsClicking)
+	{
+		AddClick(ClickRelease);
+		bIsClicking = false;
+	}
+
+	const uint8 Contact = Report.TouchContacts[0];
+	const bool bTouching = DualSenseReport::IsTouching(Contact);
+	const bool bSameTouch = bTouching && bIsTouching && (Contact & TouchIdMask) == (TouchContact & TouchIdMask);
+	const FVector2D Position = GetTouchPosition(Report.State.touchPoint1);
+
+	//Lifted, or lifted and landed again between two reports
+	if (bIsTouching && !bSameTouch)
+	{
+		if (bIsTap && Settings.bTapToClick && TouchTime <= Settings.TapTime)
+		{
+			AddClick(EDualSensePointerClick::LeftDown);
+			AddClick(EDualSensePointerClick::LeftUp);
+		}
+	}
+
+	if (bSameTouch)
+	{
+		if (bValidDelta)
+		{
+			const FVector2D Move = Position - LastPosition;
+			const float Speed = Move.Size() / DeltaTime;
+
+			const float SensitivityAlpha = FMath::Clamp(FMath::GetRangePct(Settings.MinSensitivitySpeed, Settings.MaxSensitivitySpeed, Speed), 0.f, 1.f);
+			const float Sensitivity = FMath::Lerp(Settings.MinSensitivity, Settings.MaxSensitivity, FMath::Pow(SensitivityAlpha, FMath::Max(Settings.CurveExponent, KINDA_SMALL_NUMBER)));
+
+			PointerDelta += Move * Sensitivity;
+			TouchTime += DeltaTime;
+		}
+
+		if (FVector2D::DistSquared(Position, TouchStartPosition) > FMath::Square(Settings.TapDistance))
+		{
+			bIsTap = false;
+		}
+	}
+	else if (bTouching)
+	{
+		TouchStartPosition = Position;
+		TouchTime = 0.f;
+		bIsTap = !bIsClicking;
+	}
+
+	bIsTouching = bTouching;
+	TouchContact = Contact;
+	LastPosition = Position;
+}
+
+FIntPoint FDualSenseTouchPointer::ConsumeDelta()
+{
+	const FIntPoint Pixels(FMath::TruncToInt(PointerDelta.X), FMath::TruncToInt(PointerDelta.Y));
+	PointerDelta -= FVector2D(Pixels.X, Pixels.Y);
+	return Pixels;
+}
+
+int32 FDualSenseTouchPointer::ConsumeClicks(EDualSensePointerClick (&OutClicks)[MaxPendingClicks])
+{
+	const int32 Count = ClickCount;
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		OutClicks[Index] = Clicks[Index];
+	}
+	ClickCount = 0;
+	return Count;
+}
+
+void FDualSenseTouchPointer::AddClick(EDualSensePointerClick Click)
+{
+	const bool bPress = Click == EDualSensePointerClick::LeftDown || Click == EDualSensePointerClick::RightDown;
+	const int32 Button = Click == EDualSensePointerClick::LeftDown || Click == EDualSensePointerClick::LeftUp ? 0 : 1;
+
+	if (bPress)
+	{
+		//Only with room for itself, its release and every release still owed, a stuck mouse button is worse than a lost click
+		if (ClickCount + PendingReleases + 2 > MaxPendingClicks)
+		{
+			bSkippedPress[Button] = true;
+			return;
+		}
+		++PendingReleases;
+	}
+	else
+	{
+		if (bSkippedPress[Button])
+		{
+			bSkippedPress[Button] = false;
+			return;
+		}
+		PendingReleases = FMath::Max(PendingReleases - 1, 0);
+	}
+
+	Clicks[ClickCount++] = Click;
+}
+#pragma endregion
@@ -0,0 +1,107 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseRemap.h"
+#include "WinDualSensePCH.h"
+
+namespace
+{
+	//Same order as EDualSenseButtonType
+	const TCHAR* ButtonNames[] =
+	{
+		TEXT("TRIANGLE"), TEXT("CROSS"), TEXT("SQUARE"), TEXT("CIRCLE"),
+		TEXT("DPAD_UP"), TEXT("DPAD_DOWN"), TEXT("DPAD_LEFT"), TEXT("DPAD_RIGHT"),
+		TEXT("BUMPER_LEFT"), TEXT("BUMPER_RIGHT"),
+		TEXT("TRIGGER_LEFT"), TEXT("TRIGGER_RIGHT"),
+		TEXT("LEFT_STICK_PUSH"), TEXT("RIGHT_STICK_PUSH"),
+		TEXT("SELECT"), TEXT("MENU"), TEXT("PLAYSTATION_LOGO"), TEXT("TOUCHPAD"), TEXT("MIC")
+	};
+	static_assert(UE_ARRAY_COUNT(ButtonNames) == FDualSenseButtonRemap::ButtonCount, "Button names out of sync with EDualSenseButtonType");
+}
+
+#pragma region Dual Sense [Button Remap]
+void FDualSenseButtonRemap::Map(EDualSenseButtonType Physical, EDualSenseButtonType Logical)
+{
+	const uint32 PhysicalMask = 1u << (uint32)Physical;
+	const uint32 LogicalMask = 1u << (uint32)Logical;
+	DestinationMasks[(int32)Physical] = (MappedButtons & PhysicalMask) ? DestinationMasks[(int32)Physical] | LogicalMask : LogicalMask;
+	MappedButtons |= PhysicalMask;
+}
+
+void FDualSenseButtonRemap::Swap(EDualSenseButtonType First, EDualSenseButtonType Second)
+{
+	Exchange(DestinationMasks[(int32)First], DestinationMasks[(int32)Second]);
+}
+
+void FDualSenseButtonRemap::Disable(EDualSenseButtonType Physical)
+{
+	DestinationMasks[(int32)Physical] = 0;
+}
+
+bool FDualSenseButtonRemap::Compile(const TCHAR* Mapping)
+{
+	Reset();
+
+	TArray<FString> Operations;
+	FString(Mapping).Replace(TEXT(","), TEXT(" ")).ParseIntoArrayWS(Operations);
+
+	for (const FString& Operation : Operations)
+	{
+		FString Left;
+		FString Right;
+
+		if (Operation.StartsWith(TEXT("-")))
+		{
+			const EDualSenseButtonType Physical = FindButton(Operation.RightChop(1));
+			if (Physical == EDualSenseButtonType::MAX_COUNT)
+			{
+				UE_LOG(LogWinDualSense, Warning, TEXT("Unknown DualSense Button [%s]"), *Operation);
+				return false;
+			}
+			Disable(Physical);
+		}
+		else if (Operation.Split(TEXT("<>"), &Left, &Right) || Operation.Split(TEXT("="), &Left, &Right))
+		{
+			const EDualSenseButtonType First = FindButton(Left);
+			const EDualSenseButtonType Second = FindButton(Right);
+			if (First == EDualSenseButtonType::MAX_COUNT || Second == EDualSenseButtonType::MAX_COUNT)
+			{
+				UE_LOG(LogWinDualSense, Warning, TEXT("Unknown DualSense Button [%s]"), *Operation);
+				return false;
+			}
+
+			if (Operation.Contains(TEXT("<>")))
+			{
+				Swap(First, Second);
+			}
+			else
+			{
+				Map(First, Second);
+			}
+		}
+		else
+		{
+			UE_LOG(LogWinDualSense, Warning, TEXT("Unknown DualSense Remap Operation [%s]"), *Operation);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+const TCHAR* FDualSenseButtonRemap::GetButtonName(EDualSenseButtonType Button)
+{
+	return Button < EDualSenseButtonType::MAX_COUNT ? ButtonNames[(int32)Button] : TEXT("NONE");
+}
+
+EDualSenseButtonType FDualSenseButtonRemap::FindButton(const FString& Name)
+{
+	for (int32 Index = 0; Index < ButtonCount; ++Index)
+	{
+		if (Name.Equals(ButtonNames[Index], ESearchCase::IgnoreCase))
+		{
+			return (EDualSenseButtonType)Index;
+		}
+	}
+	return EDualSenseButtonType::MAX_COUNT;
+}
+#pragma endregion
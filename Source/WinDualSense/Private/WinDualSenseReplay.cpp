@@ -0,0 +1,816 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseReplay.h"
+#include "WinDualSensePCH.h"
+#include "WinDualSenseDevice.h"
+#include "WinDualSenseOutput.h"
+#include "WinDualSenseScope.h"
+#include "WinDualSenseCalibration.h"
+#include "WinDualSenseSharedLayout.h"
+#include "HAL/RunnableThread.h"
+#include <Kismet/KismetMathLibrary.h>
+
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <Windows.h>
+#include "WinDualSenseSharedReader.h"
+#include "Windows/HideWindowsPlatformTypes.h"
+
+namespace
+{
+	FORCEINLINE float HalfSine(double Time, double Start, double Duration)
+	{
+		return Time >= Start && Time < Start + Duration ? FMath::Sin(PI * (float)((Time - Start) / Duration)) : 0.f;
+	}
+
+	//What FDualSenseAnalogData dispatches for one stick, true when anything leaves the deadzone
+	bool IsStickActive(const FDualSenseStickSample& Sample, const FVector2D& Center, float DeadZoneRatio)
+	{
+		const float X = (Sample.X - Center.X + 128.f) * (2.f / 255.f) - 1.f;
+		const float Y = (Sample.Y - Center.Y + 128.f) * (2.f / 255.f) - 1.f;
+		return !FMath::IsWithinInclusive(X, -DeadZoneRatio, DeadZoneRatio) || !FMath::IsWithinInclusive(Y, -DeadZoneRatio, DeadZoneRatio);
+	}
+}
+
+#pragma region Dual Sense [Replay]
+void DualSenseReplay::MakeGyroRecording(float Seconds, int32 ReportRate, TArray<FDualSenseInputReport>& OutReports)
+{
+	FRandomStream Random(0x5D5);
+	const int32 ReportCount = FMath::CeilToInt(Seconds * ReportRate);
+	OutReports.SetNumZeroed(ReportCount);
+
+	double SensorTime = 0.0;
+	for (int32 Index = 0; Index < ReportCount; ++Index)
+	{
+		FDualSenseInputReport& Report = OutReports[Index];
+		const float Time = (float)SensorTime;
+
+		float YawSpeed = 0.f;
+		float PitchSpeed = 0.f;
+		if (Time > 1.5f)
+		{
+			YawSpeed = 120.f * FMath::Sin(2.f * PI * 0.5f * Time);
+			PitchSpeed = 3.f * FMath::Sin(2.f * PI * 0.3f * Time);
+		}
+
+		Report.Gyroscope.x = (short)FMath::RoundToInt(5.f + PitchSpeed * DualSenseReport::GyroCountsPerDegreePerSecond + Random.FRandRange(-2.f, 2.f));
+		Report.Gyroscope.y = (short)FMath::RoundToInt(-3.f + YawSpeed * DualSenseReport::GyroCountsPerDegreePerSecond + Random.FRandRange(-2.f, 2.f));
+		Report.Gyroscope.z = (short)FMath::RoundToInt(2.f + Random.FRandRange(-2.f, 2.f));
+		Report.Accelerometer.y = (short)DualSenseReport::AccelCountsPerG;
+
+		Report.State.buttonsAndDpad = (Time > 6.f && Time < 7.f) ? DS5W_ISTATE_BTX_CROSS : 0;
+		Report.Buttons = DualSenseReport::PackButtons(Report.State);
+
+		Report.Sequence = (uint8)Index;
+		Report.SensorTimestamp = (uint32)(SensorTime * DualSenseReport::SensorTicksPerSecond);
+		SensorTime += Random.FRandRange(0.9f, 1.1f) / ReportRate;
+	}
+}
+
+void DualSenseReplay::MakeSessionRecording(float Seconds, int32 ReportRate, TArray<FDualSenseInputReport>& OutReports)
+{
+	MakeGyroRecording(Seconds, ReportRate, OutReports);
+
+	for (int32 Index = 0; Index < OutReports.Num(); ++Index)
+	{
+		FDualSenseInputReport& Report = OutReports[Index];
+		const float Time = (float)Index / ReportRate;
+		Report.State.leftStick.x = (char)FMath::RoundToInt(100.f * FMath::Sin(2.f * PI * 0.4f * Time));
+		Report.State.leftStick.y = (char)FMath::RoundToInt(60.f * FMath::Cos(2.f * PI * 0.4f * Time));
+		Report.State.rightTrigger = (unsigned char)FMath::RoundToInt(127.5f + 127.5f * FMath::Sin(2.f * PI * 0.7f * Time));
+		Report.State.touchPoint1.x = (unsigned int)(960 + FMath::RoundToInt(600.f * FMath::Sin(2.f * PI * 0.2f * Time)));
+		Report.State.touchPoint1.y = 500;
+		Report.State.battery.level = 8;
+		Report.Accelerometer.x = (short)(Index % 7 - 3);
+		Report.Accelerometer.z = (short)(Index % 5 - 2);
+		Report.Buttons = DualSenseReport::PackButtons(Report.State);
+	}
+}
+
+void DualSenseReplay::MakeTapRecording(float Seconds, int32 ReportRate, TArray<FDualSenseInputReport>& OutReports)
+{
+	struct FTap
+	{
+		uint32 Button;
+		double Start;
+		double End;
+	};
+
+	static const FTap Taps[] =
+	{
+		{ DS5W_ISTATE_BTX_CROSS, 0.0, 4.0 },
+		{ DS5W_ISTATE_BTX_CROSS, 50.0, 58.0 },
+		{ DS5W_ISTATE_BTX_CROSS, 100.0, 112.0 },
+		{ DS5W_ISTATE_BTX_CROSS, 150.0, 180.0 },
+		{ DS5W_ISTATE_BTX_CROSS, 200.0, 300.0 },
+		{ DS5W_ISTATE_BTX_CIRCLE, 250.0, 320.0 },
+		{ DS5W_ISTATE_BTX_CROSS, 340.0, 344.0 },
+		{ DS5W_ISTATE_BTX_CROSS, 350.0, 354.0 }
+	};
+
+	const int32 ReportCount = FMath::CeilToInt(Seconds * ReportRate);
+	OutReports.SetNumZeroed(ReportCount);
+
+	for (int32 Index = 0; Index < ReportCount; ++Index)
+	{
+		FDualSenseInputReport& Report = OutReports[Index];
+		const double CycleTime = FMath::Fmod(Index * 1000.0 / ReportRate, 400.0);
+
+		for (const FTap& Tap : Taps)
+		{
+			if (Index < ReportCount - 1 && CycleTime >= Tap.Start && CycleTime < Tap.End)
+			{
+				Report.State.buttonsAndDpad |= Tap.Button;
+			}
+		}
+
+		Report.Sequence = (uint8)Index;
+		Report.SensorTimestamp = (uint32)((Index + 1) * DualSenseReport::SensorTicksPerSecond / ReportRate);
+		Report.Buttons = DualSenseReport::PackButtons(Report.State);
+	}
+}
+
+void DualSenseReplay::MakeTapSessionRecording(float Seconds, int32 ReportRate, TArray<FDualSenseInputReport>& OutReports)
+{
+	TArray<FDualSenseInputReport> Taps;
+	MakeSessionRecording(Seconds, ReportRate, OutReports);
+	MakeTapRecording(Seconds, ReportRate, Taps);
+	for (int32 Index = 0; Index < OutReports.Num() && Index < Taps.Num(); ++Index)
+	{
+		FDualSenseInputReport& Report = OutReports[Index];
+		Report.State.buttonsAndDpad = Taps[Index].State.buttonsAndDpad;
+		Report.Buttons = DualSenseReport::PackButtons(Report.State);
+	}
+}
+
+void DualSenseReplay::MakePointerRecording(float Seconds, int32 ReportRate, TArray<FDualSenseInputReport>& OutReports)
+{
+	FRandomStream Random(0x70C4);
+	const int32 ReportCount = FMath::CeilToInt(Seconds * ReportRate);
+	OutReports.SetNumZeroed(ReportCount);
+
+	for (int32 Index = 0; Index < ReportCount; ++Index)
+	{
+		FDualSenseInputReport& Report = OutReports[Index];
+		//Jitter around the nominal interval that never adds up, so every second holds its gestures
+		const double SensorTime = ((double)Index + Random.FRandRange(-0.1f, 0.1f)) / ReportRate + 0.001;
+		const int32 Cycle = (int32)SensorTime;
+		const float Time = (float)(SensorTime - Cycle);
+
+		//Segment the finger belongs to, a new touch id for each
+		int32 Segment = INDEX_NONE;
+		FVector2D Position(900.f, 500.f);
+		if (Time < 0.3f)
+		{
+			Segment = 0;
+			Position = FVector2D(FMath::InterpEaseInOut(200.f, 1700.f, Time / 0.3f, 2.f), 500.f);
+		}
+		else if (Time >= 0.4f && Time < 0.7f)
+		{
+			Segment = 1;
+			Position = FVector2D(900.f, FMath::Lerp(300.f, 500.f, (Time - 0.4f) / 0.3f));
+		}
+		else if (Time >= 0.75f && Time < 0.85f)
+		{
+			Segment = 2;
+			Position = FVector2D(1200.f + Random.RandRange(-2, 2), 700.f + Random.RandRange(-2, 2));
+		}
+		else if (Time >= 0.88f && Time < 0.98f)
+		{
+			Segment = 3;
+			Position = FVector2D(1000.f, 800.f);
+		}
+
+		if (Index == ReportCount - 1)
+		{
+			Segment = INDEX_NONE;
+		}
+
+		Report.TouchContacts[0] = Segment != INDEX_NONE ? (uint8)((Cycle * 4 + Segment) & 0x7F) : DualSenseReport::NoTouchContact;
+		Report.TouchContacts[1] = DualSenseReport::NoTouchContact;
+		Report.State.touchPoint1.x = (unsigned int)FMath::RoundToInt(Position.X);
+		Report.State.touchPoint1.y = (unsigned int)FMath::RoundToInt(Position.Y);
+
+		if (Segment == 3 && Time >= 0.9f && Time < 0.95f)
+		{
+			Report.State.buttonsB = DS5W_ISTATE_BTN_B_PAD_BUTTON;
+			if (Cycle % 2 == 1)
+			{
+				Report.TouchContacts[1] = (uint8)((Cycle * 4 + 3) & 0x7F) | 0x40;
+				Report.State.touchPoint2.x = 1400;
+				Report.State.touchPoint2.y = 800;
+			}
+		}
+
+		Report.Sequence = (uint8)Index;
+		Report.SensorTimestamp = (uint32)(SensorTime * DualSenseReport::SensorTicksPerSecond);
+		Report.Buttons = DualSenseReport::PackButtons(Report.State);
+	}
+}
+
+void DualSenseReplay::MakeMotionRecording(int32 ReportRate, TArray<FDualSenseInputReport>& OutReports, TArray<FDualSenseScriptedMotionGesture>& OutGestures)
+{
+	OutGestures =
+	{
+		{ EDualSenseMotionGesture::Tap, 1.0, 1.03 },
+		{ EDualSenseMotionGesture::Tap, 1.5, 1.53 },
+		{ EDualSenseMotionGesture::FlickRight, 3.0, 3.12 },
+		{ EDualSenseMotionGesture::FlickLeft, 3.6, 3.72 },
+		{ EDualSenseMotionGesture::FlickUp, 4.2, 4.32 },
+		{ EDualSenseMotionGesture::FlickDown, 4.8, 4.92 },
+		{ EDualSenseMotionGesture::Shake, 5.5, 6.1 },
+		{ EDualSenseMotionGesture::RightSideUp, 7.0, 7.5 },
+		{ EDualSenseMotionGesture::FaceUp, 8.0, 8.5 },
+		{ EDualSenseMotionGesture::TopUp, 9.0, 9.5 },
+		{ EDualSenseMotionGesture::FaceUp, 10.0, 10.5 }
+	};
+
+	FRandomStream Random(0x3071);
+	const int32 ReportCount = FMath::CeilToInt(11.5f * ReportRate);
+	OutReports.SetNumZeroed(ReportCount);
+
+	FQuat Orientation = FQuat::Identity;
+	double LastTime = 0.0;
+	for (int32 Index = 0; Index < ReportCount; ++Index)
+	{
+		const double Time = ((double)Index + Random.FRandRange(-0.1f, 0.1f)) / ReportRate + 0.001;
+		const float DeltaTime = (float)(Time - LastTime);
+		LastTime = Time;
+
+		//Gyro axes in deg/s (flick right is a negative Y rate, flick down a negative X rate), linear acceleration in g
+		FVector AngularVelocity = FVector::ZeroVector;
+		FVector Linear = FVector::ZeroVector;
+
+		Linear.Y += 1.5f * HalfSine(Time, 1.0, 0.016) - 0.5f * HalfSine(Time, 1.016, 0.01);
+		Linear.Y += 1.5f * HalfSine(Time, 1.5, 0.016) - 0.5f * HalfSine(Time, 1.516, 0.01);
+
+		AngularVelocity.Y -= Time >= 2.0 && Time < 2.8 ? 60.f : 0.f;
+		Linear.Z += 0.4f * HalfSine(Time, 2.3, 0.2);
+
+		AngularVelocity.Y += -600.f * HalfSine(Time, 3.0, 0.12) + 600.f * HalfSine(Time, 3.6, 0.12);
+		AngularVelocity.X += 600.f * HalfSine(Time, 4.2, 0.12) - 600.f * HalfSine(Time, 4.8, 0.12);
+
+		Linear.X += Time >= 5.5 && Time < 6.1 ? 2.5f * FMath::Sin(2.f * PI * 6.f * (float)(Time - 5.5)) : 0.f;
+
+		AngularVelocity.Z += (Time >= 7.0 && Time < 7.5) ? 180.f : ((Time >= 8.0 && Time < 8.5) ? -180.f : 0.f);
+		AngularVelocity.X += (Time >= 9.0 && Time < 9.5) ? 180.f : ((Time >= 10.0 && Time < 10.5) ? -180.f : 0.f);
+
+		const float Speed = AngularVelocity.Size();
+		if (Speed > 0.f)
+		{
+			Orientation = Orientation * FQuat(AngularVelocity / Speed, FMath::DegreesToRadians(Speed) * DeltaTime);
+		}
+		const FVector Up = Orientation.UnrotateVector(FVector(0.f, 1.f, 0.f));
+
+		FDualSenseInputReport& Report = OutReports[Index];
+		const FVector Gyro = (AngularVelocity + FVector(3.f, -2.f, 1.f) + FVector(Random.FRandRange(-1.f, 1.f), Random.FRandRange(-1.f, 1.f), Random.FRandRange(-1.f, 1.f))) * DualSenseReport::GyroCountsPerDegreePerSecond;
+		const FVector Accel = (Up + Linear + FVector(Random.FRandRange(-0.01f, 0.01f), Random.FRandRange(-0.01f, 0.01f), Random.FRandRange(-0.01f, 0.01f))) * DualSenseReport::AccelCountsPerG;
+		Report.Gyroscope.x = (short)FMath::RoundToInt(Gyro.X);
+		Report.Gyroscope.y = (short)FMath::RoundToInt(Gyro.Y);
+		Report.Gyroscope.z = (short)FMath::RoundToInt(Gyro.Z);
+		Report.Accelerometer.x = (short)FMath::RoundToInt(Accel.X);
+		Report.Accelerometer.y = (short)FMath::RoundToInt(Accel.Y);
+		Report.Accelerometer.z = (short)FMath::RoundToInt(Accel.Z);
+
+		Report.Sequence = (uint8)Index;
+		Report.SensorTimestamp = (uint32)(Time * DualSenseReport::SensorTicksPerSecond);
+	}
+}
+
+void DualSenseReplay::MakeStickSamples(const FDualSenseStickProfile& Profile, float Seconds, int32 ReportRate, TArray<FDualSenseStickSample>& OutSamples)
+{
+	FRandomStream Random(0xD71F7);
+	const int32 SampleCount = FMath::CeilToInt(Seconds * ReportRate);
+	OutSamples.SetNumUninitialized(SampleCount);
+
+	auto Gaussian = [&Random]()
+	{
+		const float U = FMath::Max(Random.GetFraction(), KINDA_SMALL_NUMBER);
+		return FMath::Sqrt(-2.f * FMath::Loge(U)) * FMath::Cos(2.f * PI * Random.GetFraction());
+	};
+
+	FVector2D RestOffset = FVector2D::ZeroVector;
+	FVector2D HoldDirection = FVector2D(1.f, 0.f);
+	EDualSenseStickPhase LastPhase = EDualSenseStickPhase::Sweep;
+
+	for (int32 Index = 0; Index < SampleCount; ++Index)
+	{
+		const float Time = (float)Index / ReportRate;
+		const float CycleTime = FMath::Fmod(Time, 3.5f);
+		const EDualSenseStickPhase Phase = CycleTime < 2.f ? EDualSenseStickPhase::Rest : (CycleTime < 3.f ? EDualSenseStickPhase::Sweep : EDualSenseStickPhase::Hold);
+
+		//New release, new landing spot / new held direction
+		if (Phase != LastPhase)
+		{
+			RestOffset = FVector2D(Gaussian(), Gaussian()) * Profile.ReleaseScatter;
+			const float Angle = Random.FRandRange(0.f, 2.f * PI);
+			HoldDirection = FVector2D(FMath::Cos(Angle), FMath::Sin(Angle));
+			LastPhase = Phase;
+		}
+
+		FDualSenseStickSample& Sample = OutSamples[Index];
+		Sample.Phase = Phase;
+		Sample.Center = FMath::Lerp(Profile.StartCenter, Profile.EndCenter, Time / Seconds);
+
+		FVector2D Position = Sample.Center + FVector2D(Gaussian(), Gaussian()) * Profile.Noise;
+		switch (Phase)
+		{
+		case EDualSenseStickPhase::Rest:
+			Position += RestOffset;
+			break;
+		case EDualSenseStickPhase::Sweep:
+			Position = FVector2D(110.f * FMath::Sin(2.f * PI * 1.3f * Time), 110.f * FMath::Cos(2.f * PI * 0.9f * Time));
+			break;
+		case EDualSenseStickPhase::Hold:
+			Position += HoldDirection * (0.15f * 127.5f);
+			break;
+		}
+
+		Sample.X = (int8)FMath::Clamp(FMath::RoundToInt(Position.X), -128, 127);
+		Sample.Y = (int8)FMath::Clamp(FMath::RoundToInt(Position.Y), -128, 127);
+	}
+}
+
+void DualSenseReplay::MakeDispatchedInputs(int32 Frames, TArray<FDualSenseDispatchedInput>& OutInputs)
+{
+	OutInputs.SetNumUninitialized(Frames);
+	for (int32 Frame = 0; Frame < Frames; ++Frame)
+	{
+		FDualSenseDispatchedInput& Input = OutInputs[Frame];
+		const float Time = Frame / 60.f;
+		const float StickX = FMath::Sin(2.f * PI * 0.5f * Time);
+		Input.Buttons = (Frame / 20) % 2 == 0 ? DualSenseReport::GetButtonMask(EDualSenseButtonType::CROSS) : 0;
+		Input.LeftStick = FVector2D(FMath::Abs(StickX) > 0.25f ? StickX : 0.f, 0.f);
+		Input.RightStick = FVector2D(0.f, FMath::Cos(2.f * PI * 0.2f * Time) > 0.9f ? 1.f : 0.f);
+		Input.Triggers[0] = 0.f;
+		Input.Triggers[1] = FMath::Max(0.f, FMath::Sin(2.f * PI * 0.3f * Time));
+	}
+}
+
+void DualSenseReplay::MakeBankInputs(int32 InputFrames, TArray<FDualSenseBankInput>& OutInputs, FDualSenseCalibration* OutCalibrations, FVector* OutGyroBiases)
+{
+	constexpr int32 MaxControllers = FDualSenseIOThread::MaxDevices;
+
+	OutInputs.SetNumZeroed(InputFrames * MaxControllers);
+	for (int32 Controller = 0; Controller < MaxControllers; ++Controller)
+	{
+		OutCalibrations[Controller] = FDualSenseCalibration();
+		OutCalibrations[Controller].LeftStickCenter = FVector2D(Controller % 3 - 1.f, 0.5f);
+		OutCalibrations[Controller].TriggerRest = FVector2D(Controller % 4, 1.f);
+		OutGyroBiases[Controller] = FVector(Controller, -Controller, 2.f);
+
+		for (int32 Frame = 0; Frame < InputFrames; ++Frame)
+		{
+			FDualSenseBankInput& Input = OutInputs[Frame * MaxControllers + Controller];
+			const float Phase = 2.f * PI * (Frame + Controller * 5) / InputFrames;
+			Input.State.leftStick.x = (char)FMath::RoundToInt(120.f * FMath::Sin(Phase));
+			Input.State.leftStick.y = (char)FMath::RoundToInt(120.f * FMath::Cos(Phase));
+			Input.State.rightStick.x = (char)FMath::RoundToInt(60.f * FMath::Sin(2.f * Phase));
+			Input.State.leftTrigger = (unsigned char)FMath::RoundToInt(127.5f + 127.5f * FMath::Sin(Phase));
+			Input.State.rightTrigger = (unsigned char)(Frame * 4);
+			Input.Buttons = ((uint32)(Frame + Controller) * 0x9E3779B9u) & ((1u << (uint32)EDualSenseButtonType::MAX_COUNT) - 1);
+			Input.Report.Gyroscope.x = (short)(Frame * 37 - 1000);
+			Input.Report.Gyroscope.y = (short)(Controller * 11);
+			Input.Report.Gyroscope.z = (short)(-Frame * 5);
+			Input.Report.Accelerometer.y = 8192;
+		}
+	}
+}
+
+float DualSenseReplay::DecodeAnalog(EDualSenseAnalogType Type, const DS5W::DS5InputState& State, const FDualSenseCalibration& Calibration)
+{
+	switch (Type)
+	{
+	case EDualSenseAnalogType::LEFT_STICK_X:
+		return UKismetMathLibrary::MapRangeClamped(static_cast<float>((int)State.leftStick.x) - Calibration.LeftStickCenter.X, -128.f, 127.f, -1.f, 1.f);
+	case EDualSenseAnalogType::LEFT_STICK_Y:
+		return UKismetMathLibrary::MapRangeClamped(static_cast<float>((int)State.leftStick.y) - Calibration.LeftStickCenter.Y, -128.f, 127.f, -1.f, 1.f);
+	case EDualSenseAnalogType::RIGHT_STICK_X:
+		return UKismetMathLibrary::MapRangeClamped(static_cast<float>((int)State.rightStick.x) - Calibration.RightStickCenter.X, -128.f, 127.f, -1.f, 1.f);
+	case EDualSenseAnalogType::RIGHT_STICK_Y:
+		return UKismetMathLibrary::MapRangeClamped(static_cast<float>((int)State.rightStick.y) - Calibration.RightStickCenter.Y, -128.f, 127.f, -1.f, 1.f);
+	case EDualSenseAnalogType::LEFT_TRIGGER:
+		return UKismetMathLibrary::MapRangeClamped(static_cast<float>((int)State.leftTrigger), Calibration.TriggerRest.X, Calibration.GetTriggerFullPull(false), 0.f, 1.f);
+	case EDualSenseAnalogType::RIGHT_TRIGGER:
+		return UKismetMathLibrary::MapRangeClamped(static_cast<float>((int)State.rightTrigger), Calibration.TriggerRest.Y, Calibration.GetTriggerFullPull(true), 0.f, 1.f);
+	default:
+		return 0.f;
+	}
+}
+
+FVector DualSenseReplay::DecodeVector(EDualSenseVectorType Type, const FDualSenseInputReport& Report, const FVector& GyroBias)
+{
+	if (Type == EDualSenseVectorType::GYROSCOPE)
+	{
+		return (FVector(Report.Gyroscope.x, Report.Gyroscope.y, Report.Gyroscope.z) - GyroBias) / DualSenseReport::GyroCountsPerDegreePerSecond;
+	}
+	return FVector(Report.Accelerometer.x, Report.Accelerometer.y, Report.Accelerometer.z) / DualSenseReport::AccelCountsPerG;
+}
+
+FDualSenseInputReport DualSenseReplay::MakeIndexedReport(uint64 Index)
+{
+	FDualSenseInputReport Report;
+	FMemory::Memzero(Report.State);
+	Report.Sequence = (uint8)Index;
+	Report.SensorTimestamp = (uint32)(Index * 12000);
+	Report.Buttons = (uint32)(Index * 2654435761u);
+	Report.Gyroscope.x = (short)Index;
+	Report.Gyroscope.y = (short)(Index >> 16);
+	Report.Accelerometer.z = (short)~Index;
+	Report.State.touchPoint2.y = (unsigned int)(Index % 1080);
+	Report.ReceiveCycles = FPlatformTime::Cycles64();
+	return Report;
+}
+
+bool DualSenseReplay::IsIndexedRecordIntact(const DualSenseShared::FRecord& Record)
+{
+	return Record.Sequence == (uint8)Record.Index
+		&& Record.SensorTimestamp == (uint32)(Record.Index * 12000)
+		&& Record.Buttons == (uint32)(Record.Index * 2654435761u)
+		&& Record.Gyroscope[0] == (int16)Record.Index
+		&& Record.Gyroscope[1] == (int16)(Record.Index >> 16)
+		&& Record.Accelerometer[2] == (int16)~Record.Index
+		&& Record.TouchPoints[1][1] == (uint16)(Record.Index % 1080);
+}
+
+bool DualSenseReplay::IsIndexedSampleIntact(const FDualSenseScopeSample& Sample, uint32& OutIndex)
+{
+	OutIndex = (uint32)(uint16)Sample.Gyroscope[0] | ((uint32)(uint16)Sample.Gyroscope[1] << 16);
+	return Sample.Sequence == (uint8)OutIndex
+		&& Sample.SensorTimestamp == OutIndex * 12000u
+		&& Sample.Accelerometer[2] == (int16)~OutIndex;
+}
+
+int32 DualSenseReplay::CountPresses(const TArray<FDualSenseInputReport>& Reports, uint32 Buttons, int32 ReportRate, int32 FrameRate)
+{
+	int32 Presses = 0;
+	uint32 LastButtons = 0;
+	const int32 FrameCount = FrameRate > 0 ? FMath::CeilToInt((double)Reports.Num() * FrameRate / ReportRate) : Reports.Num();
+
+	for (int32 Frame = 0; Frame < FrameCount; ++Frame)
+	{
+		const int32 Index = FrameRate > 0 ? FMath::Min((int32)((int64)(Frame + 1) * ReportRate / FrameRate), Reports.Num()) - 1 : Frame;
+		const uint32 FrameButtons = Index >= 0 ? Reports[Index].Buttons & Buttons : 0;
+		Presses += FMath::CountBits(FrameButtons & ~LastButtons);
+		LastButtons = FrameButtons;
+	}
+	return Presses;
+}
+
+int32 DualSenseReplay::MatchMotionGestures(const TArray<FDualSenseScriptedMotionGesture>& Script, const TArray<TPair<EDualSenseMotionGesture, double>>& Detected, int32& OutUnexpected)
+{
+	int32 Matched = 0;
+	int32 Next = 0;
+	OutUnexpected = 0;
+	for (const TPair<EDualSenseMotionGesture, double>& Gesture : Detected)
+	{
+		if (Next < Script.Num() && Gesture.Key == Script[Next].Gesture && Gesture.Value >= Script[Next].Start && Gesture.Value <= Script[Next].End + 1.0)
+		{
+			++Matched;
+			++Next;
+		}
+		else
+		{
+			++OutUnexpected;
+		}
+	}
+	return Matched;
+}
+
+FDualSenseDriftScore DualSenseReplay::ScoreDrift(const TArray<FDualSenseStickSample>& Samples, int32 WarmUpSamples, float FixedDeadZoneRatio)
+{
+	FDualSenseDriftScore Score;
+	FDualSenseDriftEstimator Estimator;
+	double CenterError = 0.0;
+
+	for (int32 Index = 0; Index < Samples.Num(); ++Index)
+	{
+		const FDualSenseStickSample& Sample = Samples[Index];
+		if (Estimator.AddSample(Sample.X, Sample.Y))
+		{
+			Score.Drift = Estimator.GetDrift();
+		}
+
+		if (Index < WarmUpSamples || Sample.Phase == EDualSenseStickPhase::Sweep)
+			continue;
+
+		const FDualSenseStickDrift& Drift = Score.Drift;
+		const FVector2D AdaptiveCenter = Drift.bIsValid ? Drift.Center : FVector2D::ZeroVector;
+		const float AdaptiveDeadZone = Drift.bIsValid ? Drift.DeadZoneRatio : FixedDeadZoneRatio;
+		const bool bFixedActive = IsStickActive(Sample, FVector2D::ZeroVector, FixedDeadZoneRatio);
+		const bool bAdaptiveActive = IsStickActive(Sample, AdaptiveCenter, AdaptiveDeadZone);
+
+		if (Sample.Phase == EDualSenseStickPhase::Rest)
+		{
+			++Score.RestCount;
+			Score.FixedLeaks += bFixedActive ? 1 : 0;
+			Score.AdaptiveLeaks += bAdaptiveActive ? 1 : 0;
+			CenterError += (AdaptiveCenter - Sample.Center).Size();
+		}
+		else
+		{
+			++Score.HoldCount;
+			Score.FixedLost += bFixedActive ? 0 : 1;
+			Score.AdaptiveLost += bAdaptiveActive ? 0 : 1;
+		}
+	}
+
+	Score.MeanCenterError = Score.RestCount > 0 ? CenterError / Score.RestCount : 0.0;
+	return Score;
+}
+
+void DualSenseReplay::ReplayFrames(const TArray<FDualSenseInputReport>& Recording, int32 FrameRate, float FrameJitter,
+	TFunctionRef<void(const FDualSenseInputReport&)> AddReport, TFunctionRef<void(int32 LastIndex)> EndFrame)
+{
+	if (Recording.Num() == 0)
+		return;
+
+	FRandomStream Random(FrameRate);
+	const uint32 FirstTimestamp = Recording[0].SensorTimestamp;
+	double FrameTime = 0.0;
+	int32 NextReport = 0;
+	while (NextReport < Recording.Num())
+	{
+		FrameTime += Random.FRandRange(1.f - FrameJitter, 1.f + FrameJitter) / FrameRate;
+
+		//Unsigned difference, the sensor clock may wrap during the recording
+		int32 LastIndex = INDEX_NONE;
+		while (NextReport < Recording.Num() && (double)(Recording[NextReport].SensorTimestamp - FirstTimestamp) / DualSenseReport::SensorTicksPerSecond <= FrameTime)
+		{
+			AddReport(Recording[NextReport]);
+			LastIndex = NextReport++;
+		}
+
+		if (LastIndex != INDEX_NONE)
+		{
+			EndFrame(LastIndex);
+		}
+	}
+}
+
+int32 DualSenseReplay::ReplayFrames(FWinDualSenseDevice& Device, FDualSenseIOThread& Injector, const TArray<FDualSenseInputReport>& Recording, int32 FrameRate, float FrameJitter)
+{
+	//Frames are simulated, a frame's reports are all queued before it runs
+	int32 DroppedReports = 0;
+	ReplayFrames(Recording, FrameRate, FrameJitter,
+		[&Injector, &DroppedReports](const FDualSenseInputReport& RecordedReport)
+		{
+			FDualSenseInputReport Report = RecordedReport;
+			Report.ReceiveCycles = FPlatformTime::Cycles64();
+			DroppedReports += Injector.InjectReport(0, Report) ? 0 : 1;
+		},
+		[&Device](int32 LastIndex)
+		{
+			Device.SendControllerEvents();
+		});
+	return DroppedReports;
+}
+#pragma endregion
+
+#pragma region Dual Sense [Replay Threads]
+FDualSenseOutputCommandProducer::FDualSenseOutputCommandProducer(FDualSenseOutputQueue& InQueue, int32 InProducer, int32 InCommandCount, const std::atomic<bool>& bInStart)
+	: Queue(InQueue)
+	, Producer(InProducer)
+	, CommandCount(InCommandCount)
+	, bStart(bInStart)
+{
+	Thread = FRunnableThread::Create(this, *FString::Printf(TEXT("DualSenseOutputProducer%d"), Producer));
+}
+
+FDualSenseOutputCommandProducer::~FDualSenseOutputCommandProducer()
+{
+	Join();
+}
+
+void FDualSenseOutputCommandProducer::Join()
+{
+	if (Thread)
+	{
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+uint32 FDualSenseOutputCommandProducer::Run()
+{
+	while (!bStart.load(std::memory_order_acquire))
+	{
+		FPlatformProcess::Yield();
+	}
+
+	for (int32 Sequence = 0; Sequence < CommandCount; ++Sequence)
+	{
+		//Bounded queue : a producer faster than the drain waits for room, nothing may be lost here
+		const FDualSenseOutputCommand Command = FDualSenseOutputCommand::MakeLightBar(Producer, FColor((uint8)(Sequence >> 16), (uint8)(Sequence >> 8), (uint8)Sequence));
+		while (!Queue.Enqueue(Command))
+		{
+			++FullRetries;
+			FPlatformProcess::Yield();
+		}
+	}
+	return 0;
+}
+
+int32 FDualSenseOutputCommandProducer::GetSequence(const DS5W::Color& Color)
+{
+	return ((int32)Color.r << 16) | ((int32)Color.g << 8) | (int32)Color.b;
+}
+
+FDualSenseSharedStateReaderThread::FDualSenseSharedStateReaderThread(const FString& InName, int32 InReader) : Name(InName)
+{
+	Thread = FRunnableThread::Create(this, *FString::Printf(TEXT("DualSenseSharedReader%d"), InReader));
+}
+
+FDualSenseSharedStateReaderThread::~FDualSenseSharedStateReaderThread()
+{
+	Finish();
+}
+
+void FDualSenseSharedStateReaderThread::Finish()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+uint32 FDualSenseSharedStateReaderThread::Run()
+{
+	FDualSenseSharedReader Reader;
+	if (!Reader.Open(*Name))
+	{
+		bOpenFailed = true;
+		return 1;
+	}
+
+	uint64 Cursors[DualSenseShared::MaxControllers];
+	for (uint32 Controller = 0; Controller < DualSenseShared::MaxControllers; ++Controller)
+	{
+		Cursors[Controller] = Reader.GetWriteCount(Controller);
+	}
+	DualSenseShared::FRecord Records[DualSenseShared::RingSize];
+
+	while (!bStopping.load(std::memory_order_relaxed))
+	{
+		bool bHadRecords = false;
+		for (uint32 Controller = 0; Controller < DualSenseShared::MaxControllers; ++Controller)
+		{
+			uint64 Missed = 0;
+			const uint32 Count = Reader.ReadSince(Controller, Cursors[Controller], Records, DualSenseShared::RingSize, &Missed);
+			const uint64 ReadCycles = FPlatformTime::Cycles64();
+
+			MissedRecords += Missed;
+			for (uint32 Index = 0; Index < Count; ++Index)
+			{
+				++ReadRecords;
+				CorruptRecords += DualSenseReplay::IsIndexedRecordIntact(Records[Index]) ? 0 : 1;
+				Latencies.Add(FPlatformTime::ToMilliseconds64(ReadCycles - Records[Index].ReceiveTicks) * 1000.0);
+			}
+			bHadRecords |= Count > 0;
+		}
+
+		if (!bHadRecords)
+		{
+			FPlatformProcess::Yield();
+		}
+	}
+	return 0;
+}
+
+void FDualSenseSharedStateReaderThread::Stop()
+{
+	bStopping.store(true);
+}
+
+FDualSenseScopeReaderThread::FDualSenseScopeReaderThread(const FDualSenseScopeBuffer& InBuffer, int32 InDisplayRate) : Buffer(InBuffer), DisplayRate(InDisplayRate)
+{
+	Thread = FRunnableThread::Create(this, TEXT("DualSenseScopeReader"));
+}
+
+FDualSenseScopeReaderThread::~FDualSenseScopeReaderThread()
+{
+	Finish();
+}
+
+void FDualSenseScopeReaderThread::Finish()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+uint32 FDualSenseScopeReaderThread::Run()
+{
+	TArray<FDualSenseScopeSample> Samples;
+	Samples.Reserve(FDualSenseScopeBuffer::Capacity);
+
+	bool bHasLastIndex = false;
+	uint32 LastIndex = 0;
+	while (!bStopping.load(std::memory_order_relaxed))
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		Buffer.Read(Samples, FDualSenseScopeBuffer::Capacity);
+		ReadTimes.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0);
+		++Reads;
+
+		//Every read is consecutive, oldest first, and picks up after the previous one
+		for (int32 Index = 0; Index < Samples.Num(); ++Index)
+		{
+			uint32 SampleIndex = 0;
+			if (!DualSenseReplay::IsIndexedSampleIntact(Samples[Index], SampleIndex))
+			{
+				++CorruptSamples;
+				continue;
+			}
+
+			if (Index > 0)
+			{
+				uint32 PreviousIndex = 0;
+				DualSenseReplay::IsIndexedSampleIntact(Samples[Index - 1], PreviousIndex);
+				OutOfOrderSamples += SampleIndex == PreviousIndex + 1 ? 0 : 1;
+			}
+
+			if (!bHasLastIndex || (int32)(SampleIndex - LastIndex) > 0)
+			{
+				MissedSamples += bHasLastIndex ? SampleIndex - LastIndex - 1 : 0;
+				SeenSamples += 1;
+				LastIndex = SampleIndex;
+				bHasLastIndex = true;
+			}
+		}
+
+		FPlatformProcess::SleepNoStats(1.f / DisplayRate);
+	}
+	return 0;
+}
+
+void FDualSenseScopeReaderThread::Stop()
+{
+	bStopping.store(true);
+}
+#pragma endregion
+
+#pragma region Dual Sense [Synthetic Frame Producer]
+FDualSenseSyntheticFrameProducer::FDualSenseSyntheticFrameProducer(FWinDualSenseDevice& InDevice, FDualSenseIOThread* InInjector, int32 InControllerCount)
+	: Device(InDevice)
+	, Injector(InInjector)
+	, ControllerCount(InControllerCount)
+{
+	FMemory::Memzero(Reports);
+
+	FDualSenseGesturePattern Pattern;
+	Pattern.Key = FGamepadKeyNames::SpecialRight;
+	Pattern.Type = EDualSenseGestureType::MultiTap;
+	Pattern.Buttons = DualSenseReport::GetButtonMask(EDualSenseButtonType::CROSS);
+	Device.SetGesturePatterns({ Pattern });
+	Device.GyroAimSettings.bEnabled = true;
+
+	FDualSenseMotionGestureSettings MotionSettings;
+	MotionSettings.bEnabled = true;
+	Device.SetMotionGestureSettings(MotionSettings);
+}
+
+void FDualSenseSyntheticFrameProducer::Produce(int32 Frame)
+{
+	InjectReports(Frame);
+	SendOutputs(Frame);
+}
+
+void FDualSenseSyntheticFrameProducer::InjectReports(int32 Frame)
+{
+	for (int32 Controller = 0; Controller < ControllerCount; ++Controller)
+	{
+		FDualSenseInputReport& Report = Reports[Controller];
+		for (int32 Index = 0; Index < 4; ++Index)
+		{
+			Report.State.buttonsAndDpad = (Frame / 5) % 2 == 0 ? DS5W_ISTATE_BTX_CROSS : 0;
+			Report.State.leftStick.x = (char)((Frame * 7) % 256 - 128);
+			Report.State.rightTrigger = (unsigned char)(Frame * 3);
+			Report.Gyroscope.y = (short)((Frame % 100) * 40);
+			Report.Accelerometer.y = (short)DualSenseReport::AccelCountsPerG;
+			Report.Buttons = DualSenseReport::PackButtons(Report.State);
+			++Report.Sequence;
+			Report.SensorTimestamp += 12000;
+			Report.ReceiveCycles = FPlatformTime::Cycles64();
+			Injector->InjectReport(Controller, Report);
+		}
+	}
+}
+
+void FDualSenseSyntheticFrameProducer::SendOutputs(int32 Frame)
+{
+	for (int32 Controller = 0; Controller < ControllerCount; ++Controller)
+	{
+		FForceFeedbackValues Values;
+		Values.LeftLarge = (Frame % 2) == 0 ? 1.f : 0.f;
+		Values.RightLarge = (Frame % 256) / 255.f;
+		Device.SetChannelValues(Controller, Values);
+		Device.EnqueueOutputCommand(FDualSenseOutputCommand::MakeLightBar(Controller, FColor((uint8)Frame, 0, 255)));
+	}
+}
+#pragma endregion
@@ -0,0 +1,187 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseReport.h"
+
+#pragma region Dual Sense [Input Report]
+void DualSenseReport::DecodeInputState(const uint8* Payload, DS5W::DS5InputState& OutState)
+{
+	//Sticks to signed range (Y axis points up)
+	OutState.leftStick.x = (char)((short)(Payload[0x00] - 128));
+	OutState.leftStick.y = (char)((short)(Payload[0x01] - 127) * -1);
+	OutState.rightStick.x = (char)((short)(Payload[0x02] - 128));
+	OutState.rightStick.y = (char)((short)(Payload[0x03] - 127) * -1);
+
+	//Triggers
+	OutState.leftTrigger = Payload[0x04];
+	OutState.rightTrigger = Payload[0x05];
+
+	//Buttons
+	OutState.buttonsAndDpad = Payload[0x07] & 0xF0;
+	OutState.buttonsA = Payload[0x08];
+	OutState.buttonsB = Payload[0x09];
+
+	//DPAD hat switch to bitmask
+	switch (Payload[0x07] & 0x0F)
+	{
+	case 0x0:
+		OutState.buttonsAndDpad |= DS5W_ISTATE_DPAD_UP;
+		break;
+	case 0x1:
+		OutState.buttonsAndDpad |= DS5W_ISTATE_DPAD_UP | DS5W_ISTATE_DPAD_RIGHT;
+		break;
+	case 0x2:
+		OutState.buttonsAndDpad |= DS5W_ISTATE_DPAD_RIGHT;
+		break;
+	case 0x3:
+		OutState.buttonsAndDpad |= DS5W_ISTATE_DPAD_DOWN | DS5W_ISTATE_DPAD_RIGHT;
+		break;
+	case 0x4:
+		OutState.buttonsAndDpad |= DS5W_ISTATE_DPAD_DOWN;
+		break;
+	case 0x5:
+		OutState.buttonsAndDpad |= DS5W_ISTATE_DPAD_DOWN | DS5W_ISTATE_DPAD_LEFT;
+		break;
+	case 0x6:
+		OutState.buttonsAndDpad |= DS5W_ISTATE_DPAD_LEFT;
+		break;
+	case 0x7:
+		OutState.buttonsAndDpad |= DS5W_ISTATE_DPAD_UP | DS5W_ISTATE_DPAD_LEFT;
+		break;
+	default:
+		break;
+	}
+
+	//Motion (little endian shorts, same order DS5W copies them)
+	FMemory::Memcpy(&OutState.accelerometer, &Payload[0x0F], sizeof(DS5W::Vector3));
+	FMemory::Memcpy(&OutState.gyroscope, &Payload[0x15], sizeof(DS5W::Vector3));
+
+	//Touch points, 12 bit X / Y packed after the contact byte
+	const uint32 TouchRaw1 = (uint32)Payload[0x20] | ((uint32)Payload[0x21] << 8) | ((uint32)Payload[0x22] << 16) | ((uint32)Payload[0x23] << 24);
+	OutState.touchPoint1.x = (TouchRaw1 & 0x000FFF00) >> 8;
+	OutState.touchPoint1.y = (TouchRaw1 & 0xFFF00000) >> 20;
+
+	const uint32 TouchRaw2 = (uint32)Payload[0x24] | ((uint32)Payload[0x25] << 8) | ((uint32)Payload[0x26] << 16) | ((uint32)Payload[0x27] << 24);
+	OutState.touchPoint2.x = (TouchRaw2 & 0x000FFF00) >> 8;
+	OutState.touchPoint2.y = (TouchRaw2 & 0xFFF00000) >> 20;
+
+	//Trigger feedback
+	OutState.leftTriggerFeedback = Payload[0x2A];
+	OutState.rightTriggerFeedback = Payload[0x29];
+
+	//Headphone & Battery
+	OutState.headPhoneConnected = Payload[0x35] & 0x01;
+	OutState.battery.chargin = Payload[0x35] & 0x08;
+	OutState.battery.fullyCharged = Payload[0x36] & 0x20;
+	OutState.battery.level = Payload[0x36] & 0x0F;
+}
+
+void DualSenseReport::DecodeReport(const uint8* Payload, FDualSenseInputReport& OutReport)
+{
+	DecodeInputState(Payload, OutReport.State);
+	OutReport.Sequence = ReadSequence(Payload);
+	OutReport.SensorTimestamp = ReadSensorTimestamp(Payload);
+	OutReport.Buttons = PackButtons(OutReport.State);
+	FMemory::Memcpy(&OutReport.Gyroscope, &Payload[GyroscopeOffset], sizeof(DS5W::Vector3));
+	FMemory::Memcpy(&OutReport.Accelerometer, &Payload[AccelerometerOffset], sizeof(DS5W::Vector3));
+	OutReport.TouchContacts[0] = Payload[TouchOffsets[0]];
+	OutReport.TouchContacts[1] = Payload[TouchOffsets[1]];
+	OutReport.ReceiveCycles = FPlatformTime::Cycles64();
+}
+
+void DualSenseReport::EncodeUSBReport(const DS5W::DS5InputState& State, uint8 Sequence, uint32 SensorTimestamp, uint8* OutReport, const uint8* TouchContacts)
+{
+	FMemory::Memzero(OutReport, USBReportLength);
+	OutReport[0] = USBReportId;
+
+	uint8* Payload = OutReport + USBPayloadOffset;
+
+	//Sticks back to unsigned range
+	Payload[0x00] = (uint8)((int32)State.leftStick.x + 128);
+	Payload[0x01] = (uint8)(127 - (int32)State.leftStick.y);
+	Payload[0x02] = (uint8)((int32)State.rightStick.x + 128);
+	Payload[0x03] = (uint8)(127 - (int32)State.rightStick.y);
+
+	//Triggers
+	Payload[0x04] = State.leftTrigger;
+	Payload[0x05] = State.rightTrigger;
+
+	Payload[SequenceOffset] = Sequence;
+
+	//DPAD bitmask to hat switch (0x8 = released)
+	const bool bUp = State.buttonsAndDpad & DS5W_ISTATE_DPAD_UP;
+	const bool bDown = State.buttonsAndDpad & DS5W_ISTATE_DPAD_DOWN;
+	const bool bLeft = State.buttonsAndDpad & DS5W_ISTATE_DPAD_LEFT;
+	const bool bRight = State.buttonsAndDpad & DS5W_ISTATE_DPAD_RIGHT;
+
+	uint8 Hat = 0x8;
+	if (bUp)
+		Hat = bRight ? 0x1 : (bLeft ? 0x7 : 0x0);
+	else if (bDown)
+		Hat = bRight ? 0x3 : (bLeft ? 0x5 : 0x4);
+	else if (bRight)
+		Hat = 0x2;
+	else if (bLeft)
+		Hat = 0x6;
+
+	//Buttons
+	Payload[0x07] = (State.buttonsAndDpad & 0xF0) | Hat;
+	Payload[0x08] = State.buttonsA;
+	Payload[0x09] = State.buttonsB;
+
+	//Motion
+	FMemory::Memcpy(&Payload[0x0F], &State.accelerometer, sizeof(DS5W::Vector3));
+	FMemory::Memcpy(&Payload[0x15], &State.gyroscope, sizeof(DS5W::Vector3));
+
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		Payload[SensorTimestampOffset + Index] = (uint8)(SensorTimestamp >> (Index * 8));
+	}
+
+	//Touch points
+	const uint32 TouchRaw1 = (TouchContacts ? TouchContacts[0] : NoTouchContact) | ((State.touchPoint1.x & 0xFFF) << 8) | ((State.touchPoint1.y & 0xFFF) << 20);
+	const uint32 TouchRaw2 = (TouchContacts ? TouchContacts[1] : NoTouchContact) | ((State.touchPoint2.x & 0xFFF) << 8) | ((State.touchPoint2.y & 0xFFF) << 20);
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		Payload[0x20 + Index] = (uint8)(TouchRaw1 >> (Index * 8));
+		Payload[0x24 + Index] = (uint8)(TouchRaw2 >> (Index * 8));
+	}
+
+	//Trigger feedback
+	Payload[0x2A] = State.leftTriggerFeedback;
+	Payload[0x29] = State.rightTriggerFeedback;
+
+	//Headphone & Battery
+	Payload[0x35] = (State.headPhoneConnected ? 0x01 : 0x00) | (State.battery.chargin ? 0x08 : 0x00);
+	Payload[0x36] = (State.battery.fullyCharged ? 0x20 : 0x00) | (State.battery.level & 0x0F);
+}
+
+uint32 DualSenseReport::PackButtons(const DS5W::DS5InputState& State)
+{
+	uint32 Buttons = 0;
+
+	Buttons |= (State.buttonsAndDpad & DS5W_ISTATE_BTX_TRIANGLE) ? GetButtonMask(EDualSenseButtonType::TRIANGLE) : 0;
+	Buttons |= (State.buttonsAndDpad & DS5W_ISTATE_BTX_CROSS) ? GetButtonMask(EDualSenseButtonType::CROSS) : 0;
+	Buttons |= (State.buttonsAndDpad & DS5W_ISTATE_BTX_SQUARE) ? GetButtonMask(EDualSenseButtonType::SQUARE) : 0;
+	Buttons |= (State.buttonsAndDpad & DS5W_ISTATE_BTX_CIRCLE) ? GetButtonMask(EDualSenseButtonType::CIRCLE) : 0;
+
+	Buttons |= (State.buttonsAndDpad & DS5W_ISTATE_DPAD_UP) ? GetButtonMask(EDualSenseButtonType::DPAD_UP) : 0;
+	Buttons |= (State.buttonsAndDpad & DS5W_ISTATE_DPAD_DOWN) ? GetButtonMask(EDualSenseButtonType::DPAD_DOWN) : 0;
+	Buttons |= (State.buttonsAndDpad & DS5W_ISTATE_DPAD_LEFT) ? GetButtonMask(EDualSenseButtonType::DPAD_LEFT) : 0;
+	Buttons |= (State.buttonsAndDpad & DS5W_ISTATE_DPAD_RIGHT) ? GetButtonMask(EDualSenseButtonType::DPAD_RIGHT) : 0;
+
+	Buttons |= (State.buttonsA & DS5W_ISTATE_BTN_A_LEFT_BUMPER) ? GetButtonMask(EDualSenseButtonType::BUMPER_LEFT) : 0;
+	Buttons |= (State.buttonsA & DS5W_ISTATE_BTN_A_RIGHT_BUMPER) ? GetButtonMask(EDualSenseButtonType::BUMPER_RIGHT) : 0;
+	Buttons |= (State.buttonsA & DS5W_ISTATE_BTN_A_LEFT_TRIGGER) ? GetButtonMask(EDualSenseButtonType::TRIGGER_LEFT) : 0;
+	Buttons |= (State.buttonsA & DS5W_ISTATE_BTN_A_RIGHT_TRIGGER) ? GetButtonMask(EDualSenseButtonType::TRIGGER_RIGHT) : 0;
+	Buttons |= (State.buttonsA & DS5W_ISTATE_BTN_A_LEFT_STICK) ? GetButtonMask(EDualSenseButtonType::LEFT_STICK_PUSH) : 0;
+	Buttons |= (State.buttonsA & DS5W_ISTATE_BTN_A_RIGHT_STICK) ? GetButtonMask(EDualSenseButtonType::RIGHT_STICK_PUSH) : 0;
+	Buttons |= (State.buttonsA & DS5W_ISTATE_BTN_A_SELECT) ? GetButtonMask(EDualSenseButtonType::SELECT) : 0;
+	Buttons |= (State.buttonsA & DS5W_ISTATE_BTN_A_MENU) ? GetButtonMask(EDualSenseButtonType::MENU) : 0;
+
+	Buttons |= (State.buttonsB & DS5W_ISTATE_BTN_B_PLAYSTATION_LOGO) ? GetButtonMask(EDualSenseButtonType::PLAYSTATION_LOGO) : 0;
+	Buttons |= (State.buttonsB & DS5W_ISTATE_BTN_B_PAD_BUTTON) ? GetButtonMask(EDualSenseButtonType::TOUCHPAD) : 0;
+	Buttons |= (State.buttonsB & DS5W_ISTATE_BTN_B_MIC_BUTTON) ? GetButtonMask(EDualSenseButtonType::MIC) : 0;
+
+	return Buttons;
+}
+#pragma endregion
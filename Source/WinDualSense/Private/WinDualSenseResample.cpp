@@ -0,0 +1,221 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseResample.h"
+#include "WinDualSenseReport.h"
+#include "WinDualSenseCalibration.h"
+
+namespace
+{
+	//Same maps as the controller bank's SetInput / SetMotion
+	FORCEINLINE float GetStickValue(char Raw, float Center)
+	{
+		return FMath::Clamp(((float)Raw + 128.f - Center) * (2.f / 255.f) - 1.f, -1.f, 1.f);
+	}
+
+	FORCEINLINE float GetTriggerValue(unsigned char Raw, float Rest, float FullPull)
+	{
+		return FMath::Clamp(((float)Raw - Rest) / FMath::Max(FullPull - Rest, KINDA_SMALL_NUMBER), 0.f, 1.f);
+	}
+
+	//Step boundaries are computed from the step index, never accumulated, so the grid is the same however it is walked
+	FORCEINLINE uint64 GetStepTime(const FDualSenseResampleCursor& Cursor, double StepTicks, int64 Step)
+	{
+		return Cursor.Origin + (uint64)((double)Step * StepTicks + 0.5);
+	}
+}
+
+#pragma region Dual Sense [Fixed Step Resampling]
+FDualSenseResampleSample FDualSenseResampleSample::Make(const FDualSenseInputReport& Report, const FDualSenseCalibration& Calibration, const FVector& GyroBias)
+{
+	const DS5W::DS5InputState& State = Report.State;
+
+	FDualSenseResampleSample Sample;
+	Sample.LeftStick = FVector2D(GetStickValue(State.leftStick.x, Calibration.LeftStickCenter.X), GetStickValue(State.leftStick.y, Calibration.LeftStickCenter.Y));
+	Sample.RightStick = FVector2D(GetStickValue(State.rightStick.x, Calibration.RightStickCenter.X), GetStickValue(State.rightStick.y, Calibration.RightStickCenter.Y));
+	Sample.LeftTrigger = GetTriggerValue(State.leftTrigger, Calibration.TriggerRest.X, Calibration.GetTriggerFullPull(false));
+	Sample.RightTrigger = GetTriggerValue(State.rightTrigger, Calibration.TriggerRest.Y, Calibration.GetTriggerFullPull(true));
+	Sample.AngularVelocity = (FVector(Report.Gyroscope.x, Report.Gyroscope.y, Report.Gyroscope.z) - GyroBias) / DualSenseReport::GyroCountsPerDegreePerSecond;
+	Sample.Acceleration = FVector(Report.Accelerometer.x, Report.Accelerometer.y, Report.Accelerometer.z) / DualSenseReport::AccelCountsPerG;
+	return Sample;
+}
+
+void FDualSenseResampler::Reset()
+{
+	Head = 0;
+	Count = 0;
+	LastSensorTimestamp = 0;
+	SensorTime = 0;
+	FirstTime = 0;
+	++Epoch;
+}
+
+void FDualSenseResampler::AddSample(uint32 SensorTimestamp, const FDualSenseResampleSample& Sample)
+{
+	//Unwrapped against the previous report, the 32 bit clock wraps every 23 minutes
+	if (Count > 0)
+	{
+		//Out of order or repeated, the report stats already rejected those
+		const int32 Delta = (int32)(SensorTimestamp - LastSensorTimestamp);
+		if (Delta <= 0)
+			return;
+
+		SensorTime += (uint32)Delta;
+	}
+	else
+	{
+		SensorTime = SensorTimestamp;
+		FirstTime = SensorTime;
+	}
+	LastSensorTimestamp = SensorTimestamp;
+
+	const int32 Index = (Head + Count) % Capacity;
+	if (Count == Capacity)
+	{
+		Head = (Head + 1) % Capacity;
+	}
+	else
+	{
+		++Count;
+	}
+
+	Samples[Index] = Sample;
+	Samples[Index].SensorTime = SensorTime;
+}
+
+bool FDualSenseResampler::ConsumeStep(FDualSenseResampleCursor& Cursor, FDualSenseResampledStep& OutStep) const
+{
+	const double StepTicks = Cursor.StepSeconds * DualSenseReport::SensorTicksPerSecond;
+	if (Count == 0 || StepTicks < 1.0)
+		return false;
+
+	//Anchored to the first report rather than to whatever is kept now, a cursor used late still lands on the same grid.
+	//A given origin only holds for the clock of the first grid
+	const bool bNewGrid = !Cursor.bAnchored || Cursor.Epoch != Epoch;
+	if (bNewGrid)
+	{
+		Cursor.Origin = Cursor.bHasOrigin && !Cursor.bAnchored ? Cursor.Origin : GetFirstTime();
+		Cursor.Epoch = Epoch;
+		Cursor.NextStep = 0;
+		Cursor.bAnchored = true;
+	}
+
+	//Fell behind the kept reports (or the grid starts before them), carry on from the first step they fully cover
+	uint64 StartTime = GetStepTime(Cursor, StepTicks, Cursor.NextStep);
+	if (StartTime < GetOldestTime())
+	{
+		int64 FirstStep = (int64)FMath::CeilToDouble((double)(GetOldestTime() - Cursor.Origin) / StepTicks);
+		while (GetStepTime(Cursor, StepTicks, FirstStep) < GetOldestTime())
+		{
+			++FirstStep;
+		}
+
+		if (!bNewGrid)
+		{
+			Cursor.SkippedSteps += FirstStep - Cursor.NextStep;
+		}
+		Cursor.NextStep = FirstStep;
+		StartTime = GetStepTime(Cursor, StepTicks, Cursor.NextStep);
+	}
+
+	const uint64 EndTime = GetStepTime(Cursor, StepTicks, Cursor.NextStep + 1);
+	if (EndTime > GetNewestTime())
+		return false;
+
+	SampleAt(EndTime, OutStep);
+	Integrate(StartTime, EndTime, OutStep);
+	OutStep.Index = Cursor.NextStep;
+	OutStep.Time = (double)Cursor.NextStep * Cursor.StepSeconds;
+
+	++Cursor.NextStep;
+	return true;
+}
+
+void FDualSenseResampler::SampleAt(uint64 Time, FDualSenseResampledStep& OutStep) const
+{
+	if (Count == 0)
+		return;
+
+	const int32 Next = FindFirstAtOrAfter(Time);
+	const FDualSenseResampleSample& After = Get(FMath::Min(Next, Count - 1));
+	const FDualSenseResampleSample& Before = Get(FMath::Max(Next - 1, 0));
+
+	const float Alpha = After.SensorTime > Before.SensorTime && Time > Before.SensorTime
+		? FMath::Min((float)((double)(Time - Before.SensorTime) / (double)(After.SensorTime - Before.SensorTime)), 1.f) : 1.f;
+
+	OutStep.LeftStick = FMath::Lerp(Before.LeftStick, After.LeftStick, Alpha);
+	OutStep.RightStick = FMath::Lerp(Before.RightStick, After.RightStick, Alpha);
+	OutStep.LeftTrigger = FMath::Lerp(Before.LeftTrigger, After.LeftTrigger, Alpha);
+	OutStep.RightTrigger = FMath::Lerp(Before.RightTrigger, After.RightTrigger, Alpha);
+}
+
+void FDualSenseResampler::Integrate(uint64 StartTime, uint64 EndTime, FDualSenseResampledStep& OutStep) const
+{
+	if (Count == 0 || EndTime <= StartTime)
+		return;
+
+	//Degrees * ticks and g * ticks, in doubles so long steps lose nothing
+	double Rotation[3] = { 0.0, 0.0, 0.0 };
+	double Acceleration[3] = { 0.0, 0.0, 0.0 };
+	auto Accumulate = [&Rotation, &Acceleration](const FDualSenseResampleSample& Sample, uint64 Ticks)
+	{
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			Rotation[Axis] += (double)Sample.AngularVelocity[Axis] * Ticks;
+			Acceleration[Axis] += (double)Sample.Acceleration[Axis] * Ticks;
+		}
+	};
+
+	//Before the oldest report : its own values
+	const uint64 OldestTime = GetOldestTime();
+	if (StartTime < OldestTime)
+	{
+		Accumulate(Get(0), FMath::Min(EndTime, OldestTime) - StartTime);
+	}
+
+	//Report Index covers (previous report, report]
+	for (int32 Index = FMath::Max(FindFirstAtOrAfter(StartTime + 1), 1); Index < Count; ++Index)
+	{
+		const FDualSenseResampleSample& Sample = Get(Index);
+		const uint64 IntervalStart = FMath::Max(Get(Index - 1).SensorTime, StartTime);
+		const uint64 IntervalEnd = FMath::Min(Sample.SensorTime, EndTime);
+		if (IntervalStart >= EndTime)
+			break;
+
+		if (IntervalEnd > IntervalStart)
+		{
+			Accumulate(Sample, IntervalEnd - IntervalStart);
+		}
+	}
+
+	//After the newest report : held
+	const uint64 NewestTime = GetNewestTime();
+	if (EndTime > NewestTime)
+	{
+		Accumulate(Get(Count - 1), EndTime - FMath::Max(StartTime, NewestTime));
+	}
+
+	const double StepTicks = (double)(EndTime - StartTime);
+	OutStep.Rotation = FVector((float)(Rotation[0] / DualSenseReport::SensorTicksPerSecond), (float)(Rotation[1] / DualSenseReport::SensorTicksPerSecond), (float)(Rotation[2] / DualSenseReport::SensorTicksPerSecond));
+	OutStep.AngularVelocity = FVector((float)(Rotation[0] / StepTicks), (float)(Rotation[1] / StepTicks), (float)(Rotation[2] / StepTicks));
+	OutStep.Acceleration = FVector((float)(Acceleration[0] / StepTicks), (float)(Acceleration[1] / StepTicks), (float)(Acceleration[2] / StepTicks));
+}
+
+int32 FDualSenseResampler::FindFirstAtOrAfter(uint64 Time) const
+{
+	int32 Low = 0;
+	int32 High = Count;
+	while (Low < High)
+	{
+		const int32 Middle = (Low + High) / 2;
+		if (Get(Middle).SensorTime < Time)
+		{
+			Low = Middle + 1;
+		}
+		else
+		{
+			High = Middle;
+		}
+	}
+	return Low;
+}
+#pragma endregion
@@ -0,0 +1,94 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseScope.h"
+
+namespace
+{
+	constexpr uint64 ScopeIndexMask = FDualSenseScopeBuffer::Capacity - 1;
+	static_assert((FDualSenseScopeBuffer::Capacity & ScopeIndexMask) == 0, "Scope capacity must be a power of two");
+}
+
+#pragma region Dual Sense [Sensor Scope]
+void FDualSenseScopeBuffer::AddReport(const FDualSenseInputReport& Report)
+{
+	if (!HasReaders())
+	{
+		bHasLastReport = false;
+		return;
+	}
+
+	const uint64 Index = Head.load(std::memory_order_relaxed);
+	FDualSenseScopeSample& Sample = Samples[Index & ScopeIndexMask];
+	const DS5W::DS5InputState& State = Report.State;
+
+	Sample.SensorTimestamp = Report.SensorTimestamp;
+	Sample.SensorInterval = bHasLastReport ? (float)DualSenseReport::SensorTicksToMicroseconds(Report.SensorTimestamp - LastSensorTimestamp) : 0.f;
+	Sample.HostInterval = bHasLastReport && Report.ReceiveCycles > LastReceiveCycles
+		? (float)(FPlatformTime::ToMilliseconds64(Report.ReceiveCycles - LastReceiveCycles) * 1000.0) : 0.f;
+
+	Sample.Gyroscope[0] = Report.Gyroscope.x;
+	Sample.Gyroscope[1] = Report.Gyroscope.y;
+	Sample.Gyroscope[2] = Report.Gyroscope.z;
+	Sample.Accelerometer[0] = Report.Accelerometer.x;
+	Sample.Accelerometer[1] = Report.Accelerometer.y;
+	Sample.Accelerometer[2] = Report.Accelerometer.z;
+	Sample.Touch[0] = (uint16)State.touchPoint1.x;
+	Sample.Touch[1] = (uint16)State.touchPoint1.y;
+	Sample.Sticks[0] = (int8)State.leftStick.x;
+	Sample.Sticks[1] = (int8)State.leftStick.y;
+	Sample.Sticks[2] = (int8)State.rightStick.x;
+	Sample.Sticks[3] = (int8)State.rightStick.y;
+	Sample.Triggers[0] = State.leftTrigger;
+	Sample.Triggers[1] = State.rightTrigger;
+	Sample.Sequence = Report.Sequence;
+	Sample.TouchContact = Report.TouchContacts[0];
+
+	bHasLastReport = true;
+	LastSensorTimestamp = Report.SensorTimestamp;
+	LastReceiveCycles = Report.ReceiveCycles;
+
+	Head.store(Index + 1, std::memory_order_release);
+}
+
+int32 FDualSenseScopeBuffer::Read(TArray<FDualSenseScopeSample>& OutSamples, int32 MaxSamples) const
+{
+	const uint64 End = Head.load(std::memory_order_acquire);
+	const uint64 Count = FMath::Min<uint64>(FMath::Min<uint64>(End, (uint64)FMath::Max(MaxSamples, 0)), Capacity);
+	const uint64 Start = End - Count;
+
+	OutSamples.SetNumUninitialized((int32)Count, false);
+	if (Count == 0)
+	{
+		return 0;
+	}
+
+	//At most two runs, split where the ring wraps
+	const uint64 FirstRun = FMath::Min<uint64>(Count, Capacity - (Start & ScopeIndexMask));
+	FMemory::Memcpy(OutSamples.GetData(), &Samples[Start & ScopeIndexMask], FirstRun * sizeof(FDualSenseScopeSample));
+	if (FirstRun < Count)
+	{
+		FMemory::Memcpy(OutSamples.GetData() + FirstRun, &Samples[0], (Count - FirstRun) * sizeof(FDualSenseScopeSample));
+	}
+
+	//The producer may be writing the slot at the new head, and already rewrote everything a capacity behind it
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const uint64 NewHead = Head.load(std::memory_order_relaxed);
+	const uint64 FirstValid = NewHead + 1 > Capacity ? NewHead + 1 - Capacity : 0;
+	if (Start < FirstValid)
+	{
+		const int32 Overwritten = (int32)FMath::Min<uint64>(FirstValid - Start, Count);
+		OutSamples.RemoveAt(0, Overwritten, false);
+	}
+	return OutSamples.Num();
+}
+
+void FDualSenseScopeBuffer::AddReader()
+{
+	Readers.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FDualSenseScopeBuffer::RemoveReader()
+{
+	Readers.fetch_sub(1, std::memory_order_relaxed);
+}
+#pragma endregion
@@ -0,0 +1,360 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseScopeWidget.h"
+#include "Rendering/DrawElements.h"
+#include "Styling/CoreStyle.h"
+
+namespace
+{
+	//The buffer holds 4 s of reports at 1000 Hz
+	constexpr float MinWindowSeconds = 0.1f;
+	constexpr float MaxWindowSeconds = 4.f;
+
+	//Pixels
+	constexpr float HeaderHeight = 20.f;
+	constexpr float LabelHeight = 14.f;
+	constexpr float LanePadding = 4.f;
+	constexpr float LegendOffset = 170.f;
+	constexpr float LegendSpacing = 40.f;
+
+	//Auto ranges leave that much room over the peak
+	constexpr float RangeHeadroom = 1.1f;
+
+	enum class EScopeRange : uint8
+	{
+		//[Min, Max]
+		Fixed,
+		//Centered on 0, grows past Max to the window's peak
+		Symmetric,
+		//From 0, grows past Max to the window's peak
+		Positive
+	};
+
+	typedef float (*FScopeValue)(const FDualSenseScopeSample&);
+	typedef bool (*FScopeValid)(const FDualSenseScopeSample&);
+
+	struct FScopeChannel
+	{
+		const TCHAR* Name;
+		FLinearColor Color;
+		FScopeValue Value;
+		//Null = always, gaps are left open
+		FScopeValid IsValid;
+	};
+
+	struct FScopeLane
+	{
+		const TCHAR* Name;
+		EScopeRange Range;
+		float Min;
+		float Max;
+		int32 ChannelCount;
+		FScopeChannel Channels[4];
+	};
+
+	const FLinearColor BackgroundColor(0.01f, 0.01f, 0.012f);
+	const FLinearColor LaneColor(0.03f, 0.03f, 0.035f);
+	const FLinearColor AxisColor(0.15f, 0.15f, 0.15f);
+	const FLinearColor TextColor(0.8f, 0.8f, 0.8f);
+	const FLinearColor Red(1.f, 0.3f, 0.3f);
+	const FLinearColor Green(0.35f, 1.f, 0.35f);
+	const FLinearColor Blue(0.4f, 0.6f, 1.f);
+	const FLinearColor Yellow(1.f, 0.85f, 0.25f);
+
+	//Same map as the resampler, before calibration so deadzones can be tuned against the raw rest position
+	FORCEINLINE float GetStickValue(int8 Raw)
+	{
+		return ((float)Raw + 128.f) * (2.f / 255.f) - 1.f;
+	}
+
+	FORCEINLINE bool IsTouching(const FDualSenseScopeSample& Sample)
+	{
+		return DualSenseReport::IsTouching(Sample.TouchContact);
+	}
+
+	const FScopeLane ScopeLanes[] =
+	{
+		{ TEXT("Sticks"), EScopeRange::Fixed, -1.f, 1.f, 4,
+		{
+			{ TEXT("LX"), Red, [](const FDualSenseScopeSample& Sample) { return GetStickValue(Sample.Sticks[0]); }, nullptr },
+			{ TEXT("LY"), Green, [](const FDualSenseScopeSample& Sample) { return GetStickValue(Sample.Sticks[1]); }, nullptr },
+			{ TEXT("RX"), Blue, [](const FDualSenseScopeSample& Sample) { return GetStickValue(Sample.Sticks[2]); }, nullptr },
+			{ TEXT("RY"), Yellow, [](const FDualSenseScopeSample& Sample) { return GetStickValue(Sample.Sticks[3]); }, nullptr }
+		} },
+		{ TEXT("Triggers"), EScopeRange::Fixed, 0.f, 1.f, 2,
+		{
+			{ TEXT("L2"), Red, [](const FDualSenseScopeSample& Sample) { return Sample.Triggers[0] / 255.f; }, nullptr },
+			{ TEXT("R2"), Blue, [](const FDualSenseScopeSample& Sample) { return Sample.Triggers[1] / 255.f; }, nullptr }
+		} },
+		{ TEXT("Touch"), EScopeRange::Fixed, 0.f, 1.f, 2,
+		{
+			{ TEXT("X"), Red, [](const FDualSenseScopeSample& Sample) { return Sample.Touch[0] / (float)(DualSenseReport::TouchpadWidth - 1); }, &IsTouching },
+			{ TEXT("Y"), Green, [](const FDualSenseScopeSample& Sample) { return Sample.Touch[1] / (float)(DualSenseReport::TouchpadHeight - 1); }, &IsTouching }
+		} },
+		{ TEXT("Gyro deg/s"), EScopeRange::Symmetric, -250.f, 250.f, 3,
+		{
+			{ TEXT("X"), Red, [](const FDualSenseScopeSample& Sample) { return Sample.Gyroscope[0] / DualSenseReport::GyroCountsPerDegreePerSecond; }, nullptr },
+			{ TEXT("Y"), Green, [](const FDualSenseScopeSample& Sample) { return Sample.Gyroscope[1] / DualSenseReport::GyroCountsPerDegreePerSecond; }, nullptr },
+			{ TEXT("Z"), Blue, [](const FDualSenseScopeSample& Sample) { return Sample.Gyroscope[2] / DualSenseReport::GyroCountsPerDegreePerSecond; }, nullptr }
+		} },
+		{ TEXT("Accel g"), EScopeRange::Symmetric, -1.5f, 1.5f, 3,
+		{
+			{ TEXT("X"), Red, [](const FDualSenseScopeSample& Sample) { return Sample.Accelerometer[0] / DualSenseReport::AccelCountsPerG; }, nullptr },
+			{ TEXT("Y"), Green, [](const FDualSenseScopeSample& Sample) { return Sample.Accelerometer[1] / DualSenseReport::AccelCountsPerG; }, nullptr },
+			{ TEXT("Z"), Blue, [](const FDualSenseScopeSample& Sample) { return Sample.Accelerometer[2] / DualSenseReport::AccelCountsPerG; }, nullptr }
+		} },
+		{ TEXT("Interval us"), EScopeRange::Positive, 0.f, 1000.f, 2,
+		{
+			{ TEXT("Sensor"), Yellow, [](const FDualSenseScopeSample& Sample) { return Sample.SensorInterval; }, [](const FDualSenseScopeSample& Sample) { return Sample.SensorInterval > 0.f; } },
+			{ TEXT("Host"), Blue, [](const FDualSenseScopeSample& Sample) { return Sample.HostInterval; }, [](const FDualSenseScopeSample& Sample) { return Sample.HostInterval > 0.f; } }
+		} }
+	};
+
+	constexpr int32 ScopeLaneCount = UE_ARRAY_COUNT(ScopeLanes);
+}
+
+#pragma region Dual Sense [Sensor Scope Widget]
+void SDualSenseScope::Construct(const FArguments& InArgs)
+{
+	Buffer = InArgs._Buffer;
+	WindowSeconds = FMath::Clamp(InArgs._WindowSeconds, MinWindowSeconds, MaxWindowSeconds);
+
+	if (Buffer.IsValid())
+	{
+		Buffer->AddReader();
+
+		//Every Slate frame for as long as the widget lives, nothing is ticked once it is closed
+		RegisterActiveTimer(0.f, FWidgetActiveTimerDelegate::CreateSP(this, &SDualSenseScope::Refresh));
+	}
+}
+
+SDualSenseScope::~SDualSenseScope()
+{
+	if (Buffer.IsValid())
+	{
+		Buffer->RemoveReader();
+	}
+}
+
+FVector2D SDualSenseScope::ComputeDesiredSize(float LayoutScaleMultiplier) const
+{
+	return FVector2D(900.f, 640.f);
+}
+
+EActiveTimerReturnType SDualSenseScope::Refresh(double InCurrentTime, float InDeltaTime)
+{
+	Buffer->Read(Samples, FDualSenseScopeBuffer::Capacity);
+
+	//Sensor clock wraps, the unsigned distance to the newest report does not care
+	if (Samples.Num() > 0)
+	{
+		const uint32 NewestTimestamp = Samples.Last().SensorTimestamp;
+		const uint32 WindowTicks = (uint32)(WindowSeconds * DualSenseReport::SensorTicksPerSecond);
+
+		int32 First = 0;
+		while (First < Samples.Num() && NewestTimestamp - Samples[First].SensorTimestamp > WindowTicks)
+		{
+			++First;
+		}
+		Samples.RemoveAt(0, First, false);
+	}
+
+	SensorIntervals = ComputeIntervalStats(Samples, &FDualSenseScopeSample::SensorInterval);
+	HostIntervals = ComputeIntervalStats(Samples, &FDualSenseScopeSample::HostInterval);
+
+	DroppedReports = 0;
+	for (int32 Index = 1; Index < Samples.Num(); ++Index)
+	{
+		const uint8 Delta = Samples[Index].Sequence - Samples[Index - 1].Sequence;
+		if (Delta > 1)
+		{
+			DroppedReports += Delta - 1;
+		}
+	}
+
+	Invalidate(EInvalidateWidgetReason::Paint);
+	return EActiveTimerReturnType::Continue;
+}
+
+SDualSenseScope::FIntervalStats SDualSenseScope::ComputeIntervalStats(const TArray<FDualSenseScopeSample>& InSamples, float FDualSenseScopeSample::* Interval)
+{
+	FIntervalStats Stats;
+
+	int32 Count = 0;
+	double Sum = 0.0;
+	Stats.Min = MAX_flt;
+	for (const FDualSenseScopeSample& Sample : InSamples)
+	{
+		const float Value = Sample.*Interval;
+		if (Value > 0.f)
+		{
+			++Count;
+			Sum += Value;
+			Stats.Min = FMath::Min(Stats.Min, Value);
+			Stats.Max = FMath::Max(Stats.Max, Value);
+		}
+	}
+
+	if (Count == 0)
+	{
+		return FIntervalStats();
+	}
+
+	Stats.Mean = (float)(Sum / Count);
+
+	double SquaredSum = 0.0;
+	for (const FDualSenseScopeSample& Sample : InSamples)
+	{
+		const float Value = Sample.*Interval;
+		if (Value > 0.f)
+		{
+			SquaredSum += FMath::Square((double)Value - Stats.Mean);
+		}
+	}
+	Stats.Deviation = FMath::Sqrt((float)(SquaredSum / Count));
+	return Stats;
+}
+
+int32 SDualSenseScope::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	const FSlateBrush* WhiteBrush = FCoreStyle::Get().GetBrush("GenericWhiteBox");
+	const FSlateFontInfo Font = FCoreStyle::GetDefaultFontStyle("Regular", 8);
+	const FVector2D Size = AllottedGeometry.GetLocalSize();
+
+	const int32 BackgroundLayer = LayerId;
+	const int32 LaneLayer = LayerId + 1;
+	const int32 LineLayer = LayerId + 2;
+
+	FSlateDrawElement::MakeBox(OutDrawElements, BackgroundLayer, AllottedGeometry.ToPaintGeometry(), WhiteBrush, ESlateDrawEffect::None, BackgroundColor);
+
+	const FString Header = Samples.Num() == 0 ? FString(TEXT("Waiting for reports")) : FString::Printf(
+		TEXT("%d reports in %.1f s | Sensor interval %.1f us (%.0f Hz) jitter %.1f us [%.1f - %.1f] | Host interval %.1f us jitter %.1f us [%.1f - %.1f] | Dropped %d"),
+		Samples.Num(), WindowSeconds, SensorIntervals.Mean, SensorIntervals.Mean > 0.f ? 1000000.f / SensorIntervals.Mean : 0.f, SensorIntervals.Deviation, SensorIntervals.Min, SensorIntervals.Max,
+		HostIntervals.Mean, HostIntervals.Deviation, HostIntervals.Min, HostIntervals.Max, DroppedReports);
+	FSlateDrawElement::MakeText(OutDrawElements, LaneLayer, AllottedGeometry.ToPaintGeometry(FVector2D(LanePadding, 3.f), FVector2D(Size.X, HeaderHeight)), Header, Font, ESlateDrawEffect::None, TextColor);
+
+	const float LaneHeight = FMath::Max((Size.Y - HeaderHeight) / ScopeLaneCount, LabelHeight + LanePadding + 1.f);
+	const float PlotWidth = FMath::Max(Size.X - 2.f * LanePadding, 1.f);
+	const uint32 NewestTimestamp = Samples.Num() > 0 ? Samples.Last().SensorTimestamp : 0;
+
+	auto GetX = [&](const FDualSenseScopeSample& Sample)
+	{
+		const double Age = (double)(NewestTimestamp - Sample.SensorTimestamp) / DualSenseReport::SensorTicksPerSecond;
+		return LanePadding + PlotWidth * (1.f - (float)(Age / WindowSeconds));
+	};
+
+	for (int32 LaneIndex = 0; LaneIndex < ScopeLaneCount; ++LaneIndex)
+	{
+		const FScopeLane& Lane = ScopeLanes[LaneIndex];
+		const float Top = HeaderHeight + LaneIndex * LaneHeight;
+		const float PlotTop = Top + LabelHeight;
+		const float PlotHeight = LaneHeight - LabelHeight - LanePadding;
+
+		FSlateDrawElement::MakeBox(OutDrawElements, LaneLayer, AllottedGeometry.ToPaintGeometry(FVector2D(LanePadding, PlotTop), FVector2D(PlotWidth, PlotHeight)), WhiteBrush, ESlateDrawEffect::None, LaneColor);
+
+		//Range of the lane over the window
+		float RangeMin = Lane.Min;
+		float RangeMax = Lane.Max;
+		if (Lane.Range != EScopeRange::Fixed)
+		{
+			float Peak = 0.f;
+			for (int32 ChannelIndex = 0; ChannelIndex < Lane.ChannelCount; ++ChannelIndex)
+			{
+				const FScopeChannel& Channel = Lane.Channels[ChannelIndex];
+				for (const FDualSenseScopeSample& Sample : Samples)
+				{
+					if (!Channel.IsValid || Channel.IsValid(Sample))
+					{
+						Peak = FMath::Max(Peak, FMath::Abs(Channel.Value(Sample)));
+					}
+				}
+			}
+
+			RangeMax = FMath::Max(Lane.Max, Peak * RangeHeadroom);
+			RangeMin = Lane.Range == EScopeRange::Symmetric ? -RangeMax : 0.f;
+		}
+
+		auto GetY = [&](float Value)
+		{
+			return PlotTop + PlotHeight * (1.f - FMath::Clamp((Value - RangeMin) / (RangeMax - RangeMin), 0.f, 1.f));
+		};
+
+		if (RangeMin < 0.f && RangeMax > 0.f)
+		{
+			Points.Reset();
+			Points.Add(FVector2D(LanePadding, GetY(0.f)));
+			Points.Add(FVector2D(LanePadding + PlotWidth, GetY(0.f)));
+			FSlateDrawElement::MakeLines(OutDrawElements, LaneLayer, AllottedGeometry.ToPaintGeometry(), Points, ESlateDrawEffect::None, AxisColor, false, 1.f);
+		}
+
+		const FString Label = FString::Printf(TEXT("%s [%.4g, %.4g]"), Lane.Name, RangeMin, RangeMax);
+		FSlateDrawElement::MakeText(OutDrawElements, LaneLayer, AllottedGeometry.ToPaintGeometry(FVector2D(LanePadding, Top), FVector2D(LegendOffset, LabelHeight)), Label, Font, ESlateDrawEffect::None, TextColor);
+
+		for (int32 ChannelIndex = 0; ChannelIndex < Lane.ChannelCount; ++ChannelIndex)
+		{
+			const FScopeChannel& Channel = Lane.Channels[ChannelIndex];
+			FSlateDrawElement::MakeText(OutDrawElements, LaneLayer, AllottedGeometry.ToPaintGeometry(FVector2D(LegendOffset + ChannelIndex * LegendSpacing, Top), FVector2D(LegendSpacing, LabelHeight)),
+				FString(Channel.Name), Font, ESlateDrawEffect::None, Channel.Color);
+
+			//More reports than pixels : one low / high pair per pixel column, so spikes survive
+			Points.Reset();
+			int32 Column = INDEX_NONE;
+			int32 ColumnCount = 0;
+			float Low = 0.f;
+			float High = 0.f;
+
+			auto FlushColumn = [&]()
+			{
+				if (ColumnCount > 0)
+				{
+					Points.Add(FVector2D((float)Column, GetY(Low)));
+					if (High != Low)
+					{
+						Points.Add(FVector2D((float)Column, GetY(High)));
+					}
+				}
+				ColumnCount = 0;
+			};
+
+			auto FlushLine = [&]()
+			{
+				FlushColumn();
+				if (Points.Num() > 1)
+				{
+					FSlateDrawElement::MakeLines(OutDrawElements, LineLayer, AllottedGeometry.ToPaintGeometry(), Points, ESlateDrawEffect::None, Channel.Color, true, 1.f);
+				}
+				Points.Reset();
+				Column = INDEX_NONE;
+			};
+
+			for (const FDualSenseScopeSample& Sample : Samples)
+			{
+				if (Channel.IsValid && !Channel.IsValid(Sample))
+				{
+					FlushLine();
+					continue;
+				}
+
+				const float Value = Channel.Value(Sample);
+				const int32 SampleColumn = FMath::FloorToInt(GetX(Sample));
+				if (SampleColumn != Column)
+				{
+					FlushColumn();
+					Column = SampleColumn;
+					Low = Value;
+					High = Value;
+				}
+				else
+				{
+					Low = FMath::Min(Low, Value);
+					High = FMath::Max(High, Value);
+				}
+				++ColumnCount;
+			}
+			FlushLine();
+		}
+	}
+
+	return LineLayer;
+}
+#pragma endregion
@@ -0,0 +1,57 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SLeafWidget.h"
+#include "WinDualSenseScope.h"
+
+#pragma region Dual Sense [Sensor Scope Widget]
+//Live plot of one controller's sticks, triggers, touch, gyro and accelerometer, and of the report intervals.
+//Pulls the newest window out of the scope buffer once per Slate frame, the buffer is only filled while a scope is open
+class SDualSenseScope : public SLeafWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SDualSenseScope)
+		: _WindowSeconds(2.f)
+	{}
+		SLATE_ARGUMENT(TSharedPtr<FDualSenseScopeBuffer, ESPMode::ThreadSafe>, Buffer)
+		//Seconds of history across the width
+		SLATE_ARGUMENT(float, WindowSeconds)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs);
+	virtual ~SDualSenseScope();
+
+	//SWidget
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+
+private:
+	//Microseconds, over the samples in the window
+	struct FIntervalStats
+	{
+		float Mean = 0.f;
+		float Deviation = 0.f;
+		float Min = 0.f;
+		float Max = 0.f;
+	};
+
+	EActiveTimerReturnType Refresh(double InCurrentTime, float InDeltaTime);
+
+	static FIntervalStats ComputeIntervalStats(const TArray<FDualSenseScopeSample>& InSamples, float FDualSenseScopeSample::* Interval);
+
+	TSharedPtr<FDualSenseScopeBuffer, ESPMode::ThreadSafe> Buffer;
+	float WindowSeconds = 2.f;
+
+	//Oldest first, trimmed to the window
+	TArray<FDualSenseScopeSample> Samples;
+	FIntervalStats SensorIntervals;
+	FIntervalStats HostIntervals;
+	//Sequence gaps in the window
+	int32 DroppedReports = 0;
+
+	//Reused by every line drawn
+	mutable TArray<FVector2D> Points;
+};
+#pragma endregion
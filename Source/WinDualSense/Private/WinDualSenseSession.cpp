@@ -0,0 +1,82 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseSession.h"
+#include "WinDualSensePCH.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	constexpr uint32 SessionMagic = 0x44535353;
+}
+
+#pragma region Dual Sense [Session]
+bool FDualSenseSession::Save(const FString& File) const
+{
+	TArray<uint8> RawReports;
+	RawReports.SetNumUninitialized(Reports.Num() * DualSenseReport::USBReportLength);
+	for (int32 Index = 0; Index < Reports.Num(); ++Index)
+	{
+		const FDualSenseInputReport& Report = Reports[Index];
+		DualSenseReport::EncodeUSBReport(Report.State, Report.Sequence, Report.SensorTimestamp, RawReports.GetData() + Index * DualSenseReport::USBReportLength, Report.TouchContacts);
+	}
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	uint32 Magic = SessionMagic;
+	uint32 Version = CurrentVersion;
+	FDualSenseCalibration StoredCalibration = Calibration;
+	Writer << Magic << Version << StoredCalibration << RawReports;
+
+	if (!FFileHelper::SaveArrayToFile(Data, *File))
+	{
+		UE_LOG(LogWinDualSense, Warning, TEXT("Can't Save DualSense Session [%s]"), *File);
+		return false;
+	}
+	return true;
+}
+
+bool FDualSenseSession::Load(const FString& File)
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *File))
+	{
+		UE_LOG(LogWinDualSense, Warning, TEXT("Can't Load DualSense Session [%s]"), *File);
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	TArray<uint8> RawReports;
+	Reader << Magic << Version;
+	if (Magic != SessionMagic || Version != CurrentVersion)
+	{
+		UE_LOG(LogWinDualSense, Warning, TEXT("Not A DualSense Session [%s]"), *File);
+		return false;
+	}
+
+	Reader << Calibration << RawReports;
+	if (Reader.IsError() || RawReports.Num() % DualSenseReport::USBReportLength != 0)
+	{
+		UE_LOG(LogWinDualSense, Warning, TEXT("Corrupt DualSense Session [%s]"), *File);
+		return false;
+	}
+
+	const int32 ReportCount = RawReports.Num() / DualSenseReport::USBReportLength;
+	Reports.SetNumUninitialized(ReportCount);
+	for (int32 Index = 0; Index < ReportCount; ++Index)
+	{
+		DualSenseReport::DecodeReport(RawReports.GetData() + Index * DualSenseReport::USBReportLength + DualSenseReport::USBPayloadOffset, Reports[Index]);
+		Reports[Index].ReceiveCycles = 0;
+	}
+	return true;
+}
+
+FString FDualSenseSession::MakeFileName()
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("DualSense"), TEXT("Sessions"), FDateTime::Now().ToString() + TEXT(".dsession"));
+}
+#pragma endregion
@@ -0,0 +1,150 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseSharedState.h"
+#include "WinDualSensePCH.h"
+
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <Windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+
+#pragma region Dual Sense [Shared State Writer]
+FDualSenseSharedStateWriter::~FDualSenseSharedStateWriter()
+{
+	Close();
+}
+
+bool FDualSenseSharedStateWriter::Open(const FString& InName)
+{
+	Close();
+
+	Mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(DualSenseShared::FRegion), *InName);
+	if (!Mapping)
+	{
+		UE_LOG(LogWinDualSense, Warning, TEXT("Can't Create DualSense Shared State [%s] [%u]"), *InName, GetLastError());
+		return false;
+	}
+
+	//Readers keep a region alive after its game quit, only a live game (fresh heartbeat) keeps the name
+	const bool bAlreadyExists = GetLastError() == ERROR_ALREADY_EXISTS;
+
+	Region = static_cast<DualSenseShared::FRegion*>(MapViewOfFile(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(DualSenseShared::FRegion)));
+	if (!Region)
+	{
+		UE_LOG(LogWinDualSense, Warning, TEXT("Can't Map DualSense Shared State [%s] [%u]"), *InName, GetLastError());
+		Close();
+		return false;
+	}
+
+	//A closed writer clears the heartbeat, its name can be taken again at once
+	const uint64 HeartbeatTicks = Region->Header.HeartbeatTicks.load(std::memory_order_acquire);
+	if (bAlreadyExists && Region->Header.Magic == DualSenseShared::Magic && Region->Header.TicksPerSecond > 0 && HeartbeatTicks != 0)
+	{
+		const double HeartbeatAge = (double)(FPlatformTime::Cycles64() - HeartbeatTicks) / (double)Region->Header.TicksPerSecond;
+		if (HeartbeatAge < StaleHeartbeatSeconds)
+		{
+			UE_LOG(LogWinDualSense, Warning, TEXT("DualSense Shared State [%s] Is Published By Another Process"), *InName);
+			//Not ours, Close() would mark its controllers disconnected
+			UnmapViewOfFile(Region);
+			Region = nullptr;
+			Close();
+			return false;
+		}
+	}
+
+	//Counters restart, readers resync through their cursors
+	Region->Header.Magic = 0;
+	std::atomic_thread_fence(std::memory_order_release);
+	FMemory::Memzero(Region, sizeof(DualSenseShared::FRegion));
+
+	DualSenseShared::FHeader& Header = Region->Header;
+	Header.Version = DualSenseShared::Version;
+	Header.RegionSize = sizeof(DualSenseShared::FRegion);
+	Header.RecordSize = sizeof(DualSenseShared::FRecord);
+	Header.MaxControllers = DualSenseShared::MaxControllers;
+	Header.RingSize = DualSenseShared::RingSize;
+	Header.TicksPerSecond = (uint64)(1.0 / FPlatformTime::GetSecondsPerCycle64());
+	Header.HeartbeatTicks.store(FPlatformTime::Cycles64(), std::memory_order_relaxed);
+
+	//Readers check the magic first, it goes in last
+	std::atomic_thread_fence(std::memory_order_release);
+	Header.Magic = DualSenseShared::Magic;
+
+	Name = InName;
+	UE_LOG(LogWinDualSense, Log, TEXT("DualSense Shared State Published [%s] [%u bytes]"), *Name, (uint32)sizeof(DualSenseShared::FRegion));
+	return true;
+}
+
+void FDualSenseSharedStateWriter::Close()
+{
+	if (Region)
+	{
+		for (DualSenseShared::FControllerBlock& Block : Region->Controllers)
+		{
+			Block.bConnected.store(0, std::memory_order_release);
+		}
+		Region->Header.HeartbeatTicks.store(0, std::memory_order_release);
+		UnmapViewOfFile(Region);
+		Region = nullptr;
+	}
+	if (Mapping)
+	{
+		CloseHandle(Mapping);
+		Mapping = nullptr;
+	}
+	Name.Reset();
+}
+
+void FDualSenseSharedStateWriter::Publish(int32 ControllerId, const FDualSenseInputReport& Report)
+{
+	if (Region && (uint32)ControllerId < DualSenseShared::MaxControllers)
+	{
+		DualSenseShared::WriteRecord(Region->Controllers[ControllerId], MakeRecord(Report));
+	}
+}
+
+void FDualSenseSharedStateWriter::SetConnected(int32 ControllerId, bool bConnected)
+{
+	if (Region && (uint32)ControllerId < DualSenseShared::MaxControllers)
+	{
+		Region->Controllers[ControllerId].bConnected.store(bConnected ? 1 : 0, std::memory_order_release);
+	}
+}
+
+void FDualSenseSharedStateWriter::Heartbeat()
+{
+	if (Region)
+	{
+		Region->Header.HeartbeatTicks.store(FPlatformTime::Cycles64(), std::memory_order_release);
+	}
+}
+
+DualSenseShared::FRecord FDualSenseSharedStateWriter::MakeRecord(const FDualSenseInputReport& Report)
+{
+	const DS5W::DS5InputState& State = Report.State;
+
+	DualSenseShared::FRecord Record;
+	FMemory::Memzero(Record);
+	Record.ReceiveTicks = Report.ReceiveCycles;
+	Record.SensorTimestamp = Report.SensorTimestamp;
+	Record.Buttons = Report.Buttons;
+	Record.Sequence = Report.Sequence;
+	Record.BatteryLevel = State.battery.level;
+	Record.LeftTrigger = State.leftTrigger;
+	Record.RightTrigger = State.rightTrigger;
+	Record.LeftStick[0] = State.leftStick.x;
+	Record.LeftStick[1] = State.leftStick.y;
+	Record.RightStick[0] = State.rightStick.x;
+	Record.RightStick[1] = State.rightStick.y;
+	Record.Gyroscope[0] = Report.Gyroscope.x;
+	Record.Gyroscope[1] = Report.Gyroscope.y;
+	Record.Gyroscope[2] = Report.Gyroscope.z;
+	Record.Accelerometer[0] = Report.Accelerometer.x;
+	Record.Accelerometer[1] = Report.Accelerometer.y;
+	Record.Accelerometer[2] = Report.Accelerometer.z;
+	Record.TouchPoints[0][0] = (uint16)State.touchPoint1.x;
+	Record.TouchPoints[0][1] = (uint16)State.touchPoint1.y;
+	Record.TouchPoints[1][0] = (uint16)State.touchPoint2.x;
+	Record.TouchPoints[1][1] = (uint16)State.touchPoint2.y;
+	return Record;
+}
+#pragma endregion
@@ -0,0 +1,694 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseStream.h"
+#include "WinDualSensePCH.h"
+#include "WinDualSenseIO.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+#include "Common/UdpSocketBuilder.h"
+
+namespace
+{
+	constexpr int32 FieldBits[DualSenseStream::FieldCount] =
+	{
+		8, 8, 8,				//Buttons
+		8, 8, 8, 8,				//Sticks
+		8, 8,					//Triggers
+		12, 12, 12, 12,			//Touch points
+		8, 8,					//Touch contacts
+		16, 16, 16,				//Gyroscope
+		16, 16, 16,				//Accelerometer
+		8, 8,					//Trigger feedback
+		8,						//Status
+		8,						//Sequence
+		32						//Sensor timestamp
+	};
+
+	//Changed fields carry a 2 bit size class, then the zigzag delta in that many bits (the last class is the full width)
+	constexpr int32 SizeClassBits[3] = { 4, 8, 16 };
+
+	//LSB first bit stream over a caller owned buffer, overflow is sticky
+	struct FBitPacker
+	{
+		FBitPacker(uint8* InData, int32 InMaxBytes) : Data(InData), MaxBits(InMaxBytes * 8) {}
+
+		void Write(uint64 Value, int32 Bits)
+		{
+			if (NumBits + Bits > MaxBits)
+			{
+				bOverflow = true;
+				return;
+			}
+
+			for (int32 Bit = 0; Bit < Bits; ++Bit, ++NumBits)
+			{
+				const uint8 Mask = (uint8)(1u << (NumBits & 7));
+				Data[NumBits >> 3] = ((Value >> Bit) & 1) ? (Data[NumBits >> 3] | Mask) : (Data[NumBits >> 3] & ~Mask);
+			}
+		}
+
+		void WriteBits(const uint8* Source, int32 Bits)
+		{
+			for (int32 Bit = 0; Bit < Bits; ++Bit)
+			{
+				Write((Source[Bit >> 3] >> (Bit & 7)) & 1, 1);
+			}
+		}
+
+		FORCEINLINE int32 GetNumBytes() const
+		{
+			return (NumBits + 7) >> 3;
+		}
+
+		uint8* Data;
+		int32 MaxBits;
+		int32 NumBits = 0;
+		bool bOverflow = false;
+	};
+
+	struct FBitUnpacker
+	{
+		FBitUnpacker(const uint8* InData, int32 InNumBytes) : Data(InData), MaxBits(InNumBytes * 8) {}
+
+		uint64 Read(int32 Bits)
+		{
+			if (Position + Bits > MaxBits)
+			{
+				bOverflow = true;
+				return 0;
+			}
+
+			uint64 Value = 0;
+			for (int32 Bit = 0; Bit < Bits; ++Bit, ++Position)
+			{
+				Value |= (uint64)((Data[Position >> 3] >> (Position & 7)) & 1) << Bit;
+			}
+			return Value;
+		}
+
+		const uint8* Data;
+		int32 MaxBits;
+		int32 Position = 0;
+		bool bOverflow = false;
+	};
+
+	FORCEINLINE uint64 GetFieldMask(int32 Bits)
+	{
+		return Bits >= 64 ? ~0ull : (1ull << Bits) - 1;
+	}
+
+	void WriteField(FBitPacker& Packer, int32 Bits, uint32 Value, uint32 Base)
+	{
+		if (Value == Base)
+		{
+			Packer.Write(0, 1);
+			return;
+		}
+		Packer.Write(1, 1);
+
+		//Wrapped delta as a signed value of the field width, zigzag keeps small steps either way small
+		const uint64 Delta = ((uint64)Value - (uint64)Base) & GetFieldMask(Bits);
+		const int64 SignedDelta = Delta >= (1ull << (Bits - 1)) ? (int64)Delta - (int64)(1ull << Bits) : (int64)Delta;
+		const uint64 ZigZag = ((uint64)SignedDelta << 1) ^ (uint64)(SignedDelta >> 63);
+
+		for (int32 SizeClass = 0; SizeClass < 3; ++SizeClass)
+		{
+			const int32 ClassBits = FMath::Min(SizeClassBits[SizeClass], Bits);
+			if (ClassBits < Bits && ZigZag < (1ull << ClassBits))
+			{
+				Packer.Write(SizeClass, 2);
+				Packer.Write(ZigZag, ClassBits);
+				return;
+			}
+		}
+
+		Packer.Write(3, 2);
+		Packer.Write(ZigZag & GetFieldMask(Bits), Bits);
+	}
+
+	uint32 ReadField(FBitUnpacker& Unpacker, int32 Bits, uint32 Base)
+	{
+		if (!Unpacker.Read(1))
+		{
+			return Base;
+		}
+
+		const int32 SizeClass = (int32)Unpacker.Read(2);
+		const int32 ClassBits = SizeClass < 3 ? FMath::Min(SizeClassBits[SizeClass], Bits) : Bits;
+		const uint64 ZigZag = Unpacker.Read(ClassBits);
+		const int64 SignedDelta = (int64)(ZigZag >> 1) ^ -(int64)(ZigZag & 1);
+		return (uint32)(((uint64)Base + (uint64)SignedDelta) & GetFieldMask(Bits));
+	}
+
+	//Packet : Sequence(16) | KeyFrame(1) | [Baseline(16)] | fields
+	void WritePacket(FBitPacker& Packer, uint16 Sequence, const FDualSenseStreamState& State, const FDualSenseStreamState& Base, const uint16* Baseline)
+	{
+		Packer.Write(Sequence, 16);
+		Packer.Write(Baseline ? 0 : 1, 1);
+		if (Baseline)
+		{
+			Packer.Write(*Baseline, 16);
+		}
+
+		for (int32 Field = 0; Field < DualSenseStream::FieldCount; ++Field)
+		{
+			WriteField(Packer, FieldBits[Field], State.Fields[Field], Base.Fields[Field]);
+		}
+	}
+
+	FORCEINLINE uint32 ToField(int32 Value, EDualSenseStreamField Field)
+	{
+		return (uint32)Value & (uint32)GetFieldMask(FieldBits[(int32)Field]);
+	}
+
+	const FDualSenseStreamState ZeroState = {};
+}
+
+#pragma region Dual Sense [Stream]
+int32 DualSenseStream::GetFieldBits(EDualSenseStreamField Field)
+{
+	return FieldBits[(int32)Field];
+}
+
+int32 DualSenseStream::WriteAck(uint16 Sequence, bool bNeedKeyFrame, uint8* OutDatagram)
+{
+	OutDatagram[0] = (uint8)Magic;
+	OutDatagram[1] = (uint8)(Magic >> 8);
+	OutDatagram[2] = (uint8)Sequence;
+	OutDatagram[3] = (uint8)(Sequence >> 8);
+	OutDatagram[4] = bNeedKeyFrame ? 1 : 0;
+	return AckSize;
+}
+
+bool DualSenseStream::ReadAck(const uint8* Datagram, int32 Size, uint16& OutSequence, bool& bOutNeedKeyFrame)
+{
+	if (Size != AckSize || ((uint16)Datagram[0] | ((uint16)Datagram[1] << 8)) != Magic)
+	{
+		return false;
+	}
+
+	OutSequence = (uint16)Datagram[2] | ((uint16)Datagram[3] << 8);
+	bOutNeedKeyFrame = (Datagram[4] & 1) != 0;
+	return true;
+}
+
+FDualSenseStreamState FDualSenseStreamState::FromReport(const FDualSenseInputReport& Report)
+{
+	const DS5W::DS5InputState& State = Report.State;
+
+	FDualSenseStreamState StreamState;
+	uint32* Fields = StreamState.Fields;
+	Fields[(int32)EDualSenseStreamField::ButtonsAndDpad] = State.buttonsAndDpad;
+	Fields[(int32)EDualSenseStreamField::ButtonsA] = State.buttonsA;
+	Fields[(int32)EDualSenseStreamField::ButtonsB] = State.buttonsB;
+	Fields[(int32)EDualSenseStreamField::LeftStickX] = ToField(State.leftStick.x, EDualSenseStreamField::LeftStickX);
+	Fields[(int32)EDualSenseStreamField::LeftStickY] = ToField(State.leftStick.y, EDualSenseStreamField::LeftStickY);
+	Fields[(int32)EDualSenseStreamField::RightStickX] = ToField(State.rightStick.x, EDualSenseStreamField::RightStickX);
+	Fields[(int32)EDualSenseStreamField::RightStickY] = ToField(State.rightStick.y, EDualSenseStreamField::RightStickY);
+	Fields[(int32)EDualSenseStreamField::LeftTrigger] = State.leftTrigger;
+	Fields[(int32)EDualSenseStreamField::RightTrigger] = State.rightTrigger;
+	Fields[(int32)EDualSenseStreamField::Touch1X] = ToField(State.touchPoint1.x, EDualSenseStreamField::Touch1X);
+	Fields[(int32)EDualSenseStreamField::Touch1Y] = ToField(State.touchPoint1.y, EDualSenseStreamField::Touch1Y);
+	Fields[(int32)EDualSenseStreamField::Touch2X] = ToField(State.touchPoint2.x, EDualSenseStreamField::Touch2X);
+	Fields[(int32)EDualSenseStreamField::Touch2Y] = ToField(State.touchPoint2.y, EDualSenseStreamField::Touch2Y);
+	Fields[(int32)EDualSenseStreamField::Touch1Contact] = Report.TouchContacts[0];
+	Fields[(int32)EDualSenseStreamField::Touch2Contact] = Report.TouchContacts[1];
+	Fields[(int32)EDualSenseStreamField::GyroscopeX] = ToField(Report.Gyroscope.x, EDualSenseStreamField::GyroscopeX);
+	Fields[(int32)EDualSenseStreamField::GyroscopeY] = ToField(Report.Gyroscope.y, EDualSenseStreamField::GyroscopeY);
+	Fields[(int32)EDualSenseStreamField::GyroscopeZ] = ToField(Report.Gyroscope.z, EDualSenseStreamField::GyroscopeZ);
+	Fields[(int32)EDualSenseStreamField::AccelerometerX] = ToField(Report.Accelerometer.x, EDualSenseStreamField::AccelerometerX);
+	Fields[(int32)EDualSenseStreamField::AccelerometerY] = ToField(Report.Accelerometer.y, EDualSenseStreamField::AccelerometerY);
+	Fields[(int32)EDualSenseStreamField::AccelerometerZ] = ToField(Report.Accelerometer.z, EDualSenseStreamField::AccelerometerZ);
+	Fields[(int32)EDualSenseStreamField::LeftTriggerFeedback] = State.leftTriggerFeedback;
+	Fields[(int32)EDualSenseStreamField::RightTriggerFeedback] = State.rightTriggerFeedback;
+	Fields[(int32)EDualSenseStreamField::Status] = (State.battery.level & 0x0F) | (State.battery.chargin ? 0x10 : 0) | (State.battery.fullyCharged ? 0x20 : 0) | (State.headPhoneConnected ? 0x40 : 0);
+	Fields[(int32)EDualSenseStreamField::Sequence] = Report.Sequence;
+	Fields[(int32)EDualSenseStreamField::SensorTimestamp] = Report.SensorTimestamp;
+	return StreamState;
+}
+
+void FDualSenseStreamState::ToReport(FDualSenseInputReport& OutReport) const
+{
+	DS5W::DS5InputState& State = OutReport.State;
+	FMemory::Memzero(State);
+
+	//Narrowing back to the field's C type restores the sign
+	State.buttonsAndDpad = (unsigned char)Fields[(int32)EDualSenseStreamField::ButtonsAndDpad];
+	State.buttonsA = (unsigned char)Fields[(int32)EDualSenseStreamField::ButtonsA];
+	State.buttonsB = (unsigned char)Fields[(int32)EDualSenseStreamField::ButtonsB];
+	State.leftStick.x = (char)Fields[(int32)EDualSenseStreamField::LeftStickX];
+	State.leftStick.y = (char)Fields[(int32)EDualSenseStreamField::LeftStickY];
+	State.rightStick.x = (char)Fields[(int32)EDualSenseStreamField::RightStickX];
+	State.rightStick.y = (char)Fields[(int32)EDualSenseStreamField::RightStickY];
+	State.leftTrigger = (unsigned char)Fields[(int32)EDualSenseStreamField::LeftTrigger];
+	State.rightTrigger = (unsigned char)Fields[(int32)EDualSenseStreamField::RightTrigger];
+	State.touchPoint1.x = Fields[(int32)EDualSenseStreamField::Touch1X];
+	State.touchPoint1.y = Fields[(int32)EDualSenseStreamField::Touch1Y];
+	State.touchPoint2.x = Fields[(int32)EDualSenseStreamField::Touch2X];
+	State.touchPoint2.y = Fields[(int32)EDualSenseStreamField::Touch2Y];
+	OutReport.TouchContacts[0] = (uint8)Fields[(int32)EDualSenseStreamField::Touch1Contact];
+	OutReport.TouchContacts[1] = (uint8)Fields[(int32)EDualSenseStreamField::Touch2Contact];
+
+	OutReport.Gyroscope.x = (short)Fields[(int32)EDualSenseStreamField::GyroscopeX];
+	OutReport.Gyroscope.y = (short)Fields[(int32)EDualSenseStreamField::GyroscopeY];
+	OutReport.Gyroscope.z = (short)Fields[(int32)EDualSenseStreamField::GyroscopeZ];
+	OutReport.Accelerometer.x = (short)Fields[(int32)EDualSenseStreamField::AccelerometerX];
+	OutReport.Accelerometer.y = (short)Fields[(int32)EDualSenseStreamField::AccelerometerY];
+	OutReport.Accelerometer.z = (short)Fields[(int32)EDualSenseStreamField::AccelerometerZ];
+
+	//DS5W's labels, gyroscope block in accelerometer (see DualSenseReport::DecodeInputState)
+	State.accelerometer = OutReport.Gyroscope;
+	State.gyroscope = OutReport.Accelerometer;
+
+	State.leftTriggerFeedback = (unsigned char)Fields[(int32)EDualSenseStreamField::LeftTriggerFeedback];
+	State.rightTriggerFeedback = (unsigned char)Fields[(int32)EDualSenseStreamField::RightTriggerFeedback];
+
+	const uint32 Status = Fields[(int32)EDualSenseStreamField::Status];
+	State.battery.level = (unsigned char)(Status & 0x0F);
+	State.battery.chargin = (Status & 0x10) != 0;
+	State.battery.fullyCharged = (Status & 0x20) != 0;
+	State.headPhoneConnected = (Status & 0x40) != 0;
+
+	OutReport.Sequence = (uint8)Fields[(int32)EDualSenseStreamField::Sequence];
+	OutReport.SensorTimestamp = Fields[(int32)EDualSenseStreamField::SensorTimestamp];
+	OutReport.Buttons = DualSenseReport::PackButtons(State);
+}
+
+FDualSenseStreamEncoder::FDualSenseStreamEncoder()
+{
+	Reset();
+}
+
+void FDualSenseStreamEncoder::Reset()
+{
+	for (FPacket& Packet : History)
+	{
+		Packet.bValid = false;
+	}
+	NextSequence = 0;
+	bHasAck = false;
+	AckedSequence = 0;
+	PacketsSinceAck = 0;
+	bHasKeyFrame = false;
+	KeyFrameSequence = 0;
+	KeyFrames.store(0, std::memory_order_relaxed);
+	KeyFrameRequests.store(0, std::memory_order_relaxed);
+	AckTimeouts.store(0, std::memory_order_relaxed);
+}
+
+int32 FDualSenseStreamEncoder::Encode(const FDualSenseInputReport& Report, uint8* OutDatagram)
+{
+	const uint16 Sequence = NextSequence++;
+	FPacket& Packet = History[Sequence % DualSenseStream::HistorySize];
+	Packet.bValid = true;
+	Packet.Sequence = Sequence;
+	Packet.State = FDualSenseStreamState::FromReport(Report);
+
+	//The host went quiet (restarted, or the link is down), whatever it acked before may be gone
+	if (bHasAck && ++PacketsSinceAck > DualSenseStream::AckTimeout)
+	{
+		bHasAck = false;
+		AckTimeouts.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	//Only acknowledged states are known to the host, too old ones may be gone from its history
+	const FPacket* Baseline = nullptr;
+	if (bHasAck && (uint16)(Sequence - AckedSequence) < DualSenseStream::HistorySize)
+	{
+		const FPacket& Acked = History[AckedSequence % DualSenseStream::HistorySize];
+		Baseline = (Acked.bValid && Acked.Sequence == AckedSequence) ? &Acked : nullptr;
+	}
+
+	FBitPacker PacketPacker(Packet.Bytes, DualSenseStream::MaxPacketBytes);
+	WritePacket(PacketPacker, Sequence, Packet.State, Baseline ? Baseline->State : ZeroState, Baseline ? &Baseline->Sequence : nullptr);
+	check(!PacketPacker.bOverflow);
+	Packet.NumBits = PacketPacker.NumBits;
+	if (!Baseline)
+	{
+		bHasKeyFrame = true;
+		KeyFrameSequence = Sequence;
+		KeyFrames.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	//Datagram : Magic(16) | PacketCount - 1 (2) | packets, newest first
+	int32 PacketCount = 1;
+	const int32 MaxRedundancy = FMath::Clamp(Redundancy, 0, DualSenseStream::MaxRedundancy);
+	for (; PacketCount <= MaxRedundancy; ++PacketCount)
+	{
+		const uint16 EarlierSequence = (uint16)(Sequence - PacketCount);
+		const FPacket& Earlier = History[EarlierSequence % DualSenseStream::HistorySize];
+		if (!Earlier.bValid || Earlier.Sequence != EarlierSequence)
+			break;
+	}
+
+	FBitPacker Packer(OutDatagram, DualSenseStream::MaxDatagramSize);
+	Packer.Write(DualSenseStream::Magic, 16);
+	Packer.Write(PacketCount - 1, 2);
+	for (int32 Index = 0; Index < PacketCount; ++Index)
+	{
+		const FPacket& Sent = History[(uint16)(Sequence - Index) % DualSenseStream::HistorySize];
+		Packer.WriteBits(Sent.Bytes, Sent.NumBits);
+	}
+	check(!Packer.bOverflow);
+
+	return Packer.GetNumBytes();
+}
+
+void FDualSenseStreamEncoder::Acknowledge(uint16 Sequence)
+{
+	PacketsSinceAck = 0;
+
+	//Acks arrive out of order too, only move forward
+	if (!bHasAck || (int16)(Sequence - AckedSequence) > 0)
+	{
+		bHasAck = true;
+		AckedSequence = Sequence;
+	}
+}
+
+void FDualSenseStreamEncoder::RequestKeyFrame(uint16 Sequence)
+{
+	PacketsSinceAck = 0;
+
+	//Every datagram the host could not decode asks, one key frame after the first of them answers them all
+	if (bHasKeyFrame && (int16)(KeyFrameSequence - Sequence) > 0)
+		return;
+
+	bHasAck = false;
+	KeyFrameRequests.fetch_add(1, std::memory_order_relaxed);
+}
+
+FDualSenseStreamDecoder::FDualSenseStreamDecoder()
+{
+	Reset();
+}
+
+void FDualSenseStreamDecoder::Reset()
+{
+	for (FPacket& Packet : History)
+	{
+		Packet.bValid = false;
+	}
+	bHasPacket = false;
+	NewestSequence = 0;
+	bNeedsKeyFrame = false;
+	UndecodableSequence = 0;
+
+	DecodedPackets = 0;
+	RecoveredPackets = 0;
+	UndecodablePackets = 0;
+	StalePackets = 0;
+	MalformedDatagrams = 0;
+}
+
+bool FDualSenseStreamDecoder::Decode(const uint8* Datagram, int32 Size, TFunctionRef<void(const FDualSenseInputReport&)> Emit)
+{
+	FBitUnpacker Unpacker(Datagram, Size);
+	if (Unpacker.Read(16) != DualSenseStream::Magic)
+	{
+		++MalformedDatagrams;
+		return false;
+	}
+
+	const int32 PacketCount = (int32)Unpacker.Read(2) + 1;
+
+	struct FDecodedPacket
+	{
+		uint16 Sequence;
+		bool bIsNew;
+		bool bIsDecoded;
+		FDualSenseStreamState State;
+	};
+	FDecodedPacket Packets[DualSenseStream::MaxRedundancy + 1];
+
+	//Packets are variable length, every one is parsed even when it is already known
+	for (int32 Index = 0; Index < PacketCount; ++Index)
+	{
+		FDecodedPacket& Packet = Packets[Index];
+		Packet.Sequence = (uint16)Unpacker.Read(16);
+		const bool bIsKeyFrame = Unpacker.Read(1) != 0;
+		const uint16 BaselineSequence = bIsKeyFrame ? 0 : (uint16)Unpacker.Read(16);
+
+		const FPacket& Known = History[Packet.Sequence % DualSenseStream::HistorySize];
+		const bool bIsKnown = Known.bValid && Known.Sequence == Packet.Sequence;
+		const bool bIsTooOld = bHasPacket && (int16)(Packet.Sequence - NewestSequence) <= -DualSenseStream::HistorySize;
+		Packet.bIsNew = !bIsKnown && !bIsTooOld;
+
+		const FPacket& Baseline = History[BaselineSequence % DualSenseStream::HistorySize];
+		const bool bHasBaseline = bIsKeyFrame || (Baseline.bValid && Baseline.Sequence == BaselineSequence);
+		Packet.bIsDecoded = Packet.bIsNew && bHasBaseline;
+		UndecodablePackets += (Packet.bIsNew && !bHasBaseline) ? 1 : 0;
+
+		const FDualSenseStreamState& Base = (bIsKeyFrame || !bHasBaseline) ? ZeroState : Baseline.State;
+		for (int32 Field = 0; Field < DualSenseStream::FieldCount; ++Field)
+		{
+			Packet.State.Fields[Field] = ReadField(Unpacker, FieldBits[Field], Base.Fields[Field]);
+		}
+	}
+
+	if (Unpacker.bOverflow)
+	{
+		++MalformedDatagrams;
+		return false;
+	}
+
+	//Oldest first, the redundant copies come after the packet that repeats them
+	bool bHasNewPacket = false;
+	for (int32 Index = PacketCount - 1; Index >= 0; --Index)
+	{
+		const FDecodedPacket& Packet = Packets[Index];
+		if (!Packet.bIsDecoded)
+		{
+			//Deltas against states this host never had, the client has to start over from a key frame
+			if (Packet.bIsNew && (!bHasPacket || (int16)(Packet.Sequence - NewestSequence) > 0))
+			{
+				bNeedsKeyFrame = true;
+				UndecodableSequence = Packet.Sequence;
+			}
+			continue;
+		}
+
+		FPacket& Stored = History[Packet.Sequence % DualSenseStream::HistorySize];
+		Stored.bValid = true;
+		Stored.Sequence = Packet.Sequence;
+		Stored.State = Packet.State;
+
+		//Still a baseline for later packets, but a reordered datagram must not take the state back in time
+		if (bHasPacket && (int16)(Packet.Sequence - NewestSequence) <= 0)
+		{
+			++StalePackets;
+			continue;
+		}
+		NewestSequence = Packet.Sequence;
+		bHasPacket = true;
+		bHasNewPacket = true;
+		bNeedsKeyFrame = false;
+
+		++DecodedPackets;
+		RecoveredPackets += Index > 0 ? 1 : 0;
+
+		FDualSenseInputReport Report;
+		Packet.State.ToReport(Report);
+		Report.ReceiveCycles = FPlatformTime::Cycles64();
+		Emit(Report);
+	}
+
+	return bHasNewPacket;
+}
+
+FDualSenseStreamClient::~FDualSenseStreamClient()
+{
+	Disconnect();
+}
+
+bool FDualSenseStreamClient::Connect(const FString& Host, int32 Port)
+{
+	Disconnect();
+
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	if (!SocketSubsystem)
+	{
+		return false;
+	}
+
+	bool bIsValid = false;
+	HostAddress = SocketSubsystem->CreateInternetAddr();
+	HostAddress->SetIp(*Host, bIsValid);
+	HostAddress->SetPort(Port);
+	if (!bIsValid)
+	{
+		UE_LOG(LogWinDualSense, Error, TEXT("Invalid DualSense Stream Host! [%s]"), *Host);
+		return false;
+	}
+
+	//Ephemeral port, acks come back to it
+	Socket = FUdpSocketBuilder(TEXT("DualSenseStreamClient")).AsNonBlocking().Build();
+	if (!Socket)
+	{
+		UE_LOG(LogWinDualSense, Error, TEXT("Can't Create DualSense Stream Socket!"));
+		return false;
+	}
+
+	Encoder.Reset();
+	SentReports.store(0, std::memory_order_relaxed);
+	SentBytes.store(0, std::memory_order_relaxed);
+	DroppedDatagrams.store(0, std::memory_order_relaxed);
+	DropRandom.Initialize(0x5D5);
+	return true;
+}
+
+void FDualSenseStreamClient::Disconnect()
+{
+	if (Socket)
+	{
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+	HostAddress.Reset();
+}
+
+bool FDualSenseStreamClient::Send(const FDualSenseInputReport& Report)
+{
+	if (!Socket)
+	{
+		return false;
+	}
+
+	uint8 Datagram[DualSenseStream::MaxDatagramSize];
+	int32 BytesRead = 0;
+	while (Socket->Recv(Datagram, sizeof(Datagram), BytesRead) && BytesRead > 0)
+	{
+		uint16 AckedSequence = 0;
+		bool bNeedKeyFrame = false;
+		if (!DualSenseStream::ReadAck(Datagram, BytesRead, AckedSequence, bNeedKeyFrame))
+			continue;
+
+		if (bNeedKeyFrame)
+		{
+			Encoder.RequestKeyFrame(AckedSequence);
+		}
+		else
+		{
+			Encoder.Acknowledge(AckedSequence);
+		}
+	}
+
+	const int32 DatagramSize = Encoder.Encode(Report, Datagram);
+	SentReports.fetch_add(1, std::memory_order_relaxed);
+
+	if (DropRate > 0.f && DropRandom.FRand() < DropRate)
+	{
+		DroppedDatagrams.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	int32 BytesSent = 0;
+	if (!Socket->SendTo(Datagram, DatagramSize, BytesSent, *HostAddress))
+	{
+		return false;
+	}
+	SentBytes.fetch_add(BytesSent, std::memory_order_relaxed);
+	return true;
+}
+
+FDualSenseStreamHost::FDualSenseStreamHost(FDualSenseIOThread& InIOThread, int32 InSlot)
+	: IOThread(InIOThread)
+	, Slot(InSlot)
+{
+}
+
+FDualSenseStreamHost::~FDualSenseStreamHost()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	if (Socket)
+	{
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+
+	//Game thread sees the controller disconnect and releases the slot
+	if (bHasSlot)
+	{
+		IOThread.CloseInjectedStream(Slot);
+	}
+}
+
+bool FDualSenseStreamHost::Start(int32 Port)
+{
+	if (Thread || Slot < 0 || Slot >= FDualSenseIOThread::MaxDevices)
+	{
+		return false;
+	}
+
+	Socket = FUdpSocketBuilder(TEXT("DualSenseStreamHost")).AsNonBlocking().BoundToPort(Port).WithReceiveBufferSize(64 * 1024).Build();
+	if (!Socket)
+	{
+		UE_LOG(LogWinDualSense, Error, TEXT("Can't Listen For DualSense Stream! [Port %d]"), Port);
+		return false;
+	}
+
+	if (!IOThread.OpenInjectedStream(Slot))
+	{
+		UE_LOG(LogWinDualSense, Error, TEXT("DualSense Stream Slot Is In Use! [%d]"), Slot);
+		return false;
+	}
+	bHasSlot = true;
+
+	Thread = FRunnableThread::Create(this, TEXT("DualSenseStreamHost"), 0, TPri_AboveNormal);
+	return Thread != nullptr;
+}
+
+uint32 FDualSenseStreamHost::Run()
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	TSharedRef<FInternetAddr> Sender = SocketSubsystem->CreateInternetAddr();
+
+	uint8 Datagram[DualSenseStream::MaxDatagramSize];
+	uint8 Ack[DualSenseStream::AckSize];
+
+	while (!bStopping.load())
+	{
+		//Timeout only to notice Stop()
+		if (!Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromMilliseconds(100)))
+			continue;
+
+		int32 BytesRead = 0;
+		while (Socket->RecvFrom(Datagram, sizeof(Datagram), BytesRead, *Sender) && BytesRead > 0)
+		{
+			ReceivedBytes.fetch_add(BytesRead, std::memory_order_relaxed);
+
+			const bool bHasNewPacket = Decoder.Decode(Datagram, BytesRead, [this](const FDualSenseInputReport& Report)
+			{
+				IOThread.InjectReport(Slot, Report);
+				ReceivedReports.fetch_add(1, std::memory_order_relaxed);
+			});
+
+			int32 BytesSent = 0;
+			if (bHasNewPacket)
+			{
+				Socket->SendTo(Ack, DualSenseStream::WriteAck(Decoder.GetNewestSequence(), false, Ack), BytesSent, *Sender);
+			}
+			else if (Decoder.NeedsKeyFrame())
+			{
+				Socket->SendTo(Ack, DualSenseStream::WriteAck(Decoder.GetUndecodableSequence(), true, Ack), BytesSent, *Sender);
+			}
+		}
+	}
+
+	return 0;
+}
+
+void FDualSenseStreamHost::Stop()
+{
+	bStopping.store(true);
+}
+#pragma endregion
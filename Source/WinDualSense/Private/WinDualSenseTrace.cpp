@@ -0,0 +1,49 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseTrace.h"
+
+#if DUALSENSE_TRACE_ENABLED
+#include "ProfilingDebugging/CountersTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(DualSenseChannel);
+
+TRACE_DECLARE_INT_COUNTER(DualSense_ReportsPerSecond, TEXT("DualSense/Reports Per Second"));
+TRACE_DECLARE_INT_COUNTER(DualSense_ReportQueueDepth, TEXT("DualSense/Report Queue Depth"));
+TRACE_DECLARE_INT_COUNTER(DualSense_OutputCommands, TEXT("DualSense/Output Commands"));
+TRACE_DECLARE_INT_COUNTER(DualSense_OutputReports, TEXT("DualSense/Output Reports"));
+TRACE_DECLARE_INT_COUNTER(DualSense_SuppressedOutputs, TEXT("DualSense/Suppressed Outputs"));
+#endif
+
+#pragma region Dual Sense [Trace]
+void FDualSenseTraceCounters::EndFrame(uint64 ReceivedReports)
+{
+#if DUALSENSE_TRACE_ENABLED
+	SuppressedOutputs += FMath::Max(OutputCommands - OutputReports, 0);
+
+	const uint64 Cycles = FPlatformTime::Cycles64();
+	const double WindowSeconds = FPlatformTime::ToSeconds64(Cycles - WindowStartCycles);
+	if (WindowStartCycles == 0 || ReceivedReports < WindowStartReports)
+	{
+		//First frame traced, or controllers went away
+		WindowStartCycles = Cycles;
+		WindowStartReports = ReceivedReports;
+	}
+	else if (WindowSeconds >= 1.0)
+	{
+		ReportsPerSecond = (int64)FMath::RoundToDouble((ReceivedReports - WindowStartReports) / WindowSeconds);
+		WindowStartCycles = Cycles;
+		WindowStartReports = ReceivedReports;
+	}
+
+	TRACE_COUNTER_SET(DualSense_ReportsPerSecond, ReportsPerSecond);
+	TRACE_COUNTER_SET(DualSense_ReportQueueDepth, ReportQueueDepth);
+	TRACE_COUNTER_SET(DualSense_OutputCommands, OutputCommands);
+	TRACE_COUNTER_SET(DualSense_OutputReports, OutputReports);
+	TRACE_COUNTER_SET(DualSense_SuppressedOutputs, SuppressedOutputs);
+#endif
+
+	ReportQueueDepth = 0;
+	OutputCommands = 0;
+	OutputReports = 0;
+}
+#pragma endregion
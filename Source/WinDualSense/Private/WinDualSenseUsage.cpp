@@ -0,0 +1,285 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "WinDualSenseUsage.h"
+#include "WinDualSenseReport.h"
+#include "WinDualSenseRemap.h"
+
+namespace
+{
+	//Longer gaps between two reports are a disconnect or a stall, not usage
+	constexpr uint32 MaxReportGapTicks = (uint32)(DualSenseReport::SensorTicksPerSecond * 0.1);
+	constexpr uint32 TicksPerMillisecond = (uint32)(DualSenseReport::SensorTicksPerSecond / 1000.0);
+
+	//Raw counts of 10, 30, 90 and 270 deg/s
+	constexpr int32 GyroBucketLimits[FDualSenseUsageCounters::GyroBuckets - 1] = { 164, 492, 1475, 4424 };
+
+	//Single writer : no locked instruction, readers still never see a torn value
+	template<typename CounterType>
+	FORCEINLINE void Increment(std::atomic<CounterType>& Counter, CounterType Amount = 1)
+	{
+		Counter.store(Counter.load(std::memory_order_relaxed) + Amount, std::memory_order_relaxed);
+	}
+
+	FORCEINLINE int32 GetStickCell(char X, char Y)
+	{
+		const int32 Column = ((int32)X + 128) >> 5;
+		const int32 Row = (127 - (int32)Y) >> 5;
+		return Row * FDualSenseUsageCounters::StickCells + Column;
+	}
+
+	template<typename CounterType, int32 Count>
+	void CopyCounters(uint64(&Out)[Count], const std::atomic<CounterType>(&Counters)[Count])
+	{
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			Out[Index] = Counters[Index].load(std::memory_order_relaxed);
+		}
+	}
+
+	template<int32 Count>
+	void SubtractCounters(uint64(&Out)[Count], const uint64(&Baseline)[Count])
+	{
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			Out[Index] = Out[Index] >= Baseline[Index] ? Out[Index] - Baseline[Index] : 0;
+		}
+	}
+
+	template<int32 Count>
+	uint64 SumCounters(const uint64(&Counters)[Count])
+	{
+		uint64 Sum = 0;
+		for (uint64 Value : Counters)
+		{
+			Sum += Value;
+		}
+		return Sum;
+	}
+
+	template<int32 Count>
+	void AppendCsvRows(FString& Out, int32 ControllerId, const TCHAR* Name, const uint64(&Counters)[Count])
+	{
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			if (Counters[Index] != 0)
+			{
+				Out += FString::Printf(TEXT("%d,%s,%d,%llu\n"), ControllerId, Name, Index, Counters[Index]);
+			}
+		}
+	}
+
+	void LogHeatmap(FOutputDevice& Ar, int32 ControllerId, const TCHAR* Name, const uint64(&Cells)[FDualSenseUsageCounters::StickCells * FDualSenseUsageCounters::StickCells])
+	{
+		const uint64 Total = FMath::Max<uint64>(SumCounters(Cells), 1);
+		for (int32 Row = 0; Row < FDualSenseUsageCounters::StickCells; ++Row)
+		{
+			FString Line;
+			for (int32 Column = 0; Column < FDualSenseUsageCounters::StickCells; ++Column)
+			{
+				Line += FString::Printf(TEXT(" %5.1f"), Cells[Row * FDualSenseUsageCounters::StickCells + Column] * 100.0 / Total);
+			}
+			Ar.Logf(TEXT("DualSense [%d] %s %% |%s"), ControllerId, Name, *Line);
+		}
+	}
+
+	template<int32 Count>
+	void LogHistogram(FOutputDevice& Ar, int32 ControllerId, const TCHAR* Name, const uint64(&Buckets)[Count])
+	{
+		const uint64 Total = FMath::Max<uint64>(SumCounters(Buckets), 1);
+		FString Line;
+		for (uint64 Value : Buckets)
+		{
+			Line += FString::Printf(TEXT(" %5.1f"), Value * 100.0 / Total);
+		}
+		Ar.Logf(TEXT("DualSense [%d] %s %% |%s"), ControllerId, Name, *Line);
+	}
+}
+
+#pragma region Dual Sense [Usage Counters]
+const TCHAR* FDualSenseUsageSnapshot::CsvHeader = TEXT("Controller,Counter,Index,Value\n");
+
+FDualSenseUsageCounters::FDualSenseUsageCounters()
+{
+	//Arrays of std::atomic start out uninitialized
+	Reports.store(0, std::memory_order_relaxed);
+	SensorTicks.store(0, std::memory_order_relaxed);
+	GyroActiveTicks.store(0, std::memory_order_relaxed);
+	DroppedGestures.store(0, std::memory_order_relaxed);
+
+	for (int32 Index = 0; Index < ButtonCount; ++Index)
+	{
+		Presses[Index].store(0, std::memory_order_relaxed);
+		HoldTicks[Index].store(0, std::memory_order_relaxed);
+	}
+	for (std::atomic<uint32>& Counter : Holds)
+	{
+		Counter.store(0, std::memory_order_relaxed);
+	}
+	for (int32 Index = 0; Index < StickCells * StickCells; ++Index)
+	{
+		LeftStick[Index].store(0, std::memory_order_relaxed);
+		RightStick[Index].store(0, std::memory_order_relaxed);
+	}
+	for (int32 Index = 0; Index < TriggerBuckets; ++Index)
+	{
+		LeftTrigger[Index].store(0, std::memory_order_relaxed);
+		RightTrigger[Index].store(0, std::memory_order_relaxed);
+	}
+	for (std::atomic<uint32>& Counter : Gyro)
+	{
+		Counter.store(0, std::memory_order_relaxed);
+	}
+}
+
+void FDualSenseUsageTracker::AddReport(const FDualSenseInputReport& Report)
+{
+	uint32 ReportTicks = 0;
+	if (bHasLastReport)
+	{
+		const uint32 Delta = Report.SensorTimestamp - LastSensorTimestamp;
+		ReportTicks = Delta <= MaxReportGapTicks ? Delta : 0;
+	}
+
+	Increment<uint64>(Counters.Reports);
+	Increment<uint64>(Counters.SensorTicks, ReportTicks);
+
+	const DS5W::DS5InputState& State = Report.State;
+	Increment<uint32>(Counters.LeftStick[GetStickCell(State.leftStick.x, State.leftStick.y)]);
+	Increment<uint32>(Counters.RightStick[GetStickCell(State.rightStick.x, State.rightStick.y)]);
+	Increment<uint32>(Counters.LeftTrigger[State.leftTrigger >> 4]);
+	Increment<uint32>(Counters.RightTrigger[State.rightTrigger >> 4]);
+
+	const int32 GyroRate = FMath::Max3(FMath::Abs((int32)Report.Gyroscope.x), FMath::Abs((int32)Report.Gyroscope.y), FMath::Abs((int32)Report.Gyroscope.z));
+	int32 GyroBucket = 0;
+	while (GyroBucket < FDualSenseUsageCounters::GyroBuckets - 1 && GyroRate >= GyroBucketLimits[GyroBucket])
+	{
+		++GyroBucket;
+	}
+	Increment<uint32>(Counters.Gyro[GyroBucket]);
+	if (GyroBucket > 0)
+	{
+		Increment<uint64>(Counters.GyroActiveTicks, ReportTicks);
+	}
+
+	const uint32 ChangedButtons = Report.Buttons ^ LastButtons;
+	if (ChangedButtons != 0)
+	{
+		CountButtons(Report.Buttons, ChangedButtons, Report.SensorTimestamp);
+	}
+
+	LastButtons = Report.Buttons;
+	LastSensorTimestamp = Report.SensorTimestamp;
+	bHasLastReport = true;
+}
+
+void FDualSenseUsageTracker::ResetTracking()
+{
+	LastButtons = 0;
+	LastSensorTimestamp = 0;
+	bHasLastReport = false;
+}
+
+void FDualSenseUsageTracker::AddDroppedGesture()
+{
+	Increment<uint64>(Counters.DroppedGestures);
+}
+
+void FDualSenseUsageTracker::CountButtons(uint32 Buttons, uint32 ChangedButtons, uint32 SensorTimestamp)
+{
+	for (uint32 Remaining = ChangedButtons; Remaining != 0; Remaining &= Remaining - 1)
+	{
+		const int32 Index = (int32)FMath::CountTrailingZeros(Remaining);
+		if (Index >= FDualSenseUsageCounters::ButtonCount)
+			break;
+
+		if (Buttons & (1u << Index))
+		{
+			Increment<uint32>(Counters.Presses[Index]);
+			PressTimestamps[Index] = SensorTimestamp;
+			continue;
+		}
+
+		//Sensor clock wraps after 23 minutes, a hold is always shorter than that
+		const uint32 HoldTicks = SensorTimestamp - PressTimestamps[Index];
+		const uint32 HoldMilliseconds = HoldTicks / TicksPerMillisecond;
+		const int32 Bucket = HoldMilliseconds < 16 ? 0 : FMath::Min((int32)FMath::FloorLog2(HoldMilliseconds) - 3, FDualSenseUsageCounters::HoldBuckets - 1);
+
+		Increment<uint64>(Counters.HoldTicks[Index], HoldTicks);
+		Increment<uint32>(Counters.Holds[Bucket]);
+	}
+}
+
+void FDualSenseUsageSnapshot::Capture(const FDualSenseUsageCounters& Counters)
+{
+	Reports = Counters.Reports.load(std::memory_order_relaxed);
+	SensorTicks = Counters.SensorTicks.load(std::memory_order_relaxed);
+	GyroActiveTicks = Counters.GyroActiveTicks.load(std::memory_order_relaxed);
+	DroppedGestures = Counters.DroppedGestures.load(std::memory_order_relaxed);
+	CopyCounters(Presses, Counters.Presses);
+	CopyCounters(HoldTicks, Counters.HoldTicks);
+	CopyCounters(Holds, Counters.Holds);
+	CopyCounters(LeftStick, Counters.LeftStick);
+	CopyCounters(RightStick, Counters.RightStick);
+	CopyCounters(LeftTrigger, Counters.LeftTrigger);
+	CopyCounters(RightTrigger, Counters.RightTrigger);
+	CopyCounters(Gyro, Counters.Gyro);
+}
+
+void FDualSenseUsageSnapshot::Subtract(const FDualSenseUsageSnapshot& Baseline)
+{
+	Reports = Reports >= Baseline.Reports ? Reports - Baseline.Reports : 0;
+	SensorTicks = SensorTicks >= Baseline.SensorTicks ? SensorTicks - Baseline.SensorTicks : 0;
+	GyroActiveTicks = GyroActiveTicks >= Baseline.GyroActiveTicks ? GyroActiveTicks - Baseline.GyroActiveTicks : 0;
+	DroppedGestures = DroppedGestures >= Baseline.DroppedGestures ? DroppedGestures - Baseline.DroppedGestures : 0;
+	SubtractCounters(Presses, Baseline.Presses);
+	SubtractCounters(HoldTicks, Baseline.HoldTicks);
+	SubtractCounters(Holds, Baseline.Holds);
+	SubtractCounters(LeftStick, Baseline.LeftStick);
+	SubtractCounters(RightStick, Baseline.RightStick);
+	SubtractCounters(LeftTrigger, Baseline.LeftTrigger);
+	SubtractCounters(RightTrigger, Baseline.RightTrigger);
+	SubtractCounters(Gyro, Baseline.Gyro);
+}
+
+void FDualSenseUsageSnapshot::Log(FOutputDevice& Ar, int32 ControllerId) const
+{
+	const double Seconds = SensorTicks / DualSenseReport::SensorTicksPerSecond;
+	const double GyroSeconds = GyroActiveTicks / DualSenseReport::SensorTicksPerSecond;
+	Ar.Logf(TEXT("DualSense [%d] Usage | Reports [%llu] | Seconds [%.1f] | Gyro Active [%.1f s] (%.1f%%) | Dropped Gestures [%llu]"), ControllerId,
+		Reports, Seconds, GyroSeconds, Seconds > 0.0 ? GyroSeconds * 100.0 / Seconds : 0.0, DroppedGestures);
+
+	//Presses and the mean hold (releases counted against presses, a button still down adds a press without a hold)
+	for (int32 Index = 0; Index < ButtonCount; ++Index)
+	{
+		if (Presses[Index] == 0)
+			continue;
+
+		Ar.Logf(TEXT("DualSense [%d] %-16s | Presses [%llu] | Held [%.2f s] | Mean Hold [%.1f ms]"), ControllerId,
+			FDualSenseButtonRemap::GetButtonName((EDualSenseButtonType)Index), Presses[Index],
+			HoldTicks[Index] / DualSenseReport::SensorTicksPerSecond, HoldTicks[Index] * 1000.0 / DualSenseReport::SensorTicksPerSecond / Presses[Index]);
+	}
+
+	LogHistogram(Ar, ControllerId, TEXT("Hold <16 <32 <64 <128 <256 <512 <1024 <2048 ms, longer"), Holds);
+	LogHeatmap(Ar, ControllerId, TEXT("Left Stick "), LeftStick);
+	LogHeatmap(Ar, ControllerId, TEXT("Right Stick"), RightStick);
+	LogHistogram(Ar, ControllerId, TEXT("Left Trigger Travel "), LeftTrigger);
+	LogHistogram(Ar, ControllerId, TEXT("Right Trigger Travel"), RightTrigger);
+	LogHistogram(Ar, ControllerId, TEXT("Gyro <10 <30 <90 <270 deg/s, faster"), Gyro);
+}
+
+void FDualSenseUsageSnapshot::AppendCsv(FString& Out, int32 ControllerId) const
+{
+	Out += FString::Printf(TEXT("%d,Reports,0,%llu\n"), ControllerId, Reports);
+	Out += FString::Printf(TEXT("%d,SensorTicks,0,%llu\n"), ControllerId, SensorTicks);
+	Out += FString::Printf(TEXT("%d,GyroActiveTicks,0,%llu\n"), ControllerId, GyroActiveTicks);
+	Out += FString::Printf(TEXT("%d,DroppedGestures,0,%llu\n"), ControllerId, DroppedGestures);
+	AppendCsvRows(Out, ControllerId, TEXT("Presses"), Presses);
+	AppendCsvRows(Out, ControllerId, TEXT("HoldTicks"), HoldTicks);
+	AppendCsvRows(Out, ControllerId, TEXT("Holds"), Holds);
+	AppendCsvRows(Out, ControllerId, TEXT("LeftStick"), LeftStick);
+	AppendCsvRows(Out, ControllerId, TEXT("RightStick"), RightStick);
+	AppendCsvRows(Out, ControllerId, TEXT("LeftTrigger"), LeftTrigger);
+	AppendCsvRows(Out, ControllerId, TEXT("RightTrigger"), RightTrigger);
+	AppendCsvRows(Out, ControllerId, TEXT("Gyro"), Gyro);
+}
+#pragma endregion
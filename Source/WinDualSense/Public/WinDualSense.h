@@ -8,6 +8,7 @@
 #include "IInputDeviceModule.h"
 #include "IInputDevice.h"
 #include "Misc/ConfigCacheIni.h"
+#include "Async/Future.h"
 #include "WinDualSenseLibrary/ds5w.h"
 
 #pragma region Dual Sense [Plugin]
@@ -15,11 +16,7 @@ class FWinDualSensePlugin : public IInputDeviceModule
 {
 public:
 
-	virtual TSharedPtr< class IInputDevice > CreateInputDevice(const TSharedRef< FGenericApplicationMessageHandler >& InMessageHandler) override
-	{
-		UE_LOG(LogWinDualSense, Log, TEXT("DualSense Input Device Created"));
-		return TSharedPtr< class IInputDevice >(new FWinDualSenseDevice(InMessageHandler));
-	}
+	virtual TSharedPtr< class IInputDevice > CreateInputDevice(const TSharedRef< FGenericApplicationMessageHandler >& InMessageHandler) override;
 
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
@@ -27,8 +24,12 @@ public:
 	void AddInput(FString InputName, uint8 keyFlags);
 	void RegisterInputs();
 
+	//Any thread, DS5W calls are only safe once this is true
+	static bool IsLibraryLoaded();
+
 private:
-	void* WinDualSenseLibraryHandle;
+	//ds5w_x64.dll handle, loaded on the thread pool so neither startup nor shutdown waits for it
+	TFuture<void*> LibraryLoad;
 
 };
 #pragma endregion
\ No newline at end of file
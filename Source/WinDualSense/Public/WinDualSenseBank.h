@@ -0,0 +1,74 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WinDualSense_Enum.h"
+#include "WinDualSenseLibrary/ds5w.h"
+
+struct FDualSenseCalibration;
+struct FDualSenseInputReport;
+
+#pragma region Dual Sense [Controller Bank]
+//Latest input of every controller slot as structure of arrays : one contiguous row per signal, one lane per ControllerId.
+//Filled per controller, then normalized for all controllers at once, 4 lanes per vector instruction.
+//Rows are 16 byte aligned, which the default heap alignment keeps when the bank lives inside another object.
+struct FDualSenseControllerBank
+{
+	static constexpr int32 MaxControllers = 16;
+	static constexpr int32 AnalogCount = 6;
+	//Gyroscope X / Y / Z, accelerometer X / Y / Z
+	static constexpr int32 MotionCount = 6;
+
+	FDualSenseControllerBank();
+
+	//Buttons (after remap), sticks and triggers of a controller's latest state.
+	//A stalled controller gets no buttons and centered analogs, like the dispatch did before.
+	void SetInput(int32 ControllerId, uint32 InButtons, const DS5W::DS5InputState& State, const FDualSenseCalibration& Calibration, bool bIsStalled);
+
+	//Raw motion of the controller's latest report, GyroBias in counts
+	void SetMotion(int32 ControllerId, const FDualSenseInputReport& Report, const FVector& GyroBias);
+
+	//Controller (re)connected, its first state is diffed against nothing pressed and its rows read 0 until it reports
+	void ResetLane(int32 ControllerId);
+
+	//Every lane below LaneCount : pressed / released words against the previous update, analogs and motion normalized
+	void Update(int32 LaneCount);
+
+	//Same results, one lane at a time, reference for the benchmark
+	void UpdateScalar(int32 LaneCount);
+
+	FORCEINLINE float GetAnalog(EDualSenseAnalogType Type, int32 ControllerId) const
+	{
+		return AnalogValues[(int32)Type][ControllerId];
+	}
+
+	FORCEINLINE FVector GetAngularVelocity(int32 ControllerId) const
+	{
+		return FVector(MotionValues[0][ControllerId], MotionValues[1][ControllerId], MotionValues[2][ControllerId]);
+	}
+
+	FORCEINLINE FVector GetAcceleration(int32 ControllerId) const
+	{
+		return FVector(MotionValues[3][ControllerId], MotionValues[4][ControllerId], MotionValues[5][ControllerId]);
+	}
+
+	//Packed inputs, one bit per EDualSenseButtonType
+	alignas(16) uint32 Buttons[MaxControllers];
+	alignas(16) uint32 PreviousButtons[MaxControllers];
+	alignas(16) uint32 PressedButtons[MaxControllers];
+	alignas(16) uint32 ReleasedButtons[MaxControllers];
+
+	//Raw stick / trigger bytes and motion shorts, widened to 32 bit lanes for the int to float conversion
+	alignas(16) int32 Analogs[AnalogCount][MaxControllers];
+	alignas(16) int32 Motion[MotionCount][MaxControllers];
+
+	//Per lane Value = Clamp(Raw * Scale + Offset, Min, Max), calibration folded in by SetInput / SetMotion
+	alignas(16) float AnalogScales[AnalogCount][MaxControllers];
+	alignas(16) float AnalogOffsets[AnalogCount][MaxControllers];
+	alignas(16) float MotionOffsets[MotionCount][MaxControllers];
+
+	alignas(16) float AnalogValues[AnalogCount][MaxControllers];
+	alignas(16) float MotionValues[MotionCount][MaxControllers];
+};
+#pragma endregion
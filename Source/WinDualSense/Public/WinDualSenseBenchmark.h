@@ -0,0 +1,83 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#pragma region Dual Sense [Benchmark]
+//Console benchmarks (DUALSENSE BENCH ...) run against fake controllers, no hardware needed. They only measure,
+//what the replays must produce is checked by the automation tests (Plugins.WinDualSense)
+namespace DualSenseBenchmark
+{
+	//DUALSENSE BENCH <Name> [Arguments], Cmd is the rest of the line after BENCH. False for an unknown benchmark
+	bool Exec(const TCHAR* Cmd, FOutputDevice& Ar);
+
+	//Fake controllers on named pipes read by the single IO thread vs one blocking reader thread per device
+	void RunIOBenchmark(FOutputDevice& Ar, int32 DeviceCount, float Seconds, int32 ReportRate);
+
+	//Report write to OnControllerButtonPressed / OnControllerAnalog dispatch through a real FWinDualSenseDevice,
+	//for several frame rates, with reports coming through the completion port or injected into the controller queue
+	void RunLatencyBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate);
+
+	//Press edges timed at the read thread callback, at the game thread event it posts and at the frame's button dispatch,
+	//plus the callback's own cost
+	void RunCallbackBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate, int32 FrameRate);
+
+	//Same fake controller and frame loop with the late latch off (input sampled at a fixed point of the frame) and on.
+	//Reports the age of the dispatched input, press latency and what the waits cost the game thread
+	void RunLatchBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate, int32 FrameRate);
+
+	//Producer threads flood the output command queue while one consumer drains it, reports commands per second
+	void RunOutputStress(FOutputDevice& Ar, int32 ProducerCount, int32 CommandsPerProducer);
+
+	//Time of SendControllerEvents per frame with injected controllers, in whatever state the DualSense trace channel is.
+	//Run it with the channel off and on (Trace.Enable DualSense) to see what tracing costs
+	void RunFrameBenchmark(FOutputDevice& Ar, int32 ControllerCount, int32 Frames);
+
+	//Streams a synthetic recording to a stream host over localhost, Loss drops that share of datagrams before sending.
+	//Reports bytes per second against raw USB reports and send to inject latency
+	void RunStreamBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate, int32 Redundancy, float Loss, int32 Port);
+
+	//One thread publishes synthetic reports for every controller into a shared state region, reader threads map it
+	//on their own (as another process would) and poll it. Reports the writer's cost without and with the readers and publish to read latency
+	void RunSharedStateBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate, int32 ReaderCount);
+
+	//Captures a synthetic game's dispatched input into an input history frame by frame and compares a repeat-last-input
+	//prediction over the last Window frames against it, as rollback does. Reports the cost of both per frame
+	void RunHistoryBenchmark(FOutputDevice& Ar, int32 Frames, int32 Window);
+
+	//Feeds simulated healthy, worn and drifting sticks (rest with noise and release scatter, sweeps, small held deflections)
+	//through the drift estimator. Reports the center error, idle reports leaking through the deadzone and small deflections
+	//lost in it, for the fixed 0.25 deadzone and the adaptive one, plus the estimator's cost per report
+	void RunDriftBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate);
+
+	//Counts the usage of a synthetic session with taps, moving sticks, triggers and gyro.
+	//Logs the counters and the cost per report
+	void RunUsageBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate);
+
+	//Replays a synthetic session (jittered report intervals) into fixed steps of 1 / StepRate seconds, read at 20, 60 and 144 fps
+	//with jittering frame times. Reports the cost per step
+	void RunResampleBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate, int32 StepRate);
+
+	//Replays touchpad swipes, a slow drag, taps and touchpad presses through the touch pointer at 20, 60 and 144 fps with jittering frame times.
+	//Reports the read thread cost per report and the game thread cost per frame
+	void RunPointerBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate);
+
+	//Runs a scripted motion session (taps on the shell, flicks, a shake, orientation changes, slow turns and pushes)
+	//at 250 and 1000 Hz through the motion gesture detector, reports its cost per report against BudgetNanoseconds.
+	//File : also lists the gestures found in a recorded session
+	void RunMotionGestureBenchmark(FOutputDevice& Ar, float BudgetNanoseconds, const FString& File);
+
+	//Measures the scope buffer's producer cost closed and open, then writes flat out while a reader copies the newest window at DisplayRate.
+	//Reports both costs and the reader's copy time
+	void RunScopeBenchmark(FOutputDevice& Ar, float Seconds, int32 DisplayRate);
+
+	//Decodes synthetic input of 1, 4 and 16 controllers per frame through the original per controller TMaps,
+	//the flattened per controller bindings and the structure of arrays bank, reports ns per frame
+	void RunBankBenchmark(FOutputDevice& Ar, int32 Frames);
+
+	//Builds the columnar table of a synthetic session with the scalar and the vectorized kernels,
+	//reports per second for both and for writing the file
+	void RunExportBenchmark(FOutputDevice& Ar, float Seconds, int32 ReportRate);
+}
+#pragma endregion
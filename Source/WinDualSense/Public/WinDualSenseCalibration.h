@@ -0,0 +1,68 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "WinDualSenseLibrary/ds5w.h"
+
+#pragma region Dual Sense [Calibration]
+//What differs between two physical controllers, in decoded DS5InputState units
+struct FDualSenseCalibration
+{
+	static constexpr uint32 CurrentVersion = 1;
+
+	//Raw gyro counts at rest
+	FVector GyroBias = FVector::ZeroVector;
+
+	//Stick position when released
+	FVector2D LeftStickCenter = FVector2D::ZeroVector;
+	FVector2D RightStickCenter = FVector2D::ZeroVector;
+
+	//Released trigger values (Left, Right)
+	FVector2D TriggerRest = FVector2D::ZeroVector;
+	//Deepest pull seen so far (Left, Right)
+	FVector2D TriggerMax = FVector2D::ZeroVector;
+
+	//Seconds the controller spent at rest feeding these values
+	float RestSeconds = 0.f;
+
+	//Value mapped to a full pull, nominal until a deep enough pull was seen
+	FORCEINLINE float GetTriggerFullPull(bool bRight) const
+	{
+		const float Max = bRight ? TriggerMax.Y : TriggerMax.X;
+		return Max >= 200.f ? Max : 255.f;
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, FDualSenseCalibration& Calibration)
+	{
+		Ar << Calibration.GyroBias;
+		Ar << Calibration.LeftStickCenter;
+		Ar << Calibration.RightStickCenter;
+		Ar << Calibration.TriggerRest;
+		Ar << Calibration.TriggerMax;
+		Ar << Calibration.RestSeconds;
+		return Ar;
+	}
+};
+
+//On disk cache, one file per device path under Saved/DualSense/Calibration
+namespace DualSenseCalibration
+{
+	FString GetCacheFile(const FString& DevicePath);
+
+	//Thread pool, unset when there is no (valid) file yet. Reads after the async saves of the file started before it
+	TFuture<TOptional<FDualSenseCalibration>> LoadAsync(const FString& DevicePath);
+	bool Save(const FString& DevicePath, const FDualSenseCalibration& Calibration);
+	//Thread pool, saves of the same file land in the order they were made
+	void SaveAsync(const FString& DevicePath, const FDualSenseCalibration& Calibration);
+}
+
+//Refines a calibration from the reports of a controller while it is at rest
+class FDualSenseCalibrator
+{
+public:
+	//bIsAtRest : the gyro says nobody is holding / moving the pad. Returns true when the calibration learned something.
+	bool AddSample(const DS5W::DS5InputState& State, uint32 Buttons, bool bIsAtRest, float DeltaTime, FDualSenseCalibration& Calibration);
+};
+#pragma endregion
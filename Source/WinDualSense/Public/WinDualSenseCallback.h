@@ -0,0 +1,123 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/CircularQueue.h"
+#include "WinDualSenseReport.h"
+#include <atomic>
+
+struct FDualSenseInputCallback;
+
+enum class EDualSenseCallbackTrigger : uint8
+{
+	//Every report read from the controller
+	EveryReport,
+	//Reports where one of the callback's buttons went down or up
+	ButtonEdge
+};
+
+#pragma region Dual Sense [Input Callback]
+//Posted by a callback on the read thread, handed to the game thread
+struct FDualSenseCallbackEvent
+{
+	int32 CallbackId = INDEX_NONE;
+	//Report the callback ran for
+	uint32 SensorTimestamp = 0;
+	uint64 ReceiveCycles = 0;
+	uint32 PressedButtons = 0;
+	uint32 ReleasedButtons = 0;
+	//Whatever the callback posted
+	int64 Value = 0;
+};
+
+typedef TCircularQueue<FDualSenseCallbackEvent> FDualSenseCallbackEventQueue;
+
+//What a callback sees of one report, only valid during the call
+struct FDualSenseCallbackContext
+{
+	FDualSenseCallbackContext(int32 InControllerId, const FDualSenseInputReport& InReport, uint32 InPressedButtons, uint32 InReleasedButtons, FDualSenseInputCallback& InCallback, FDualSenseCallbackEventQueue& InEvents)
+		: ControllerId(InControllerId)
+		, Report(InReport)
+		, PressedButtons(InPressedButtons)
+		, ReleasedButtons(InReleasedButtons)
+		, Callback(InCallback)
+		, Events(InEvents)
+	{
+	}
+
+	int32 ControllerId;
+	//Decoded and remapped, SensorTimestamp is the device time of the input
+	const FDualSenseInputReport& Report;
+	//EDualSenseButtonType bits that changed since the controller's previous report
+	uint32 PressedButtons;
+	uint32 ReleasedButtons;
+
+	//Queues Value for the game thread without locking or allocating, false (and counted as dropped) when the queue is full
+	bool Post(int64 Value) const;
+
+private:
+	FDualSenseInputCallback& Callback;
+	FDualSenseCallbackEventQueue& Events;
+};
+
+typedef TFunction<void(const FDualSenseCallbackContext&)> FDualSenseCallbackFunction;
+typedef TFunction<void(int32 ControllerId, const FDualSenseCallbackEvent&)> FDualSenseCallbackEventHandler;
+
+//Cost and traffic of one callback, written by the report producers (IO thread, injectors), read anywhere
+struct FDualSenseCallbackStats
+{
+	void Reset();
+
+	void AddCall(uint64 CallCycles);
+
+	FORCEINLINE double GetMeanMicroseconds() const
+	{
+		const uint64 CallCount = Calls.load(std::memory_order_relaxed);
+		return CallCount > 0 ? FPlatformTime::ToMilliseconds64(Cycles.load(std::memory_order_relaxed)) * 1000.0 / CallCount : 0.0;
+	}
+
+	FORCEINLINE double GetMaxMicroseconds() const
+	{
+		return FPlatformTime::ToMilliseconds64(MaxCycles.load(std::memory_order_relaxed)) * 1000.0;
+	}
+
+	std::atomic<uint64> Calls{ 0 };
+	std::atomic<uint64> Cycles{ 0 };
+	std::atomic<uint64> MaxCycles{ 0 };
+	std::atomic<uint64> PostedEvents{ 0 };
+	std::atomic<uint64> DroppedEvents{ 0 };
+};
+
+//One registered callback, only Stats changes after registration.
+//Freed once the report producers moved past its unregistration, the report in flight may still run it.
+struct FDualSenseInputCallback
+{
+	int32 Id = INDEX_NONE;
+	EDualSenseCallbackTrigger Trigger = EDualSenseCallbackTrigger::EveryReport;
+	//ButtonEdge : EDualSenseButtonType bits watched, 0 watches every button
+	uint32 Buttons = 0;
+
+	//Read thread, keep it short : every report of every controller waits for it
+	FDualSenseCallbackFunction Function;
+	//Game thread, every event Function posted (may be null)
+	FDualSenseCallbackEventHandler OnEvent;
+
+	FDualSenseCallbackStats Stats;
+};
+
+//Callbacks the IO thread runs, immutable once published
+class FDualSenseCallbackSet
+{
+public:
+	void Add(FDualSenseInputCallback* Callback);
+
+	//Report producer : runs every callback the report triggers, LastButtons is the previous report's button word
+	void Dispatch(int32 ControllerId, const FDualSenseInputReport& Report, uint32 LastButtons, FDualSenseCallbackEventQueue& Events) const;
+
+	TArray<FDualSenseInputCallback*> Callbacks;
+	bool bHasEveryReport = false;
+	//Union of the edge callbacks' buttons, reports without a change in these skip the edge callbacks
+	uint32 EdgeButtons = 0;
+};
+#pragma endregion
@@ -0,0 +1,66 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FDualSenseSession;
+
+enum class EDualSenseColumnType : uint32
+{
+	Float32,
+	Float64,
+	UInt32
+};
+
+#pragma region Dual Sense [Columnar Export]
+//One column per signal, RowCount values of Type back to back
+struct FDualSenseColumn
+{
+	FString Name;
+	EDualSenseColumnType Type = EDualSenseColumnType::Float32;
+	TArray<uint8, TAlignedHeapAllocator<64>> Data;
+
+	template <typename ValueType>
+	ValueType* GetValues()
+	{
+		return reinterpret_cast<ValueType*>(Data.GetData());
+	}
+};
+
+//Structure of arrays view of a session, the same normalization the input device applies
+struct FDualSenseColumnarTable
+{
+	int64 RowCount = 0;
+	TArray<FDualSenseColumn> Columns;
+
+	const FDualSenseColumn* FindColumn(const TCHAR* Name) const;
+};
+
+//File layout (little endian), meant to be memory mapped :
+//	Header    : Magic "DSCF" (uint32) | Version (uint32) | RowCount (uint64) | ColumnCount (uint32) | zero padding to 64 bytes
+//	Directory : ColumnCount x { Name (32 bytes, UTF-8, zero terminated and padded) | Type (uint32, EDualSenseColumnType) | zero (uint32) | Offset (uint64) }
+//	Data      : every column at its Offset from the start of the file, 64 byte aligned, RowCount x 4 or 8 bytes
+namespace DualSenseColumnar
+{
+	static constexpr uint32 Magic = 0x46435344;
+	static constexpr uint32 Version = 1;
+	static constexpr int32 HeaderSize = 64;
+	static constexpr int32 ColumnNameSize = 32;
+	static constexpr int32 ColumnAlignment = 64;
+
+	//Out = Clamp(In * Scale + Offset, Min, Max), MapRangeClamped folded into one multiply add
+	void ConvertScalar(const int32* In, float* Out, int32 Count, float Scale, float Offset, float Min, float Max);
+	//Same result, 8 values per iteration in vector registers.
+	//In and Out need no alignment, VectorIntLoad and VectorStore are the unaligned load and store
+	void ConvertVectorized(const int32* In, float* Out, int32 Count, float Scale, float Offset, float Min, float Max);
+
+	//Transposes the reports into integer columns, then converts them with the chosen kernel
+	void BuildTable(const FDualSenseSession& Session, bool bVectorized, FDualSenseColumnarTable& OutTable);
+
+	bool WriteFile(const FDualSenseColumnarTable& Table, const FString& File);
+
+	//Session -> file, logs reports per second
+	bool Export(const FDualSenseSession& Session, const FString& File);
+}
+#pragma endregion
@@ -7,12 +7,103 @@
 #include "IInputDeviceModule.h"
 #include "IInputDevice.h"
 #include "WinDualSenseLibrary/ds5w.h"
+#include "WinDualSenseReport.h"
+#include "WinDualSenseIO.h"
+#include "WinDualSenseMotion.h"
+#include "WinDualSensePointer.h"
+#include "WinDualSenseOutput.h"
+#include "WinDualSenseCalibration.h"
+#include "WinDualSenseStream.h"
+#include "WinDualSenseSession.h"
+#include "WinDualSenseSharedState.h"
+#include "WinDualSenseHistory.h"
+#include "WinDualSenseResample.h"
+#include "WinDualSenseBank.h"
+#include "WinDualSenseLatch.h"
+#include "WinDualSenseTrace.h"
+
+#pragma region Dual Sense [Controller]
+//Bindings flattened when a controller connects, the per frame path only walks these arrays
+struct FDualSenseButtonBinding
+{
+	EDualSenseButtonType Type;
+	uint32 Mask;
+	FName KeyName;
+	FDualSenseButtonData Data;
+};
+
+struct FDualSenseAnalogBinding
+{
+	EDualSenseAnalogType Type;
+	FName KeyName;
+	FDualSenseAnalogData Data;
+};
+
+struct FDualSenseVectorBinding
+{
+	EDualSenseVectorType Type;
+	FDualSenseVectorData Data;
+};
+
+//Game thread state of one controller slot
+struct FDualSenseController
+{
+	int32 ControllerId = INDEX_NONE;
+	bool bConnected = false;
+
+	DS5W::DS5InputState inState;
+	//Only written by the output stage, other threads go through FWinDualSenseDevice::EnqueueOutputCommand
+	DS5W::DS5OutputState outState;
+	//outState changed since the last output report
+	bool bOutputDirty = false;
+
+	FDualSenseReportStats ReportStats;
+	uint64 LastReportCycles = 0;
+	//Latest report buttons, one bit per EDualSenseButtonType after the remap
+	uint32 ButtonMask = 0;
+
+	//Button edges replayed from the read thread, and presses released again before the frame saw them
+	uint64 ReplayedEdges = 0;
+	uint64 SubFrameTaps = 0;
+
+	//Calibrated gyro / accelerometer, integrated for every report
+	FDualSenseMotion Motion;
+
+	//Touchpad as a mouse, integrated for every report
+	FDualSenseTouchPointer TouchPointer;
+
+	//Loaded from the cache when the controller connects, refined while it rests, saved when it goes away
+	FString DevicePath;
+	FDualSenseCalibration Calibration;
+	FDualSenseCalibrator Calibrator;
+	TFuture<TOptional<FDualSenseCalibration>> PendingCalibration;
+	bool bCalibrationDirty = false;
+
+	//Resting position and noise of the sticks, estimated on the read thread
+	FDualSenseDriftEstimate Drift;
+
+	//Age of the input SendControllerEvents dispatched, and the late latch waits for it
+	FDualSenseLatchStats LatchStats;
+
+	//What SendControllerEvents dispatched, one snapshot per game frame (rollback)
+	FDualSenseInputHistory History;
+
+	//Every report read, on its sensor timestamp, for fixed step consumers
+	FDualSenseResampler Resampler;
+
+	//Capacity is kept across reconnects
+	TArray<FDualSenseButtonBinding> Buttons;
+	TArray<FDualSenseAnalogBinding> Analogs;
+	TArray<FDualSenseVectorBinding> Vectors;
+};
+#pragma endregion
 
 #pragma region Dual Sense [Input Device]
 class FWinDualSenseDevice : public IInputDevice
 {
 public:
-	FWinDualSenseDevice(const TSharedRef< FGenericApplicationMessageHandler >& InMessageHandler);
+	//InIOThread : prepared IO thread (fake devices), a DS5W enumerating one is created when null
+	FWinDualSenseDevice(const TSharedRef< FGenericApplicationMessageHandler >& InMessageHandler, TUniquePtr<FDualSenseIOThread> InIOThread = nullptr);
 	~FWinDualSenseDevice();
 
 	void Tick(float DeltaTime) override;
@@ -28,40 +119,90 @@ public:
 	class IHapticDevice* GetHapticDevice() override;
 	bool IsGamepadAttached() const override;
 
-	FORCEINLINE void UpdateInputs();
-	void UpdateButtons();
-	void UpdateAnalogs();
-	void UpdateVectors();
-	
-	//DEBUG PRINTING
-	void DEBUG_Inputs();
+	//Null for a slot that never connected
+	const FDualSenseInputHistory* GetInputHistory(int32 ControllerId) const;
 
-	//TODO
-	FORCEINLINE void UpdateOutputs();
+	//Null for a slot that never connected, estimates are not valid until the sticks rested for a while
+	const FDualSenseDriftEstimate* GetStickDrift(int32 ControllerId) const;
 
-	/*void UpdateRumble();
-	void UpdateLED();
-	void UpdateAdaptiveTrigger();
-	void UpdateAdaptiveTriggerEffect();
-	void UpdateMicrophone();*/
+	//Next step of Cursor's fixed timestep grid resampled from the controller's reports, once they cover all of it.
+	//Call until false every frame (physics substeps), the steps only depend on the reports, never on the frame rate
+	bool ConsumeFixedStep(int32 ControllerId, FDualSenseResampleCursor& Cursor, FDualSenseResampledStep& OutStep) const;
 
-public:
-	DS5W::DeviceEnumInfo infos[16];
-	unsigned int controllersCount = 0;
-	DS5W::DeviceContext DualSenseController;
-	DS5W::DS5InputState inState;
-	DS5W::DS5OutputState outState;
+	//Microseconds between receiving the controller's newest report and its last dispatch, negative before the first one
+	double GetInputAge(int32 ControllerId) const;
+
+	//Creates the controller's state the first time it is needed (connect or output command)
+	FDualSenseController& GetController(int32 ControllerId);
+
+	void UpdateConnection(FDualSenseController& Controller);
+	void UpdateReports(FDualSenseController& Controller);
+	void UpdateCalibration(FDualSenseController& Controller);
+	//Takes the read thread's latest drift estimate : recenters the sticks and sizes their deadzones
+	void UpdateDrift(FDualSenseController& Controller);
+	void ApplyDeadZones(FDualSenseController& Controller);
+	//Holds the frame for reports predicted within the wait budget, then reads them (controllers below LaneCount)
+	void LatchReports(int32 LaneCount);
+	void SaveCalibration(FDualSenseController& Controller, bool bAsync);
+	FORCEINLINE void UpdateInputs(FDualSenseController& Controller);
+	void UpdateButtons(FDualSenseController& Controller);
+	//Dispatches every button edge of the reports read this frame, in order. Returns the buttons it dispatched
+	uint32 ReplayButtonEdges(FDualSenseController& Controller);
+	void UpdateAnalogs(FDualSenseController& Controller);
+	void UpdateVectors(FDualSenseController& Controller);
+	void UpdateGestures(FDualSenseController& Controller);
+	void UpdateCallbacks(FDualSenseController& Controller);
+	//Moves the platform cursor by the touchpad pointer's whole pixels and sends its clicks
+	void UpdatePointer(FDualSenseController& Controller);
+	//Remapped buttons the physical touchpad press drives, which the pointer takes over while enabled (0 otherwise)
+	uint32 GetPointerButtons(const FDualSenseController& Controller) const;
+	//Quantizes the button and analog state just dispatched into the controller's history
+	void CaptureHistory(FDualSenseController& Controller, uint64 Frame);
+	void ReleaseInputs(FDualSenseController& Controller);
+	void BindInputs(FDualSenseController& Controller);
+	void InitDefaultBindings();
 
-	DS5W::TriggerEffectType LeftTriggerEffectType = DS5W::TriggerEffectType::NoResitance;
-	DS5W::TriggerEffectType RightTriggerEffectType = DS5W::TriggerEffectType::NoResitance;
+	//Publishes a copy of Remap to the IO thread for this controller
+	void SetButtonRemap(int32 ControllerId, const FDualSenseButtonRemap& Remap);
 
-	float Intensity_LED = 1.0f;
-	
-	uint16_t LeftRumble = 0.0;
-	uint16_t RightRumble = 0.0;
+	//Compiles the patterns for the IO thread and registers their keys, false keeps the previous set
+	bool SetGesturePatterns(const TArray<FDualSenseGesturePattern>& Patterns);
 
-	int btMul = 0;
+	//Publishes a copy of Settings to the IO thread (off unless bEnabled) and registers the motion gesture keys
+	void SetMotionGestureSettings(const FDualSenseMotionGestureSettings& Settings);
 
+	//Runs Function on the read thread for every report or every edge of Buttons (0 = any button), before the game thread sees the report.
+	//What it posts reaches OnEvent on the game thread, until it is unregistered. Returns the id to unregister with
+	int32 RegisterInputCallback(EDualSenseCallbackTrigger Trigger, uint32 Buttons, FDualSenseCallbackFunction Function, FDualSenseCallbackEventHandler OnEvent = nullptr);
+	void UnregisterInputCallback(int32 CallbackId);
+	const FDualSenseInputCallback* FindInputCallback(int32 CallbackId) const;
+
+	//Publishes every controller's reports under Name for other processes (WinDualSenseSharedReader.h), from the read thread
+	bool StartSharedState(const FString& Name);
+	void StopSharedState();
+
+	//DEBUG PRINTING (DUALSENSE DEBUG), formats logs every frame so it is outside the allocation free path
+	void DEBUG_Inputs(const FDualSenseController& Controller);
+	bool bDebugInputs = false;
+
+	//Any thread, folded into the controller's next output report
+	void EnqueueOutputCommand(const FDualSenseOutputCommand& Command);
+
+	//Output stage (game thread) : drains every queued command, then writes the reports that changed
+	void DrainOutputCommands();
+	FORCEINLINE void UpdateOutputs(FDualSenseController& Controller);
+
+public:
+	//Reads every controller, slot index is the ControllerId
+	TUniquePtr<FDualSenseIOThread> IOThread;
+
+	//Null until the slot first connects
+	TUniquePtr<FDualSenseController> Controllers[FDualSenseIOThread::MaxDevices];
+
+	//Latest state of every controller side by side, normalized for all of them at once before dispatch
+	FDualSenseControllerBank Bank;
+
+	//Default bindings, filled when the first controller connects and copied into each one
 	UPROPERTY()
 	TMap<EDualSenseButtonType, FDualSenseButtonData> Buttons;
 
@@ -71,8 +212,106 @@ public:
 	UPROPERTY()
 	TMap<EDualSenseVectorType, FDualSenseVectorData> Vectors;
 
+	bool bHasDefaultBindings = false;
+
+	//DUALSENSE DRIFT : stick deadzones follow the estimated resting noise, the default ratio otherwise
+	bool bAdaptiveDeadZones = true;
+
+	//DUALSENSE LATCH
+	FDualSenseLatchSettings LatchSettings;
+	FDualSenseFramePacing FramePacing;
+
+	//Copied into a controller when it connects, DUALSENSE GYRO updates both
+	FDualSenseGyroAimSettings GyroAimSettings;
+
+	//Copied into a controller when it connects, DUALSENSE POINTER updates both
+	FDualSenseTouchPointerSettings TouchPointerSettings;
+
+	//Last patterns given to SetGesturePatterns
+	TArray<FDualSenseGesturePattern> GesturePatterns;
+
+	//Last settings given to SetMotionGestureSettings, DUALSENSE MOTION
+	FDualSenseMotionGestureSettings MotionGestureSettings;
+
+	//DUALSENSE STREAM SEND : every report of StreamControllerId also goes to a remote host, sent by an input callback
+	TUniquePtr<FDualSenseStreamClient> StreamClient;
+	int32 StreamControllerId = 0;
+	int32 StreamCallbackId = INDEX_NONE;
+
+	//DUALSENSE STREAM HOST : a remote controller injected into one of our slots
+	TUniquePtr<FDualSenseStreamHost> StreamHost;
+
+	//DUALSENSE RECORD : every report of RecordingControllerId, appended by an input callback and saved on DUALSENSE RECORD STOP
+	static constexpr int32 MaxReportRate = 1000;
+	static constexpr int32 MaxRecordedReports = 30 * 60 * MaxReportRate;
+	TUniquePtr<FDualSenseSession> Recording;
+	int32 RecordingControllerId = 0;
+	int32 RecordingCallbackId = INDEX_NONE;
+	//Reports past the reserved cap, not recorded
+	std::atomic<uint64> RecordingOverflow{ 0 };
+
+	//DUALSENSE SHARE : null when nothing is published
+	TUniquePtr<FDualSenseSharedStateWriter> SharedState;
+	int32 SharedStateCallbackId = INDEX_NONE;
+
 private:
+	FDualSenseOutputQueue OutputCommands;
+	//Refused by a full output queue, any thread
+	std::atomic<uint64> DroppedOutputCommands{ 0 };
+
+	//Published to the DualSense trace channel at the end of every frame it is on
+	FDualSenseTraceCounters TraceCounters;
+
+	//DUALSENSE USAGE RESET : usage counted before it, per slot
+	FDualSenseUsageSnapshot UsageBaselines[FDualSenseIOThread::MaxDevices];
+
+	//Replaced published objects, until the report producers moved past them
+	FDualSenseRetireList RetiredObjects;
+
+	//Published per slot, null while the slot maps buttons as they are
+	TUniquePtr<FDualSenseButtonRemap> ButtonRemaps[FDualSenseIOThread::MaxDevices];
+	//Published, null when there are no patterns
+	TUniquePtr<FDualSenseGestureSet> PublishedGestureSet;
+	//Published, null while motion gestures are off
+	TUniquePtr<FDualSenseMotionGestureSettings> PublishedMotionGestureSettings;
+
+	//DUALSENSE SCOPE : made the first time a slot is scoped and published for good, open scope widgets hold their own reference
+	TSharedPtr<FDualSenseScopeBuffer, ESPMode::ThreadSafe> ScopeBuffers[FDualSenseIOThread::MaxDevices];
+
+	//Registered callbacks in id order, an unregistered one is retired with the set that ran it
+	TArray<TUniquePtr<FDualSenseInputCallback>> InputCallbacks;
+	int32 NextCallbackId = 0;
+	//Published, null when nothing is registered
+	TUniquePtr<FDualSenseCallbackSet> PublishedCallbackSet;
+
+	//Returns the epoch the replaced set was retired at
+	uint64 PublishCallbacks();
+	//Unregisters and waits until no report runs the callback anymore, whatever it captured can go afterwards
+	void StopCallback(int32& CallbackId);
+
+	//DUALSENSE <Subcommand> handlers, Cmd is the rest of the line after the subcommand
+	bool ExecStats(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecResetStats(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecUsage(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecDebug(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecScope(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecRemap(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecGesture(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecMotion(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecGyro(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecPointer(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecDrift(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecLatch(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecStream(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecRecord(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecExport(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecShare(const TCHAR* Cmd, FOutputDevice& Ar);
+	bool ExecBench(const TCHAR* Cmd, FOutputDevice& Ar);
+
+	//Gesture events the game thread read too late for, per controller that lost any
+	void LogDroppedGestures(FOutputDevice& Ar) const;
+
 	// handler to send all messages to
 	TSharedRef<FGenericApplicationMessageHandler> MessageHandler;
 };
-#pragma endregion
\ No newline at end of file
+#pragma endregion
@@ -0,0 +1,74 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#pragma region Dual Sense [Stick Drift]
+//Resting behaviour of one stick, in decoded DS5InputState units like FDualSenseCalibration
+struct FDualSenseStickDrift
+{
+	//Where the released stick sits, subtracted to recenter
+	FVector2D Center = FVector2D::ZeroVector;
+	//Standard deviation of the resting position (noise and where it lands after each release)
+	float Noise = 0.f;
+	//Inner deadzone covering that spread, in FDualSenseAnalogData::DeadZoneRatio units
+	float DeadZoneRatio = 0.f;
+	uint32 IdleSamples = 0;
+	//Enough idle reports went in for the values to be used
+	bool bIsValid = false;
+
+	//Distance of the resting position from the nominal center, -1..1 stick units
+	float GetDriftRatio() const;
+};
+
+//Both sticks, published by the read thread
+struct FDualSenseDriftEstimate
+{
+	FDualSenseStickDrift LeftStick;
+	FDualSenseStickDrift RightStick;
+};
+
+//Streaming estimate of one stick's resting distribution, fed with every report on the read thread.
+//A report is idle once the stick held still near its center for a while, idle reports update an exponentially
+//weighted mean / variance per axis. Fixed size, constant work per report.
+//Rest windows in a row that agree with each other but not with the estimate restart the learning (worn or knocked stick).
+class FDualSenseDriftEstimator
+{
+public:
+	//Idle reports between two published estimates
+	static constexpr uint32 PublishInterval = 32;
+
+	FDualSenseDriftEstimator()
+	{
+		Reset();
+	}
+
+	void Reset();
+
+	//Every report, in order. Returns true when a new estimate is due
+	bool AddSample(int8 X, int8 Y);
+
+	FDualSenseStickDrift GetDrift() const;
+
+private:
+	float MeanX;
+	float MeanY;
+	float VarianceX;
+	float VarianceY;
+	uint32 IdleSamples;
+
+	//Box the stick stayed in since it last moved
+	int8 RunMinX;
+	int8 RunMaxX;
+	int8 RunMinY;
+	int8 RunMaxY;
+	uint32 RunLength;
+	bool bRunRejected;
+
+	//Consecutive rest windows outside the gate, and where the first of them rested
+	uint32 RejectedWindows;
+	float RejectedX;
+	float RejectedY;
+};
+#pragma endregion
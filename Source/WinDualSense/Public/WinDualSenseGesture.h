@@ -0,0 +1,110 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WinDualSense_Enum.h"
+
+#include <atomic>
+
+enum class EDualSenseGestureType : uint8
+{
+	//Buttons held together for HoldTime
+	LongPress,
+	//One button pressed TapCount times, each press within TapWindow of the previous release
+	MultiTap,
+	//Buttons pressed within ChordWindow of each other
+	Chord,
+	MAX_COUNT
+};
+
+#pragma region Dual Sense [Gesture]
+struct FDualSenseGesturePattern
+{
+	//Reported as a controller button of this name (pressed and released at once)
+	FName Key;
+	EDualSenseGestureType Type = EDualSenseGestureType::LongPress;
+	//One bit per EDualSenseButtonType (remapped buttons)
+	uint32 Buttons = 0;
+
+	float HoldTime = 0.5f;
+	int32 TapCount = 2;
+	float TapWindow = 0.25f;
+	float ChordWindow = 0.05f;
+};
+
+//Detected on the IO thread, dispatched on the game thread
+struct FDualSenseGestureEvent
+{
+	FName Key;
+	EDualSenseGestureType Type = EDualSenseGestureType::LongPress;
+	//Motion gesture (WinDualSenseMotionGesture.h), Type does not apply
+	bool bIsMotion = false;
+	//Report that completed the gesture
+	uint32 SensorTimestamp = 0;
+	uint64 ReceiveCycles = 0;
+};
+
+//Patterns with their times converted to sensor ticks, immutable once compiled
+class FDualSenseGestureSet
+{
+public:
+	//Detector keeps one fired bit per pattern
+	static constexpr int32 MaxPatterns = 64;
+
+	//Returns false when there are too many patterns or one of them has no button or an unknown type
+	bool Compile(const TArray<FDualSenseGesturePattern>& InPatterns);
+
+	struct FCompiledPattern
+	{
+		FName Key;
+		EDualSenseGestureType Type;
+		uint32 Buttons;
+		int32 TapCount;
+		//Sensor ticks
+		uint64 HoldTicks;
+		uint64 TapWindowTicks;
+		uint64 ChordWindowTicks;
+	};
+
+	TArray<FCompiledPattern> Patterns;
+	//New for every compile, pattern indices of one set mean nothing in another
+	uint32 Serial = 0;
+	//Long press patterns still need reports while nothing changes
+	uint32 LongPressButtons = 0;
+	uint32 AllButtons = 0;
+};
+
+//Per controller detection state, runs for every report at report rate on device timestamps
+class FDualSenseGestureDetector
+{
+public:
+	FDualSenseGestureDetector()
+	{
+		Reset();
+	}
+
+	void Reset();
+
+	//Buttons : remapped button word of the report. A set other than the last one starts its patterns over
+	void Update(const FDualSenseGestureSet& Set, uint32 Buttons, uint32 SensorTimestamp, TFunctionRef<void(const FDualSenseGestureSet::FCompiledPattern&)> Emit);
+
+private:
+	//Latest press time of every button in Mask, and the earliest one
+	void GetPressTimes(uint32 Mask, uint64& OutEarliest, uint64& OutLatest) const;
+
+	bool bHasTime;
+	uint32 LastSensorTimestamp;
+	//Sensor ticks since the first report, unwrapped
+	uint64 Time;
+
+	uint32 LastButtons;
+	uint64 PressTimes[(int32)EDualSenseButtonType::MAX_COUNT];
+	uint64 ReleaseTimes[(int32)EDualSenseButtonType::MAX_COUNT];
+
+	//Per pattern of the set with this serial
+	uint32 SetSerial;
+	uint64 FiredPatterns;
+	int32 TapCounts[FDualSenseGestureSet::MaxPatterns];
+};
+#pragma endregion
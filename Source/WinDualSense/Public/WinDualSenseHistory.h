@@ -0,0 +1,145 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WinDualSense_Enum.h"
+
+//Field groups of a snapshot, combined as bits by FDualSenseInputSnapshot::Diff
+enum class EDualSenseSnapshotField : uint8
+{
+	Buttons = 1 << 0,
+	LeftStick = 1 << 1,
+	RightStick = 1 << 2,
+	Triggers = 1 << 3
+};
+ENUM_CLASS_FLAGS(EDualSenseSnapshotField);
+
+#pragma region Dual Sense [Input History]
+//One frame of the input a controller dispatched, quantized into 64 bits :
+//	Bits  0 - 18 : pressed buttons (one per EDualSenseButtonType)
+//	Bits 19 - 50 : left X / left Y / right X / right Y, signed 8 bit steps of 1/127
+//	Bits 51 - 62 : left / right trigger, 6 bit steps of 1/63
+struct FDualSenseInputSnapshot
+{
+	static constexpr int32 ButtonBits = (int32)EDualSenseButtonType::MAX_COUNT;
+	static constexpr int32 StickShift = ButtonBits;
+	static constexpr int32 StickBits = 8;
+	static constexpr int32 TriggerShift = StickShift + 4 * StickBits;
+	static constexpr int32 TriggerBits = 6;
+	static_assert(TriggerShift + 2 * TriggerBits <= 64, "Snapshot does not fit 64 bits");
+
+	static constexpr uint64 ButtonMask = (1ull << ButtonBits) - 1;
+	static constexpr uint64 LeftStickMask = ((1ull << (2 * StickBits)) - 1) << StickShift;
+	static constexpr uint64 RightStickMask = ((1ull << (2 * StickBits)) - 1) << (StickShift + 2 * StickBits);
+	static constexpr uint64 TriggerMask = ((1ull << (2 * TriggerBits)) - 1) << TriggerShift;
+
+	uint64 Bits = 0;
+
+	//Sticks -1 ~ 1, triggers 0 ~ 1 (dispatched ratios, after dead zones)
+	static FDualSenseInputSnapshot Make(uint32 Buttons, const FVector2D& LeftStick, const FVector2D& RightStick, float LeftTrigger, float RightTrigger);
+
+	FORCEINLINE uint32 GetButtons() const
+	{
+		return (uint32)(Bits & ButtonMask);
+	}
+
+	//Axis 0 - 3 : left X, left Y, right X, right Y
+	FORCEINLINE int32 GetStickSteps(int32 Axis) const
+	{
+		return (int32)(int8)(uint8)(Bits >> (StickShift + Axis * StickBits));
+	}
+
+	FORCEINLINE int32 GetTriggerSteps(bool bRight) const
+	{
+		return (int32)((Bits >> (TriggerShift + (bRight ? TriggerBits : 0))) & ((1ull << TriggerBits) - 1));
+	}
+
+	FVector2D GetLeftStick() const;
+	FVector2D GetRightStick() const;
+	float GetTrigger(bool bRight) const;
+
+	FORCEINLINE bool operator==(const FDualSenseInputSnapshot& Other) const
+	{
+		return Bits == Other.Bits;
+	}
+
+	FORCEINLINE bool operator!=(const FDualSenseInputSnapshot& Other) const
+	{
+		return Bits != Other.Bits;
+	}
+
+	//Field groups that differ
+	EDualSenseSnapshotField Diff(const FDualSenseInputSnapshot& Other) const;
+
+	FORCEINLINE uint32 GetChangedButtons(const FDualSenseInputSnapshot& Other) const
+	{
+		return (uint32)((Bits ^ Other.Bits) & ButtonMask);
+	}
+
+	//Largest difference of any stick or trigger, in quantization steps
+	int32 GetMaxAnalogDistance(const FDualSenseInputSnapshot& Other) const;
+
+	//Same buttons and every analog within Tolerance steps, for predictions that don't need to be exact
+	FORCEINLINE bool NearlyEquals(const FDualSenseInputSnapshot& Other, int32 Tolerance) const
+	{
+		return Bits == Other.Bits || (GetChangedButtons(Other) == 0 && GetMaxAnalogDistance(Other) <= Tolerance);
+	}
+};
+
+//Last Capacity frames of one controller's snapshots, indexed by game frame number.
+//Fixed size, O(1) capture and lookup, nothing allocated after construction.
+class FDualSenseInputHistory
+{
+public:
+	static constexpr int32 Capacity = 128;
+	static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	FDualSenseInputHistory()
+	{
+		Reset();
+	}
+
+	void Reset();
+
+	//Capturing the same frame again replaces it
+	FORCEINLINE void Capture(uint64 Frame, FDualSenseInputSnapshot Snapshot)
+	{
+		const int32 Index = (int32)(Frame & (Capacity - 1));
+		Snapshots[Index] = Snapshot;
+		Frames[Index] = Frame;
+		LatestFrame = bHasFrames ? FMath::Max(LatestFrame, Frame) : Frame;
+		bHasFrames = true;
+	}
+
+	//Null when the frame was never captured or is more than Capacity frames old
+	FORCEINLINE const FDualSenseInputSnapshot* Find(uint64 Frame) const
+	{
+		const int32 Index = (int32)(Frame & (Capacity - 1));
+		return bHasFrames && Frames[Index] == Frame ? &Snapshots[Index] : nullptr;
+	}
+
+	FORCEINLINE bool HasFrames() const
+	{
+		return bHasFrames;
+	}
+
+	FORCEINLINE uint64 GetLatestFrame() const
+	{
+		return LatestFrame;
+	}
+
+	//First frame from FirstFrame on whose captured input differs from Predicted[i] (frame FirstFrame + i), INDEX_NONE when all match.
+	//Frames that were never captured count as different, their input is unknown
+	int64 FindFirstDifference(uint64 FirstFrame, const FDualSenseInputSnapshot* Predicted, int32 Count) const;
+
+	//Same with a tolerance on the analogs (FDualSenseInputSnapshot::NearlyEquals)
+	int64 FindFirstDifference(uint64 FirstFrame, const FDualSenseInputSnapshot* Predicted, int32 Count, int32 Tolerance) const;
+
+private:
+	FDualSenseInputSnapshot Snapshots[Capacity];
+	uint64 Frames[Capacity];
+	uint64 LatestFrame;
+	bool bHasFrames;
+};
+#pragma endregion
@@ -0,0 +1,193 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Containers/CircularQueue.h"
+#include "WinDualSenseLibrary/ds5w.h"
+#include "WinDualSenseReport.h"
+#include "WinDualSenseRemap.h"
+#include "WinDualSenseGesture.h"
+#include "WinDualSenseMotionGesture.h"
+#include "WinDualSenseCallback.h"
+#include "WinDualSenseDrift.h"
+#include "WinDualSenseUsage.h"
+#include "WinDualSenseScope.h"
+#include <atomic>
+
+enum class EDualSenseSlotState : uint8
+{
+	//Nothing open, IO thread may claim it
+	Free,
+	//IO thread is opening a controller in it
+	Reserved,
+	//Reading, reports are queued
+	Connected,
+	//Read failed, waiting for the game thread to release the context
+	Lost
+};
+
+#pragma region Dual Sense [IO Thread]
+//Single thread that waits on every open controller handle at once (overlapped reads on one completion port)
+//and queues the decoded reports per controller for the game thread.
+class FDualSenseIOThread : public FRunnable
+{
+public:
+	static constexpr int32 MaxDevices = 16;
+	static constexpr uint32 ReportQueueSize = 64;
+	//Button and motion gestures share it, events that find it full are counted as FDualSenseUsageCounters::DroppedGestures
+	static constexpr uint32 GestureQueueSize = 16;
+	static constexpr uint32 CallbackQueueSize = 64;
+	static constexpr uint32 DriftQueueSize = 4;
+	static constexpr uint32 EdgeQueueSize = 256;
+
+	//bEnumerateDevices : discover DualSense controllers through DS5W, otherwise only streams opened by hand are read
+	FDualSenseIOThread(bool bInEnumerateDevices = true);
+	~FDualSenseIOThread();
+
+	bool Start(const TCHAR* ThreadName = TEXT("DualSenseIO"));
+
+	//Opens any path that delivers DualSense input reports (HID device or pipe) into a slot.
+	//Only valid before Start(), streams are released with the thread.
+	bool OpenReportStream(int32 Slot, const TCHAR* Path, DS5W::DeviceConnection Connection);
+
+	//Marks a slot connected without a handle, its reports come from InjectReport (single producer).
+	//Any time, a running IO thread never claims the slot afterwards
+	bool OpenInjectedStream(int32 Slot);
+	//Producer is done, the game thread sees a disconnect and releases the slot
+	void CloseInjectedStream(int32 Slot);
+	bool InjectReport(int32 Slot, const FDualSenseInputReport& Report);
+
+	//Remap applied to every report of the slot from the next one on (null = identity), survives reconnects.
+	//The report in flight may still read the previous remap, retire it with AdvanceEpoch.
+	void SetButtonRemap(int32 Slot, const FDualSenseButtonRemap* Remap);
+
+	//Patterns matched against every report of every slot (null = none), same lifetime rule as the remap
+	void SetGestureSet(const FDualSenseGestureSet* Set);
+	//Game thread, after replacing published objects : they may be freed once HasPassedEpoch returns true for the result
+	uint64 AdvanceEpoch();
+	//No report producer is still inside a report it started before Epoch
+	bool HasPassedEpoch(uint64 Epoch) const;
+	//Yields until HasPassedEpoch, a report takes microseconds
+	void WaitForEpoch(uint64 Epoch) const;
+
+	//Motion gestures matched against every report of every slot (null = none), same lifetime rule as the remap.
+	//They come out of DequeueGestureEvent with the button gestures
+	void SetMotionGestureSettings(const FDualSenseMotionGestureSettings* Settings);
+
+	//Callbacks run by the report producer for every report of every slot (null = none), same lifetime rule as the remap
+	void SetCallbackSet(const FDualSenseCallbackSet* Set);
+
+	//Ring every report of the slot is copied into while a scope reads it (null = none), same lifetime rule as the remap
+	void SetScopeBuffer(int32 Slot, FDualSenseScopeBuffer* Buffer);
+
+	//Game thread
+	EDualSenseSlotState GetSlotState(int32 Slot) const;
+	DS5W::DeviceContext* GetDeviceContext(int32 Slot);
+	//HID path (or pipe name) of a connected slot, empty for injected streams
+	FString GetDevicePath(int32 Slot) const;
+	bool DequeueReport(int32 Slot, FDualSenseInputReport& OutReport);
+	//A report is queued for the slot, does not take it
+	bool HasReport(int32 Slot) const;
+	//Sleeps until every slot of SlotMask has a report queued or DeadlineCycles passed, woken by the producers.
+	//The last millisecond is yielded away rather than slept. Returns the slots still without one
+	uint32 WaitForReports(uint32 SlotMask, uint64 DeadlineCycles);
+	bool DequeueGestureEvent(int32 Slot, FDualSenseGestureEvent& OutEvent);
+	bool DequeueCallbackEvent(int32 Slot, FDualSenseCallbackEvent& OutEvent);
+	//Oldest button edge not taken yet, only taken when its report was (SensorTimestamp at or before UpToSensorTimestamp)
+	bool DequeueButtonEdge(int32 Slot, uint32 UpToSensorTimestamp, FDualSenseButtonEdge& OutEdge);
+	//Stick drift, refreshed while the sticks rest
+	bool DequeueDriftEstimate(int32 Slot, FDualSenseDriftEstimate& OutEstimate);
+	//Counted since the thread started, any thread may read them
+	const FDualSenseUsageCounters& GetUsageCounters(int32 Slot) const;
+	void ReleaseSlot(int32 Slot);
+
+	//FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	struct FSlot;
+
+	void EnumerateDevices();
+	bool OpenSlot(int32 Slot, void* Handle);
+	bool IssueRead(FSlot& Slot);
+	void CompleteRead(FSlot& Slot, uint32 BytesRead);
+	//Every producer stage, then queued for the game thread
+	bool ProduceReport(FSlot& Slot, FDualSenseInputReport& Report);
+	static void RemapReport(const FSlot& Slot, FDualSenseInputReport& Report);
+	void DetectGestures(FSlot& Slot, const FDualSenseInputReport& Report);
+	void DetectMotionGestures(FSlot& Slot, const FDualSenseInputReport& Report);
+	void RunCallbacks(FSlot& Slot, const FDualSenseInputReport& Report);
+	void EstimateDrift(FSlot& Slot, const FDualSenseInputReport& Report);
+	void LatchButtonEdges(FSlot& Slot, const FDualSenseInputReport& Report);
+	static void WriteScope(const FSlot& Slot, const FDualSenseInputReport& Report);
+	void LoseSlot(FSlot& Slot);
+	void CancelPendingReads();
+
+	TUniquePtr<FSlot> Slots[MaxDevices];
+
+	void* CompletionPort = nullptr;
+	FRunnableThread* Thread = nullptr;
+	std::atomic<bool> bStopping{ false };
+	std::atomic<uint64> PublishEpoch{ 1 };
+	std::atomic<const FDualSenseGestureSet*> GestureSet{ nullptr };
+	std::atomic<const FDualSenseMotionGestureSettings*> MotionGestureSettings{ nullptr };
+	std::atomic<const FDualSenseCallbackSet*> CallbackSet{ nullptr };
+
+	//Triggered by the producers after queuing a report while the game thread waits in WaitForReports
+	FEvent* ReportEvent = nullptr;
+	std::atomic<bool> bReportAwaited{ false };
+
+	bool bEnumerateDevices;
+	//First pass is logged with its timing
+	bool bHasEnumerated = false;
+	double NextEnumerateTime = 0.0;
+	//Seconds between looking for new controllers
+	double EnumerateInterval = 1.0;
+	//Seconds between checks for the library before the first enumeration
+	double LibraryPollInterval = 0.05;
+};
+//Published objects the report producers may still read after they were replaced, game thread only.
+//Each one is freed once every producer moved past the epoch it was retired at
+class FDualSenseRetireList
+{
+public:
+	template<typename T>
+	void Retire(TUniquePtr<T>&& Object, uint64 Epoch)
+	{
+		if (Object)
+		{
+			TUniquePtr<TRetired<T>> Retired = MakeUnique<TRetired<T>>();
+			Retired->Epoch = Epoch;
+			Retired->Object = MoveTemp(Object);
+			Objects.Add(MoveTemp(Retired));
+		}
+	}
+
+	//Frees what no producer can reach anymore, oldest first
+	void Collect(const FDualSenseIOThread& IOThread);
+
+	FORCEINLINE int32 Num() const
+	{
+		return Objects.Num();
+	}
+
+private:
+	struct FRetired
+	{
+		virtual ~FRetired() {}
+		uint64 Epoch = 0;
+	};
+
+	template<typename T>
+	struct TRetired : FRetired
+	{
+		TUniquePtr<T> Object;
+	};
+
+	TArray<TUniquePtr<FRetired>> Objects;
+};
+#pragma endregion
@@ -0,0 +1,100 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#pragma region Dual Sense [Late Latch]
+struct FDualSenseLatchSettings
+{
+	//Wait in SendControllerEvents for a report that is about to arrive instead of dispatching the older one.
+	//Off by default, it trades up to the wait budget of every frame for fresher input
+	bool bEnabled = false;
+
+	//Longest the game thread waits, microseconds
+	float MaxWaitMicroseconds = 1000.f;
+	//Share of the frame interval the wait may take, the budget is the smaller of the two
+	float MaxFrameShare = 0.1f;
+	//Receive jitter allowed past the predicted arrival, microseconds
+	float JitterMicroseconds = 250.f;
+};
+
+//Cadence of SendControllerEvents, which is where gameplay gets its input
+struct FDualSenseFramePacing
+{
+	void Reset();
+
+	//Once per SendControllerEvents
+	void AddFrame(uint64 Cycles);
+
+	//Microseconds, smoothed over the last frames, 0 until two frames were seen
+	double IntervalMean = 0.0;
+	uint64 LastFrameCycles = 0;
+};
+
+//How old the dispatched input of a controller was and what waiting for it cost
+struct FDualSenseLatchStats
+{
+	FDualSenseLatchStats()
+	{
+		Reset();
+	}
+
+	void Reset();
+
+	//Age of the newest report when it was dispatched
+	void AddDispatch(double AgeMicroseconds);
+	//bCaughtReport : the awaited report arrived before the deadline. Overshoot : how long past the deadline the wait returned
+	void AddWait(double WaitMicroseconds, bool bCaughtReport, double OvershootMicroseconds);
+
+	FORCEINLINE double GetAgeMean() const
+	{
+		return Dispatches > 0 ? AgeSum / Dispatches : 0.0;
+	}
+
+	FORCEINLINE double GetWaitMean() const
+	{
+		return Waits > 0 ? WaitSum / Waits : 0.0;
+	}
+
+	FORCEINLINE double GetOvershootMean() const
+	{
+		return Waits > 0 ? OvershootSum / Waits : 0.0;
+	}
+
+	uint64 Dispatches;
+	double AgeSum;
+	double AgeMax;
+	//Negative until the first dispatch
+	double LastAge;
+
+	uint64 Waits;
+	uint64 CaughtReports;
+	double WaitSum;
+	double OvershootSum;
+	double OvershootMax;
+};
+
+namespace DualSenseLatch
+{
+	//Microseconds until the controller's next report should be received (negative = overdue),
+	//from when the last one was received and the controller's mean report interval
+	double GetTimeToNextReport(uint64 LastReportCycles, double ReportIntervalMicroseconds, uint64 NowCycles);
+
+	//Longest wait the current frame pacing affords, 0 = do not wait
+	double GetWaitBudget(const FDualSenseLatchSettings& Settings, const FDualSenseFramePacing& Pacing);
+
+	//Whether a report due in TimeToNextReport is worth holding the frame for
+	bool ShouldWait(const FDualSenseLatchSettings& Settings, double TimeToNextReport, double ReportIntervalMicroseconds, double WaitBudget);
+
+	FORCEINLINE double CyclesToMicroseconds(uint64 Cycles)
+	{
+		return FPlatformTime::ToMilliseconds64(Cycles) * 1000.0;
+	}
+
+	FORCEINLINE uint64 MicrosecondsToCycles(double Microseconds)
+	{
+		return Microseconds > 0.0 ? (uint64)(Microseconds / (1000000.0 * FPlatformTime::GetSecondsPerCycle64())) : 0;
+	}
+}
+#pragma endregion
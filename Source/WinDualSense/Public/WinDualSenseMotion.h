@@ -0,0 +1,99 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WinDualSense_Enum.h"
+#include "WinDualSenseReport.h"
+
+#pragma region Dual Sense [Gyro Aim]
+struct FDualSenseGyroAimSettings
+{
+	bool bEnabled = false;
+
+	//Output counts per degree of rotation, from MinSensitivity at MinSensitivitySpeed (deg/s) to MaxSensitivity at MaxSensitivitySpeed
+	float MinSensitivity = 10.f;
+	float MaxSensitivity = 20.f;
+	float MinSensitivitySpeed = 0.f;
+	float MaxSensitivitySpeed = 90.f;
+	//Response curve between the two speeds, sensitivity follows Alpha^CurveExponent.
+	//1 is linear, higher keeps slow turns precise longer, lower reaches full sensitivity sooner
+	float CurveExponent = 2.f;
+
+	//Soft tiered smoothing : averaged below half the threshold (deg/s), direct above it
+	float SmoothThreshold = 4.f;
+	//Seconds of samples averaged in the smoothed tier
+	float SmoothTime = 0.1f;
+
+	//Holding this button lifts the gyro like a mouse (MAX_COUNT = no ratchet)
+	EDualSenseButtonType RatchetButton = EDualSenseButtonType::MAX_COUNT;
+
+	bool bInvertYaw = false;
+	bool bInvertPitch = false;
+};
+#pragma endregion
+
+#pragma region Dual Sense [Motion]
+//Calibrated motion of one controller, fed with every report at sensor rate.
+//Gyro aim integrates each sample with its own sensor timestamp delta, so the output never depends on the frame rate.
+class FDualSenseMotion
+{
+public:
+	static constexpr int32 SmoothBufferSize = 64;
+
+	FDualSenseMotion();
+
+	void Reset();
+
+	//Every report, in order
+	void AddSample(const FDualSenseInputReport& Report);
+
+	//Aim since the last call in whole output counts, the fraction carries over
+	FIntPoint ConsumeAimDelta();
+
+	//deg/s, bias removed
+	FORCEINLINE const FVector& GetAngularVelocity() const
+	{
+		return AngularVelocity;
+	}
+
+	//g
+	FORCEINLINE const FVector& GetAcceleration() const
+	{
+		return Acceleration;
+	}
+
+	//g, low passed acceleration
+	FORCEINLINE const FVector& GetGravity() const
+	{
+		return Gravity;
+	}
+
+	//Gyro stayed still long enough for the bias to follow it
+	bool IsAtRest() const;
+
+	FDualSenseGyroAimSettings AimSettings;
+
+	//Raw gyro counts while the controller is at rest
+	FVector GyroBias;
+
+private:
+	void UpdateBias(const FVector& RawGyro, float DeltaTime);
+	FVector2D SmoothAim(const FVector2D& Velocity, float DeltaTime);
+
+	bool bHasLastSample;
+	uint32 LastSensorTimestamp;
+
+	FVector AngularVelocity;
+	FVector Acceleration;
+	FVector Gravity;
+
+	//Seconds the gyro stayed under the rest speed
+	float RestTime;
+
+	FVector2D AimDelta;
+
+	FVector2D SmoothBuffer[SmoothBufferSize];
+	int32 SmoothIndex;
+};
+#pragma endregion
@@ -0,0 +1,141 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WinDualSenseGesture.h"
+
+struct FDualSenseInputReport;
+
+//Every motion gesture is reported as its own controller button (DualSense_Motion_<Name>).
+//Flick directions follow gyro aim (screen axes), orientations are the controller face pointing up, then the side pointing up
+enum class EDualSenseMotionGesture : uint8
+{
+	Shake,
+	Tap,
+	FlickLeft,
+	FlickRight,
+	FlickUp,
+	FlickDown,
+	FaceUp,
+	FaceDown,
+	RightSideUp,
+	LeftSideUp,
+	TopDown,
+	TopUp,
+	MAX_COUNT
+};
+
+//Kind of a motion gesture, each one has its own cooldown
+enum class EDualSenseMotionGestureType : uint8
+{
+	Shake,
+	Tap,
+	Flick,
+	OrientationSnap,
+	MAX_COUNT
+};
+
+#pragma region Dual Sense [Motion Gesture]
+namespace DualSenseMotionGesture
+{
+	//Key the gesture is dispatched as
+	const FName& GetKey(EDualSenseMotionGesture Gesture);
+	EDualSenseMotionGestureType GetType(EDualSenseMotionGesture Gesture);
+}
+
+struct FDualSenseMotionGestureSettings
+{
+	bool bEnabled = false;
+
+	bool bShake = true;
+	bool bTap = true;
+	bool bFlick = true;
+	bool bSnap = true;
+
+	//Shake : the linear acceleration (g) past ShakeAcceleration in alternating directions on one axis,
+	//ShakeReversals times in a row, each within ShakeReversalTime seconds of the previous peak
+	float ShakeAcceleration = 1.5f;
+	int32 ShakeReversals = 4;
+	float ShakeReversalTime = 0.25f;
+
+	//Tap on the controller body : a jolt past TapAcceleration (g) settled again within TapTime seconds,
+	//after TapQuietTime seconds of stillness and without turning faster than TapMaxRotation (deg/s)
+	float TapAcceleration = 0.6f;
+	float TapTime = 0.04f;
+	float TapQuietTime = 0.1f;
+	float TapMaxRotation = 90.f;
+
+	//Flick : a turn peaking over FlickSpeed (deg/s), over within FlickTime seconds and covering FlickAngle degrees
+	float FlickSpeed = 360.f;
+	float FlickTime = 0.25f;
+	float FlickAngle = 20.f;
+
+	//Orientation snap : gravity within SnapAngle degrees of another face for SnapTime seconds
+	float SnapAngle = 25.f;
+	float SnapTime = 0.2f;
+
+	//Seconds before the same kind of gesture fires again
+	float Cooldown = 0.3f;
+};
+
+//Per controller streaming filters over the accelerometer and gyro, fed with every report on device timestamps.
+//Constant work per report, no history beyond a few filter states
+class FDualSenseMotionGestureDetector
+{
+public:
+	FDualSenseMotionGestureDetector()
+	{
+		Reset();
+	}
+
+	void Reset();
+
+	void Update(const FDualSenseMotionGestureSettings& Settings, const FDualSenseInputReport& Report, TFunctionRef<void(EDualSenseMotionGesture)> Emit);
+
+private:
+	//Filters that only make sense over a continuous stream, kept gravity and orientation aside
+	void ResetTracking();
+
+	bool CanEmit(EDualSenseMotionGestureType Type, float Cooldown) const;
+	void Fire(EDualSenseMotionGesture Gesture, TFunctionRef<void(EDualSenseMotionGesture)>& Emit);
+
+	void UpdateShake(const FDualSenseMotionGestureSettings& Settings, const FVector& Linear, TFunctionRef<void(EDualSenseMotionGesture)>& Emit);
+	void UpdateTap(const FDualSenseMotionGestureSettings& Settings, const FVector& Linear, float RotationSpeed, float DeltaTime, TFunctionRef<void(EDualSenseMotionGesture)>& Emit);
+	void UpdateFlick(const FDualSenseMotionGestureSettings& Settings, const FVector2D& AimVelocity, float DeltaTime, TFunctionRef<void(EDualSenseMotionGesture)>& Emit);
+	void UpdateSnap(const FDualSenseMotionGestureSettings& Settings, float DeltaTime, TFunctionRef<void(EDualSenseMotionGesture)>& Emit);
+
+	bool IsShaking(float ShakeReversalTime) const;
+
+	bool bHasLastSample;
+	uint32 LastSensorTimestamp;
+	//Seconds since the first report
+	double Time;
+
+	//g, low passed acceleration
+	FVector Gravity;
+
+	//Per axis : sign of the last peak, alternating peaks in a row and when the last one was
+	int8 ShakeSigns[3];
+	int32 ShakePeaks[3];
+	double ShakePeakTimes[3];
+
+	float TapQuietTime;
+	bool bTapSpike;
+	bool bTapSpikeValid;
+	double TapSpikeStart;
+
+	bool bFlickActive;
+	double FlickStart;
+	float FlickPeakSpeed;
+	FVector2D FlickRotation;
+
+	//EDualSenseMotionGesture face index or INDEX_NONE
+	int32 Orientation;
+	int32 PendingOrientation;
+	float PendingTime;
+
+	//Per EDualSenseMotionGestureType
+	double LastFireTimes[(int32)EDualSenseMotionGestureType::MAX_COUNT];
+};
+#pragma endregion
@@ -0,0 +1,106 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WinDualSenseLibrary/ds5w.h"
+#include <atomic>
+
+enum class EDualSenseOutputCommandType : uint8
+{
+	LeftRumble,
+	RightRumble,
+	//Both motors at once
+	Rumble,
+	LightBar,
+	PlayerLeds,
+	LeftTriggerEffect,
+	RightTriggerEffect,
+	MicLed
+};
+
+#pragma region Dual Sense [Output Command]
+namespace DualSenseOutput
+{
+	//Light bar of a controller nobody set a color for, and the one ResetLightColor goes back to
+	const FColor DefaultLightColor(0, 0, 255);
+}
+
+//One change to a controller's output report, only the field matching Type is read
+struct FDualSenseOutputCommand
+{
+	FDualSenseOutputCommand()
+	{
+		FMemory::Memzero(LightBar);
+		FMemory::Memzero(PlayerLeds);
+		FMemory::Memzero(TriggerEffect);
+	}
+
+	int32 ControllerId = 0;
+	EDualSenseOutputCommandType Type = EDualSenseOutputCommandType::LeftRumble;
+
+	//Left motor for LeftRumble and Rumble, right motor for RightRumble
+	uint8 Rumble = 0;
+	//Right motor for Rumble
+	uint8 RightRumble = 0;
+	DS5W::Color LightBar;
+	DS5W::PlayerLeds PlayerLeds;
+	DS5W::TriggerEffect TriggerEffect;
+	DS5W::MicLed MicLed = DS5W::MicLed::OFF;
+
+	static FDualSenseOutputCommand MakeRumble(int32 ControllerId, bool bRight, uint8 Rumble);
+	static FDualSenseOutputCommand MakeRumble(int32 ControllerId, uint8 LeftRumble, uint8 RightRumble);
+	static FDualSenseOutputCommand MakeLightBar(int32 ControllerId, FColor Color);
+	static FDualSenseOutputCommand MakePlayerLeds(int32 ControllerId, uint8 Bitmask, DS5W::LedBrightness Brightness, bool bFade);
+	static FDualSenseOutputCommand MakeTriggerEffect(int32 ControllerId, bool bRight, const DS5W::TriggerEffect& TriggerEffect);
+	static FDualSenseOutputCommand MakeMicLed(int32 ControllerId, DS5W::MicLed MicLed);
+
+	//Folds the command into the state sent with the next output report, returns true when the state changed
+	bool Apply(DS5W::DS5OutputState& OutState) const;
+};
+
+//Output commands from any thread (gameplay, audio, physics) to the single output stage on the game thread.
+//Bounded lock free multi producer / single consumer ring, every cell preallocated so nothing allocates per command.
+//FIFO per producer.
+class FDualSenseOutputQueue
+{
+public:
+	//Power of two, commands the output stage may fall behind by before new ones are refused
+	static constexpr uint32 Capacity = 1024;
+
+	FDualSenseOutputQueue();
+
+	//Any thread, false when the queue is full (the command is not queued)
+	bool Enqueue(const FDualSenseOutputCommand& Command);
+
+	//Output stage only, returns the number of commands handed to Visitor
+	template <typename VisitorType>
+	int32 Drain(VisitorType&& Visitor)
+	{
+		int32 Count = 0;
+		FDualSenseOutputCommand Command;
+		while (Dequeue(Command))
+		{
+			Visitor(Command);
+			++Count;
+		}
+		return Count;
+	}
+
+private:
+	bool Dequeue(FDualSenseOutputCommand& OutCommand);
+
+	//Sequence == position : free for the producer claiming that position, position + 1 : written, ready to drain
+	struct FCell
+	{
+		std::atomic<uint32> Sequence;
+		FDualSenseOutputCommand Command;
+	};
+
+	FCell Cells[Capacity];
+
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> EnqueuePosition{ 0 };
+	//Output stage only
+	alignas(PLATFORM_CACHE_LINE_SIZE) uint32 DequeuePosition = 0;
+};
+#pragma endregion
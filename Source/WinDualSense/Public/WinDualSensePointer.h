@@ -0,0 +1,87 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WinDualSenseReport.h"
+
+enum class EDualSensePointerClick : uint8
+{
+	LeftDown,
+	LeftUp,
+	RightDown,
+	RightUp
+};
+
+#pragma region Dual Sense [Touch Pointer]
+struct FDualSenseTouchPointerSettings
+{
+	bool bEnabled = false;
+
+	//Screen pixels per touchpad count, blended by finger speed (counts/s) between the two speeds
+	float MinSensitivity = 0.5f;
+	float MaxSensitivity = 2.f;
+	float MinSensitivitySpeed = 100.f;
+	float MaxSensitivitySpeed = 2500.f;
+	//Acceleration curve between the two speeds, 1 is linear, higher keeps slow moves precise longer
+	float CurveExponent = 2.f;
+
+	//A finger down and up again within TapTime seconds, moving less than TapDistance counts, is a left click
+	bool bTapToClick = true;
+	float TapTime = 0.18f;
+	float TapDistance = 30.f;
+};
+
+//First finger on the touchpad as a mouse : integrated with every report's own sensor timestamp delta,
+//so the distance moved never depends on the frame rate. Pressing the touchpad clicks (right click with a second finger down).
+class FDualSenseTouchPointer
+{
+public:
+	static constexpr int32 MaxPendingClicks = 16;
+
+	FDualSenseTouchPointer();
+
+	void Reset();
+
+	//Every report, in order
+	void AddSample(const FDualSenseInputReport& Report);
+
+	//Pixels since the last call, the fraction carries over
+	FIntPoint ConsumeDelta();
+
+	//Clicks since the last call in the order they happened. Past MaxPendingClicks in one frame a press is skipped
+	//together with its release, a release of a press already sent is never dropped
+	int32 ConsumeClicks(EDualSensePointerClick (&OutClicks)[MaxPendingClicks]);
+
+	FDualSenseTouchPointerSettings Settings;
+
+private:
+	void AddClick(EDualSensePointerClick Click);
+
+	bool bHasLastSample;
+	uint32 LastSensorTimestamp;
+
+	//Finger tracked since it touched down, a new touch never jumps the pointer
+	bool bIsTouching;
+	uint8 TouchContact;
+	FVector2D LastPosition;
+
+	//Current touch, for tap to click
+	FVector2D TouchStartPosition;
+	float TouchTime;
+	bool bIsTap;
+
+	//Touchpad button held, and the click it started
+	bool bIsClicking;
+	EDualSensePointerClick ClickRelease;
+
+	FVector2D PointerDelta;
+
+	EDualSensePointerClick Clicks[MaxPendingClicks];
+	int32 ClickCount;
+	//Presses queued without their release yet, room is kept for those
+	int32 PendingReleases;
+	//Per button (left, right), the press was skipped so its release is too
+	bool bSkippedPress[2];
+};
+#pragma endregion
@@ -0,0 +1,60 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WinDualSense_Enum.h"
+
+#pragma region Dual Sense [Button Remap]
+//Compiled button remap : one destination mask per physical button.
+//Applied to the packed button word (DualSenseReport::PackButtons) with bit operations only.
+struct FDualSenseButtonRemap
+{
+	static constexpr int32 ButtonCount = (int32)EDualSenseButtonType::MAX_COUNT;
+
+	//Identity
+	FDualSenseButtonRemap()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		for (int32 Index = 0; Index < ButtonCount; ++Index)
+		{
+			DestinationMasks[Index] = 1u << Index;
+		}
+		MappedButtons = 0;
+	}
+
+	FORCEINLINE uint32 Apply(uint32 Buttons) const
+	{
+		uint32 Remapped = 0;
+		for (int32 Index = 0; Index < ButtonCount; ++Index)
+		{
+			//All ones when the physical button is down, zero otherwise
+			Remapped |= DestinationMasks[Index] & (0u - ((Buttons >> Index) & 1u));
+		}
+		return Remapped;
+	}
+
+	//Physical button acts as Logical. The first map of a physical button replaces what it drove,
+	//the next ones add to it, so successive maps let one physical button drive several logical buttons
+	void Map(EDualSenseButtonType Physical, EDualSenseButtonType Logical);
+	void Swap(EDualSenseButtonType First, EDualSenseButtonType Second);
+	void Disable(EDualSenseButtonType Physical);
+
+	//Space / comma separated operations applied in order on top of identity :
+	//"CROSS=CIRCLE" map, "BUMPER_LEFT<>BUMPER_RIGHT" swap, "-MIC" disable. Returns false on an unknown button.
+	bool Compile(const TCHAR* Mapping);
+
+	static const TCHAR* GetButtonName(EDualSenseButtonType Button);
+	static EDualSenseButtonType FindButton(const FString& Name);
+
+	uint32 DestinationMasks[ButtonCount];
+
+private:
+	//Physical buttons mapped since the last Reset
+	uint32 MappedButtons;
+};
+#pragma endregion
@@ -0,0 +1,262 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WinDualSenseReport.h"
+#include "WinDualSenseMotionGesture.h"
+#include "WinDualSenseDrift.h"
+#include "WinDualSenseIO.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+class FWinDualSenseDevice;
+class FDualSenseOutputQueue;
+class FDualSenseScopeBuffer;
+struct FDualSenseScopeSample;
+struct FDualSenseCalibration;
+
+namespace DualSenseShared
+{
+	struct FRecord;
+}
+
+#pragma region Dual Sense [Replay]
+//A gesture the motion recording performs between Start and End (seconds)
+struct FDualSenseScriptedMotionGesture
+{
+	EDualSenseMotionGesture Gesture;
+	double Start;
+	double End;
+};
+
+//Simulated stick wear, decoded units
+struct FDualSenseStickProfile
+{
+	const TCHAR* Name;
+	FVector2D StartCenter;
+	FVector2D EndCenter;
+	float Noise;
+	//Spread of where the stick lands after each release
+	float ReleaseScatter;
+};
+
+enum class EDualSenseStickPhase : uint8
+{
+	Rest,
+	Sweep,
+	//Small deliberate deflection, held
+	Hold
+};
+
+struct FDualSenseStickSample
+{
+	int8 X;
+	int8 Y;
+	EDualSenseStickPhase Phase;
+	FVector2D Center;
+};
+
+//How the adaptive deadzone did on one stick against the fixed one, scored after the warm up, sweeps left out
+struct FDualSenseDriftScore
+{
+	//Last estimate the game thread had
+	FDualSenseStickDrift Drift;
+	int64 RestCount = 0;
+	int64 HoldCount = 0;
+	//Rest reports outside the deadzone
+	int64 FixedLeaks = 0;
+	int64 AdaptiveLeaks = 0;
+	//Held deflections inside the deadzone
+	int64 FixedLost = 0;
+	int64 AdaptiveLost = 0;
+	double MeanCenterError = 0.0;
+
+	double GetLeakPercent(bool bAdaptive) const
+	{
+		return RestCount > 0 ? (bAdaptive ? AdaptiveLeaks : FixedLeaks) * 100.0 / RestCount : 0.0;
+	}
+
+	double GetLostPercent(bool bAdaptive) const
+	{
+		return HoldCount > 0 ? (bAdaptive ? AdaptiveLost : FixedLost) * 100.0 / HoldCount : 0.0;
+	}
+};
+
+//Dispatched state of a synthetic game for one frame, what the input history captures
+struct FDualSenseDispatchedInput
+{
+	uint32 Buttons;
+	FVector2D LeftStick;
+	FVector2D RightStick;
+	float Triggers[2];
+};
+
+//Input of one controller for one frame, what UpdateReports leaves behind
+struct FDualSenseBankInput
+{
+	DS5W::DS5InputState State;
+	FDualSenseInputReport Report;
+	uint32 Buttons;
+};
+
+//Synthetic recordings and their replay, shared by the console benchmarks (DUALSENSE BENCH) and the automation tests (Plugins.WinDualSense)
+namespace DualSenseReplay
+{
+	//Gyro recording : at rest long enough to calibrate, then fast sweeps with slow tracking on the other axis,
+	//a raw bias, sensor noise, jittered report intervals and the ratchet (Cross) held for one second
+	void MakeGyroRecording(float Seconds, int32 ReportRate, TArray<FDualSenseInputReport>& OutReports);
+
+	//Gyro recording with moving sticks, triggers and a finger on the touchpad
+	void MakeSessionRecording(float Seconds, int32 ReportRate, TArray<FDualSenseInputReport>& OutReports);
+
+	//Tap recording, every 400ms : Cross taps of 4, 8, 12, 30 and 100ms, Circle pressed across the end of the long one,
+	//then a Cross double tap inside 20ms. Ends with everything released
+	void MakeTapRecording(float Seconds, int32 ReportRate, TArray<FDualSenseInputReport>& OutReports);
+
+	//Session recording with the tap recording's buttons on top
+	void MakeTapSessionRecording(float Seconds, int32 ReportRate, TArray<FDualSenseInputReport>& OutReports);
+
+	//Touchpad recording, every second : a fast swipe right (300ms), a slow drag down (300ms), a 100ms tap,
+	//then a finger pressing the touchpad (a second finger down on odd seconds). Jittered report intervals, ends with the finger lifted
+	void MakePointerRecording(float Seconds, int32 ReportRate, TArray<FDualSenseInputReport>& OutReports);
+
+	//Motion recording, flat on its back first : two taps on the shell, a slow turn with a gentle push, flicks in every direction,
+	//a shake, then rolled onto its right side and pitched onto its top and back, turning too slowly to flick.
+	//Gravity follows the orientation integrated from the gyro, with gyro bias, sensor noise and jittered report intervals
+	void MakeMotionRecording(int32 ReportRate, TArray<FDualSenseInputReport>& OutReports, TArray<FDualSenseScriptedMotionGesture>& OutGestures);
+
+	//2 s at rest, 1 s of sweeps, 0.5 s held at 0.15 of the range, repeated while the center moves from start to end
+	void MakeStickSamples(const FDualSenseStickProfile& Profile, float Seconds, int32 ReportRate, TArray<FDualSenseStickSample>& OutSamples);
+
+	//60 fps of a synthetic game, sticks past a dead zone, cross held every other 20 frames
+	void MakeDispatchedInputs(int32 Frames, TArray<FDualSenseDispatchedInput>& OutInputs);
+
+	//InputFrames frames of moving input for every bank lane (frame major), with a calibration and gyro bias per controller
+	void MakeBankInputs(int32 InputFrames, TArray<FDualSenseBankInput>& OutInputs, FDualSenseCalibration* OutCalibrations, FVector* OutGyroBiases);
+
+	//Per controller decode of one analog / motion vector, as UpdateAnalogs did it before the bank
+	float DecodeAnalog(EDualSenseAnalogType Type, const DS5W::DS5InputState& State, const FDualSenseCalibration& Calibration);
+	FVector DecodeVector(EDualSenseVectorType Type, const FDualSenseInputReport& Report, const FVector& GyroBias);
+
+	//Fields of a synthetic indexed report all derive from its index, a torn copy can't match
+	FDualSenseInputReport MakeIndexedReport(uint64 Index);
+	bool IsIndexedRecordIntact(const DualSenseShared::FRecord& Record);
+	//Scope samples of indexed reports, the low 32 bits of the index come back from the gyroscope
+	bool IsIndexedSampleIntact(const FDualSenseScopeSample& Sample, uint32& OutIndex);
+
+	//Presses (0 -> 1 transitions) of Buttons, seen by every report or only by the last report of each frame
+	int32 CountPresses(const TArray<FDualSenseInputReport>& Reports, uint32 Buttons, int32 ReportRate, int32 FrameRate);
+
+	//Matches detected gestures (sensor seconds) to the script in order, within a second of each scripted end. Returns the gestures that matched
+	int32 MatchMotionGestures(const TArray<FDualSenseScriptedMotionGesture>& Script, const TArray<TPair<EDualSenseMotionGesture, double>>& Detected, int32& OutUnexpected);
+
+	//Feeds the samples through a drift estimator, only the latest published estimate is used like on the game thread
+	FDualSenseDriftScore ScoreDrift(const TArray<FDualSenseStickSample>& Samples, int32 WarmUpSamples, float FixedDeadZoneRatio);
+
+	//A game reading the recording at FrameRate on the sensor clock, each frame interval scaled by a random 1 +- FrameJitter (seeded with FrameRate).
+	//Every report up to a frame goes to AddReport, then EndFrame gets the index of the last one. Frames no report reached are skipped
+	void ReplayFrames(const TArray<FDualSenseInputReport>& Recording, int32 FrameRate, float FrameJitter,
+		TFunctionRef<void(const FDualSenseInputReport&)> AddReport, TFunctionRef<void(int32 LastIndex)> EndFrame);
+
+	//Same frames through the IO thread and SendControllerEvents of a device on injected controller 0. Returns the reports its queue dropped
+	int32 ReplayFrames(FWinDualSenseDevice& Device, FDualSenseIOThread& Injector, const TArray<FDualSenseInputReport>& Recording, int32 FrameRate, float FrameJitter = 0.f);
+}
+
+//Hammers the output queue from its own thread, the command sequence number rides in the light bar color
+class FDualSenseOutputCommandProducer : public FRunnable
+{
+public:
+	FDualSenseOutputCommandProducer(FDualSenseOutputQueue& InQueue, int32 InProducer, int32 InCommandCount, const std::atomic<bool>& bInStart);
+	~FDualSenseOutputCommandProducer();
+
+	void Join();
+
+	virtual uint32 Run() override;
+
+	static int32 GetSequence(const DS5W::Color& Color);
+
+	//Times the queue was full, written by the producer thread, read after it finished
+	uint64 FullRetries = 0;
+
+private:
+	FDualSenseOutputQueue& Queue;
+	int32 Producer;
+	int32 CommandCount;
+	const std::atomic<bool>& bStart;
+	FRunnableThread* Thread = nullptr;
+};
+
+//Polls every controller of a shared state region through its own mapping, like a tool in another process
+class FDualSenseSharedStateReaderThread : public FRunnable
+{
+public:
+	FDualSenseSharedStateReaderThread(const FString& InName, int32 InReader);
+	~FDualSenseSharedStateReaderThread();
+
+	//Stops polling and joins, results can be read afterwards
+	void Finish();
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	FString Name;
+	bool bOpenFailed = false;
+	uint64 ReadRecords = 0;
+	uint64 MissedRecords = 0;
+	uint64 CorruptRecords = 0;
+	TArray<double> Latencies;
+
+private:
+	std::atomic<bool> bStopping{ false };
+	FRunnableThread* Thread = nullptr;
+};
+
+//Reads the newest scope samples of indexed reports at display rate, like the scope widget
+class FDualSenseScopeReaderThread : public FRunnable
+{
+public:
+	FDualSenseScopeReaderThread(const FDualSenseScopeBuffer& InBuffer, int32 InDisplayRate);
+	~FDualSenseScopeReaderThread();
+
+	//Stops reading and joins, results can be read afterwards
+	void Finish();
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	uint64 Reads = 0;
+	uint64 SeenSamples = 0;
+	uint64 MissedSamples = 0;
+	uint64 CorruptSamples = 0;
+	uint64 OutOfOrderSamples = 0;
+	TArray<double> ReadTimes;
+
+private:
+	const FDualSenseScopeBuffer& Buffer;
+	int32 DisplayRate;
+	std::atomic<bool> bStopping{ false };
+	FRunnableThread* Thread = nullptr;
+};
+
+//Injected controllers fed 4 reports, force feedback and a light bar command each per frame, with everything the frame can do turned on
+class FDualSenseSyntheticFrameProducer
+{
+public:
+	FDualSenseSyntheticFrameProducer(FWinDualSenseDevice& InDevice, FDualSenseIOThread* InInjector, int32 InControllerCount);
+
+	void Produce(int32 Frame);
+
+	//What the IO thread does for the frame, every producer stage runs inside InjectReport
+	void InjectReports(int32 Frame);
+
+	//What gameplay does for the frame, through the same entry points as the engine
+	void SendOutputs(int32 Frame);
+
+private:
+	FWinDualSenseDevice& Device;
+	FDualSenseIOThread* Injector;
+	int32 ControllerCount;
+	FDualSenseInputReport Reports[FDualSenseIOThread::MaxDevices];
+};
+#pragma endregion
@@ -0,0 +1,271 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WinDualSense_Enum.h"
+#include "WinDualSenseLibrary/ds5w.h"
+
+struct FDualSenseInputReport;
+
+#pragma region Dual Sense [Input Report]
+//Raw HID input report fields that DS5W does not decode into DS5InputState
+namespace DualSenseReport
+{
+	//Payload starts after the report id on USB, BT reports carry one more header byte
+	static constexpr int32 USBPayloadOffset = 1;
+	static constexpr int32 BTPayloadOffset = 2;
+
+	//Read sizes DS5W uses for each connection
+	static constexpr int32 USBReportLength = 64;
+	static constexpr int32 BTReportLength = 547;
+
+	//Full input report ids (BT only sends 0x31 once DS5W switched the controller to full reports)
+	static constexpr uint8 USBReportId = 0x01;
+	static constexpr uint8 BTReportId = 0x31;
+
+	//Payload bytes up to and including the battery state
+	static constexpr int32 MinPayloadLength = 0x37;
+
+	//Offsets inside the payload
+	static constexpr int32 SequenceOffset = 0x06;
+	static constexpr int32 SensorTimestampOffset = 0x1B;
+
+	//Motion blocks, gyroscope first (DS5W copies this one into DS5InputState::accelerometer)
+	static constexpr int32 GyroscopeOffset = 0x0F;
+	static constexpr int32 AccelerometerOffset = 0x15;
+
+	//Touch points, a contact byte then 12 bit X / Y each
+	static constexpr int32 TouchOffsets[2] = { 0x20, 0x24 };
+	//Contact bit set while no finger is down, the low 7 bits count the touches
+	static constexpr uint8 NoTouchContact = 0x80;
+	//Touch point range
+	static constexpr int32 TouchpadWidth = 1920;
+	static constexpr int32 TouchpadHeight = 1080;
+
+	//Sensor timestamp ticks at 3MHz (0.33us per tick)
+	static constexpr double SensorTicksPerSecond = 3000000.0;
+
+	//Nominal motion resolution (+-2000 deg/s, +-4 g), before per-device calibration
+	static constexpr float GyroCountsPerDegreePerSecond = 16.384f;
+	static constexpr float AccelCountsPerG = 8192.f;
+
+	FORCEINLINE int32 GetPayloadOffset(DS5W::DeviceConnection Connection)
+	{
+		return Connection == DS5W::DeviceConnection::BT ? BTPayloadOffset : USBPayloadOffset;
+	}
+
+	FORCEINLINE uint8 GetReportId(DS5W::DeviceConnection Connection)
+	{
+		return Connection == DS5W::DeviceConnection::BT ? BTReportId : USBReportId;
+	}
+
+	FORCEINLINE int32 GetReportLength(DS5W::DeviceConnection Connection)
+	{
+		return Connection == DS5W::DeviceConnection::BT ? BTReportLength : USBReportLength;
+	}
+
+	FORCEINLINE const uint8* GetPayload(const DS5W::DeviceContext& Context)
+	{
+		return Context._internal.hidBuffer + GetPayloadOffset(Context._internal.connection);
+	}
+
+	FORCEINLINE uint8 ReadSequence(const uint8* Payload)
+	{
+		return Payload[SequenceOffset];
+	}
+
+	FORCEINLINE uint32 ReadSensorTimestamp(const uint8* Payload)
+	{
+		const uint8* Bytes = Payload + SensorTimestampOffset;
+		return (uint32)Bytes[0] | ((uint32)Bytes[1] << 8) | ((uint32)Bytes[2] << 16) | ((uint32)Bytes[3] << 24);
+	}
+
+	FORCEINLINE double SensorTicksToMicroseconds(uint32 Ticks)
+	{
+		return (double)Ticks * 1000000.0 / SensorTicksPerSecond;
+	}
+
+	//Same decoding DS5W::getDeviceInputState applies, for reports read outside the library
+	void DecodeInputState(const uint8* Payload, DS5W::DS5InputState& OutState);
+
+	//DecodeInputState plus the fields DS5W drops (sequence, timestamp, correctly labeled motion)
+	void DecodeReport(const uint8* Payload, FDualSenseInputReport& OutReport);
+
+	//Inverse of DecodeInputState, builds a full USB input report (USBReportLength bytes) for fake devices.
+	//TouchContacts : both contact bytes, null when no finger is down
+	void EncodeUSBReport(const DS5W::DS5InputState& State, uint8 Sequence, uint32 SensorTimestamp, uint8* OutReport, const uint8* TouchContacts = nullptr);
+
+	//One bit per EDualSenseButtonType
+	uint32 PackButtons(const DS5W::DS5InputState& State);
+
+	FORCEINLINE uint32 GetButtonMask(EDualSenseButtonType ButtonType)
+	{
+		return ButtonType < EDualSenseButtonType::MAX_COUNT ? 1u << (uint32)ButtonType : 0u;
+	}
+
+	FORCEINLINE bool IsTouching(uint8 TouchContact)
+	{
+		return (TouchContact & NoTouchContact) == 0;
+	}
+}
+
+//One decoded report with the header fields DS5W drops
+struct FDualSenseInputReport
+{
+	DS5W::DS5InputState State;
+	uint8 Sequence = 0;
+	uint32 SensorTimestamp = 0;
+	//One bit per EDualSenseButtonType, after the controller's button remap
+	uint32 Buttons = 0;
+	//Raw motion counts
+	DS5W::Vector3 Gyroscope;
+	DS5W::Vector3 Accelerometer;
+	//FPlatformTime::Cycles64() when the report was read
+	uint64 ReceiveCycles = 0;
+	//Contact byte of each touch point, DS5W drops them
+	uint8 TouchContacts[2] = { DualSenseReport::NoTouchContact, DualSenseReport::NoTouchContact };
+};
+
+//Buttons that went down / up between a report and the one before it, latched by the read thread
+//so taps shorter than a frame are still replayed in order
+struct FDualSenseButtonEdge
+{
+	uint32 PressedButtons = 0;
+	uint32 ReleasedButtons = 0;
+	//Of the report that carried the edge
+	uint32 SensorTimestamp = 0;
+	uint64 ReceiveCycles = 0;
+};
+
+//Per-controller report health, fed with every report read from the device
+struct FDualSenseReportStats
+{
+	FDualSenseReportStats()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		ReceivedReports = 0;
+		DroppedReports = 0;
+		DuplicateReports = 0;
+		Stalls = 0;
+		ConsecutiveStaleReports = 0;
+
+		IntervalCount = 0;
+		IntervalMean = 0.0;
+		IntervalM2 = 0.0;
+		IntervalMin = 0.0;
+		IntervalMax = 0.0;
+
+		bHasLastReport = false;
+		LastSequence = 0;
+		LastSeenSequence = 0;
+		LastSensorTimestamp = 0;
+	}
+
+	//Returns true when the report carries new data
+	bool AddReport(uint8 Sequence, uint32 SensorTimestamp)
+	{
+		++ReceivedReports;
+
+		if (!bHasLastReport)
+		{
+			bHasLastReport = true;
+			LastSequence = Sequence;
+			LastSeenSequence = Sequence;
+			LastSensorTimestamp = SensorTimestamp;
+			return true;
+		}
+
+		//Counter wraps at 256, unsigned math keeps the distance right
+		const uint8 SequenceDelta = (uint8)(Sequence - LastSeenSequence);
+		if (SequenceDelta == 0)
+		{
+			++DuplicateReports;
+			AddMissedReport();
+			return false;
+		}
+
+		DroppedReports += SequenceDelta - 1;
+		LastSeenSequence = Sequence;
+
+		//New report around an old sensor sample : stale once here, and its sequence is not taken for a dropped one later
+		const uint32 TimestampDelta = SensorTimestamp - LastSensorTimestamp;
+		if (TimestampDelta == 0)
+		{
+			AddMissedReport();
+			return false;
+		}
+
+		ConsecutiveStaleReports = 0;
+
+		//Every report sent since the last fresh one shares the interval, stale ones included
+		AddInterval(DualSenseReport::SensorTicksToMicroseconds(TimestampDelta) / FMath::Max((int32)(uint8)(Sequence - LastSequence), 1));
+
+		LastSequence = Sequence;
+		LastSensorTimestamp = SensorTimestamp;
+		return true;
+	}
+
+	//Called when a poll brought nothing new from the device
+	void AddMissedReport()
+	{
+		SetMissedReports(ConsecutiveStaleReports + 1);
+	}
+
+	void SetMissedReports(int32 MissedReports)
+	{
+		if (ConsecutiveStaleReports < StaleReportLimit && MissedReports >= StaleReportLimit)
+		{
+			++Stalls;
+		}
+		ConsecutiveStaleReports = MissedReports;
+	}
+
+	FORCEINLINE bool IsStalled() const
+	{
+		return ConsecutiveStaleReports >= StaleReportLimit;
+	}
+
+	FORCEINLINE double GetIntervalStdDev() const
+	{
+		return IntervalCount > 1 ? FMath::Sqrt(IntervalM2 / (double)(IntervalCount - 1)) : 0.0;
+	}
+
+	//Intervals in microseconds (Welford running mean / variance)
+	void AddInterval(double Interval)
+	{
+		++IntervalCount;
+		const double Delta = Interval - IntervalMean;
+		IntervalMean += Delta / (double)IntervalCount;
+		IntervalM2 += Delta * (Interval - IntervalMean);
+
+		IntervalMin = IntervalCount == 1 ? Interval : FMath::Min(IntervalMin, Interval);
+		IntervalMax = IntervalCount == 1 ? Interval : FMath::Max(IntervalMax, Interval);
+	}
+
+	//Missed reports in a row before the controller is treated as frozen
+	int32 StaleReportLimit = 8;
+
+	uint64 ReceivedReports;
+	uint64 DroppedReports;
+	uint64 DuplicateReports;
+	uint64 Stalls;
+	int32 ConsecutiveStaleReports;
+
+	uint64 IntervalCount;
+	double IntervalMean;
+	double IntervalM2;
+	double IntervalMin;
+	double IntervalMax;
+
+	bool bHasLastReport;
+	//Of the last report with new data, and of the last report at all
+	uint8 LastSequence;
+	uint8 LastSeenSequence;
+	uint32 LastSensorTimestamp;
+};
+#pragma endregion
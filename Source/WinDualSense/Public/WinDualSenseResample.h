@@ -0,0 +1,141 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FDualSenseInputReport;
+struct FDualSenseCalibration;
+
+#pragma region Dual Sense [Fixed Step Resampling]
+//Analogs and motion of one report in the units the device dispatches :
+//sticks -1 ~ 1 and triggers 0 ~ 1 (calibrated, before dead zones), angular velocity deg/s (bias removed), acceleration g
+struct FDualSenseResampleSample
+{
+	//Sensor clock ticks, unwrapped
+	uint64 SensorTime = 0;
+	FVector2D LeftStick = FVector2D::ZeroVector;
+	FVector2D RightStick = FVector2D::ZeroVector;
+	float LeftTrigger = 0.f;
+	float RightTrigger = 0.f;
+	FVector AngularVelocity = FVector::ZeroVector;
+	FVector Acceleration = FVector::ZeroVector;
+
+	//SensorTime is left for the resampler to unwrap
+	static FDualSenseResampleSample Make(const FDualSenseInputReport& Report, const FDualSenseCalibration& Calibration, const FVector& GyroBias);
+};
+
+//Input over one fixed step
+struct FDualSenseResampledStep
+{
+	//Step index on the consumer's grid, and the seconds since the grid started
+	int64 Index = 0;
+	double Time = 0.0;
+
+	//Interpolated between the two reports around the end of the step
+	FVector2D LeftStick = FVector2D::ZeroVector;
+	FVector2D RightStick = FVector2D::ZeroVector;
+	float LeftTrigger = 0.f;
+	float RightTrigger = 0.f;
+
+	//Integrated over the step, each report's rate held since the report before it : degrees turned and their mean rate
+	FVector Rotation = FVector::ZeroVector;
+	FVector AngularVelocity = FVector::ZeroVector;
+	//Mean over the step, g
+	FVector Acceleration = FVector::ZeroVector;
+};
+
+//A fixed step consumer's grid on the sensor clock (physics substeps, vehicle simulation).
+//The grid starts at the controller's first report, or at an origin the consumer gives, so steps never depend on when they are asked for.
+struct FDualSenseResampleCursor
+{
+	explicit FDualSenseResampleCursor(double InStepSeconds = 1.0 / 120.0)
+		: StepSeconds(InStepSeconds)
+	{
+	}
+
+	//Grid starting at a sensor timestamp of the controller instead of its first report (a replay's or a peer's start).
+	//Only for the clock it was taken from, a reconnected controller starts over at its first report
+	FDualSenseResampleCursor(double InStepSeconds, uint32 InOrigin)
+		: StepSeconds(InStepSeconds)
+		, Origin(InOrigin)
+		, bHasOrigin(true)
+	{
+	}
+
+	double StepSeconds;
+
+	//Next step to hand out
+	int64 NextStep = 0;
+	//Steps the consumer fell too far behind for, skipped to the oldest report kept.
+	//Steps older than the kept reports when the cursor is first used are not counted
+	int64 SkippedSteps = 0;
+
+	//Grid origin (sensor ticks) and the resampler epoch it belongs to, a reconnected controller starts a new grid
+	uint64 Origin = 0;
+	uint32 Epoch = 0;
+	bool bHasOrigin = false;
+	bool bAnchored = false;
+};
+
+//Recent reports of one controller on their own sensor timestamps, resampled to any fixed step.
+//Game thread, fed with every report SendControllerEvents reads. The same reports always give the same steps.
+class FDualSenseResampler
+{
+public:
+	//Reports kept, a quarter second at 1000 Hz
+	static constexpr int32 Capacity = 256;
+
+	//New controller, new clock : cursors on the old grid start over
+	void Reset();
+
+	void AddSample(uint32 SensorTimestamp, const FDualSenseResampleSample& Sample);
+
+	//Next step of the cursor's grid, once reports cover all of it. False (OutStep untouched) when the step is not complete yet
+	bool ConsumeStep(FDualSenseResampleCursor& Cursor, FDualSenseResampledStep& OutStep) const;
+
+	//Values at any sensor time covered by the kept reports (clamped to them), rates integrated between two sensor times
+	void SampleAt(uint64 Time, FDualSenseResampledStep& OutStep) const;
+	void Integrate(uint64 StartTime, uint64 EndTime, FDualSenseResampledStep& OutStep) const;
+
+	int32 Num() const
+	{
+		return Count;
+	}
+
+	//Sensor time of the first report since the last Reset, even once it is no longer kept
+	uint64 GetFirstTime() const
+	{
+		return FirstTime;
+	}
+
+	uint64 GetOldestTime() const
+	{
+		return Count > 0 ? Get(0).SensorTime : 0;
+	}
+
+	uint64 GetNewestTime() const
+	{
+		return Count > 0 ? Get(Count - 1).SensorTime : 0;
+	}
+
+private:
+	//0 = oldest
+	FORCEINLINE const FDualSenseResampleSample& Get(int32 Index) const
+	{
+		return Samples[(Head + Index) % Capacity];
+	}
+
+	//First kept report at or after Time (Count when none)
+	int32 FindFirstAtOrAfter(uint64 Time) const;
+
+	FDualSenseResampleSample Samples[Capacity];
+	int32 Head = 0;
+	int32 Count = 0;
+
+	uint32 LastSensorTimestamp = 0;
+	uint64 SensorTime = 0;
+	uint64 FirstTime = 0;
+	uint32 Epoch = 1;
+};
+#pragma endregion
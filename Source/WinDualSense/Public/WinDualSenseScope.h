@@ -0,0 +1,69 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WinDualSenseReport.h"
+#include <atomic>
+
+#pragma region Dual Sense [Sensor Scope]
+//One report as the scope draws it, raw counts
+struct FDualSenseScopeSample
+{
+	uint32 SensorTimestamp;
+	//Microseconds since the previous sample, by the controller clock and by the read time (0 for the first one)
+	float SensorInterval;
+	float HostInterval;
+	int16 Gyroscope[3];
+	int16 Accelerometer[3];
+	//First touch point
+	uint16 Touch[2];
+	//Left X / Y, right X / Y
+	int8 Sticks[4];
+	uint8 Triggers[2];
+	uint8 Sequence;
+	uint8 TouchContact;
+};
+
+//Overwriting ring between the report producer (single writer) and the scope widgets (readers) of one controller.
+//Only written while a scope is open, the producer pays one relaxed load per report otherwise
+class FDualSenseScopeBuffer
+{
+public:
+	//Power of two, 4 s at 1000 Hz
+	static constexpr uint32 Capacity = 4096;
+
+	//Report producer, every report in order
+	void AddReport(const FDualSenseInputReport& Report);
+
+	//Newest samples, oldest first, at most MaxSamples. Samples the producer overwrote while they were copied are dropped.
+	//Any thread, OutSamples keeps its allocation
+	int32 Read(TArray<FDualSenseScopeSample>& OutSamples, int32 MaxSamples) const;
+
+	//A scope opened / closed on the buffer
+	void AddReader();
+	void RemoveReader();
+
+	FORCEINLINE bool HasReaders() const
+	{
+		return Readers.load(std::memory_order_relaxed) > 0;
+	}
+
+	//Samples written since the buffer was made
+	FORCEINLINE uint64 GetWrittenCount() const
+	{
+		return Head.load(std::memory_order_acquire);
+	}
+
+private:
+	std::atomic<uint64> Head{ 0 };
+	std::atomic<int32> Readers{ 0 };
+
+	//Producer only, intervals restart whenever the scope reopens
+	bool bHasLastReport = false;
+	uint32 LastSensorTimestamp = 0;
+	uint64 LastReceiveCycles = 0;
+
+	FDualSenseScopeSample Samples[Capacity];
+};
+#pragma endregion
@@ -0,0 +1,25 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WinDualSenseReport.h"
+#include "WinDualSenseCalibration.h"
+
+#pragma region Dual Sense [Session]
+//Every report one controller sent during a recording, with the calibration it had.
+//Stored as raw USB input reports, loading decodes them through the same path the IO thread uses.
+struct FDualSenseSession
+{
+	static constexpr uint32 CurrentVersion = 1;
+
+	FDualSenseCalibration Calibration;
+	TArray<FDualSenseInputReport> Reports;
+
+	bool Save(const FString& File) const;
+	bool Load(const FString& File);
+
+	//Saved/DualSense/Sessions/<date>.dsession
+	static FString MakeFileName();
+};
+#pragma endregion
@@ -0,0 +1,121 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+//Shared memory layout of the published controller state.
+//Plain C++ on purpose : companion tools include this (and WinDualSenseSharedReader.h) without the engine.
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#pragma region Dual Sense [Shared State Layout]
+namespace DualSenseShared
+{
+	static constexpr uint32_t Magic = 0x4D535344;
+	//Bumped whenever a field below moves, readers refuse any other version
+	static constexpr uint32_t Version = 1;
+
+	static constexpr uint32_t MaxControllers = 16;
+	//Reports kept per controller, power of two
+	static constexpr uint32_t RingSize = 64;
+
+	static constexpr const wchar_t* DefaultName = L"Local\\DualSenseState";
+
+	//One decoded report, buttons are the remapped EDualSenseButtonType bits
+	struct FRecord
+	{
+		//Position in the controller's stream (0, 1, 2, ...), tells a reader the slot was not overwritten meanwhile
+		uint64_t Index;
+		//QueryPerformanceCounter ticks when the report was read, see FHeader::TicksPerSecond
+		uint64_t ReceiveTicks;
+		//Device clock, 3MHz
+		uint32_t SensorTimestamp;
+		uint32_t Buttons;
+		uint8_t Sequence;
+		uint8_t BatteryLevel;
+		uint8_t LeftTrigger;
+		uint8_t RightTrigger;
+		int8_t LeftStick[2];
+		int8_t RightStick[2];
+		//Raw counts, correctly labeled
+		int16_t Gyroscope[3];
+		int16_t Accelerometer[3];
+		uint16_t TouchPoints[2][2];
+		uint32_t Reserved;
+	};
+
+	//Seqlock : odd while the writer is inside Record
+	struct alignas(64) FRingEntry
+	{
+		std::atomic<uint32_t> Sequence;
+		uint32_t Padding;
+		FRecord Record;
+	};
+
+	struct alignas(64) FControllerBlock
+	{
+		//Reports published so far, the newest is Ring[(WriteCount - 1) % RingSize]
+		std::atomic<uint64_t> WriteCount;
+		std::atomic<uint32_t> bConnected;
+		uint32_t Padding;
+		FRingEntry Ring[RingSize];
+	};
+
+	struct alignas(64) FHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		//Sizes a reader checks before trusting anything else
+		uint32_t RegionSize;
+		uint32_t RecordSize;
+		uint32_t MaxControllers;
+		uint32_t RingSize;
+		uint64_t TicksPerSecond;
+		//ReceiveTicks clock, refreshed by the game thread every frame, stops when the game does
+		std::atomic<uint64_t> HeartbeatTicks;
+	};
+
+	struct FRegion
+	{
+		FHeader Header;
+		FControllerBlock Controllers[MaxControllers];
+	};
+
+	static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free, "Shared state needs address free atomics");
+	static_assert((RingSize & (RingSize - 1)) == 0, "RingSize must be a power of two");
+
+	//Single writer per controller. Never waits on readers
+	inline void WriteRecord(FControllerBlock& Block, FRecord Record)
+	{
+		const uint64_t Index = Block.WriteCount.load(std::memory_order_relaxed);
+		FRingEntry& Entry = Block.Ring[Index & (RingSize - 1)];
+		Record.Index = Index;
+
+		const uint32_t Sequence = Entry.Sequence.load(std::memory_order_relaxed);
+		Entry.Sequence.store(Sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		std::memcpy(&Entry.Record, &Record, sizeof(FRecord));
+		Entry.Sequence.store(Sequence + 2, std::memory_order_release);
+
+		Block.WriteCount.store(Index + 1, std::memory_order_release);
+	}
+
+	//Copies the record at Index, false when the writer was inside it or already lapped it
+	inline bool ReadRecord(const FControllerBlock& Block, uint64_t Index, FRecord& OutRecord)
+	{
+		const FRingEntry& Entry = Block.Ring[Index & (RingSize - 1)];
+
+		const uint32_t SequenceBefore = Entry.Sequence.load(std::memory_order_acquire);
+		if (SequenceBefore & 1)
+		{
+			return false;
+		}
+
+		std::memcpy(&OutRecord, &Entry.Record, sizeof(FRecord));
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		return Entry.Sequence.load(std::memory_order_relaxed) == SequenceBefore && OutRecord.Index == Index;
+	}
+}
+#pragma endregion
@@ -0,0 +1,172 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+//Reader side of the published controller state, header only, no engine.
+//Include <Windows.h> first. Reads never lock and never make the game wait, a torn read is retried or reported as missed.
+
+#include "WinDualSenseSharedLayout.h"
+
+#pragma region Dual Sense [Shared State Reader]
+class FDualSenseSharedReader
+{
+public:
+	//Attempts at one slot before giving up on it (the writer only holds a slot for a memcpy)
+	static constexpr int MaxRetries = 16;
+
+	~FDualSenseSharedReader()
+	{
+		Close();
+	}
+
+	//False when no game publishes under Name or the layout does not match this header
+	bool Open(const wchar_t* Name = DualSenseShared::DefaultName)
+	{
+		Close();
+
+		Mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, Name);
+		if (!Mapping)
+		{
+			return false;
+		}
+
+		Region = static_cast<const DualSenseShared::FRegion*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, sizeof(DualSenseShared::FRegion)));
+		if (!Region || !IsCompatible(Region->Header))
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void Close()
+	{
+		if (Region)
+		{
+			UnmapViewOfFile(Region);
+			Region = nullptr;
+		}
+		if (Mapping)
+		{
+			CloseHandle(Mapping);
+			Mapping = nullptr;
+		}
+	}
+
+	bool IsOpen() const
+	{
+		return Region != nullptr;
+	}
+
+	bool IsConnected(uint32_t Controller) const
+	{
+		return Region && Controller < DualSenseShared::MaxControllers && Region->Controllers[Controller].bConnected.load(std::memory_order_acquire) != 0;
+	}
+
+	//Seconds since the game last refreshed the heartbeat, huge once it stopped publishing
+	double GetWriterAge() const
+	{
+		if (!Region)
+		{
+			return -1.0;
+		}
+
+		LARGE_INTEGER Now;
+		QueryPerformanceCounter(&Now);
+		const uint64_t Heartbeat = Region->Header.HeartbeatTicks.load(std::memory_order_acquire);
+		return (double)((uint64_t)Now.QuadPart - Heartbeat) / (double)Region->Header.TicksPerSecond;
+	}
+
+	//Reports published so far, a cursor starting here only sees what comes next
+	uint64_t GetWriteCount(uint32_t Controller) const
+	{
+		return Region && Controller < DualSenseShared::MaxControllers ? Region->Controllers[Controller].WriteCount.load(std::memory_order_acquire) : 0;
+	}
+
+	//Newest report of the controller
+	bool ReadLatest(uint32_t Controller, DualSenseShared::FRecord& OutRecord) const
+	{
+		if (!Region || Controller >= DualSenseShared::MaxControllers)
+		{
+			return false;
+		}
+
+		const DualSenseShared::FControllerBlock& Block = Region->Controllers[Controller];
+		for (int Attempt = 0; Attempt < MaxRetries; ++Attempt)
+		{
+			const uint64_t WriteCount = Block.WriteCount.load(std::memory_order_acquire);
+			if (WriteCount == 0)
+			{
+				return false;
+			}
+			if (DualSenseShared::ReadRecord(Block, WriteCount - 1, OutRecord))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//Reports published after Cursor (0 = from the oldest one still in the ring), up to MaxRecords.
+	//Cursor moves past what was returned, OutMissed counts the reports the writer overwrote before we got to them.
+	//A cursor past the writer's count (the region was published again) restarts at 0.
+	uint32_t ReadSince(uint32_t Controller, uint64_t& Cursor, DualSenseShared::FRecord* OutRecords, uint32_t MaxRecords, uint64_t* OutMissed = nullptr) const
+	{
+		uint64_t Missed = 0;
+		uint32_t Count = 0;
+
+		if (Region && Controller < DualSenseShared::MaxControllers)
+		{
+			const DualSenseShared::FControllerBlock& Block = Region->Controllers[Controller];
+			const uint64_t WriteCount = Block.WriteCount.load(std::memory_order_acquire);
+
+			//The game published the region again and its counters restarted, start over from its oldest report
+			if (Cursor > WriteCount)
+			{
+				Cursor = 0;
+			}
+
+			//Older ones are gone, one entry of margin for the slot being written
+			const uint64_t Oldest = WriteCount > DualSenseShared::RingSize - 1 ? WriteCount - (DualSenseShared::RingSize - 1) : 0;
+			if (Cursor < Oldest)
+			{
+				Missed += Oldest - Cursor;
+				Cursor = Oldest;
+			}
+
+			while (Cursor < WriteCount && Count < MaxRecords)
+			{
+				if (DualSenseShared::ReadRecord(Block, Cursor, OutRecords[Count]))
+				{
+					++Count;
+				}
+				else
+				{
+					++Missed;
+				}
+				++Cursor;
+			}
+		}
+
+		if (OutMissed)
+		{
+			*OutMissed = Missed;
+		}
+		return Count;
+	}
+
+	static bool IsCompatible(const DualSenseShared::FHeader& Header)
+	{
+		return Header.Magic == DualSenseShared::Magic
+			&& Header.Version == DualSenseShared::Version
+			&& Header.RegionSize == sizeof(DualSenseShared::FRegion)
+			&& Header.RecordSize == sizeof(DualSenseShared::FRecord)
+			&& Header.MaxControllers == DualSenseShared::MaxControllers
+			&& Header.RingSize == DualSenseShared::RingSize;
+	}
+
+private:
+	HANDLE Mapping = nullptr;
+	const DualSenseShared::FRegion* Region = nullptr;
+};
+#pragma endregion
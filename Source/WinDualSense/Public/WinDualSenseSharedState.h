@@ -0,0 +1,47 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WinDualSenseReport.h"
+#include "WinDualSenseSharedLayout.h"
+
+#pragma region Dual Sense [Shared State Writer]
+//Publishes every controller's reports into a named shared memory region (WinDualSenseSharedLayout.h)
+//for tools in other processes, which read it through FDualSenseSharedReader
+class FDualSenseSharedStateWriter
+{
+public:
+	//A region whose heartbeat is older than this belongs to a game that is gone and can be taken over
+	static constexpr double StaleHeartbeatSeconds = 2.0;
+
+	~FDualSenseSharedStateWriter();
+
+	bool Open(const FString& InName);
+	void Close();
+
+	FORCEINLINE bool IsOpen() const
+	{
+		return Region != nullptr;
+	}
+
+	FORCEINLINE const FString& GetName() const
+	{
+		return Name;
+	}
+
+	//Report producer of the controller (single writer per controller)
+	void Publish(int32 ControllerId, const FDualSenseInputReport& Report);
+
+	//Game thread
+	void SetConnected(int32 ControllerId, bool bConnected);
+	void Heartbeat();
+
+	static DualSenseShared::FRecord MakeRecord(const FDualSenseInputReport& Report);
+
+private:
+	FString Name;
+	void* Mapping = nullptr;
+	DualSenseShared::FRegion* Region = nullptr;
+};
+#pragma endregion
@@ -0,0 +1,239 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "WinDualSenseReport.h"
+#include <atomic>
+
+class FSocket;
+class FInternetAddr;
+class FDualSenseIOThread;
+
+//Report fields sent over the wire, in packet order
+enum class EDualSenseStreamField : uint8
+{
+	ButtonsAndDpad,
+	ButtonsA,
+	ButtonsB,
+	LeftStickX,
+	LeftStickY,
+	RightStickX,
+	RightStickY,
+	LeftTrigger,
+	RightTrigger,
+	Touch1X,
+	Touch1Y,
+	Touch2X,
+	Touch2Y,
+	//Raw contact bytes, finger id and the no contact bit
+	Touch1Contact,
+	Touch2Contact,
+	GyroscopeX,
+	GyroscopeY,
+	GyroscopeZ,
+	AccelerometerX,
+	AccelerometerY,
+	AccelerometerZ,
+	LeftTriggerFeedback,
+	RightTriggerFeedback,
+	//Battery level, charging, fully charged, headphone
+	Status,
+	Sequence,
+	SensorTimestamp,
+	MAX_COUNT
+};
+
+#pragma region Dual Sense [Stream]
+//Remote input : the client delta encodes every report against the last state the host acknowledged
+//and sends it over UDP, the host decodes it into an injected controller slot.
+namespace DualSenseStream
+{
+	static constexpr uint16 Magic = 0xD55E;
+	static constexpr int32 DefaultPort = 7765;
+
+	static constexpr int32 FieldCount = (int32)EDualSenseStreamField::MAX_COUNT;
+
+	//Packets both sides remember, a baseline older than this is never used
+	static constexpr int32 HistorySize = 32;
+	//Earlier packets repeated in every datagram
+	static constexpr int32 MaxRedundancy = 3;
+
+	//Every field changed by its full width, plus the packet header
+	static constexpr int32 MaxPacketBytes = 64;
+	static constexpr int32 MaxDatagramSize = 4 + MaxPacketBytes * (MaxRedundancy + 1);
+	static constexpr int32 AckSize = 5;
+
+	//Packets the client sends without any ack coming back before it stops trusting its baseline and sends key frames
+	static constexpr int32 AckTimeout = 16;
+
+	int32 GetFieldBits(EDualSenseStreamField Field);
+
+	//Host to client : newest packet decoded, or with bNeedKeyFrame the newest packet it had no baseline for
+	//(a restarted host). Returns the datagram size
+	int32 WriteAck(uint16 Sequence, bool bNeedKeyFrame, uint8* OutDatagram);
+	bool ReadAck(const uint8* Datagram, int32 Size, uint16& OutSequence, bool& bOutNeedKeyFrame);
+}
+
+//One report as stream field values, each masked to its width
+struct FDualSenseStreamState
+{
+	uint32 Fields[DualSenseStream::FieldCount];
+
+	static FDualSenseStreamState FromReport(const FDualSenseInputReport& Report);
+	//Buttons are packed again from the state, the host applies its own remap
+	void ToReport(FDualSenseInputReport& OutReport) const;
+
+	FORCEINLINE bool operator==(const FDualSenseStreamState& Other) const
+	{
+		return FMemory::Memcmp(Fields, Other.Fields, sizeof(Fields)) == 0;
+	}
+};
+
+//Client side codec
+class FDualSenseStreamEncoder
+{
+public:
+	FDualSenseStreamEncoder();
+
+	void Reset();
+
+	//Returns the datagram size (at most MaxDatagramSize)
+	int32 Encode(const FDualSenseInputReport& Report, uint8* OutDatagram);
+	void Acknowledge(uint16 Sequence);
+	//The host could not decode Sequence, the next packet is a key frame unless one went out after it
+	void RequestKeyFrame(uint16 Sequence);
+
+	//Earlier packets sent again with every datagram (0 - MaxRedundancy)
+	int32 Redundancy = 1;
+
+	//Written by the encoding thread, readable from any
+	std::atomic<uint64> KeyFrames{ 0 };
+	//Key frames the host asked for, and baselines dropped because no ack came back for AckTimeout packets
+	std::atomic<uint64> KeyFrameRequests{ 0 };
+	std::atomic<uint64> AckTimeouts{ 0 };
+
+private:
+	struct FPacket
+	{
+		bool bValid = false;
+		uint16 Sequence = 0;
+		FDualSenseStreamState State;
+		//Encoded once, repeated as is for redundancy
+		uint8 Bytes[DualSenseStream::MaxPacketBytes];
+		int32 NumBits = 0;
+	};
+
+	FPacket History[DualSenseStream::HistorySize];
+	uint16 NextSequence = 0;
+	bool bHasAck = false;
+	uint16 AckedSequence = 0;
+	//Since the last ack of any kind came back
+	int32 PacketsSinceAck = 0;
+	bool bHasKeyFrame = false;
+	uint16 KeyFrameSequence = 0;
+};
+
+//Host side codec
+class FDualSenseStreamDecoder
+{
+public:
+	FDualSenseStreamDecoder();
+
+	void Reset();
+
+	//Emit gets every report newer than the last one emitted, oldest first. Returns true when something new was decoded
+	bool Decode(const uint8* Datagram, int32 Size, TFunctionRef<void(const FDualSenseInputReport&)> Emit);
+
+	//Newest packet decoded, the one to acknowledge
+	FORCEINLINE uint16 GetNewestSequence() const { return NewestSequence; }
+	//A packet newer than everything decoded had no baseline, nothing decodes until a key frame arrives
+	FORCEINLINE bool NeedsKeyFrame() const { return bNeedsKeyFrame; }
+	FORCEINLINE uint16 GetUndecodableSequence() const { return UndecodableSequence; }
+
+	uint64 DecodedPackets = 0;
+	//Decoded from a redundant copy, the datagram carrying them first was lost
+	uint64 RecoveredPackets = 0;
+	//Baseline no longer (or never) known
+	uint64 UndecodablePackets = 0;
+	//Arrived after a newer packet was emitted, kept as a baseline only
+	uint64 StalePackets = 0;
+	uint64 MalformedDatagrams = 0;
+
+private:
+	struct FPacket
+	{
+		bool bValid = false;
+		uint16 Sequence = 0;
+		FDualSenseStreamState State;
+	};
+
+	FPacket History[DualSenseStream::HistorySize];
+	bool bHasPacket = false;
+	uint16 NewestSequence = 0;
+	bool bNeedsKeyFrame = false;
+	uint16 UndecodableSequence = 0;
+};
+
+//Sends one controller's reports to a host
+class FDualSenseStreamClient
+{
+public:
+	~FDualSenseStreamClient();
+
+	bool Connect(const FString& Host, int32 Port);
+	void Disconnect();
+
+	//Reads the acks that came back, then encodes and sends the report
+	bool Send(const FDualSenseInputReport& Report);
+
+	FDualSenseStreamEncoder Encoder;
+
+	//Datagrams dropped before sending (0 - 1), simulates a lossy link
+	float DropRate = 0.f;
+
+	//Written by the sending thread, readable from any
+	std::atomic<uint64> SentReports{ 0 };
+	std::atomic<uint64> SentBytes{ 0 };
+	std::atomic<uint64> DroppedDatagrams{ 0 };
+
+private:
+	FSocket* Socket = nullptr;
+	TSharedPtr<FInternetAddr> HostAddress;
+	FRandomStream DropRandom;
+};
+
+//Receives a client's reports on its own thread and injects them into one IO thread slot
+class FDualSenseStreamHost : public FRunnable
+{
+public:
+	FDualSenseStreamHost(FDualSenseIOThread& InIOThread, int32 InSlot);
+	~FDualSenseStreamHost();
+
+	//Claims the slot and starts listening
+	bool Start(int32 Port);
+
+	//FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	FORCEINLINE int32 GetSlot() const { return Slot; }
+
+	std::atomic<uint64> ReceivedBytes{ 0 };
+	std::atomic<uint64> ReceivedReports{ 0 };
+
+	//Host thread only while running
+	FDualSenseStreamDecoder Decoder;
+
+private:
+	FDualSenseIOThread& IOThread;
+	int32 Slot;
+	bool bHasSlot = false;
+
+	FSocket* Socket = nullptr;
+	FRunnableThread* Thread = nullptr;
+	std::atomic<bool> bStopping{ false };
+};
+#pragma endregion
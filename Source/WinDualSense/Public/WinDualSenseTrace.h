@@ -0,0 +1,47 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Config.h"
+
+//Compiled out in shipping (and wherever trace is), the scopes below are then empty and the counters never gathered
+#ifndef DUALSENSE_TRACE_ENABLED
+#define DUALSENSE_TRACE_ENABLED (UE_TRACE_ENABLED && !UE_BUILD_SHIPPING)
+#endif
+
+#if DUALSENSE_TRACE_ENABLED
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+//Unreal Insights channel "DualSense" : -trace=cpu,counters,dualsense or Trace.Enable DualSense at runtime
+UE_TRACE_CHANNEL_EXTERN(DualSenseChannel);
+
+#define DUALSENSE_TRACE_IS_ENABLED() UE_TRACE_CHANNELEXPR_IS_ENABLED(DualSenseChannel)
+#define DUALSENSE_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(DualSense_##Name, DualSenseChannel)
+#else
+#define DUALSENSE_TRACE_IS_ENABLED() false
+#define DUALSENSE_TRACE_SCOPE(Name)
+#endif
+
+#pragma region Dual Sense [Trace]
+//Game thread counters, only gathered while the channel is on and published once per frame
+struct FDualSenseTraceCounters
+{
+	//Deepest report queue a controller had when the frame read it
+	int32 ReportQueueDepth = 0;
+	//Output commands drained and output reports written this frame
+	int32 OutputCommands = 0;
+	int32 OutputReports = 0;
+	//Commands that did not get an output report of their own (nothing changed, or folded into another one), since start
+	int64 SuppressedOutputs = 0;
+
+	//ReceivedReports total of every controller at the start of the current one second window
+	uint64 WindowStartCycles = 0;
+	uint64 WindowStartReports = 0;
+	int64 ReportsPerSecond = 0;
+
+	//ReceivedReports : total of every connected controller. Publishes, then starts the next frame
+	void EndFrame(uint64 ReceivedReports);
+};
+#pragma endregion
@@ -0,0 +1,111 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WinDualSense_Enum.h"
+#include <atomic>
+
+struct FDualSenseInputReport;
+
+#pragma region Dual Sense [Usage Counters]
+//Session usage of one controller slot. Only the slot's report producer writes, so a count goes up with a relaxed
+//load and store instead of a locked read-modify-write. Readers on any thread see every counter whole, not all of them at once.
+struct FDualSenseUsageCounters
+{
+	static constexpr int32 ButtonCount = (int32)EDualSenseButtonType::MAX_COUNT;
+	//Heatmap cells per stick axis, 32 counts each, row 0 is full up
+	static constexpr int32 StickCells = 8;
+	//Trigger travel buckets, 16 counts each
+	static constexpr int32 TriggerBuckets = 16;
+	//Hold durations : under 16ms, under 32ms, ... under 2048ms, longer
+	static constexpr int32 HoldBuckets = 9;
+	//Angular speed on the fastest axis : under 10, 30, 90, 270 deg/s, faster
+	static constexpr int32 GyroBuckets = 5;
+
+	FDualSenseUsageCounters();
+
+	std::atomic<uint64> Reports;
+	//Device time the reports covered, gaps (disconnects, stalls) left out
+	std::atomic<uint64> SensorTicks;
+
+	std::atomic<uint32> Presses[ButtonCount];
+	//Sensor ticks between press and release, per button
+	std::atomic<uint64> HoldTicks[ButtonCount];
+	//Every button's releases by hold duration
+	std::atomic<uint32> Holds[HoldBuckets];
+
+	//Reports per region
+	std::atomic<uint32> LeftStick[StickCells * StickCells];
+	std::atomic<uint32> RightStick[StickCells * StickCells];
+	std::atomic<uint32> LeftTrigger[TriggerBuckets];
+	std::atomic<uint32> RightTrigger[TriggerBuckets];
+
+	//Reports per angular speed, and the device time spent turning faster than 10 deg/s
+	std::atomic<uint32> Gyro[GyroBuckets];
+	std::atomic<uint64> GyroActiveTicks;
+
+	//Button and motion gesture events lost to a full event queue (the game thread read them too late)
+	std::atomic<uint64> DroppedGestures;
+};
+
+//Updates a slot's counters from its reports, owned by the report producer (IO thread or injector)
+class FDualSenseUsageTracker
+{
+public:
+	void AddReport(const FDualSenseInputReport& Report);
+
+	//Holds in progress are forgotten, the counts carry on over reconnects
+	void ResetTracking();
+
+	void AddDroppedGesture();
+
+	const FDualSenseUsageCounters& GetCounters() const
+	{
+		return Counters;
+	}
+
+private:
+	void CountButtons(uint32 Buttons, uint32 ChangedButtons, uint32 SensorTimestamp);
+
+	FDualSenseUsageCounters Counters;
+
+	uint32 LastButtons = 0;
+	uint32 LastSensorTimestamp = 0;
+	bool bHasLastReport = false;
+	uint32 PressTimestamps[FDualSenseUsageCounters::ButtonCount] = {};
+};
+
+//Plain copy of the counters at one point, minus a baseline for usage since a reset
+struct FDualSenseUsageSnapshot
+{
+	static constexpr int32 ButtonCount = FDualSenseUsageCounters::ButtonCount;
+	static constexpr int32 StickCells = FDualSenseUsageCounters::StickCells;
+	static constexpr int32 TriggerBuckets = FDualSenseUsageCounters::TriggerBuckets;
+	static constexpr int32 HoldBuckets = FDualSenseUsageCounters::HoldBuckets;
+	static constexpr int32 GyroBuckets = FDualSenseUsageCounters::GyroBuckets;
+
+	//Column names of AppendCsv rows
+	static const TCHAR* CsvHeader;
+
+	void Capture(const FDualSenseUsageCounters& Counters);
+	void Subtract(const FDualSenseUsageSnapshot& Baseline);
+
+	void Log(FOutputDevice& Ar, int32 ControllerId) const;
+	//One Controller,Counter,Index,Value row per non zero counter, heatmap cells are indexed Row * StickCells + Column
+	void AppendCsv(FString& Out, int32 ControllerId) const;
+
+	uint64 Reports = 0;
+	uint64 SensorTicks = 0;
+	uint64 Presses[ButtonCount] = {};
+	uint64 HoldTicks[ButtonCount] = {};
+	uint64 Holds[HoldBuckets] = {};
+	uint64 LeftStick[StickCells * StickCells] = {};
+	uint64 RightStick[StickCells * StickCells] = {};
+	uint64 LeftTrigger[TriggerBuckets] = {};
+	uint64 RightTrigger[TriggerBuckets] = {};
+	uint64 Gyro[GyroBuckets] = {};
+	uint64 GyroActiveTicks = 0;
+	uint64 DroppedGestures = 0;
+};
+#pragma endregion
@@ -43,6 +43,9 @@ public class WinDualSense : ModuleRules
 		PrivateDependencyModuleNames.AddRange(
 			new string[]
 			{
+				"SlateCore",
+				"Sockets",
+				"Networking"
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);